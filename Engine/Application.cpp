@@ -20,7 +20,12 @@
 #include "ImGui/ImGuizmo.h"
 #include "SDL/include/SDL.h"
 #include "JSONSerialization.h"
-#include "mmgr/mmgr.h"
+#include "BinarySerialization.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "FrameStats.h"
+#include "MemoryTracker.h"
 
 static int malloc_count;
 static void *counted_malloc(size_t size);
@@ -43,6 +48,11 @@ Application::Application()
 
 	random = new math::LCG();
 	Json_seria = new JSONSerialization();
+	Binary_seria = new BinarySerialization();
+	jobs = new JobSystem();
+	profiler = new Profiler();
+	frame_stats = new FrameStats();
+	memory = new MemoryTracker();
 
 	// The order of calls is very important!
 	// Modules will Init() Start() and Update in this order
@@ -77,6 +87,11 @@ Application::~Application()
 	RELEASE(configuration);
 	RELEASE(random);
 	RELEASE(Json_seria);
+	RELEASE(Binary_seria);
+	RELEASE(jobs);
+	RELEASE(profiler);
+	RELEASE(frame_stats);
+	RELEASE(memory);
 }
 
 bool Application::Init()
@@ -87,6 +102,17 @@ bool Application::Init()
 	JSON_Object* config;
 	JSON_Object* config_node;
 
+	// Check the SIMD level of the build before the modules start ------
+	LogCpuFeatures();
+	if (CheckBuildSIMDSupport() == false)
+	{
+		LOG("ERROR: This build uses %s instructions and the CPU doesn't support them.", GetBuildSIMDLevel());
+		SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Culverin", "This build needs a CPU with the SIMD instruction set it was compiled with.\nUse the Release configuration instead.", NULL);
+		return false;
+	}
+
+	jobs->Start();
+
 	config_file = json_parse_file("config.json");
 
 	configuration = new DockContext();
@@ -103,6 +129,7 @@ bool Application::Init()
 		orgName = json_object_get_string(config_node, "Org Name");
 		maxFPS = json_object_get_number(config_node, "Max FPS");
 		vsync = json_object_get_boolean(config_node, "VSYNC");
+		memory->Load(config_node);
 		SetFpsCap(maxFPS);
 		// ---------------------------------------------------
 
@@ -146,6 +173,9 @@ void Application::PrepareUpdate()
 	realTime.dt = (float)realTime.ms_timer.ReadSec();
 	realTime.ms_timer.Start();
 	realTime.frame_time.Start();
+	jobs->BeginFrame();
+	profiler->BeginFrame();
+	frame_stats->BeginFrame();
 
 	if (gameTime.prepare_frame)
 	{
@@ -177,7 +207,7 @@ void Application::FinishUpdate()
 	// SAVE & LOAD FUNCTIONS ------------------------
 	if (want_to_save == true)
 	{
-		Json_seria->SaveScene();
+		Binary_seria->SaveScene();
 		want_to_save = false;
 	}
 
@@ -186,7 +216,7 @@ void Application::FinishUpdate()
 		//Before Delete GameObjects Del Variables Scripts GameObject 
 		App->scene->ClearAllVariablesScript();
 		App->scene->DeleteGameObjects(App->scene->gameobjects);
-		Json_seria->LoadScene();
+		Binary_seria->LoadScene();
 		App->resource_manager->ReImportAllScripts();
 		want_to_load = false;
 	}
@@ -209,7 +239,7 @@ void Application::FinishUpdate()
 	realTime.last_frame_ms = realTime.frame_time.Read();
 	uint32 frames_on_last_update = realTime.prev_last_sec_frame_count;
 	
-	ms_log[ms_index] = realTime.last_frame_ms;
+	ms_log[ms_index] = frame_stats->ReadFrameMs();
 
 	//Get all performance data-------------------
 	std::list<Module*>::iterator item = list_modules.begin();
@@ -226,6 +256,10 @@ void Application::FinishUpdate()
 	}
 
 	ms_index = (ms_index + 1) % IM_ARRAYSIZE(ms_log); //ms_index works for all the logs (same size)
+	jobs->EndFrame();
+	profiler->EndFrame();
+	frame_stats->EndFrame(*profiler);
+	memory->Update();
 
 
 	if (realTime.capped_ms > 0 && realTime.last_frame_ms < realTime.capped_ms)
@@ -258,27 +292,33 @@ update_status Application::Update()
 	// ---------------------------------------------------------
 	
 	std::list<Module*>::iterator item = list_modules.begin();
-	while (item != list_modules.end() && ret == UPDATE_CONTINUE)
 	{
-		if (item._Ptr->_Myval->IsEnabled())
+		ProfilerZone phase("PreUpdate");
+		while (item != list_modules.end() && ret == UPDATE_CONTINUE)
 		{
-			if (item._Ptr->_Myval == camera)
-			{
-				ret = item._Ptr->_Myval->PreUpdate(realTime.dt); // Camera can't be affected by Game Time Scale (0 dt = 0 movement)
-			}
-			else
+			if (item._Ptr->_Myval->IsEnabled())
 			{
-				if (engineState == EngineState::PLAY || engineState == EngineState::PLAYFRAME)
+				ProfilerZone zone(item._Ptr->_Myval->name.c_str());
+				if (item._Ptr->_Myval == camera)
 				{
-					ret = item._Ptr->_Myval->PreUpdate(realTime.dt * gameTime.timeScale);
+					ret = item._Ptr->_Myval->PreUpdate(realTime.dt); // Camera can't be affected by Game Time Scale (0 dt = 0 movement)
 				}
-				else if (engineState == EngineState::PAUSE || engineState == EngineState::STOP)
+				else
 				{
-					ret = item._Ptr->_Myval->PreUpdate(0);
+					if (engineState == EngineState::PLAY || engineState == EngineState::PLAYFRAME)
+					{
+						ret = item._Ptr->_Myval->PreUpdate(realTime.dt * gameTime.timeScale);
+					}
+					else if (engineState == EngineState::PAUSE || engineState == EngineState::STOP)
+					{
+						ret = item._Ptr->_Myval->PreUpdate(0);
+					}
 				}
+				item._Ptr->_Myval->preUpdate_t = zone.ReadMs();
 			}
+			item++;
 		}
-		item++;
+		frame_stats->SetPhase(FRAME_SERIES_PREUPDATE, phase.ReadMs());
 	}
 
 	/* ImGui + ImGuizmo Begin Frame */
@@ -287,28 +327,34 @@ update_status Application::Update()
 
 	item = list_modules.begin();
 
-	while (item != list_modules.end() && ret == UPDATE_CONTINUE)
 	{
-		if (item._Ptr->_Myval->IsEnabled())
+		ProfilerZone phase("Update");
+		while (item != list_modules.end() && ret == UPDATE_CONTINUE)
 		{
-			if (item._Ptr->_Myval == camera)
-			{
-				// Camera can't be affected by Game Time Scale (0 dt = 0 movement)
-				ret = item._Ptr->_Myval->Update(realTime.dt); 
-			}
-			else
+			if (item._Ptr->_Myval->IsEnabled())
 			{
-				if (engineState == EngineState::PLAY || engineState == EngineState::PLAYFRAME)
+				ProfilerZone zone(item._Ptr->_Myval->name.c_str());
+				if (item._Ptr->_Myval == camera)
 				{
-					ret = item._Ptr->_Myval->Update(realTime.dt * gameTime.timeScale);
+					// Camera can't be affected by Game Time Scale (0 dt = 0 movement)
+					ret = item._Ptr->_Myval->Update(realTime.dt); 
 				}
-				else if (engineState == EngineState::PAUSE || engineState == EngineState::STOP)
+				else
 				{
-					ret = item._Ptr->_Myval->Update(0);
+					if (engineState == EngineState::PLAY || engineState == EngineState::PLAYFRAME)
+					{
+						ret = item._Ptr->_Myval->Update(realTime.dt * gameTime.timeScale);
+					}
+					else if (engineState == EngineState::PAUSE || engineState == EngineState::STOP)
+					{
+						ret = item._Ptr->_Myval->Update(0);
+					}
 				}
+				item._Ptr->_Myval->Update_t = zone.ReadMs();
 			}
+			item++;
 		}
-		item++;
+		frame_stats->SetPhase(FRAME_SERIES_UPDATE, phase.ReadMs());
 	}
 
 	//PERFORMANCE WINDOW -----------------------
@@ -333,6 +379,9 @@ update_status Application::Update()
 				}
 				item++;
 			}
+			jobs->ShowPerformance(); // Last frame
+			profiler->ShowPerformance();
+			frame_stats->ShowPerformance();
 			ImGui::End();
 		}
 		stop_perf = false;
@@ -340,28 +389,34 @@ update_status Application::Update()
 	//-----------------------------------------------
 
 	item = list_modules.begin();
-	while (item != list_modules.end() && ret == UPDATE_CONTINUE)
 	{
-		if (item._Ptr->_Myval->IsEnabled())
+		ProfilerZone phase("PostUpdate");
+		while (item != list_modules.end() && ret == UPDATE_CONTINUE)
 		{
-			if (item._Ptr->_Myval == camera)
-			{
-				// Camera can't be affected by Game Time Scale (0 dt = 0 movement)
-				ret = item._Ptr->_Myval->PostUpdate(realTime.dt); 
-			}
-			else
+			if (item._Ptr->_Myval->IsEnabled())
 			{
-				if (engineState == EngineState::PLAY || engineState == EngineState::PLAYFRAME)
+				ProfilerZone zone(item._Ptr->_Myval->name.c_str());
+				if (item._Ptr->_Myval == camera)
 				{
-					ret = item._Ptr->_Myval->PostUpdate(realTime.dt * gameTime.timeScale);
+					// Camera can't be affected by Game Time Scale (0 dt = 0 movement)
+					ret = item._Ptr->_Myval->PostUpdate(realTime.dt); 
 				}
-				else if (engineState == EngineState::PAUSE || engineState == EngineState::STOP)
+				else
 				{
-					ret = item._Ptr->_Myval->PostUpdate(0);
+					if (engineState == EngineState::PLAY || engineState == EngineState::PLAYFRAME)
+					{
+						ret = item._Ptr->_Myval->PostUpdate(realTime.dt * gameTime.timeScale);
+					}
+					else if (engineState == EngineState::PAUSE || engineState == EngineState::STOP)
+					{
+						ret = item._Ptr->_Myval->PostUpdate(0);
+					}
 				}
+				item._Ptr->_Myval->postUpdate_t = zone.ReadMs();
 			}
+			item++;
 		}
-		item++;
+		frame_stats->SetPhase(FRAME_SERIES_POSTUPDATE, phase.ReadMs());
 	}
 
 	FinishUpdate();
@@ -447,38 +502,16 @@ void Application::Config()
 			}
 
 			// MEMORY CONSUMPTION ----------------------------------------------
-			sMStats stats = m_getMemoryStatistics();
 			if (!configuration->_BeginDock("Memory Consumption", temp, 0))
 			{
 				configuration->_EndDock();
 			}
 			else
 			{
-				ImGui::BulletText("ACCUMULATED");
-				ImGui::Text("- Actual Memory:"); ImGui::SameLine();
-				ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.08f, 1.0f), "%i", stats.accumulatedActualMemory);
-				ImGui::Text("- Allocated memory:"); ImGui::SameLine();
-				ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.08f, 1.0f), "%i", stats.accumulatedAllocUnitCount);
-				ImGui::Text("- Reported memory:"); ImGui::SameLine();
-				ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.08f, 1.0f), "%i", stats.accumulatedReportedMemory);
-				ImGui::Spacing();
-
-				ImGui::BulletText("PEAK");
-				ImGui::Text("- Actual Memory:"); ImGui::SameLine();
-				ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.08f, 1.0f), "%i", stats.peakActualMemory);
-				ImGui::Text("- Allocated memory:"); ImGui::SameLine();
-				ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.08f, 1.0f), "%i", stats.peakAllocUnitCount);
-				ImGui::Text("- Reported memory:"); ImGui::SameLine();
-				ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.08f, 1.0f), "%i", stats.peakReportedMemory);
+				memory->ShowAllocator();
 				ImGui::Spacing();
 
-				ImGui::BulletText("TOTAL");
-				ImGui::Text("- Actual memory:"); ImGui::SameLine();
-				ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.08f, 1.0f), "%i", stats.totalActualMemory);
-				ImGui::Text("- Allocated memory:"); ImGui::SameLine();
-				ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.08f, 1.0f), "%i", stats.totalAllocUnitCount);
-				ImGui::Text("- Reported memory:"); ImGui::SameLine();
-				ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.08f, 1.0f), "%i", stats.totalReportedMemory);
+				memory->ShowMemory();
 
 				configuration->_EndDock();
 			}
@@ -525,6 +558,7 @@ bool Application::CleanUp()
 		item--;
 		ret = item._Ptr->_Myval->CleanUp();
 	}
+	jobs->Stop();
 	return ret;
 }
 
@@ -570,6 +604,7 @@ bool Application::SaveConfig()
 		json_object_set_string(config_node, "Org Name", orgName.c_str());
 		json_object_set_number(config_node, "Max FPS", maxFPS);
 		json_object_set_boolean(config_node, "VSYNC", vsync);
+		memory->Save(config_node);
 
 
 		//Iterate all modules to save each respective info
@@ -642,7 +677,7 @@ void Application::SetState(EngineState state)
 				scene->sceneBuff->WantRefreshRatio();
 
 				//To Save all elements in the scene to load them correctly when exiting Game Mode
-				Json_seria->SaveScene();
+				Binary_seria->SaveScene();
 			}
 			else
 			{
@@ -32,6 +32,11 @@ class ModuleTextures;
 class ModuleResourceManager;
 
 class JSONSerialization;
+class BinarySerialization;
+class JobSystem;
+class Profiler;
+class FrameStats;
+class MemoryTracker;
 
 enum EngineState
 {
@@ -147,6 +152,19 @@ public:
 
 	//Use for Serialization scene or prefabs 
 	JSONSerialization* Json_seria = nullptr;
+	BinarySerialization* Binary_seria = nullptr;
+
+	// Worker threads for the jobs of each frame phase (transforms, boxes, culling)
+	JobSystem* jobs = nullptr;
+
+	// Zones of each frame (PROFILE_SCOPE), module phases are measured here
+	Profiler* profiler = nullptr;
+
+	// Histograms of the frame & phase times (percentiles, hitches)
+	FrameStats* frame_stats = nullptr;
+
+	// Memory of each subsystem (CPU & GPU) with budgets
+	MemoryTracker* memory = nullptr;
 
 private:
 	std::string appName;
@@ -0,0 +1,592 @@
+#include "Benchmark.h"
+#include "Application.h"
+#include "Scene.h"
+#include "GameObject.h"
+#include "CompTransform.h"
+#include "CompCamera.h"
+#include "ResourceMesh.h"
+#include "ImportMesh.h"
+#include "ModuleFS.h"
+#include "BinarySerialization.h"
+#include "RenderQueue.h"
+#include "FrustumCulling.h"
+#include "MathBenchmark.h"
+#include "JobSystem.h"
+#include "JSONWriter.h"
+#include "PerfTimer.h"
+#include "MathGeoLib.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct BenchmarkStats
+{
+	double min = 0.0;
+	double median = 0.0;
+	double mean = 0.0;
+	double p95 = 0.0;
+	double max = 0.0;
+	double stddev = 0.0;
+};
+
+struct BenchmarkScene
+{
+	std::vector<GameObject*> objects;	/* Parents before their childs */
+	std::vector<GameObject*> dynamic;
+	std::vector<float3> positions;		/* Initial position of the dynamic ones */
+	ResourceMesh* mesh = nullptr;		/* Shared by all the objects (picking) */
+	float extent = 0.0f;				/* Roots are inside [-extent, extent] */
+};
+
+// ARGUMENTS -----------------------------------------
+bool ParseBenchmarkArgs(int argc, char** argv, BenchmarkConfig& config)
+{
+	bool benchmark = false;
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+		if (strcmp(arg, "-benchmark") == 0)
+		{
+			benchmark = true;
+		}
+		else if (strcmp(arg, "-json") == 0)
+		{
+			config.json = true;
+		}
+		else if (value != nullptr)
+		{
+			if (strcmp(arg, "-objects") == 0) config.objects = atoi(value);
+			else if (strcmp(arg, "-depth") == 0) config.depth = atoi(value);
+			else if (strcmp(arg, "-dynamic") == 0) config.dynamic = atoi(value);
+			else if (strcmp(arg, "-vertices") == 0) config.vertices = atoi(value);
+			else if (strcmp(arg, "-frames") == 0) config.frames = atoi(value);
+			else if (strcmp(arg, "-seed") == 0) config.seed = atoi(value);
+			else if (strcmp(arg, "-output") == 0) config.output = value;
+			else continue;
+			i++;
+		}
+	}
+
+	config.depth = Clamp(config.depth, 1u, 16u);
+	config.dynamic = Min(config.dynamic, 100u);
+	config.vertices = Max(config.vertices, 4u);
+	config.frames = Max(config.frames, 1u);
+	return benchmark;
+}
+
+// SYNTHETIC SCENE -----------------------------------
+// Grid of side x side vertices in [-1, 1] with waves (real triangles for the picking)
+static void CreateMeshData(uint num_vertices, std::vector<float3>& vertices, std::vector<float3>& normals,
+	std::vector<float2>& tex_coords, std::vector<uint>& indices)
+{
+	uint side = Max((uint)sqrtf((float)num_vertices), 2u);
+	for (uint z = 0; z < side; z++)
+	{
+		for (uint x = 0; x < side; x++)
+		{
+			float u = (float)x / (side - 1);
+			float v = (float)z / (side - 1);
+			float px = u * 2.0f - 1.0f;
+			float pz = v * 2.0f - 1.0f;
+			vertices.push_back(float3(px, 0.2f * sinf(px * 6.0f) * cosf(pz * 6.0f), pz));
+			normals.push_back(float3(-1.2f * cosf(px * 6.0f) * cosf(pz * 6.0f), 1.0f, 1.2f * sinf(px * 6.0f) * sinf(pz * 6.0f)).Normalized());
+			tex_coords.push_back(float2(u, v));
+		}
+	}
+
+	for (uint z = 0; z + 1 < side; z++)
+	{
+		for (uint x = 0; x + 1 < side; x++)
+		{
+			uint i = z * side + x;
+			indices.push_back(i);
+			indices.push_back(i + side);
+			indices.push_back(i + 1);
+			indices.push_back(i + 1);
+			indices.push_back(i + side);
+			indices.push_back(i + side + 1);
+		}
+	}
+}
+
+// Hierarchies of 2^(depth - 1) objects: each one is a child of a random object of its
+// hierarchy above the last level. A hierarchy is static or dynamic as a whole.
+static void CreateScene(const BenchmarkConfig& config, const AABB& mesh_box, BenchmarkScene& scene)
+{
+	LCG lcg(config.seed);
+	uint tree_size = 1 << (config.depth - 1);
+	uint num_trees = (config.objects + tree_size - 1) / tree_size;
+	scene.extent = Clamp(sqrtf((float)num_trees) * 4.0f, 20.0f, OCTREE_SIZE * 0.8f);
+
+	std::vector<uint> levels(config.objects);
+	std::vector<uint> parents(config.objects);
+	std::vector<GameObject*> statics;
+	bool tree_dynamic = false;
+
+	scene.objects.reserve(config.objects);
+	for (uint i = 0; i < config.objects; i++)
+	{
+		uint tree_index = i % tree_size;
+		GameObject* parent = nullptr;
+		float3 position;
+		if (tree_index == 0)
+		{
+			tree_dynamic = lcg.Int(0, 99) < (int)config.dynamic;
+			levels[i] = 0;
+			position.Set(lcg.Float(-scene.extent, scene.extent), lcg.Float(0.0f, 10.0f), lcg.Float(-scene.extent, scene.extent));
+		}
+		else
+		{
+			uint p = i - tree_index + lcg.Int(0, tree_index - 1);
+			while (levels[p] + 1 >= config.depth)
+			{
+				p = parents[p];
+			}
+			parents[i] = p;
+			levels[i] = levels[p] + 1;
+			parent = scene.objects[p];
+			position.Set(lcg.Float(-3.0f, 3.0f), lcg.Float(0.0f, 2.0f), lcg.Float(-3.0f, 3.0f));
+		}
+
+		GameObject* obj = App->scene->CreateGameObject(parent);
+		CompTransform* transform = obj->GetComponentTransform();
+		transform->SetPos(position);
+		transform->SetRot(float3(0.0f, lcg.Float(0.0f, 360.0f), 0.0f));
+		obj->bounding_box = new AABB(mesh_box);
+		obj->SetStatic(tree_dynamic == false);
+
+		scene.objects.push_back(obj);
+		if (tree_dynamic)
+		{
+			scene.dynamic.push_back(obj);
+			scene.positions.push_back(position);
+		}
+		else if (parent == nullptr)
+		{
+			statics.push_back(obj);
+		}
+	}
+
+	// Global transforms, boxes & octree
+	App->scene->UpdateTransforms();
+
+	App->scene->quadtree.Init(scene.extent + 20.0f);
+	App->scene->quadtree.Bake(statics);
+	App->scene->FillStaticObjectsVector(true);
+}
+
+static void DeleteScene(BenchmarkScene& scene)
+{
+	App->scene->FillStaticObjectsVector(false);
+	App->scene->quadtree.Clear();
+
+	// Childs before their parents
+	for (int i = scene.objects.size() - 1; i >= 0; i--)
+	{
+		scene.objects[i]->DeleteAllComponents();
+		RELEASE(scene.objects[i]);
+	}
+	scene.objects.clear();
+	App->scene->gameobjects.clear();
+	RELEASE(scene.mesh);
+}
+
+// Loaded objects (not in the scene vectors), childs before their parents
+static uint DeleteLoaded(GameObject* obj)
+{
+	uint deleted = 1;
+	for (uint i = 0; i < obj->GetNumChilds(); i++)
+	{
+		deleted += DeleteLoaded(obj->GetChildbyIndex(i));
+	}
+	obj->DeleteAllComponents();
+	RELEASE(obj);
+	return deleted;
+}
+
+// Same tests as ModuleCamera3D::MousePick, the closest object hit (nullptr if none)
+static GameObject* Pick(const LineSegment& ray, const ResourceMesh& mesh, std::vector<int>& candidates,
+	std::multimap<float, GameObject*>& intersections)
+{
+	candidates.clear();
+	intersections.clear();
+	App->scene->octree.CollectCandidates(candidates, ray, false);
+	for (uint i = 0; i < candidates.size(); i++)
+	{
+		GameObject* candidate = App->scene->octree.GetObjectByHandle(candidates[i]);
+		float entry_dist = 0.0f;
+		float exit_dist = 0.0f;
+		if (candidate != nullptr && ray.Intersects(candidate->box_fixed, entry_dist, exit_dist))
+		{
+			intersections.insert(std::pair<float, GameObject*>(entry_dist, candidate));
+		}
+	}
+
+	GameObject* best = nullptr;
+	float min_distance = INFINITY;
+	for (std::multimap<float, GameObject*>::iterator it = intersections.begin(); it != intersections.end(); ++it)
+	{
+		if (it->first > min_distance)
+		{
+			break;
+		}
+
+		LineSegment local = ray;
+		local.Transform(it->second->GetComponentTransform()->GetGlobalTransform().Inverted());
+		float length = local.Length();
+		float distance = 0.0f;
+		if (length > 0.0f && mesh.bvh.RayCast(Ray(local.a, (local.b - local.a) / length), length, mesh.geometry, distance))
+		{
+			distance /= length;
+			if (distance < min_distance)
+			{
+				min_distance = distance;
+				best = it->second;
+			}
+		}
+	}
+	return best;
+}
+
+// Camera around the scene, one turn in 'frames'
+static void OrbitCamera(CompCamera& camera, const BenchmarkScene& scene, uint frame, uint frames)
+{
+	float angle = 2.0f * (float)PI * (float)frame / (float)frames;
+	float radius = scene.extent * 1.2f;
+	camera.frustum.pos.Set(cosf(angle) * radius, scene.extent * 0.3f, sinf(angle) * radius);
+	camera.LookAt(float3::zero);
+}
+
+// STATISTICS ----------------------------------------
+static BenchmarkStats GetStats(std::vector<double> samples)
+{
+	BenchmarkStats stats;
+	if (samples.size() == 0)
+	{
+		return stats;
+	}
+
+	std::sort(samples.begin(), samples.end());
+	uint size = samples.size();
+	stats.min = samples.front();
+	stats.max = samples.back();
+	stats.median = (size % 2 == 1) ? samples[size / 2] : 0.5 * (samples[size / 2 - 1] + samples[size / 2]);
+	stats.p95 = samples[Min((uint)ceil(0.95 * size), size) - 1];
+
+	for (uint i = 0; i < size; i++)
+	{
+		stats.mean += samples[i];
+	}
+	stats.mean /= size;
+
+	for (uint i = 0; i < size; i++)
+	{
+		stats.stddev += (samples[i] - stats.mean) * (samples[i] - stats.mean);
+	}
+	stats.stddev = sqrt(stats.stddev / size);
+	return stats;
+}
+
+static std::string WriteCSV(const std::vector<BenchmarkLoop>& loops)
+{
+	std::string csv = "loop,frames,min_ms,median_ms,mean_ms,p95_ms,max_ms,stddev_ms,check,failures\n";
+	char line[256];
+	for (uint i = 0; i < loops.size(); i++)
+	{
+		BenchmarkStats stats = GetStats(loops[i].samples);
+		snprintf(line, sizeof(line), "%s,%i,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.0f,%u\n", loops[i].name.c_str(), loops[i].samples.size(),
+			stats.min, stats.median, stats.mean, stats.p95, stats.max, stats.stddev, loops[i].check, loops[i].failures);
+		csv += line;
+	}
+	return csv;
+}
+
+static std::string WriteJSON(const BenchmarkConfig& config, const std::vector<BenchmarkLoop>& loops)
+{
+	JSONWriter writer;
+	writer.BeginObject();
+	writer.BeginObject("config");
+	writer.Number("objects", config.objects);
+	writer.Number("depth", config.depth);
+	writer.Number("dynamic", config.dynamic);
+	writer.Number("vertices", config.vertices);
+	writer.Number("frames", config.frames);
+	writer.Number("seed", config.seed);
+	writer.EndObject();
+
+	writer.BeginArray("loops");
+	for (uint i = 0; i < loops.size(); i++)
+	{
+		BenchmarkStats stats = GetStats(loops[i].samples);
+		writer.BeginObject();
+		writer.String("name", loops[i].name.c_str());
+		writer.Number("frames", loops[i].samples.size());
+		writer.Number("min_ms", stats.min);
+		writer.Number("median_ms", stats.median);
+		writer.Number("mean_ms", stats.mean);
+		writer.Number("p95_ms", stats.p95);
+		writer.Number("max_ms", stats.max);
+		writer.Number("stddev_ms", stats.stddev);
+		writer.Number("check", loops[i].check);
+		writer.Number("failures", loops[i].failures);
+		writer.EndObject();
+	}
+	writer.EndArray();
+	writer.EndObject();
+	return std::string(writer.GetBuffer(), writer.GetSize()) + "\n";
+}
+
+// BENCHMARK -----------------------------------------
+int RunBenchmark(const BenchmarkConfig& config)
+{
+	App->jobs->Start();
+
+	PerfTimer timer;
+	std::vector<BenchmarkLoop> loops;
+	BenchmarkScene scene;
+	ImportMesh importer;
+	bool ret = true;
+
+	// Mesh --------------------------------------
+	std::vector<float3> vertices;
+	std::vector<float3> normals;
+	std::vector<float2> tex_coords;
+	std::vector<uint> indices;
+	CreateMeshData(config.vertices, vertices, normals, tex_coords, indices);
+
+	uint size = 0;
+	char* data = importer.SaveMeshData(vertices.size(), indices.size(), vertices.data(), indices.data(), normals.data(), tex_coords.data(), size);
+	ret = App->fs->SaveFile(data, BENCHMARK_MESH_FILE, size, IMPORT_DIRECTORY_LIBRARY_MESHES);
+	RELEASE_ARRAY(data);
+
+	// Mesh loading (streaming path: map, decode, stage & BVH) ---
+	if (ret)
+	{
+		BenchmarkLoop loop;
+		loop.name = "resource_load";
+		for (uint f = 0; f < BENCHMARK_WARMUP_FRAMES + config.frames && ret; f++)
+		{
+			RELEASE(scene.mesh);
+			scene.mesh = new ResourceMesh(0);
+			timer.Start();
+			ret = importer.PrepareResource(BENCHMARK_MESH_FILE, scene.mesh);
+			if (f >= BENCHMARK_WARMUP_FRAMES)
+			{
+				loop.samples.push_back(timer.ReadMs());
+				loop.check += scene.mesh->bvh.GetNumNodes();
+			}
+		}
+		loops.push_back(loop);
+		remove((std::string(DIRECTORY_LIBRARY_MESHES) + BENCHMARK_MESH_FILE).c_str());
+	}
+	if (ret == false)
+	{
+		fprintf(stderr, "Benchmark: can't save/load %s%s\n", DIRECTORY_LIBRARY_MESHES, BENCHMARK_MESH_FILE);
+		DeleteScene(scene);
+		App->jobs->Stop();
+		return EXIT_FAILURE;
+	}
+
+	AABB mesh_box;
+	mesh_box.SetNegativeInfinity();
+	mesh_box.Enclose(vertices.data(), vertices.size());
+	CreateScene(config, mesh_box, scene);
+
+	// Transforms (dynamic objects moved) ---------
+	{
+		BenchmarkLoop loop;
+		loop.name = "transforms";
+		for (uint f = 0; f < BENCHMARK_WARMUP_FRAMES + config.frames; f++)
+		{
+			float t = f * 0.1f;
+			timer.Start();
+			for (uint i = 0; i < scene.dynamic.size(); i++)
+			{
+				float phase = t + i * 0.37f;
+				scene.dynamic[i]->GetComponentTransform()->SetPos(scene.positions[i] + float3(sinf(phase), 0.0f, cosf(phase)) * 0.5f);
+			}
+			App->scene->UpdateTransforms();
+			if (f >= BENCHMARK_WARMUP_FRAMES)
+			{
+				loop.samples.push_back(timer.ReadMs());
+				loop.check += App->scene->transform_hierarchy.GetChanged().size();
+			}
+		}
+		loops.push_back(loop);
+	}
+
+	CompCamera camera(C_CAMERA, nullptr);
+
+	// Culling (quadtree + octree) -----------------
+	{
+		BenchmarkLoop loop;
+		loop.name = "culling";
+		for (uint f = 0; f < BENCHMARK_WARMUP_FRAMES + config.frames; f++)
+		{
+			OrbitCamera(camera, scene, f, config.frames);
+			timer.Start();
+			camera.DoCulling();
+			if (f >= BENCHMARK_WARMUP_FRAMES)
+			{
+				loop.samples.push_back(timer.ReadMs());
+				for (uint i = 0; i < scene.objects.size(); i++)
+				{
+					loop.check += scene.objects[i]->isVisible() ? 1 : 0;
+				}
+			}
+		}
+		loops.push_back(loop);
+	}
+
+	// Picking (BENCHMARK_RAYS each frame) ---------
+	{
+		BenchmarkLoop loop;
+		loop.name = "picking";
+		LCG lcg(config.seed);
+		std::vector<int> candidates;
+		std::multimap<float, GameObject*> intersections;
+		for (uint f = 0; f < BENCHMARK_WARMUP_FRAMES + config.frames; f++)
+		{
+			OrbitCamera(camera, scene, f, config.frames);
+			uint hits = 0;
+			timer.Start();
+			for (uint i = 0; i < BENCHMARK_RAYS; i++)
+			{
+				LineSegment ray = camera.frustum.UnProjectLineSegment(lcg.Float(-0.5f, 0.5f), lcg.Float(-0.5f, 0.5f));
+				hits += (Pick(ray, *scene.mesh, candidates, intersections) != nullptr) ? 1 : 0;
+			}
+			if (f >= BENCHMARK_WARMUP_FRAMES)
+			{
+				loop.samples.push_back(timer.ReadMs());
+				loop.check += hits;
+			}
+		}
+		loops.push_back(loop);
+	}
+
+	// Serialization (binary scene) -----------------
+	{
+		BenchmarkLoop loop;
+		loop.name = "serialization_save";
+		for (uint f = 0; f < BENCHMARK_WARMUP_FRAMES + config.frames; f++)
+		{
+			timer.Start();
+			App->Binary_seria->SaveScene(BENCHMARK_SCENE_FILE);
+			if (f >= BENCHMARK_WARMUP_FRAMES)
+			{
+				loop.samples.push_back(timer.ReadMs());
+				std::ifstream file(BENCHMARK_SCENE_FILE, std::ifstream::binary | std::ifstream::ate);
+				loop.check += (double)file.tellg();
+			}
+		}
+		loops.push_back(loop);
+	}
+	{
+		// The loaded roots are appended to the scene, removed after each frame
+		BenchmarkLoop loop;
+		loop.name = "serialization_load";
+		std::vector<GameObject*> roots = App->scene->gameobjects;
+		for (uint f = 0; f < BENCHMARK_WARMUP_FRAMES + config.frames; f++)
+		{
+			timer.Start();
+			bool loaded = App->Binary_seria->LoadScene(BENCHMARK_SCENE_FILE);
+			double ms = timer.ReadMs();
+
+			uint num_loaded = 0;
+			for (uint i = roots.size(); i < App->scene->gameobjects.size(); i++)
+			{
+				num_loaded += DeleteLoaded(App->scene->gameobjects[i]);
+			}
+			App->scene->gameobjects = roots;
+
+			if (f >= BENCHMARK_WARMUP_FRAMES)
+			{
+				loop.samples.push_back(ms);
+				loop.check += num_loaded;
+				loop.failures += (loaded && num_loaded == scene.objects.size()) ? 0 : 1;
+			}
+		}
+		loops.push_back(loop);
+		remove(BENCHMARK_SCENE_FILE);
+	}
+
+	DeleteScene(scene);
+
+	// Test suites (once, pass/fail) ----------------
+	{
+		BenchmarkLoop loop;
+		loop.name = "render_queue";
+		timer.Start();
+		bool passed = RenderQueueBenchmark(10000, 100, 20);
+		loop.samples.push_back(timer.ReadMs());
+		loop.check = passed ? 1 : 0;
+		loop.failures = passed ? 0 : 1;
+		loops.push_back(loop);
+	}
+	{
+		BenchmarkLoop loop;
+		loop.name = "instancing";
+		timer.Start();
+		bool passed = RenderQueueInstancingTest(50, 200);
+		loop.samples.push_back(timer.ReadMs());
+		loop.check = passed ? 1 : 0;
+		loop.failures = passed ? 0 : 1;
+		loops.push_back(loop);
+	}
+	{
+		BenchmarkLoop loop;
+		loop.name = "culling_kernel";
+		timer.Start();
+		bool passed = CullingBenchmark(50000, 10);
+		loop.samples.push_back(timer.ReadMs());
+		loop.check = passed ? 1 : 0;
+		loop.failures = passed ? 0 : 1;
+		loops.push_back(loop);
+	}
+	{
+		BenchmarkLoop loop;
+		loop.name = "math";
+		timer.Start();
+		bool passed = MathBenchmark(20);
+		loop.samples.push_back(timer.ReadMs());
+		loop.check = passed ? 1 : 0;
+		loop.failures = passed ? 0 : 1;
+		loops.push_back(loop);
+	}
+
+	App->jobs->Stop();
+
+	int exit_code = EXIT_SUCCESS;
+	for (uint i = 0; i < loops.size(); i++)
+	{
+		if (loops[i].failures > 0)
+		{
+			fprintf(stderr, "Benchmark: %s failed %u times\n", loops[i].name.c_str(), loops[i].failures);
+			exit_code = EXIT_FAILURE;
+		}
+	}
+
+	// Results ---------------------------------------
+	std::string results = config.json ? WriteJSON(config, loops) : WriteCSV(loops);
+	if (config.output.empty())
+	{
+		fwrite(results.c_str(), 1, results.size(), stdout);
+		fflush(stdout);
+	}
+	else
+	{
+		std::ofstream file(config.output, std::ofstream::binary);
+		if (file.good() == false)
+		{
+			fprintf(stderr, "Benchmark: can't write %s\n", config.output.c_str());
+			return EXIT_FAILURE;
+		}
+		file.write(results.c_str(), results.size());
+	}
+	return exit_code;
+}
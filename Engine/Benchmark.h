@@ -0,0 +1,56 @@
+#ifndef _BENCHMARK_
+#define _BENCHMARK_
+
+#include "Globals.h"
+#include <string>
+#include <vector>
+
+#define BENCHMARK_WARMUP_FRAMES 5
+#define BENCHMARK_RAYS 64						/* Picking rays each frame */
+#define BENCHMARK_MESH_FILE "benchmark_mesh"	/* In Library/Meshes */
+#define BENCHMARK_SCENE_FILE "benchmark.scene"
+
+// Headless benchmark -----------------------------------------
+// "Engine.exe -benchmark [options]" creates the modules without starting them
+// (no window, GL or ImGui), generates a synthetic scene and runs fixed frame
+// loops of transforms, culling, picking, scene serialization (save & load) and
+// mesh loading, then the test suites of the engine (render queue & instancing
+// with the null backend, culling kernel, math). The times of each loop are
+// written as CSV (or JSON) and the exit code fails if a loop fails a check:
+//	-objects N		GameObjects (10000)
+//	-depth D		Levels of the hierarchy (4)
+//	-dynamic P		% of the hierarchies that move each frame, the rest are static (20)
+//	-vertices V		Vertices of the mesh shared by all the GameObjects (2500)
+//	-frames F		Frames measured of each loop (100)
+//	-seed S			Same seed, same scene (1234)
+//	-json			JSON instead of CSV
+//	-output FILE	Results file (stdout by default)
+struct BenchmarkConfig
+{
+	uint objects = 10000;
+	uint depth = 4;
+	uint dynamic = 20;
+	uint vertices = 2500;
+	uint frames = 100;
+	uint seed = 1234;
+	bool json = false;
+	std::string output;
+};
+
+// Time of each frame of a loop (ms). 'check' sums a result of the loop
+// (objects moved, visible, hit...), it only changes if the results change.
+struct BenchmarkLoop
+{
+	std::string name;
+	std::vector<double> samples;
+	double check = 0.0;
+	uint failures = 0; /* Frames with wrong results, fail the run */
+};
+
+// False if there isn't -benchmark in the arguments
+bool ParseBenchmarkArgs(int argc, char** argv, BenchmarkConfig& config);
+
+// Needs the App created (not initialized), returns the exit code
+int RunBenchmark(const BenchmarkConfig& config);
+
+#endif
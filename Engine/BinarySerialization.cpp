@@ -0,0 +1,422 @@
+#include "BinarySerialization.h"
+#include "Application.h"
+#include "ModuleFS.h"
+#include "Scene.h"
+#include "GameObject.h"
+#include "Component.h"
+#include "parson.h"
+#include "JSONArena.h"
+#include "PerfTimer.h"
+
+#include <map>
+
+BinarySerialization::BinarySerialization()
+{
+}
+
+BinarySerialization::~BinarySerialization()
+{
+}
+
+// Pad the chunk data, entries of the next chunks stay aligned in the mapped file
+static void AlignChunk(std::vector<char>& data)
+{
+	while (data.size() % 4 != 0)
+	{
+		data.push_back(0);
+	}
+}
+
+void BinarySerialization::SaveScene(const char* file)
+{
+	LOG("SAVING SCENE (binary) -----");
+	PerfTimer timer;
+	timer.Start();
+
+	SceneTables tables;
+	for (uint i = 0; i < App->scene->gameobjects.size(); i++)
+	{
+		AddGameObject(*App->scene->gameobjects[i], SCENE_OBJECT_ROOT, tables);
+	}
+
+	WriteTables(file, tables);
+	LOG("Saved %i GameObjects in %.3f ms", tables.objects.size(), timer.ReadMs());
+}
+
+// Parents are added before their childs (depth first)
+void BinarySerialization::AddGameObject(const GameObject& gameObject, int parent, SceneTables& tables) const
+{
+	int index = tables.objects.size();
+	SceneObjectEntry object;
+	object.uuid = gameObject.GetUUID();
+	object.parent = parent;
+	object.name = AddString(gameObject.GetName(), tables);
+	object.flags |= gameObject.isStatic() ? SCENE_OBJECT_STATIC : 0;
+	object.flags |= gameObject.isAABBActive() ? SCENE_OBJECT_AABB : 0;
+	object.first_component = tables.components.size();
+	object.num_components = gameObject.GetNumComponents();
+
+	// Components ------------
+	for (uint i = 0; i < object.num_components; i++)
+	{
+		const Component* component = gameObject.GetComponentbyIndex(i);
+		SceneComponentEntry entry;
+		entry.type = component->GetType();
+		entry.offset = tables.blobs.size();
+		if (component->SaveBinary(tables.blobs) == false)
+		{
+			// Components without binary layout (scripts) keep their JSON
+			tables.json.Clear();
+			tables.json.BeginObject();
+			component->Save(tables.json, true);
+			tables.json.EndObject();
+			const char* json = tables.json.GetBuffer();
+			tables.blobs.insert(tables.blobs.end(), json, json + tables.json.GetSize() + 1);
+			entry.format = SCENE_BLOB_JSON;
+		}
+		entry.size = tables.blobs.size() - entry.offset;
+		tables.components.push_back(entry);
+	}
+	tables.objects.push_back(object);
+
+	// Childs --------------
+	for (uint i = 0; i < gameObject.GetNumChilds(); i++)
+	{
+		AddGameObject(*gameObject.GetChildbyIndex(i), index, tables);
+	}
+}
+
+uint BinarySerialization::AddString(const char* string, SceneTables& tables) const
+{
+	uint offset = tables.strings.size();
+	if (string == nullptr)
+	{
+		string = "";
+	}
+	tables.strings.insert(tables.strings.end(), string, string + strlen(string) + 1);
+	return offset;
+}
+
+bool BinarySerialization::WriteTables(const char* file, const SceneTables& tables) const
+{
+	std::vector<char> strings = tables.strings;
+	std::vector<char> blobs = tables.blobs;
+	AlignChunk(strings);
+	AlignChunk(blobs);
+
+	uint objects_size = tables.objects.size() * sizeof(SceneObjectEntry);
+	uint components_size = tables.components.size() * sizeof(SceneComponentEntry);
+
+	SceneFileHeader header;
+	header.num_chunks = 4;
+	uint size = sizeof(header) + header.num_chunks * sizeof(SceneChunkHeader) +
+		objects_size + components_size + strings.size() + blobs.size();
+
+	char* data = new char[size];
+	char* cursor = data;
+	memcpy(cursor, &header, sizeof(header));
+	cursor += sizeof(header);
+
+	SceneChunkHeader chunks[4];
+	const void* chunk_data[4] = { tables.objects.data(), tables.components.data(), strings.data(), blobs.data() };
+	chunks[0].id = SCENE_CHUNK_OBJECTS;
+	chunks[0].size = objects_size;
+	chunks[1].id = SCENE_CHUNK_COMPONENTS;
+	chunks[1].size = components_size;
+	chunks[2].id = SCENE_CHUNK_STRINGS;
+	chunks[2].size = strings.size();
+	chunks[3].id = SCENE_CHUNK_BLOBS;
+	chunks[3].size = blobs.size();
+
+	for (uint i = 0; i < header.num_chunks; i++)
+	{
+		memcpy(cursor, &chunks[i], sizeof(SceneChunkHeader));
+		cursor += sizeof(SceneChunkHeader);
+		if (chunks[i].size > 0)
+		{
+			memcpy(cursor, chunk_data[i], chunks[i].size);
+			cursor += chunks[i].size;
+		}
+	}
+
+	App->fs->SaveFile(data, file, size);
+	RELEASE_ARRAY(data);
+	return true;
+}
+
+bool BinarySerialization::LoadScene(const char* file)
+{
+	LOG("LOADING SCENE (binary) -----");
+
+	// First time: scene saved with the old format
+	if (App->fs->CheckIsFileExist(file) == false && App->fs->CheckIsFileExist(SCENE_FILE_JSON))
+	{
+		ConvertScene(SCENE_FILE_JSON, file);
+	}
+
+	PerfTimer timer;
+	timer.Start();
+
+	MappedFile mapped;
+	if (App->fs->MapFile(file, mapped) == false)
+	{
+		return false;
+	}
+
+	SceneView view;
+	if (ReadView(mapped.data, mapped.size, view) == false)
+	{
+		LOG("[error] Scene %s is corrupted or from other version.", file);
+		App->fs->UnmapFile(mapped);
+		return false;
+	}
+
+	// Single pass, the parent of each object is already created
+	std::vector<GameObject*> objects(view.num_objects, nullptr);
+	for (uint i = 0; i < view.num_objects; i++)
+	{
+		const SceneObjectEntry& entry = view.objects[i];
+		GameObject* obj = CreateGameObject(entry, view);
+		objects[i] = obj;
+
+		if (entry.parent >= 0 && entry.parent < (int)i)
+		{
+			objects[entry.parent]->AddChildGameObject_Load(obj);
+		}
+		else
+		{
+			App->scene->gameobjects.push_back(obj);
+		}
+	}
+
+	App->fs->UnmapFile(mapped);
+	LOG("Loaded %i GameObjects in %.3f ms", view.num_objects, timer.ReadMs());
+	return true;
+}
+
+// Check header & chunks and get the views of the tables
+bool BinarySerialization::ReadView(const char* data, uint size, SceneView& view) const
+{
+	if (size < sizeof(SceneFileHeader))
+	{
+		return false;
+	}
+	SceneFileHeader header;
+	memcpy(&header, data, sizeof(header));
+	if (header.id != SCENE_FILE_ID || header.version != SCENE_FILE_VERSION)
+	{
+		return false;
+	}
+
+	uint cursor = sizeof(header);
+	for (uint i = 0; i < header.num_chunks; i++)
+	{
+		SceneChunkHeader chunk;
+		if (cursor + sizeof(chunk) > size)
+		{
+			return false;
+		}
+		memcpy(&chunk, data + cursor, sizeof(chunk));
+		cursor += sizeof(chunk);
+		if (chunk.size > size - cursor)
+		{
+			return false;
+		}
+
+		const char* chunk_data = data + cursor;
+		switch (chunk.id)
+		{
+		case SCENE_CHUNK_OBJECTS:
+			view.objects = (const SceneObjectEntry*)chunk_data;
+			view.num_objects = chunk.size / sizeof(SceneObjectEntry);
+			break;
+		case SCENE_CHUNK_COMPONENTS:
+			view.components = (const SceneComponentEntry*)chunk_data;
+			view.num_components = chunk.size / sizeof(SceneComponentEntry);
+			break;
+		case SCENE_CHUNK_STRINGS:
+			view.strings = chunk_data;
+			view.strings_size = chunk.size;
+			break;
+		case SCENE_CHUNK_BLOBS:
+			view.blobs = chunk_data;
+			view.blobs_size = chunk.size;
+			break;
+		default:
+			break;
+		}
+		cursor += chunk.size;
+	}
+
+	// Check the references between tables
+	for (uint i = 0; i < view.num_objects; i++)
+	{
+		const SceneObjectEntry& object = view.objects[i];
+		if (object.name >= view.strings_size || object.first_component > view.num_components ||
+			object.num_components > view.num_components - object.first_component)
+		{
+			return false;
+		}
+	}
+	for (uint i = 0; i < view.num_components; i++)
+	{
+		const SceneComponentEntry& component = view.components[i];
+		if (component.offset > view.blobs_size || component.size > view.blobs_size - component.offset)
+		{
+			return false;
+		}
+		// JSON is parsed as a string, it can't read out of the blob
+		if (component.format == SCENE_BLOB_JSON && (component.size == 0 || view.blobs[component.offset + component.size - 1] != '\0'))
+		{
+			return false;
+		}
+	}
+	// Names can't read out of the chunk
+	return view.num_objects == 0 || view.strings[view.strings_size - 1] == '\0';
+}
+
+GameObject* BinarySerialization::CreateGameObject(const SceneObjectEntry& entry, const SceneView& view) const
+{
+	char* nameGameObject = App->GetCharfromConstChar(view.strings + entry.name);
+	GameObject* obj = new GameObject(nameGameObject, entry.uuid);
+	obj->SetStatic((entry.flags & SCENE_OBJECT_STATIC) != 0);
+	obj->SetAABBActive((entry.flags & SCENE_OBJECT_AABB) != 0);
+
+	// Same as GameObject::LoadComponents: first add all components by type, then load them
+	for (uint i = 0; i < entry.num_components; i++)
+	{
+		Comp_Type type = (Comp_Type)view.components[entry.first_component + i].type;
+		if (type != Comp_Type::C_UNKNOWN)
+		{
+			obj->AddComponent(type, type == Comp_Type::C_SCRIPT);
+		}
+	}
+
+	for (uint i = 0; i < entry.num_components && i < (uint)obj->GetNumComponents(); i++)
+	{
+		const SceneComponentEntry& component = view.components[entry.first_component + i];
+		Component* comp = obj->GetComponentbyIndex(i);
+		const char* blob = view.blobs + component.offset;
+		if (component.format == SCENE_BLOB_JSON)
+		{
+			JSON_Value* value = json_parse_string(blob);
+			if (value != nullptr)
+			{
+				comp->Load(json_value_get_object(value), "");
+				json_value_free(value);
+			}
+		}
+		else if (comp->LoadBinary(blob, component.size) == false)
+		{
+			LOG("[error] Component %i of %s can't be loaded.", i, obj->GetName());
+		}
+	}
+	return obj;
+}
+
+// Read the old JSON scene with a linear pass (GameObjectN.* keys in order) and write it as .scene
+bool BinarySerialization::ConvertScene(const char* json_file, const char* file)
+{
+	LOG("CONVERTING SCENE %s -> %s -----", json_file, file);
+
+	JSONArena arena; // All the document is released at the end
+	JSON_Value* config_file = json_parse_file(json_file);
+	if (config_file == nullptr)
+	{
+		return false;
+	}
+	JSON_Object* config_node = json_object_get_object(json_value_get_object(config_file), "Scene");
+	if (config_node == nullptr)
+	{
+		json_value_free(config_file);
+		return false;
+	}
+
+	// GameObjects by uuid, the file can have childs before their parent
+	std::vector<JSON_Object*> sources;
+	std::map<uint, uint> index_by_uuid;
+	for (uint i = 0; i < json_object_get_count(config_node); i++)
+	{
+		if (strncmp(json_object_get_name(config_node, i), "GameObject", 10) != 0)
+		{
+			continue;
+		}
+		JSON_Object* source = json_value_get_object(json_object_get_value_at(config_node, i));
+		index_by_uuid[(uint)json_object_get_number(source, "UUID")] = sources.size();
+		sources.push_back(source);
+	}
+
+	std::vector<std::vector<uint>> childs(sources.size());
+	std::vector<uint> roots;
+	for (uint i = 0; i < sources.size(); i++)
+	{
+		// Parent uuid was saved as an int (-1 = root)
+		int parent = (int)json_object_get_number(sources[i], "Parent");
+		std::map<uint, uint>::iterator it = index_by_uuid.find((uint)parent);
+		if (parent == -1 || it == index_by_uuid.end())
+		{
+			roots.push_back(i);
+		}
+		else
+		{
+			childs[it->second].push_back(i);
+		}
+	}
+
+	// Depth first, parents before childs
+	SceneTables tables;
+	std::vector<std::pair<uint, int>> stack; // source, parent index in tables
+	for (int i = roots.size() - 1; i >= 0; i--)
+	{
+		stack.push_back(std::pair<uint, int>(roots[i], SCENE_OBJECT_ROOT));
+	}
+	while (stack.size() > 0)
+	{
+		uint source_index = stack.back().first;
+		int parent = stack.back().second;
+		stack.pop_back();
+		JSON_Object* source = sources[source_index];
+
+		int index = tables.objects.size();
+		SceneObjectEntry object;
+		object.uuid = (uint)json_object_get_number(source, "UUID");
+		object.parent = parent;
+		object.name = AddString(json_object_get_string(source, "Name"), tables);
+		object.flags |= json_object_get_boolean(source, "Static") == 1 ? SCENE_OBJECT_STATIC : 0;
+		object.flags |= json_object_get_boolean(source, "Bounding Box") == 1 ? SCENE_OBJECT_AABB : 0;
+		object.first_component = tables.components.size();
+
+		// Components are kept as JSON blobs, next save writes the binary layouts
+		uint num_components = (uint)json_object_get_number(source, "Number of Components");
+		JSON_Object* components = json_object_get_object(source, "Components");
+		for (uint i = 0; i < num_components && components != nullptr; i++)
+		{
+			std::string name = "Component " + std::to_string(i);
+			JSON_Value* value = json_object_get_value(components, name.c_str());
+			if (value == nullptr)
+			{
+				continue;
+			}
+			SceneComponentEntry entry;
+			entry.type = (int)json_object_get_number(json_value_get_object(value), "Type");
+			entry.format = SCENE_BLOB_JSON;
+			entry.offset = tables.blobs.size();
+			char* json = json_serialize_to_string(value);
+			tables.blobs.insert(tables.blobs.end(), json, json + strlen(json) + 1);
+			json_free_serialized_string(json);
+			entry.size = tables.blobs.size() - entry.offset;
+			tables.components.push_back(entry);
+			object.num_components++;
+		}
+		tables.objects.push_back(object);
+
+		for (int i = childs[source_index].size() - 1; i >= 0; i--)
+		{
+			stack.push_back(std::pair<uint, int>(childs[source_index][i], index));
+		}
+	}
+
+	json_value_free(config_file);
+	LOG("Converted %i GameObjects", tables.objects.size());
+	return WriteTables(file, tables);
+}
@@ -0,0 +1,107 @@
+#ifndef _BINARYSERIALIZATION_
+#define _BINARYSERIALIZATION_
+
+#include "Globals.h"
+#include "JSONWriter.h"
+#include <vector>
+#include <string>
+
+class GameObject;
+
+#define SCENE_FILE "Scene_1.scene"
+#define SCENE_FILE_JSON "Scene_1.json"
+
+// .scene ----------------------------------------------------
+// Header + chunks (id, size, data), unknown chunks are skipped.
+// Objects are stored parents first, then a single pass creates and links them.
+#define SCENE_FILE_ID 0x4E435343 // "CSCN"
+#define SCENE_FILE_VERSION 1
+
+#define SCENE_CHUNK_OBJECTS		0x544A424F // "OBJT" SceneObjectEntry[]
+#define SCENE_CHUNK_COMPONENTS	0x504D4F43 // "COMP" SceneComponentEntry[]
+#define SCENE_CHUNK_STRINGS		0x53525453 // "STRS" Names ('\0' terminated)
+#define SCENE_CHUNK_BLOBS		0x424F4C42 // "BLOB" Data of the components
+
+#define SCENE_OBJECT_ROOT -1
+#define SCENE_OBJECT_STATIC	(1 << 0)
+#define SCENE_OBJECT_AABB	(1 << 1)
+
+#define SCENE_BLOB_BINARY 0 // Component::SaveBinary layout
+#define SCENE_BLOB_JSON 1	// Component::Save output ('\0' terminated)
+
+struct SceneFileHeader
+{
+	uint32 id = SCENE_FILE_ID;
+	uint32 version = SCENE_FILE_VERSION;
+	uint32 num_chunks = 0;
+};
+
+struct SceneChunkHeader
+{
+	uint32 id = 0;
+	uint32 size = 0;
+};
+
+struct SceneObjectEntry
+{
+	uint32 uuid = 0;
+	int parent = SCENE_OBJECT_ROOT;	/* Index of the parent (always lower) */
+	uint32 name = 0;				/* Offset in the strings chunk */
+	uint32 flags = 0;
+	uint32 first_component = 0;
+	uint32 num_components = 0;
+};
+
+struct SceneComponentEntry
+{
+	int type = -1;		/* Comp_Type */
+	uint32 format = SCENE_BLOB_BINARY;
+	uint32 offset = 0;	/* Offset in the blobs chunk */
+	uint32 size = 0;
+};
+
+// Tables of a scene in memory, written/read by the chunks
+struct SceneTables
+{
+	std::vector<SceneObjectEntry> objects;
+	std::vector<SceneComponentEntry> components;
+	std::vector<char> strings;
+	std::vector<char> blobs;
+	JSONWriter json; // Components saved as JSON
+};
+
+// Chunks of a loaded file (views of the mapped file)
+struct SceneView
+{
+	const SceneObjectEntry* objects = nullptr;
+	uint num_objects = 0;
+	const SceneComponentEntry* components = nullptr;
+	uint num_components = 0;
+	const char* strings = nullptr;
+	uint strings_size = 0;
+	const char* blobs = nullptr;
+	uint blobs_size = 0;
+};
+
+class BinarySerialization
+{
+public:
+	BinarySerialization();
+	~BinarySerialization();
+
+	// SAVE & LOAD SCENE --------------------------
+	void SaveScene(const char* file = SCENE_FILE);
+	bool LoadScene(const char* file = SCENE_FILE);
+	// Old scenes (GameObjectN.* keys) to the binary format
+	bool ConvertScene(const char* json_file, const char* file);
+	// --------------------------------------
+
+private:
+	void AddGameObject(const GameObject& gameObject, int parent, SceneTables& tables) const;
+	uint AddString(const char* string, SceneTables& tables) const;
+	bool WriteTables(const char* file, const SceneTables& tables) const;
+	bool ReadView(const char* data, uint size, SceneView& view) const;
+	GameObject* CreateGameObject(const SceneObjectEntry& object, const SceneView& view) const;
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include "CompTransform.h"
 #include "GameObject.h"
 #include "Scene.h"
+#include "JSONWriter.h"
 
 //SCRIPT VARIABLE UTILITY METHODS ------
 ScriptVariable::ScriptVariable(const char* name, VarType type, VarAccess access, CSharpScript* script) : name(name), type(type), access(access), script(script)
@@ -842,15 +843,17 @@ void CSharpScript::IncrementRotation(MonoObject* object, MonoObject* vector3)
 	}
 }
 
-void CSharpScript::Save(JSON_Object* object, std::string name) const
+void CSharpScript::Save(JSONWriter& writer) const
 {
+	char name[64];
 	for (int i = 0; i < variables.size(); i++)
 	{
 		if (variables[i]->type == VarType::Var_GAMEOBJECT)
 		{
 			if (variables[i]->gameObject != nullptr)
 			{
-				json_object_dotset_number_with_std(object, name + "Variables GameObject UUID " + std::to_string(i), variables[i]->gameObject->GetUUID());
+				sprintf_s(name, sizeof(name), "Variables GameObject UUID %i", i);
+				writer.Number(name, variables[i]->gameObject->GetUUID());
 			}
 		}
 	}
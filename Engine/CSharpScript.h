@@ -15,6 +15,7 @@
 
 class CSharpScript;
 class GameObject;
+class JSONWriter;
 typedef struct json_object_t JSON_Object;
 
 enum FunctionBase
@@ -138,7 +139,7 @@ public:
 	void IncrementRotation(MonoObject* object, MonoObject* vector3);
 
 	// LOAD - SAVE METHODS ------------------
-	void Save(JSON_Object* object, std::string name) const;
+	void Save(JSONWriter& writer) const;
 	void Load(const JSON_Object* object, std::string name);
 	void LoadValues();
 
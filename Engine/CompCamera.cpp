@@ -7,6 +7,8 @@
 #include "ModuleFS.h"
 #include "ModuleRenderer3D.h"
 #include "GameObject.h"
+#include "JSONWriter.h"
+#include "JobSystem.h"
 
 #include "SDL\include\SDL_opengl.h"
 #include <math.h>
@@ -252,6 +254,9 @@ void CompCamera::ShowCameraPopup()
 
 void CompCamera::DoCulling()
 {
+	// Extract frustum planes once per frame
+	cull_planes.Set(frustum);
+
 	// First check culling with static objects (optimized with quadtree)
 	CullStaticObjects();
 
@@ -280,53 +285,68 @@ void CompCamera::CullStaticObjects()
 
 void CompCamera::CullDynamicObjects()
 {
-	const AABB* box = nullptr;
+	LooseOctree& octree = App->scene->octree;
 
-	// Push all active elements that are root & active
-	for (uint i = 0; i < App->scene->gameobjects.size(); i++)
+	// First time, all objects can be visible
+	if (dynamic_cull_reset)
 	{
-		if (App->scene->gameobjects[i]->isActive())
+		std::vector<GameObject*> objects;
+		octree.CollectObjects(objects);
+		dynamic_visible.clear();
+		for (uint i = 0; i < objects.size(); i++)
 		{
-			candidates_to_cull.push(App->scene->gameobjects[i]);
+			dynamic_visible.push_back(objects[i]->octree_handle);
 		}
+		dynamic_cull_reset = false;
 	}
 
-	// Check candidates_to_cull vector until it's empty
-	while (candidates_to_cull.empty() == false)
+	// Objects visible last frame and new ones go outside camera vision
+	octree.CollectInserted(dynamic_visible);
+	for (uint i = 0; i < dynamic_visible.size(); i++)
 	{
-		// If it's not static, check if it's inside the vision of the camera to set 
-		if (!candidates_to_cull.front()->isStatic())
+		GameObject* obj = octree.GetObjectByHandle(dynamic_visible[i]);
+		if (obj != nullptr && !obj->isStatic())
 		{
-			if (candidates_to_cull.front()->bounding_box != nullptr) // Check if it has AABB and it's not the camera itself
-			{
-				box = &candidates_to_cull.front()->box_fixed;
-				if (ContainsAABox(*box) == CULL_OUT)
-				{
-					candidates_to_cull.front()->SetVisible(false); // OUTSIDE CAMERA VISION
-				}
-				else
-				{
-					candidates_to_cull.front()->SetVisible(true); // INSIDE CAMERA VISION
-				}
-			}
+			obj->SetVisible(false); // OUTSIDE CAMERA VISION
 		}
+	}
+	dynamic_visible.clear();
 
-		//Push all the active childs to the candidates vector
-		for (std::vector<GameObject*>::iterator it = candidates_to_cull.front()->GetChildsPtr()->begin(); it != candidates_to_cull.front()->GetChildsPtr()->end(); it++)
+	// Get dynamic objects of the octree nodes inside the frustum
+	cull_candidates.clear();
+	octree.CollectCandidates(cull_candidates, frustum, false);
+
+	// Then test all of them at once with the batch kernel
+	cull_batch.Clear();
+	for (uint i = 0; i < cull_candidates.size(); i++)
+	{
+		int handle = cull_candidates[i];
+		if (handle >= (int)plane_hints.size())
 		{
-			if ((*it)->isActive())
-			{
-				candidates_to_cull.push((*it));
-			}
+			plane_hints.resize(handle + 1, 0);
 		}
+		cull_batch.Add(octree.GetObjectByHandle(handle)->box_fixed, plane_hints[handle]);
+	}
+	cull_batch.Cull(cull_planes, App->jobs);
 
-		// Delete from vector the object already checked
-		candidates_to_cull.pop();
+	for (uint i = 0; i < cull_candidates.size(); i++)
+	{
+		int handle = cull_candidates[i];
+		plane_hints[handle] = cull_batch.hints[i];
+
+		GameObject* obj = octree.GetObjectByHandle(handle);
+		if (cull_batch.IsVisible(i) && !obj->isStatic())
+		{
+			obj->SetVisible(true); // INSIDE CAMERA VISION
+			dynamic_visible.push_back(handle);
+		}
 	}
 }
 
 void CompCamera::UnCull()
 {
+	dynamic_cull_reset = true;
+
 	// Push all active elements that are root & active
 	for (uint i = 0; i < App->scene->gameobjects.size(); i++)
 	{
@@ -515,44 +535,112 @@ float* CompCamera::GetProjectionMatrix() const
 	return (float*)matrix.v;
 }
 
-void CompCamera::Save(JSON_Object * object, std::string name, bool saveScene, uint& countResources) const
+void CompCamera::Save(JSONWriter& writer, bool saveScene) const
 {
-	json_object_dotset_number_with_std(object, name + "Type", C_CAMERA);
+	writer.Number("Type", C_CAMERA);
 
 	// Transform variables ------
-	App->fs->json_array_dotset_float3(object, name + "Position", frustum.pos);
-	App->fs->json_array_dotset_float3(object, name + "Front", frustum.front);
-	App->fs->json_array_dotset_float3(object, name + "Up", frustum.up);
+	writer.Floats("Position", frustum.pos.ptr(), 3);
+	writer.Floats("Front", frustum.front.ptr(), 3);
+	writer.Floats("Up", frustum.up.ptr(), 3);
 
 	// Frustum variables --------
-	json_object_dotset_number_with_std(object, name + "Near Plane", frustum.nearPlaneDistance);
-	json_object_dotset_number_with_std(object, name + "Far Plane", frustum.farPlaneDistance);
-	json_object_dotset_number_with_std(object, name + "Vertical Pov", frustum.verticalFov);
+	writer.Number("Near Plane", frustum.nearPlaneDistance);
+	writer.Number("Far Plane", frustum.farPlaneDistance);
+	writer.Number("Vertical Pov", frustum.verticalFov);
 
 	// Config options variables ---------
-	json_object_dotset_boolean_with_std(object, name + "Main Camera", is_main);
-	json_object_dotset_boolean_with_std(object, name + "Culling", culling);
+	writer.Boolean("Main Camera", is_main);
+	writer.Boolean("Culling", culling);
 }
 
 void CompCamera::Load(const JSON_Object * object, std::string name)
 {
+	static const JSON_Key key_position = json_key("Position");
+	static const JSON_Key key_front = json_key("Front");
+	static const JSON_Key key_up = json_key("Up");
+	static const JSON_Key key_near = json_key("Near Plane");
+	static const JSON_Key key_far = json_key("Far Plane");
+	static const JSON_Key key_fov = json_key("Vertical Pov");
+	static const JSON_Key key_main = json_key("Main Camera");
+	static const JSON_Key key_culling = json_key("Culling");
+
+	const JSON_Object* node = json_object_dotget_node_with_std(object, name);
+
 	// Set frustum variables -------
-	frustum.pos = App->fs->json_array_dotget_float3_string(object, name + "Position");
-	frustum.front = App->fs->json_array_dotget_float3_string(object, name + "Front");
-	frustum.up = App->fs->json_array_dotget_float3_string(object, name + "Up");
-	frustum.nearPlaneDistance = json_object_dotget_number_with_std(object, name + "Near Plane");
-	frustum.farPlaneDistance = json_object_dotget_number_with_std(object, name + "Far Plane");
-	frustum.verticalFov = json_object_dotget_number_with_std(object, name + "Vertical Pov");
-
-	// Set output variables ----
+	frustum.pos = App->fs->json_array_get_float3_by_key(node, key_position);
+	frustum.front = App->fs->json_array_get_float3_by_key(node, key_front);
+	frustum.up = App->fs->json_array_get_float3_by_key(node, key_up);
+	frustum.nearPlaneDistance = json_object_get_number_by_key(node, &key_near);
+	frustum.farPlaneDistance = json_object_get_number_by_key(node, &key_far);
+	frustum.verticalFov = json_object_get_number_by_key(node, &key_fov);
+	is_main = json_object_get_boolean_by_key(node, &key_main);
+	culling = json_object_get_boolean_by_key(node, &key_culling);
+
+	SetLoadedFrustum();
+}
+
+// Binary: frustum (position, front, up, planes & fov) and options
+struct CameraBlob
+{
+	float position[3];
+	float front[3];
+	float up[3];
+	float near_plane;
+	float far_plane;
+	float vertical_fov;
+	uchar is_main;
+	uchar culling;
+	uchar padding[2];
+};
+
+bool CompCamera::SaveBinary(std::vector<char>& blob) const
+{
+	CameraBlob data;
+	memset(&data, 0, sizeof(data));
+	memcpy(data.position, frustum.pos.ptr(), sizeof(data.position));
+	memcpy(data.front, frustum.front.ptr(), sizeof(data.front));
+	memcpy(data.up, frustum.up.ptr(), sizeof(data.up));
+	data.near_plane = frustum.nearPlaneDistance;
+	data.far_plane = frustum.farPlaneDistance;
+	data.vertical_fov = frustum.verticalFov;
+	data.is_main = is_main ? 1 : 0;
+	data.culling = culling ? 1 : 0;
+
+	const char* bytes = (const char*)&data;
+	blob.insert(blob.end(), bytes, bytes + sizeof(data));
+	return true;
+}
+
+bool CompCamera::LoadBinary(const char* blob, uint size)
+{
+	if (size != sizeof(CameraBlob))
+	{
+		return false;
+	}
+	CameraBlob data;
+	memcpy(&data, blob, sizeof(data));
+	frustum.pos = float3(data.position);
+	frustum.front = float3(data.front);
+	frustum.up = float3(data.up);
+	frustum.nearPlaneDistance = data.near_plane;
+	frustum.farPlaneDistance = data.far_plane;
+	frustum.verticalFov = data.vertical_fov;
+	is_main = (data.is_main != 0);
+	culling = (data.culling != 0);
+
+	SetLoadedFrustum();
+	return true;
+}
+
+// After Load: set the output variables from the frustum
+void CompCamera::SetLoadedFrustum()
+{
 	near_plane = frustum.nearPlaneDistance;
 	far_plane = frustum.farPlaneDistance;
 	vertical_fov = frustum.verticalFov * RADTODEG; /* output variable in Degrees */
-	
-	is_main = json_object_dotget_boolean_with_std(object, name + "Main Camera");
-	SetMain(is_main);
 
-	culling = json_object_dotget_boolean_with_std(object, name + "Culling");
+	SetMain(is_main);
 
 	Enable();
 }
@@ -3,7 +3,9 @@
 
 #include "Component.h"
 #include "Geometry/Frustum.h"
+#include "FrustumCulling.h"
 #include <queue>
+#include <vector>
 
 class GameObject;
 
@@ -57,12 +59,17 @@ public:
 	float* GetViewMatrix() const;
 	float* GetProjectionMatrix() const;
 
-	void Save(JSON_Object* object, std::string name, bool saveScene, uint& countResources) const;
+	void Save(JSONWriter& writer, bool saveScene) const;
 	void Load(const JSON_Object* object, std::string name);
+	bool SaveBinary(std::vector<char>& blob) const;
+	bool LoadBinary(const char* blob, uint size);
 
 public:
 	Frustum frustum;
 
+private:
+	void SetLoadedFrustum();
+
 private:
 	bool showPopup = false;
 
@@ -78,6 +85,16 @@ private:
 	// -------------------------------
 
 	std::queue<GameObject*> candidates_to_cull;
+
+	// Octree handles of the dynamic objects that can be visible (set invisible before next culling)
+	std::vector<int> dynamic_visible;
+	bool dynamic_cull_reset = true;
+
+	// Batch culling (planes extracted once per frame) ---
+	CullPlanes cull_planes;
+	CullBatch cull_batch;
+	std::vector<int> cull_candidates;
+	std::vector<uchar> plane_hints; // Plane coherency by octree handle
 };
 
 #endif
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "ModuleFS.h"
 #include "ImportMaterial.h"
 #include "ResourceMaterial.h"
+#include "JSONWriter.h"
 #include "Scene.h"
 
 CompMaterial::CompMaterial(Comp_Type t, GameObject* parent): Component(t, parent)
@@ -67,7 +68,7 @@ void CompMaterial::preUpdate(float dt)
 				// Check if loaded
 				if (resourceMaterial->IsLoadedToMemory() == Resource::State::UNLOADED)
 				{
-					App->importer->iMaterial->LoadResource(std::to_string(resourceMaterial->GetUUID()).c_str(), resourceMaterial);
+					App->resource_manager->RequestLoad(resourceMaterial);
 				}
 				uuidResourceReimported = 0;
 			}
@@ -95,7 +96,7 @@ Color CompMaterial::GetColor() const
 
 uint CompMaterial::GetTextureID() const
 {
-	if (resourceMaterial != nullptr)
+	if (resourceMaterial != nullptr && resourceMaterial->IsLoadedToMemory() == Resource::State::LOADED)
 	{
 		return resourceMaterial->GetTextureID();
 	}
@@ -233,19 +234,19 @@ void CompMaterial::ShowInspectorInfo()
 	ImGui::TreePop();
 }
 
-void CompMaterial::Save(JSON_Object* object, std::string name, bool saveScene, uint& countResources) const
+void CompMaterial::Save(JSONWriter& writer, bool saveScene) const
 {
-	json_object_dotset_number_with_std(object, name + "Type", C_MATERIAL);
-	float4 tempColor = { color.r, color.g, color.b, color.a };
-	App->fs->json_array_dotset_float4(object, name + "Color", tempColor);
-	json_object_dotset_number_with_std(object, name + "UUID", uid);
+	writer.Number("Type", C_MATERIAL);
+	float tempColor[4] = { color.r, color.g, color.b, color.a };
+	writer.Floats("Color", tempColor, 4);
+	writer.Number("UUID", uid);
 	if (resourceMaterial != nullptr)
 	{
-		json_object_dotset_number_with_std(object, name + "Resource Material UUID", resourceMaterial->GetUUID());
+		writer.Number("Resource Material UUID", resourceMaterial->GetUUID());
 	}
 	else
 	{
-		json_object_dotset_number_with_std(object, name + "Resource Material UUID", 0);
+		writer.Number("Resource Material UUID", 0);
 	}
 }
 
@@ -255,6 +256,48 @@ void CompMaterial::Load(const JSON_Object* object, std::string name)
 	color.Set(tempColor.x, tempColor.y, tempColor.z, tempColor.w);
 	uid = json_object_dotget_number_with_std(object, name + "UUID");
 	uint resourceID = json_object_dotget_number_with_std(object, name + "Resource Material UUID");
+	LinkLoadedResource(resourceID);
+}
+
+// Binary: color, uuid, uuid of the resource
+struct MaterialBlob
+{
+	float color[4];
+	uint uuid;
+	uint resource;
+};
+
+bool CompMaterial::SaveBinary(std::vector<char>& blob) const
+{
+	MaterialBlob data;
+	data.color[0] = color.r;
+	data.color[1] = color.g;
+	data.color[2] = color.b;
+	data.color[3] = color.a;
+	data.uuid = uid;
+	data.resource = (resourceMaterial != nullptr) ? resourceMaterial->GetUUID() : 0;
+
+	const char* bytes = (const char*)&data;
+	blob.insert(blob.end(), bytes, bytes + sizeof(data));
+	return true;
+}
+
+bool CompMaterial::LoadBinary(const char* blob, uint size)
+{
+	if (size != sizeof(MaterialBlob))
+	{
+		return false;
+	}
+	MaterialBlob data;
+	memcpy(&data, blob, sizeof(data));
+	color.Set(data.color[0], data.color[1], data.color[2], data.color[3]);
+	uid = data.uuid;
+	LinkLoadedResource(data.resource);
+	return true;
+}
+
+void CompMaterial::LinkLoadedResource(uint resourceID)
+{
 	if (resourceID > 0)
 	{
 		resourceMaterial = (ResourceMaterial*)App->resource_manager->GetResource(resourceID);
@@ -265,7 +308,7 @@ void CompMaterial::Load(const JSON_Object* object, std::string name)
 			// LOAD MATERIAL -------------------------
 			if (resourceMaterial->IsLoadedToMemory() == Resource::State::UNLOADED)
 			{
-				App->importer->iMaterial->LoadResource(std::to_string(resourceMaterial->GetUUID()).c_str(), resourceMaterial);
+				App->resource_manager->RequestLoad(resourceMaterial);
 			}
 		}
 	}
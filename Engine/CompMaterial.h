@@ -28,13 +28,18 @@ public:
 	// -------------------------
 
 	// SAVE - LOAD METHODS ------------------------
-	void Save(JSON_Object* object, std::string name, bool saveScene, uint& countResources) const;
+	void Save(JSONWriter& writer, bool saveScene) const;
 	void Load(const JSON_Object* object, std::string name);
+	bool SaveBinary(std::vector<char>& blob) const;
+	bool LoadBinary(const char* blob, uint size);
 	// --------------------------------------------
 
 public:
 	ResourceMaterial* resourceMaterial = nullptr;
 
+private:
+	void LinkLoadedResource(uint resourceID);
+
 private:
 	Color color = White;
 	bool selectMaterial = false;
@@ -4,11 +4,13 @@
 #include "CompMesh.h"
 #include "CompMaterial.h"
 #include "CompTransform.h"
+#include "CompCamera.h"
 #include "ModuleRenderer3D.h"
 #include "GameObject.h"
 #include "Scene.h"
 #include "ImportMesh.h"
 #include "ResourceMesh.h"
+#include "JSONWriter.h"
 #include "Color.h"
 
 #include <vector>
@@ -31,6 +33,7 @@ CompMesh::CompMesh(const CompMesh& copy, GameObject* parent) :Component(Comp_Typ
 	//material = material;
 	hasNormals = copy.hasNormals;
 	render = copy.render;
+	pending_bounding_box = copy.pending_bounding_box;
 
 	nameComponent = "Mesh";
 }
@@ -74,6 +77,10 @@ void CompMesh::preUpdate(float dt)
 			uuidResourceReimported = resourceMesh->GetUUID();
 			resourceMesh = nullptr;
 		}
+		else
+		{
+			ResourceLoaded(resourceMesh);
+		}
 	}
 	else
 	{
@@ -86,7 +93,7 @@ void CompMesh::preUpdate(float dt)
 				// Check if loaded!
 				if (resourceMesh->IsLoadedToMemory() == Resource::State::UNLOADED)
 				{
-					App->importer->iMesh->LoadResource(std::to_string(resourceMesh->GetUUID()).c_str(), resourceMesh);
+					App->resource_manager->RequestLoad(resourceMesh);
 				}
 				uuidResourceReimported = 0;
 			}
@@ -98,6 +105,16 @@ void CompMesh::Update(float dt)
 {
 }
 
+void CompMesh::ResourceLoaded(const ResourceMesh* mesh)
+{
+	if (pending_bounding_box && mesh == resourceMesh && resourceMesh->GetState() == Resource::State::LOADED)
+	{
+		// Mesh streamed, now the vertices are ready
+		parent->AddBoundingBox(resourceMesh);
+		pending_bounding_box = false;
+	}
+}
+
 void CompMesh::ShowOptions()
 {
 	//ImGui::MenuItem("CREATE", NULL, false, false);
@@ -178,10 +195,20 @@ void CompMesh::ShowInspectorInfo()
 	{
 		ImGui::Text("Name:"); ImGui::SameLine();
 		ImGui::TextColored(ImVec4(0.25f, 1.00f, 0.00f, 1.00f), "%s", resourceMesh->name);
-		ImGui::Text("Vertices:"); ImGui::SameLine();
-		ImGui::TextColored(ImVec4(0.25f, 1.00f, 0.00f, 1.00f), "%i", resourceMesh->num_vertices);
-		ImGui::Text("Indices:"); ImGui::SameLine();
-		ImGui::TextColored(ImVec4(0.25f, 1.00f, 0.00f, 1.00f), "%i", resourceMesh->num_indices);
+		// A loader thread writes the data of the mesh while it's streaming, only read it once loaded
+		if (resourceMesh->IsLoadedToMemory() == Resource::State::LOADED)
+		{
+			ImGui::Text("Vertices:"); ImGui::SameLine();
+			ImGui::TextColored(ImVec4(0.25f, 1.00f, 0.00f, 1.00f), "%i", resourceMesh->num_vertices);
+			ImGui::Text("Indices:"); ImGui::SameLine();
+			ImGui::TextColored(ImVec4(0.25f, 1.00f, 0.00f, 1.00f), "%i", resourceMesh->num_indices);
+			ImGui::Text("Vertex Size:"); ImGui::SameLine();
+			ImGui::TextColored(ImVec4(0.25f, 1.00f, 0.00f, 1.00f), "%i bytes %s", resourceMesh->vertex_size, resourceMesh->quantized ? "(Quantized)" : "");
+		}
+		else
+		{
+			ImGui::Text("Loading...");
+		}
 
 		ImGui::Checkbox("Render", &render);
 	}
@@ -220,7 +247,14 @@ void CompMesh::ShowInspectorInfo()
 					App->importer->iMesh->LoadResource(std::to_string(resourceMesh->GetUUID()).c_str(), resourceMesh);
 				}
 				Enable();
-				parent->AddBoundingBox(resourceMesh);
+				if (resourceMesh->IsLoadedToMemory() == Resource::State::LOADED)
+				{
+					parent->AddBoundingBox(resourceMesh);
+				}
+				else
+				{
+					pending_bounding_box = true;
+				}
 			}
 		}
 	}
@@ -229,90 +263,45 @@ void CompMesh::ShowInspectorInfo()
 
 void CompMesh::Draw()
 {
-	if (render && resourceMesh != nullptr)
+	// Meshes still streaming aren't drawn
+	if (render && resourceMesh != nullptr && resourceMesh->IsLoadedToMemory() == Resource::State::LOADED)
 	{
-		CompTransform* transform = (CompTransform*)parent->FindComponentByType(C_TRANSFORM);
-		if (transform != nullptr)
+		if (resourceMesh->geometry.GetNumVertices() > 0 && resourceMesh->geometry.GetNumIndices() > 0)
 		{
-			/* Push Matrix to Draw with transform applied, only if it contains a transform component */
-			glMatrixMode(GL_MODELVIEW);
-			glPushMatrix();
-			glMultMatrixf(transform->GetMultMatrixForOpenGL());
-		}
-
-		if (resourceMesh->vertices.size() > 0 && resourceMesh->indices.size() > 0)
-		{
-			glEnableClientState(GL_VERTEX_ARRAY);
-			glEnableClientState(GL_NORMAL_ARRAY);
-			glEnableClientState(GL_ELEMENT_ARRAY_BUFFER);
-			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-
-			//Set Wireframe
-			if (App->renderer3D->wireframe)
-			{
-				glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-			}
+			/* Draw with transform applied, only if it contains a transform component */
+			CompTransform* transform = (CompTransform*)parent->FindComponentByType(C_TRANSFORM);
+			float4x4 global = (transform != nullptr) ? transform->GetGlobalTransform() : float4x4::identity;
 
 			//Set Color
+			Color color(1.0f, 0.0f, 1.0f, 1.0f);
 			if (material != nullptr)
 			{
-				glColor4f(material->GetColor().r, material->GetColor().g, material->GetColor().b, material->GetColor().a);
-			}
-			else
-			{
-				glColor4f(1.0f, 0.0f, 1.0f, 1.0f);
+				color = material->GetColor();
 			}
 
+			uint texture = 0;
 			if (App->renderer3D->texture_2d)
 			{
 				CompMaterial* temp = parent->GetComponentMaterial();
-				if(temp != nullptr)
-					glBindTexture(GL_TEXTURE_2D, temp->GetTextureID());
+				if (temp != nullptr)
+					texture = temp->GetTextureID();
 			}
 
-			glBindBuffer(GL_ARRAY_BUFFER, resourceMesh->vertices_id); //VERTEX ID
-			glVertexPointer(3, GL_FLOAT, sizeof(Vertex), NULL);
-			glNormalPointer(GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, norm));
-			glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
-			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			// Distance to the camera only sorts the instances of the same mesh & material
+			const Frustum& frustum = App->renderer3D->active_camera->frustum;
+			float depth = global.TranslatePart().Distance(frustum.pos) / frustum.farPlaneDistance;
 
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, resourceMesh->indices_id); // INDICES ID
-			glDrawElements(GL_TRIANGLES, resourceMesh->indices.size(), GL_UNSIGNED_INT, NULL);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+			// Normals lines are drawn with the mesh
+			bool draw_normals = App->renderer3D->normals && hasNormals && resourceMesh->CreateNormalsBuffer();
 
-			// NORMALS ----------------------------------
-			if (App->renderer3D->normals && hasNormals)
-			{
-				glBindBuffer(GL_ARRAY_BUFFER, resourceMesh->vertices_norm_id);
-				glVertexPointer(3, GL_FLOAT, sizeof(float3), NULL);
-				glDrawArrays(GL_LINES, 0, resourceMesh->vertices.size() * 2);
-				glBindBuffer(GL_ARRAY_BUFFER, 0);
-			}
-
-			//Reset TextureColor
-			glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-			glBindTexture(GL_TEXTURE_2D, 0);
-
-			//Disable Wireframe -> only this object will be wireframed
-			if (App->renderer3D->wireframe)
-			{
-				glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-			}
-			glDisableClientState(GL_VERTEX_ARRAY);
-			glDisableClientState(GL_NORMAL_ARRAY);
-			glDisableClientState(GL_ELEMENT_ARRAY_BUFFER);
-			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+			// The render queue draws it after the scene is traversed (sorted & batched)
+			App->renderer3D->render_queue.Submit(resourceMesh, texture, color, global, depth, draw_normals);
 		}
 
 		else
 		{
 			LOG("Cannot draw the mesh");
 		}
-
-		if (transform != nullptr)
-		{
-			glPopMatrix();
-		}
 	}
 }
 
@@ -365,24 +354,18 @@ void CompMesh::SetResource(ResourceMesh* resourse_mesh, bool isImport)
 	}
 }
 
-void CompMesh::Save(JSON_Object* object, std::string name, bool saveScene, uint& countResources) const
+// Prefabs also list the mesh resources in "Info" (see JSONSerialization::SavePrefabResources)
+void CompMesh::Save(JSONWriter& writer, bool saveScene) const
 {
-	json_object_dotset_number_with_std(object, name + "Type", C_MESH);
-	json_object_dotset_number_with_std(object, name + "UUID", uid);
+	writer.Number("Type", C_MESH);
+	writer.Number("UUID", uid);
 	if(resourceMesh != nullptr)
 	{
-		if (saveScene == false)
-		{
-			// Save Info of Resource in Prefab (next we use this info for Reimport this prefab)
-			std::string temp = std::to_string(countResources++);
-			json_object_dotset_number_with_std(object, "Info.Resources.Resource " + temp + ".UUID Resource", resourceMesh->GetUUID());
-			json_object_dotset_string_with_std(object, "Info.Resources.Resource " + temp + ".Name", resourceMesh->name);
-		}
-		json_object_dotset_number_with_std(object, name + "Resource Mesh UUID", resourceMesh->GetUUID());
+		writer.Number("Resource Mesh UUID", resourceMesh->GetUUID());
 	}
 	else
 	{
-		json_object_dotset_number_with_std(object, name + "Resource Mesh UUID", 0);
+		writer.Number("Resource Mesh UUID", 0);
 	}
 }
 
@@ -390,6 +373,42 @@ void CompMesh::Load(const JSON_Object* object, std::string name)
 {
 	uid = json_object_dotget_number_with_std(object, name + "UUID");
 	uint resourceID = json_object_dotget_number_with_std(object, name + "Resource Mesh UUID");
+	LinkLoadedResource(resourceID);
+}
+
+// Binary: uuid, uuid of the resource
+struct MeshBlob
+{
+	uint uuid;
+	uint resource;
+};
+
+bool CompMesh::SaveBinary(std::vector<char>& blob) const
+{
+	MeshBlob data;
+	data.uuid = uid;
+	data.resource = (resourceMesh != nullptr) ? resourceMesh->GetUUID() : 0;
+
+	const char* bytes = (const char*)&data;
+	blob.insert(blob.end(), bytes, bytes + sizeof(data));
+	return true;
+}
+
+bool CompMesh::LoadBinary(const char* blob, uint size)
+{
+	if (size != sizeof(MeshBlob))
+	{
+		return false;
+	}
+	MeshBlob data;
+	memcpy(&data, blob, sizeof(data));
+	uid = data.uuid;
+	LinkLoadedResource(data.resource);
+	return true;
+}
+
+void CompMesh::LinkLoadedResource(uint resourceID)
+{
 	if (resourceID > 0)
 	{
 		resourceMesh = (ResourceMesh*)App->resource_manager->GetResource(resourceID);
@@ -400,10 +419,17 @@ void CompMesh::Load(const JSON_Object* object, std::string name)
 			// LOAD MESH ----------------------------
 			if (resourceMesh->IsLoadedToMemory() == Resource::State::UNLOADED)
 			{
-				App->importer->iMesh->LoadResource(std::to_string(resourceMesh->GetUUID()).c_str(), resourceMesh);			
+				App->resource_manager->RequestLoad(resourceMesh);
+			}
+			// Add bounding box (streamed meshes add it when they are loaded) ------
+			if (resourceMesh->IsLoadedToMemory() == Resource::State::LOADED)
+			{
+				parent->AddBoundingBox(resourceMesh);
+			}
+			else
+			{
+				pending_bounding_box = true;
 			}
-			// Add bounding box ------
-			parent->AddBoundingBox(resourceMesh);
 		}
 	}
 	Enable();
@@ -46,10 +46,14 @@ public:
 
 	void LinkMaterial(const CompMaterial* mat);
 	void SetResource(ResourceMesh * resourse_mesh, bool isImport = false);
+	// Streaming finished: adds the pending bounding box (active or not)
+	void ResourceLoaded(const ResourceMesh* mesh);
 
 	// SAVE - LOAD METHODS ----------------
-	void Save(JSON_Object* object, std::string name, bool saveScene, uint& countResources) const;
+	void Save(JSONWriter& writer, bool saveScene) const;
 	void Load(const JSON_Object* object, std::string name);
+	bool SaveBinary(std::vector<char>& blob) const;
+	bool LoadBinary(const char* blob, uint size);
 	// -------------------------------------
 
 public:
@@ -58,8 +62,12 @@ public:
 
 	ResourceMesh* resourceMesh = nullptr;
 
+private:
+	void LinkLoadedResource(uint resourceID);
+
 private:
 	bool render = true;
+	bool pending_bounding_box = false; // Waiting the mesh streaming
 	bool SelectMesh = false;
 	const CompMaterial* material = nullptr;
 	uint uuidResourceReimported = 0;
@@ -7,6 +7,7 @@
 #include "CSharpScript.h"
 #include "Scene.h"
 #include "ModuleFS.h"
+#include "JSONWriter.h"
 
 CompScript::CompScript(Comp_Type t, GameObject* parent) : Component(t, parent)
 {
@@ -132,7 +133,10 @@ bool CompScript::CheckAllVariables()
 
 void CompScript::RemoveReferences(GameObject* go)
 {
-	resourcescript->GetCSharpScript()->RemoveReferences(go);
+	if (resourcescript != nullptr && resourcescript->GetCSharpScript() != nullptr)
+	{
+		resourcescript->GetCSharpScript()->RemoveReferences(go);
+	}
 }
 
 void CompScript::ClearVariables()
@@ -465,17 +469,17 @@ void CompScript::ShowVarValue(ScriptVariable* var, int pushi)
 	}
 }
 
-void CompScript::Save(JSON_Object* object, std::string name, bool saveScene, uint& countResources) const
+void CompScript::Save(JSONWriter& writer, bool saveScene) const
 {
-	json_object_dotset_number_with_std(object, name + "Type", Comp_Type::C_SCRIPT);
-	json_object_dotset_number_with_std(object, name + "UUID", uid);
+	writer.Number("Type", Comp_Type::C_SCRIPT);
+	writer.Number("UUID", uid);
 	if (resourcescript != nullptr)
 	{
-		json_object_dotset_number_with_std(object, name + "Resource Script UUID", resourcescript->GetUUID());
+		writer.Number("Resource Script UUID", resourcescript->GetUUID());
 		// Now Save Info in CSharp
-		resourcescript->Save(object, name);
+		resourcescript->Save(writer);
 	}
-	json_object_dotset_string_with_std(object, name + "Name Script", nameScript.c_str());
+	writer.String("Name Script", nameScript.c_str());
 }
 
 void CompScript::Load(const JSON_Object* object, std::string name)
@@ -34,7 +34,7 @@ public:
 	// -------------------------
 
 	// SAVE - LOAD METHODS ----------------
-	void Save(JSON_Object* object, std::string name, bool saveScene, uint& countResources) const;
+	void Save(JSONWriter& writer, bool saveScene) const;
 	void Load(const JSON_Object* object, std::string name);
 	// -------------------------------------
 
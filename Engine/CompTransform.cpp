@@ -8,6 +8,7 @@
 #include "ModuleInput.h"
 #include "CompCamera.h"
 #include "ModuleFS.h"
+#include "JSONWriter.h"
 #include "Scene.h"
 #include "ModuleConsole.h"
 #include "ModuleWindow.h"
@@ -20,13 +21,21 @@
 CompTransform::CompTransform(Comp_Type t, GameObject* parent) : Component(t, parent)
 {
 	nameComponent = "Transformation";
+	if (parent->isPrefabTemplate() == false)
+	{
+		hierarchy_index = App->scene->transform_hierarchy.Add(this, GetParentHierarchyIndex());
+	}
 }
 
 CompTransform::CompTransform(const CompTransform& copy, GameObject* parent) : Component(Comp_Type::C_TRANSFORM, parent)
 {
 	freeze = copy.freeze; //To enable/disable editing transforms
 	transform_mode = copy.transform_mode; //LOCAL or WORLD
-	
+	if (parent->isPrefabTemplate() == false)
+	{
+		hierarchy_index = App->scene->transform_hierarchy.Add(this, GetParentHierarchyIndex());
+	}
+
 	Init(copy.GetPos(), copy.GetRotEuler(), copy.GetScale()); //Set Local matrix
 
 	nameComponent = "Transformation";
@@ -34,10 +43,11 @@ CompTransform::CompTransform(const CompTransform& copy, GameObject* parent) : Co
 
 CompTransform::~CompTransform()
 {
+	App->scene->transform_hierarchy.Remove(hierarchy_index);
 }
 
 // Init from Rotation Quaternion
-void CompTransform::Init(float3 p, float4 r, float3 s)
+void CompTransform::Init(float3 p, const float4& r, float3 s)
 {
 	SetPos(p);
 	SetRot(Quat(r.x, r.y, r.z, r.w));
@@ -71,7 +81,7 @@ void CompTransform::Update(float dt)
 		ImGuizmo::SetRect(screen.x, screen.y, screen.z, screen.w);
 
 		// Get global transform of the object and transpose it to edit with Guizmo
-		global_transposed = global_transform.Transposed();
+		global_transposed = GetGlobalTransform().Transposed();
 
 		if (io.WantTextInput == false)
 		{
@@ -98,29 +108,21 @@ void CompTransform::Update(float dt)
 		{
 			global_transposed.Transpose();
 
+			float4x4 local_transform = global_transposed;
+
 			//If it's a root node, global and local transforms are the same
-			if (parent->GetParent() == nullptr)
-			{
-				local_transform = global_transposed;
-			}
-			else
+			//Otherwise, set local matrix from parent global matrix (inverted)
+			if (parent->GetParent() != nullptr)
 			{
-				//Otherwise, set local matrix from parent global matrix (inverted)
 				const CompTransform* transform = parent->GetParent()->GetComponentTransform();
 				local_transform = transform->GetGlobalTransform().Inverted() * global_transposed;
 			}
 
 			local_transform.Decompose(position, rotation, scale);
 			rotation_euler = rotation.ToEulerXYZ() * RADTODEG;
-			toUpdate = true;
+			SetDirty();
 		}
 	}
-
-	if (toUpdate)
-	{
-		UpdateMatrix(transform_mode);
-		toUpdate = false;
-	}
 }
 
 void CompTransform::ShowOptions()
@@ -267,51 +269,51 @@ void CompTransform::ShowTransform(float drag_speed)
 void CompTransform::SetPosGlobal(float3 pos)
 {
 	position_global = pos;
-	toUpdate = true;
+	SetDirty();
 }
 
 void CompTransform::SetRotGlobal(float3 rot_g)
 {
 	rotation_global = Quat::FromEulerXYZ(rot_g[0] * DEGTORAD, rot_g[1] * DEGTORAD, rot_g[2] * DEGTORAD);
-	toUpdate = true;
+	SetDirty();
 }
 
 void CompTransform::SetScaleGlobal(float3 scale)
 {
 	scale_global = scale;
-	toUpdate = true;
+	SetDirty();
 }
 
 void CompTransform::SetPos(float3 pos_g)
 {
 	position = pos_g;
-	toUpdate = true;
+	SetDirty();
 }
 
 void CompTransform::IncrementRot(float3 rot)
 {
 	rotation_euler += rot;
 	rotation = Quat::FromEulerXYZ(rotation_euler[0] * DEGTORAD, rotation_euler[1] * DEGTORAD, rotation_euler[2] * DEGTORAD);
-	toUpdate = true;
+	SetDirty();
 }
 
-void CompTransform::SetRot(Quat rot)
+void CompTransform::SetRot(const Quat& rot)
 {
 	rotation_euler = rot.ToEulerXYZ() * RADTODEG;
 	rotation = rot;
-	toUpdate = true;
+	SetDirty();
 }
 
 void CompTransform::SetRot(float3 rot)
 {
 	rotation = Quat::FromEulerXYZ(rot[0] * DEGTORAD, rot[1] * DEGTORAD, rot[2] * DEGTORAD);
-	toUpdate = true;
+	SetDirty();
 }
 
 void CompTransform::SetScale(float3 scal)
 {
 	scale = scal;
-	toUpdate = true;
+	SetDirty();
 }
 
 void CompTransform::ResetMatrix()
@@ -324,85 +326,42 @@ void CompTransform::ResetMatrix()
 
 void CompTransform::SetLocalTransform()
 {
-	local_transform = float4x4::FromTRS(position, rotation, scale);
+	App->scene->transform_hierarchy.SetLocal(hierarchy_index, float4x4::FromTRS(position, rotation, scale));
 }
 
-void CompTransform::SetGlobalTransform()
+// Mark this transform to be recomputed (with all its childs) in the next TransformHierarchy::Propagate()
+void CompTransform::SetDirty()
 {
-	global_transform = float4x4::FromTRS(position_global, rotation_global, scale);
+	App->scene->transform_hierarchy.SetDirty(hierarchy_index);
 }
 
-void CompTransform::UpdateLocalTransform()
+int CompTransform::GetParentHierarchyIndex() const
 {
-	local_transform = float4x4::identity;
-	const GameObject* parent_object = parent;
-
-	//If it has no parents, local transform is the same as the global transform
-	if (parent_object->GetParent() == nullptr)
+	if (parent != nullptr && parent->GetParent() != nullptr)
 	{
-		local_transform = global_transform;		
-	}
-	//If not, apply parent global transform (Inverted) to get its local transform
-	else
-	{
-		CompTransform* parent_transform = parent_object->GetParent()->GetComponentTransform();
-		local_transform = global_transform * parent_transform->GetGlobalTransform().Inverted();
+		const CompTransform* transform = parent->GetParent()->GetComponentTransform();
+		if (transform != nullptr)
+		{
+			return transform->GetHierarchyIndex();
+		}
 	}
+	return TRANSFORM_NONE;
 }
 
-void CompTransform::UpdateGlobalTransform()
+// Call it when the game object changes its parent
+void CompTransform::LinkParent()
 {
-	global_transform = float4x4::identity;
-	std::list<const GameObject*> parents;
-	const GameObject* parent_object = parent;
-
-	// Put all parents of the game object to pass from local to global matrix
-	while (parent_object != nullptr)
-	{
-		parents.push_back(parent_object);
-		parent_object = parent_object->GetParent();
-	}
-
-	std::list<const GameObject*>::reverse_iterator item = parents.rbegin();
-	
-	// Multiply parents local transforms to get the Global transform of this game object
-	while (item !=  parents.crend())
-	{
-		float4x4 matrix = (*item)->GetComponentTransform()->GetLocalTransform();
-		global_transform = global_transform * matrix;
-		item++;
-	}
+	App->scene->transform_hierarchy.SetParent(hierarchy_index, GetParentHierarchyIndex());
 }
 
-// Update Global transform and call this function for all its childs
-void CompTransform::UpdateGlobalMatrixRecursive()
+void CompTransform::SetHierarchyIndex(int index)
 {
-	UpdateGlobalTransform();
-	parent->UpdateChildsMatrices();
+	hierarchy_index = index;
 }
 
-void CompTransform::UpdateMatrix(ImGuizmo::MODE mode)
+int CompTransform::GetHierarchyIndex() const
 {
-	switch (mode)
-	{
-	case (ImGuizmo::MODE::LOCAL): // Local Mode only for now
-	{
-		SetLocalTransform(); /*First, set local transform from inspector variables*/
-		UpdateGlobalTransform(); /*Then, update global matrix*/
-		break;
-	}
-	//case (ImGuizmo::MODE::WORLD):
-	//{
-	//	SetGlobalTransform(); /*First, set global transform from inspector variables*/
-	//	UpdateLocalTransform(); /*Then, update local matrix*/
-	//	break;
-	//}
-	default:
-		break;
-	}
-
-	// Update Global matrices of all children
-	parent->UpdateChildsMatrices();
+	return hierarchy_index;
 }
 
 float3 CompTransform::GetPos() const
@@ -430,14 +389,28 @@ float3 CompTransform::GetScale() const
 	return scale;
 }
 
+// Prefab templates aren't in the hierarchy, their matrices are built when asked
 float4x4 CompTransform::GetLocalTransform() const
 {
-	return local_transform;
+	if (hierarchy_index == TRANSFORM_NONE)
+	{
+		return float4x4::FromTRS(position, rotation, scale);
+	}
+	return App->scene->transform_hierarchy.GetLocal(hierarchy_index);
 }
 
 float4x4 CompTransform::GetGlobalTransform() const
 {
-	return global_transform;
+	if (hierarchy_index == TRANSFORM_NONE)
+	{
+		const CompTransform* parent_transform = (parent->GetParent() != nullptr) ? parent->GetParent()->GetComponentTransform() : nullptr;
+		if (parent_transform != nullptr)
+		{
+			return parent_transform->GetGlobalTransform() * GetLocalTransform();
+		}
+		return GetLocalTransform();
+	}
+	return App->scene->transform_hierarchy.GetGlobal(hierarchy_index);
 }
 
 ImGuizmo::MODE CompTransform::GetMode() const
@@ -452,28 +425,73 @@ void CompTransform::Freeze(bool freeze)
 
 const float* CompTransform::GetMultMatrixForOpenGL() const
 {
-	return global_transform.Transposed().ptr();
+	return GetGlobalTransform().Transposed().ptr();
 }
 
-void CompTransform::Save(JSON_Object* object, std::string name, bool saveScene, uint& countResources) const
+void CompTransform::Save(JSONWriter& writer, bool saveScene) const
 {
+	float3 position = GetPos();
+	Quat rotation = GetRot();
+	float3 scale = GetScale();
+
 	// TRANSFORM -----------
-	json_object_dotset_number_with_std(object, name + "Type", C_TRANSFORM);
+	writer.Number("Type", C_TRANSFORM);
 	// Position
-	App->fs->json_array_dotset_float3(object, name + "Position", GetPos());
+	writer.Floats("Position", position.ptr(), 3);
 	// Rotation
-	App->fs->json_array_dotset_float4(object, name + "Rotation", float4(GetRot().x, GetRot().y, GetRot().z, GetRot().w));
+	writer.Floats("Rotation", rotation.ptr(), 4);
 	// Scale
-	App->fs->json_array_dotset_float3(object, name + "Scale", GetScale());
-
+	writer.Floats("Scale", scale.ptr(), 3);
 }
 
 void CompTransform::Load(const JSON_Object* object, std::string name)
 {
-	float3 position = App->fs->json_array_dotget_float3_string(object, name + "Position");
-	float4 rotation = App->fs->json_array_dotget_float4_string(object, name + "Rotation");
-	float3 scale = App->fs->json_array_dotget_float3_string(object, name + "Scale");
+	static const JSON_Key key_position = json_key("Position");
+	static const JSON_Key key_rotation = json_key("Rotation");
+	static const JSON_Key key_scale = json_key("Scale");
+
+	// Resolve the component once, then read the fields directly
+	const JSON_Object* node = json_object_dotget_node_with_std(object, name);
+	float3 position = App->fs->json_array_get_float3_by_key(node, key_position);
+	float4 rotation = App->fs->json_array_get_float4_by_key(node, key_rotation);
+	float3 scale = App->fs->json_array_get_float3_by_key(node, key_scale);
 	Init(position, rotation, scale);
 	Enable();
 }
 
+// Binary: position, rotation (quaternion), scale
+struct TransformBlob
+{
+	float position[3];
+	float rotation[4];
+	float scale[3];
+};
+
+bool CompTransform::SaveBinary(std::vector<char>& blob) const
+{
+	TransformBlob data;
+	float3 position = GetPos();
+	Quat rotation = GetRot();
+	float3 scale = GetScale();
+	memcpy(data.position, position.ptr(), sizeof(data.position));
+	memcpy(data.rotation, rotation.ptr(), sizeof(data.rotation));
+	memcpy(data.scale, scale.ptr(), sizeof(data.scale));
+
+	const char* bytes = (const char*)&data;
+	blob.insert(blob.end(), bytes, bytes + sizeof(data));
+	return true;
+}
+
+bool CompTransform::LoadBinary(const char* blob, uint size)
+{
+	if (size != sizeof(TransformBlob))
+	{
+		return false;
+	}
+	TransformBlob data;
+	memcpy(&data, blob, sizeof(data));
+	Init(float3(data.position), float4(data.rotation), float3(data.scale));
+	Enable();
+	return true;
+}
+
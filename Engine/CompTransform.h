@@ -23,7 +23,7 @@ public:
 	CompTransform(const CompTransform& copy, GameObject* parent);
 	~CompTransform();
 
-	void Init(float3 p, float4 r, float3 s);
+	void Init(float3 p, const float4& r, float3 s);
 	void Init(float3 p, float3 r, float3 s);
 	void Update(float dt);
 
@@ -37,16 +37,16 @@ public:
 	void SetPos(float3 pos);
 	void IncrementRot(float3 rot);
 	void SetRot(float3 rot);	//"rot" is "rotation_euler" updated, so we don't need to update it inside this method
-	void SetRot(Quat rot);		//"rot" is the quaternion we want to set to our rotation quaternion
+	void SetRot(const Quat& rot);		//"rot" is the quaternion we want to set to our rotation quaternion
 	void SetScale(float3 scale);
 	void SetLocalTransform();
-	void SetGlobalTransform();
-	void UpdateLocalTransform();
-	void UpdateGlobalTransform();
-	void UpdateGlobalMatrixRecursive();
 
 	void ResetMatrix();
-	void UpdateMatrix(ImGuizmo::MODE mode);
+
+	// Scene Transform Hierarchy ---------
+	void LinkParent();
+	void SetHierarchyIndex(int index);
+	int GetHierarchyIndex() const;
 
 	float3 GetPos() const;
 	float3 GetPosGlobal() const;
@@ -61,12 +61,18 @@ public:
 
 	const float* GetMultMatrixForOpenGL() const;
 
-	void Save(JSON_Object* object, std::string name, bool saveScene, uint& countResources) const;
+	void Save(JSONWriter& writer, bool saveScene) const;
 	void Load(const JSON_Object* object, std::string name);
+	bool SaveBinary(std::vector<char>& blob) const;
+	bool LoadBinary(const char* blob, uint size);
+
+private:
+	void SetDirty();
+	int GetParentHierarchyIndex() const;
 
 private:
 	Axis axis;
-	bool toUpdate = false;
+	int hierarchy_index = -1; // Index of the matrices inside Scene TransformHierarchy
 	bool freeze = false;
 	bool editing_transform = false;
 
@@ -84,9 +90,6 @@ private:
 	Quat rotation = math::Quat::identity;
 	Quat rotation_global = math::Quat::identity;
 
-	float4x4 global_transform = math::float4x4::identity;
-	float4x4 local_transform = math::float4x4::identity;
-
 	float4 screen = math::float4::zero;
 	float4x4 global_transposed = float4x4::identity;
 	ImGuizmo::MODE transform_mode = ImGuizmo::LOCAL;
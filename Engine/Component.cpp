@@ -76,10 +76,30 @@ uint Component::GetUUID() const
 	return uid;
 }
 
-void Component::Save(JSON_Object* object, std::string name, bool saveScene, uint& countResources) const
+GameObject* Component::GetParent() const
+{
+	return parent;
+}
+
+int Component::GetPoolHandle() const
+{
+	return pool_handle;
+}
+
+void Component::Save(JSONWriter& writer, bool saveScene) const
 {
 }
 
 void Component::Load(const JSON_Object* object, std::string name)
 {
+}
+
+bool Component::SaveBinary(std::vector<char>& blob) const
+{
+	return false;
+}
+
+bool Component::LoadBinary(const char* blob, uint size)
+{
+	return false;
 }
\ No newline at end of file
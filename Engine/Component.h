@@ -4,11 +4,13 @@
 #include "Globals.h"
 #include "ImGui\imgui.h"
 #include <string>
+#include <vector>
 
 struct json_object_t;
 typedef struct json_object_t JSON_Object;
 
 class GameObject;
+class JSONWriter;
 
 enum Comp_Type 
 {	
@@ -20,6 +22,8 @@ enum Comp_Type
 	C_SCRIPT
 };
 
+#define MAX_COMP_TYPES 5 // Types with a pool and a slot in each GameObject
+
 class Component
 {
 public:
@@ -43,6 +47,8 @@ public:
 	bool isActive() const;
 	void SetActive(bool active);
 	uint GetUUID() const;
+	GameObject* GetParent() const;
+	int GetPoolHandle() const; // -1 if it isn't in a ComponentPool
 
 	const char* GetName() const
 	{
@@ -54,12 +60,18 @@ public:
 	}
 
 	// LOAD - SAVE METHODS ------------------
-	virtual void Save(JSON_Object* object, std::string name, bool saveScene, uint& countResources) const;
+	virtual void Save(JSONWriter& writer, bool saveScene) const;
 	virtual void Load(const JSON_Object* object, std::string name);
+	// Binary scene, false if the component hasn't got its own layout (then it's saved as JSON)
+	virtual bool SaveBinary(std::vector<char>& blob) const;
+	virtual bool LoadBinary(const char* blob, uint size);
 
 private:
+	template<typename TYPE> friend class ComponentPool;
+
 	Comp_Type type = C_UNKNOWN;
 	bool active = true;
+	int pool_handle = -1;
 
 protected:
 	GameObject* parent = nullptr; // Through this pointer we call some methods that modificate its data
@@ -0,0 +1,115 @@
+#include "ComponentPool.h"
+#include "CompTransform.h"
+#include "CompMesh.h"
+#include "CompMaterial.h"
+#include "CompCamera.h"
+#include "CompScript.h"
+
+ComponentPools::ComponentPools()
+{
+	transforms = new ComponentPool<CompTransform>();
+	meshes = new ComponentPool<CompMesh>();
+	materials = new ComponentPool<CompMaterial>();
+	cameras = new ComponentPool<CompCamera>();
+	scripts = new ComponentPool<CompScript>();
+}
+
+ComponentPools::~ComponentPools()
+{
+	RELEASE(transforms);
+	RELEASE(meshes);
+	RELEASE(materials);
+	RELEASE(cameras);
+	RELEASE(scripts);
+}
+
+Component* ComponentPools::Create(Comp_Type type, GameObject* parent)
+{
+	switch (type)
+	{
+	case Comp_Type::C_TRANSFORM:
+		return transforms->Create(type, parent);
+	case Comp_Type::C_MESH:
+		return meshes->Create(type, parent);
+	case Comp_Type::C_MATERIAL:
+		return materials->Create(type, parent);
+	case Comp_Type::C_CAMERA:
+		return cameras->Create(type, parent);
+	case Comp_Type::C_SCRIPT:
+		return scripts->Create(type, parent);
+	default:
+		return nullptr;
+	}
+}
+
+// Copy constructors of each type
+Component* ComponentPools::Copy(const Component& copy, GameObject* parent)
+{
+	switch (copy.GetType())
+	{
+	case Comp_Type::C_TRANSFORM:
+		return transforms->Create((const CompTransform&)copy, parent);
+	case Comp_Type::C_MESH:
+		return meshes->Create((const CompMesh&)copy, parent);
+	case Comp_Type::C_MATERIAL:
+		return materials->Create((const CompMaterial&)copy, parent);
+	case Comp_Type::C_CAMERA:
+		return cameras->Create((const CompCamera&)copy, parent);
+	case Comp_Type::C_SCRIPT:
+		return scripts->Create((const CompScript&)copy, parent);
+	default:
+		return nullptr;
+	}
+}
+
+void ComponentPools::Release(Component* component)
+{
+	if (component == nullptr)
+	{
+		return;
+	}
+	if (component->GetPoolHandle() == -1)
+	{
+		delete component; // Created outside the pools
+		return;
+	}
+
+	switch (component->GetType())
+	{
+	case Comp_Type::C_TRANSFORM:
+		transforms->Release((CompTransform*)component);
+		break;
+	case Comp_Type::C_MESH:
+		meshes->Release((CompMesh*)component);
+		break;
+	case Comp_Type::C_MATERIAL:
+		materials->Release((CompMaterial*)component);
+		break;
+	case Comp_Type::C_CAMERA:
+		cameras->Release((CompCamera*)component);
+		break;
+	case Comp_Type::C_SCRIPT:
+		scripts->Release((CompScript*)component);
+		break;
+	default:
+		break;
+	}
+}
+
+uint ComponentPools::GetMemory() const
+{
+	return transforms->GetMemory() + meshes->GetMemory() + materials->GetMemory() + cameras->GetMemory() + scripts->GetMemory();
+}
+
+uint ComponentPools::Size(Comp_Type type) const
+{
+	switch (type)
+	{
+	case Comp_Type::C_TRANSFORM: return transforms->Size();
+	case Comp_Type::C_MESH: return meshes->Size();
+	case Comp_Type::C_MATERIAL: return materials->Size();
+	case Comp_Type::C_CAMERA: return cameras->Size();
+	case Comp_Type::C_SCRIPT: return scripts->Size();
+	default: return 0;
+	}
+}
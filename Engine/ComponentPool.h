@@ -0,0 +1,188 @@
+#ifndef _COMPONENT_POOL_
+#define _COMPONENT_POOL_
+
+#include "Globals.h"
+#include "Component.h"
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+#define COMPONENT_POOL_CHUNK 256
+
+class CompTransform;
+class CompMesh;
+class CompMaterial;
+class CompCamera;
+class CompScript;
+
+// Component Pool --------------------------------------------------
+// Components of one type are constructed in chunks of consecutive slots.
+// Chunks never move, so pointers and handles (chunk * size + slot) stay valid
+// until the component is released, and the slot is reused after that.
+template<typename TYPE>
+class ComponentPool
+{
+public:
+	ComponentPool();
+	~ComponentPool();
+
+	template<typename... ARGS>
+	TYPE* Create(ARGS&&... args);
+	void Release(TYPE* component);
+
+	// nullptr if the slot is free
+	TYPE* Get(int handle) const;
+	uint Size() const;
+	uint Capacity() const;
+	uint GetMemory() const;	/* Bytes of the chunks & free list */
+
+	// Linear iteration over the alive components (in slot order)
+	template<typename FUNCTION>
+	void ForEach(FUNCTION function) const;
+
+private:
+	struct Chunk
+	{
+		typename std::aligned_storage<sizeof(TYPE), alignof(TYPE)>::type slots[COMPONENT_POOL_CHUNK];
+		bool alive[COMPONENT_POOL_CHUNK];
+	};
+
+	std::vector<Chunk*> chunks;
+	std::vector<int> free_slots;
+	uint num_alive = 0;
+};
+
+// All the pools of the scene, one per Comp_Type --------------------
+class ComponentPools
+{
+public:
+	ComponentPools();
+	~ComponentPools();
+
+	Component* Create(Comp_Type type, GameObject* parent);
+	Component* Copy(const Component& copy, GameObject* parent);
+	void Release(Component* component);
+
+	uint Size(Comp_Type type) const;
+	uint GetMemory() const;
+
+public:
+	ComponentPool<CompTransform>* transforms = nullptr;
+	ComponentPool<CompMesh>* meshes = nullptr;
+	ComponentPool<CompMaterial>* materials = nullptr;
+	ComponentPool<CompCamera>* cameras = nullptr;
+	ComponentPool<CompScript>* scripts = nullptr;
+};
+
+template<typename TYPE>
+inline ComponentPool<TYPE>::ComponentPool()
+{
+}
+
+// Only the memory is released, components still alive aren't destroyed (same as before the pools)
+template<typename TYPE>
+inline ComponentPool<TYPE>::~ComponentPool()
+{
+	for (uint i = 0; i < chunks.size(); i++)
+	{
+		delete chunks[i];
+	}
+	chunks.clear();
+}
+
+template<typename TYPE>
+template<typename... ARGS>
+inline TYPE* ComponentPool<TYPE>::Create(ARGS&&... args)
+{
+	if (free_slots.size() == 0)
+	{
+		Chunk* chunk = new Chunk;
+		int first = chunks.size() * COMPONENT_POOL_CHUNK;
+		for (int i = COMPONENT_POOL_CHUNK - 1; i >= 0; i--)
+		{
+			chunk->alive[i] = false;
+			free_slots.push_back(first + i);
+		}
+		chunks.push_back(chunk);
+	}
+
+	int handle = free_slots.back();
+	free_slots.pop_back();
+
+	Chunk* chunk = chunks[handle / COMPONENT_POOL_CHUNK];
+	int slot = handle % COMPONENT_POOL_CHUNK;
+	TYPE* component = new (&chunk->slots[slot]) TYPE(std::forward<ARGS>(args)...);
+	chunk->alive[slot] = true;
+	component->pool_handle = handle;
+	num_alive++;
+	return component;
+}
+
+template<typename TYPE>
+inline void ComponentPool<TYPE>::Release(TYPE* component)
+{
+	int handle = component->pool_handle;
+	if (Get(handle) != component)
+	{
+		return;
+	}
+
+	component->~TYPE();
+	chunks[handle / COMPONENT_POOL_CHUNK]->alive[handle % COMPONENT_POOL_CHUNK] = false;
+	free_slots.push_back(handle);
+	num_alive--;
+}
+
+template<typename TYPE>
+inline TYPE* ComponentPool<TYPE>::Get(int handle) const
+{
+	if (handle < 0 || handle >= (int)(chunks.size() * COMPONENT_POOL_CHUNK))
+	{
+		return nullptr;
+	}
+
+	Chunk* chunk = chunks[handle / COMPONENT_POOL_CHUNK];
+	int slot = handle % COMPONENT_POOL_CHUNK;
+	if (chunk->alive[slot] == false)
+	{
+		return nullptr;
+	}
+	return (TYPE*)&chunk->slots[slot];
+}
+
+template<typename TYPE>
+inline uint ComponentPool<TYPE>::Size() const
+{
+	return num_alive;
+}
+
+template<typename TYPE>
+inline uint ComponentPool<TYPE>::Capacity() const
+{
+	return chunks.size() * COMPONENT_POOL_CHUNK;
+}
+
+template<typename TYPE>
+inline uint ComponentPool<TYPE>::GetMemory() const
+{
+	return chunks.size() * sizeof(Chunk) + chunks.capacity() * sizeof(Chunk*) + free_slots.capacity() * sizeof(int);
+}
+
+template<typename TYPE>
+template<typename FUNCTION>
+inline void ComponentPool<TYPE>::ForEach(FUNCTION function) const
+{
+	for (uint c = 0; c < chunks.size(); c++)
+	{
+		Chunk* chunk = chunks[c];
+		for (uint i = 0; i < COMPONENT_POOL_CHUNK; i++)
+		{
+			if (chunk->alive[i])
+			{
+				function((TYPE*)&chunk->slots[i]);
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,107 @@
+#include "CpuFeatures.h"
+#include "MathGeoLib.h"
+#include <string.h>
+#include <intrin.h>
+
+static void DetectCpuFeatures(CpuFeatures& features)
+{
+	int info[4] = { 0 };
+	memset(features.brand, 0, sizeof(features.brand));
+
+	__cpuid(info, 0);
+	int num_ids = info[0];
+
+	if (num_ids >= 1)
+	{
+		__cpuid(info, 1);
+		features.sse = (info[3] & (1 << 25)) != 0;
+		features.sse2 = (info[3] & (1 << 26)) != 0;
+		features.sse3 = (info[2] & (1 << 0)) != 0;
+		features.ssse3 = (info[2] & (1 << 9)) != 0;
+		features.sse41 = (info[2] & (1 << 19)) != 0;
+		features.sse42 = (info[2] & (1 << 20)) != 0;
+		features.fma = (info[2] & (1 << 12)) != 0;
+
+		// YMM registers have to be saved by the OS on context switches
+		bool os_xsave = (info[2] & (1 << 27)) != 0;
+		bool cpu_avx = (info[2] & (1 << 28)) != 0;
+		if (os_xsave && cpu_avx)
+		{
+			features.avx = (_xgetbv(0) & 0x6) == 0x6;
+		}
+		features.fma = features.fma && features.avx;
+	}
+
+	if (num_ids >= 7 && features.avx)
+	{
+		__cpuidex(info, 7, 0);
+		features.avx2 = (info[1] & (1 << 5)) != 0;
+	}
+
+	// Brand string (3 extended leafs of 16 chars)
+	__cpuid(info, 0x80000000);
+	if ((unsigned)info[0] >= 0x80000004)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			__cpuid(info, 0x80000002 + i);
+			memcpy(features.brand + i * 16, info, 16);
+		}
+	}
+}
+
+const CpuFeatures& GetCpuFeatures()
+{
+	static CpuFeatures features;
+	static bool detected = false;
+	if (detected == false)
+	{
+		DetectCpuFeatures(features);
+		detected = true;
+	}
+	return features;
+}
+
+const char* GetBuildSIMDLevel()
+{
+#if defined(MATH_AVX)
+	return "AVX";
+#elif defined(MATH_SSE41)
+	return "SSE4.1";
+#elif defined(MATH_SSE2)
+	return "SSE2";
+#elif defined(MATH_SSE)
+	return "SSE";
+#else
+	return "None (scalar)";
+#endif
+}
+
+bool CheckBuildSIMDSupport()
+{
+	const CpuFeatures& cpu = GetCpuFeatures();
+	bool ret = true;
+
+#if defined(MATH_AVX)
+	ret = cpu.avx;
+#elif defined(MATH_SSE41)
+	ret = cpu.sse41;
+#elif defined(MATH_SSE2)
+	ret = cpu.sse2;
+#elif defined(MATH_SSE)
+	ret = cpu.sse;
+#endif
+
+	return ret;
+}
+
+void LogCpuFeatures()
+{
+	const CpuFeatures& cpu = GetCpuFeatures();
+	LOG("CPU: %s", cpu.brand);
+	LOG("CPU SIMD: SSE %s, SSE2 %s, SSE3 %s, SSSE3 %s, SSE4.1 %s, SSE4.2 %s, AVX %s, AVX2 %s, FMA %s",
+		cpu.sse ? "yes" : "no", cpu.sse2 ? "yes" : "no", cpu.sse3 ? "yes" : "no",
+		cpu.ssse3 ? "yes" : "no", cpu.sse41 ? "yes" : "no", cpu.sse42 ? "yes" : "no",
+		cpu.avx ? "yes" : "no", cpu.avx2 ? "yes" : "no", cpu.fma ? "yes" : "no");
+	LOG("Math library SIMD level: %s", GetBuildSIMDLevel());
+}
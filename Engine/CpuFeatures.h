@@ -0,0 +1,33 @@
+#ifndef _CPU_FEATURES_
+#define _CPU_FEATURES_
+
+#include "Globals.h"
+
+// Instruction sets of the CPU (CPUID) ----------------------
+// AVX also needs the OS support (OSXSAVE & XCR0), otherwise it's reported as false.
+struct CpuFeatures
+{
+	bool sse = false;
+	bool sse2 = false;
+	bool sse3 = false;
+	bool ssse3 = false;
+	bool sse41 = false;
+	bool sse42 = false;
+	bool avx = false;
+	bool avx2 = false;
+	bool fma = false;
+	char brand[49];
+};
+
+// Detected once, the first time it's called
+const CpuFeatures& GetCpuFeatures();
+
+// SIMD level MathGeoLib has been compiled with (MATH_SSE2/MATH_SSE41/MATH_AVX)
+const char* GetBuildSIMDLevel();
+
+// False if this build uses instructions the CPU doesn't have (the engine can't run)
+bool CheckBuildSIMDSupport();
+
+void LogCpuFeatures();
+
+#endif
@@ -0,0 +1,437 @@
+#include "FrameStats.h"
+#include "JSONWriter.h"
+#include "ImGui/imgui.h"
+#include "SDL/include/SDL_timer.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#define FRAME_STATS_MIN_FRAMES 30		/* Before detecting hitches */
+#define FRAME_STATS_HITCH_ZONES 8		/* Slowest zones shown of each hitch */
+
+static const char* series_names[FRAME_SERIES_MAX] = { "Frame", "Interval", "PreUpdate", "Update", "PostUpdate" };
+
+static double TicksToMs(uint64 ticks)
+{
+	static const double frequency = (double)SDL_GetPerformanceFrequency();
+	return 1000.0 * (double)ticks / frequency;
+}
+
+// HISTOGRAM -----------------------------------------
+FrameHistogram::FrameHistogram()
+{
+	Clear();
+}
+
+void FrameHistogram::Clear()
+{
+	memset(buckets, 0, sizeof(buckets));
+	count = 0;
+	total = 0.0;
+	max = 0.0;
+}
+
+// Values under 2^(SUB_BITS + 1) are exact, then the SUB_BITS bits under the highest one
+uint FrameHistogram::GetBucket(uint us)
+{
+	uint high = 0;
+	for (uint value = us; value > 1; value >>= 1)
+	{
+		high++;
+	}
+	if (high <= FRAME_HISTOGRAM_SUB_BITS)
+	{
+		return us;
+	}
+	uint shift = high - FRAME_HISTOGRAM_SUB_BITS;
+	return (shift << FRAME_HISTOGRAM_SUB_BITS) + (us >> shift);
+}
+
+double FrameHistogram::GetBucketMs(uint bucket)
+{
+	const uint sub_buckets = 1 << FRAME_HISTOGRAM_SUB_BITS;
+	if (bucket < 2 * sub_buckets)
+	{
+		return bucket / 1000.0;
+	}
+	uint shift = (bucket >> FRAME_HISTOGRAM_SUB_BITS) - 1;
+	uint64 sub = (bucket & (sub_buckets - 1)) + sub_buckets;
+	return (double)(((sub + 1) << shift) - 1) / 1000.0;
+}
+
+void FrameHistogram::Record(double ms)
+{
+	double us = ms * 1000.0;
+	us = (us < 0.0) ? 0.0 : (us > 4294967295.0) ? 4294967295.0 : us;
+	buckets[GetBucket((uint)us)]++;
+	count++;
+	total += ms;
+	max = (ms > max) ? ms : max;
+}
+
+void FrameHistogram::Add(const FrameHistogram& other)
+{
+	for (uint i = 0; i < FRAME_HISTOGRAM_BUCKETS; i++)
+	{
+		buckets[i] += other.buckets[i];
+	}
+	count += other.count;
+	total += other.total;
+	max = (other.max > max) ? other.max : max;
+}
+
+double FrameHistogram::Percentile(double percent) const
+{
+	if (count == 0)
+	{
+		return 0.0;
+	}
+
+	// Smallest bucket with 'percent' of the values in it or before
+	uint target = (uint)ceil(percent / 100.0 * count);
+	target = (target < 1) ? 1 : target;
+	uint accumulated = 0;
+	for (uint i = 0; i < FRAME_HISTOGRAM_BUCKETS; i++)
+	{
+		accumulated += buckets[i];
+		if (accumulated >= target)
+		{
+			double ms = GetBucketMs(i);
+			return (ms > max) ? max : ms;
+		}
+	}
+	return max;
+}
+
+double FrameHistogram::GetMean() const
+{
+	return (count > 0) ? total / count : 0.0;
+}
+
+double FrameHistogram::GetMax() const
+{
+	return max;
+}
+
+uint FrameHistogram::GetCount() const
+{
+	return count;
+}
+
+uint FrameHistogram::GetBucketCount(uint bucket) const
+{
+	return buckets[bucket];
+}
+
+// FRAME STATS ---------------------------------------
+FrameStats::FrameStats()
+{
+	Reset();
+}
+
+FrameStats::~FrameStats()
+{
+}
+
+void FrameStats::BeginFrame()
+{
+	// Interval of the previous frame (with the fps cap / vsync)
+	if (frame_count > 0)
+	{
+		SetPhase(FRAME_SERIES_INTERVAL, interval_timer.ReadMs());
+	}
+	interval_timer.Start();
+	frame_timer.Start();
+}
+
+void FrameStats::SetPhase(FrameSeries series, double ms)
+{
+	last[series] = ms;
+	windows[window][series].Record(ms);
+	sliding[series].Record(ms);
+	session[series].Record(ms);
+}
+
+void FrameStats::EndFrame(const Profiler& profiler)
+{
+	CheckHitch(profiler);
+	SetPhase(FRAME_SERIES_FRAME, frame_timer.ReadMs());
+	frame_count++;
+
+	if (window_timer.ReadMs() >= FRAME_STATS_WINDOW_MS)
+	{
+		NextWindow();
+	}
+}
+
+// The oldest window leaves the sliding window
+void FrameStats::NextWindow()
+{
+	window_timer.Start();
+	window = (window + 1) % FRAME_STATS_WINDOWS;
+	for (uint s = 0; s < FRAME_SERIES_MAX; s++)
+	{
+		windows[window][s].Clear();
+		sliding[s].Clear();
+		for (uint w = 0; w < FRAME_STATS_WINDOWS; w++)
+		{
+			sliding[s].Add(windows[w][s]);
+		}
+	}
+}
+
+void FrameStats::CheckHitch(const Profiler& profiler)
+{
+	const FrameHistogram& frames = sliding[FRAME_SERIES_FRAME];
+	if (frames.GetCount() < FRAME_STATS_MIN_FRAMES)
+	{
+		return;
+	}
+
+	double ms = frame_timer.ReadMs();
+	double median = frames.Percentile(50.0);
+	if (ms < median * hitch_factor || ms < hitch_min_ms)
+	{
+		return;
+	}
+
+	if (hitches.size() == FRAME_STATS_HITCHES)
+	{
+		hitches.erase(hitches.begin());
+	}
+	FrameHitch hitch;
+	hitch.frame = frame_count;
+	hitch.time = (float)(start_timer.ReadMs() / 1000.0);
+	hitch.ms = ms;
+	hitch.median = median;
+	if (profiler.IsPaused() == false)
+	{
+		hitch.zones = profiler.GetLastFrame();
+	}
+	hitches.push_back(hitch);
+	num_hitches++;
+}
+
+double FrameStats::ReadFrameMs() const
+{
+	return frame_timer.ReadMs();
+}
+
+double FrameStats::GetLast(FrameSeries series) const
+{
+	return last[series];
+}
+
+const FrameHistogram& FrameStats::GetWindow(FrameSeries series) const
+{
+	return sliding[series];
+}
+
+const FrameHistogram& FrameStats::GetSession(FrameSeries series) const
+{
+	return session[series];
+}
+
+uint FrameStats::GetMemory() const
+{
+	uint memory = sizeof(FrameStats) + hitches.capacity() * sizeof(FrameHitch);
+	for (uint i = 0; i < hitches.size(); i++)
+	{
+		memory += hitches[i].zones.capacity() * sizeof(ProfilerEvent);
+	}
+	return memory;
+}
+
+void FrameStats::Reset()
+{
+	for (uint s = 0; s < FRAME_SERIES_MAX; s++)
+	{
+		for (uint w = 0; w < FRAME_STATS_WINDOWS; w++)
+		{
+			windows[w][s].Clear();
+		}
+		sliding[s].Clear();
+		session[s].Clear();
+		last[s] = 0.0;
+	}
+	window = 0;
+	frame_count = 0;
+	hitches.clear();
+	num_hitches = 0;
+	window_timer.Start();
+	interval_timer.Start();
+	start_timer.Start();
+}
+
+static void WriteHistogram(JSONWriter& writer, const char* name, const FrameHistogram& histogram, bool buckets)
+{
+	writer.BeginObject(name);
+	writer.Number("count", histogram.GetCount());
+	writer.Number("mean", histogram.GetMean());
+	writer.Number("p50", histogram.Percentile(50.0));
+	writer.Number("p95", histogram.Percentile(95.0));
+	writer.Number("p99", histogram.Percentile(99.0));
+	writer.Number("p999", histogram.Percentile(99.9));
+	writer.Number("max", histogram.GetMax());
+
+	// Only the buckets with values (top of the bucket in ms, frames)
+	if (buckets)
+	{
+		writer.BeginArray("bucket_ms");
+		for (uint i = 0; i < FRAME_HISTOGRAM_BUCKETS; i++)
+		{
+			if (histogram.GetBucketCount(i) > 0)
+			{
+				writer.Number(FrameHistogram::GetBucketMs(i));
+			}
+		}
+		writer.EndArray();
+		writer.BeginArray("bucket_count");
+		for (uint i = 0; i < FRAME_HISTOGRAM_BUCKETS; i++)
+		{
+			if (histogram.GetBucketCount(i) > 0)
+			{
+				writer.Number(histogram.GetBucketCount(i));
+			}
+		}
+		writer.EndArray();
+	}
+	writer.EndObject();
+}
+
+// Times in ms: sliding window & session of each series, and the hitches with their zones
+bool FrameStats::Export(const char* file) const
+{
+	JSONWriter writer;
+	writer.BeginObject();
+	writer.Number("frames", (double)frame_count);
+	writer.Number("hitch_factor", hitch_factor);
+	writer.Number("hitch_min_ms", hitch_min_ms);
+
+	writer.BeginArray("series");
+	for (uint s = 0; s < FRAME_SERIES_MAX; s++)
+	{
+		writer.BeginObject();
+		writer.String("name", series_names[s]);
+		WriteHistogram(writer, "window", sliding[s], false);
+		WriteHistogram(writer, "session", session[s], true);
+		writer.EndObject();
+	}
+	writer.EndArray();
+
+	writer.BeginArray("hitches");
+	for (uint i = 0; i < hitches.size(); i++)
+	{
+		const FrameHitch& hitch = hitches[i];
+		uint64 begin = (hitch.zones.size() > 0) ? hitch.zones[0].begin : 0;
+		for (uint z = 0; z < hitch.zones.size(); z++)
+		{
+			begin = (hitch.zones[z].begin < begin) ? hitch.zones[z].begin : begin;
+		}
+
+		writer.BeginObject();
+		writer.Number("frame", (double)hitch.frame);
+		writer.Number("time", hitch.time);
+		writer.Number("ms", hitch.ms);
+		writer.Number("median", hitch.median);
+		writer.BeginArray("zones");
+		for (uint z = 0; z < hitch.zones.size(); z++)
+		{
+			const ProfilerEvent& zone = hitch.zones[z];
+			writer.BeginObject();
+			writer.String("name", zone.name);
+			writer.Number("thread", zone.thread);
+			writer.Number("depth", zone.depth);
+			writer.Number("begin", TicksToMs(zone.begin - begin));
+			writer.Number("ms", TicksToMs(zone.end - zone.begin));
+			writer.EndObject();
+		}
+		writer.EndArray();
+		writer.EndObject();
+	}
+	writer.EndArray();
+	writer.EndObject();
+
+	return writer.SaveFile(file);
+}
+
+void FrameStats::ShowPerformance()
+{
+	if (ImGui::TreeNodeEx("FRAME TIMES"))
+	{
+		ImGui::Checkbox("Session", &show_session);
+		ImGui::SameLine();
+		if (ImGui::Button("RESET"))
+		{
+			Reset();
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("EXPORT"))
+		{
+			if (Export(FRAME_STATS_FILE))
+			{
+				LOG("Frame stats saved to %s", FRAME_STATS_FILE);
+			}
+		}
+
+		// Percentiles of each series (ms) ------------
+		ImGui::Columns(6, "frame_times");
+		ImGui::Text(show_session ? "Session" : "Last %is", FRAME_STATS_WINDOWS); ImGui::NextColumn();
+		ImGui::Text("p50"); ImGui::NextColumn();
+		ImGui::Text("p95"); ImGui::NextColumn();
+		ImGui::Text("p99"); ImGui::NextColumn();
+		ImGui::Text("max"); ImGui::NextColumn();
+		ImGui::Text("last"); ImGui::NextColumn();
+		ImGui::Separator();
+		for (uint s = 0; s < FRAME_SERIES_MAX; s++)
+		{
+			const FrameHistogram& histogram = show_session ? session[s] : sliding[s];
+			ImGui::Text("%s", series_names[s]); ImGui::NextColumn();
+			ImGui::Text("%.3f", histogram.Percentile(50.0)); ImGui::NextColumn();
+			ImGui::Text("%.3f", histogram.Percentile(95.0)); ImGui::NextColumn();
+			ImGui::Text("%.3f", histogram.Percentile(99.0)); ImGui::NextColumn();
+			ImGui::Text("%.3f", histogram.GetMax()); ImGui::NextColumn();
+			ImGui::Text("%.3f", last[s]); ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+		ImGui::Separator();
+
+		// Hitches ------------------------------------
+		ImGui::PushItemWidth(120);
+		ImGui::SliderFloat("x median", &hitch_factor, 1.2f, 10.0f, "%.1f");
+		ImGui::SameLine();
+		ImGui::SliderFloat("min ms", &hitch_min_ms, 1.0f, 200.0f, "%.1f");
+		ImGui::PopItemWidth();
+		ImGui::Text("Hitches: %i", num_hitches);
+
+		for (int i = hitches.size() - 1; i >= 0; i--)
+		{
+			const FrameHitch& hitch = hitches[i];
+			ImGui::PushID(i);
+			if (ImGui::TreeNode("hitch", "Frame %llu (%.1f s): %.3f ms (median %.3f ms)", hitch.frame, hitch.time, hitch.ms, hitch.median))
+			{
+				// Slowest zones of that frame
+				std::vector<const ProfilerEvent*> zones;
+				for (uint z = 0; z < hitch.zones.size(); z++)
+				{
+					zones.push_back(&hitch.zones[z]);
+				}
+				std::sort(zones.begin(), zones.end(), [](const ProfilerEvent* a, const ProfilerEvent* b)
+				{
+					return (a->end - a->begin) > (b->end - b->begin);
+				});
+				for (uint z = 0; z < zones.size() && z < FRAME_STATS_HITCH_ZONES; z++)
+				{
+					ImGui::BulletText("%s: %.3f ms (thread %i)", zones[z]->name, TicksToMs(zones[z]->end - zones[z]->begin), zones[z]->thread);
+				}
+				if (zones.size() == 0)
+				{
+					ImGui::Text("No zones (profiler paused)");
+				}
+				ImGui::TreePop();
+			}
+			ImGui::PopID();
+		}
+		ImGui::TreePop();
+	}
+}
@@ -0,0 +1,119 @@
+#ifndef _FRAME_STATS_
+#define _FRAME_STATS_
+
+#include "Globals.h"
+#include "PerfTimer.h"
+#include "Profiler.h"
+#include <vector>
+
+// Buckets of 1 us up to 64 us, then 32 buckets for each power of 2 (error < 3.2%)
+#define FRAME_HISTOGRAM_SUB_BITS 5
+#define FRAME_HISTOGRAM_BUCKETS ((32 - FRAME_HISTOGRAM_SUB_BITS + 1) << FRAME_HISTOGRAM_SUB_BITS)
+
+#define FRAME_STATS_WINDOW_MS 1000.0	/* Length of each window */
+#define FRAME_STATS_WINDOWS 10			/* Sliding window: the last 10 s */
+#define FRAME_STATS_HITCHES 16			/* Last hitches kept with their zones */
+#define FRAME_STATS_FILE "frame_stats.json"
+
+enum FrameSeries
+{
+	FRAME_SERIES_FRAME = 0,		/* Work of the frame (without the fps cap) */
+	FRAME_SERIES_INTERVAL,		/* Time between frames (what the user sees) */
+	FRAME_SERIES_PREUPDATE,
+	FRAME_SERIES_UPDATE,
+	FRAME_SERIES_POSTUPDATE,
+	FRAME_SERIES_MAX
+};
+
+// HDR style histogram: fixed relative precision from 1 us to 70 min,
+// recording is O(1) and histograms of different windows can be added.
+class FrameHistogram
+{
+public:
+	FrameHistogram();
+
+	void Clear();
+	void Record(double ms);
+	void Add(const FrameHistogram& other);
+
+	double Percentile(double percent) const; /* ms, top of the bucket (never more than the max) */
+	double GetMean() const;
+	double GetMax() const;
+	uint GetCount() const;
+
+	uint GetBucketCount(uint bucket) const;
+	static double GetBucketMs(uint bucket); /* Top of the bucket */
+
+private:
+	static uint GetBucket(uint us);
+
+private:
+	uint buckets[FRAME_HISTOGRAM_BUCKETS];
+	uint count = 0;
+	double total = 0.0;
+	double max = 0.0;
+};
+
+// Frame over the limit with the zones of the profiler of that frame
+struct FrameHitch
+{
+	uint64 frame = 0;
+	float time = 0.0f;			/* Seconds since start */
+	double ms = 0.0;
+	double median = 0.0;		/* Of the sliding window when it happened */
+	std::vector<ProfilerEvent> zones;
+};
+
+// Frame Stats ----------------------------------------
+// High resolution frame & phase times in histograms: one per window of
+// FRAME_STATS_WINDOW_MS, the last FRAME_STATS_WINDOWS added as the sliding
+// window and one for the whole session. A frame slower than hitch_factor x the
+// median of the window (and hitch_min_ms) is a hitch, the profiler zones of that
+// frame are kept to see what caused it.
+class FrameStats
+{
+public:
+	FrameStats();
+	~FrameStats();
+
+	void BeginFrame();
+	void SetPhase(FrameSeries series, double ms);
+	void EndFrame(const Profiler& profiler); /* After Profiler::EndFrame (zones of this frame) */
+
+	double ReadFrameMs() const;		/* Since BeginFrame */
+	double GetLast(FrameSeries series) const;
+	const FrameHistogram& GetWindow(FrameSeries series) const;
+	const FrameHistogram& GetSession(FrameSeries series) const;
+
+	void Reset();
+	bool Export(const char* file) const;
+	uint GetMemory() const;
+	void ShowPerformance();
+
+private:
+	void NextWindow();
+	void CheckHitch(const Profiler& profiler);
+
+public:
+	float hitch_factor = 2.0f;
+	float hitch_min_ms = 20.0f;
+
+private:
+	FrameHistogram windows[FRAME_STATS_WINDOWS][FRAME_SERIES_MAX];
+	FrameHistogram sliding[FRAME_SERIES_MAX];
+	FrameHistogram session[FRAME_SERIES_MAX];
+	double last[FRAME_SERIES_MAX];
+	uint window = 0;
+
+	PerfTimer frame_timer;
+	PerfTimer interval_timer;
+	PerfTimer window_timer;
+	PerfTimer start_timer;
+	uint64 frame_count = 0;
+
+	std::vector<FrameHitch> hitches;	/* Oldest first */
+	uint num_hitches = 0;
+	bool show_session = false;
+};
+
+#endif
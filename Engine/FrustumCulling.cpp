@@ -0,0 +1,355 @@
+#include "FrustumCulling.h"
+#include "Application.h"
+#include "CompCamera.h"
+#include "PerfTimer.h"
+#include "JobSystem.h"
+#include <string.h>
+
+#ifdef CULLING_SSE
+#include <xmmintrin.h>
+#endif
+#ifdef CULLING_AVX
+#include <immintrin.h>
+#endif
+
+// CULL PLANES ---------------------------------------
+void CullPlanes::Set(const Frustum& frustum)
+{
+	Plane planes[CULL_PLANES];
+	frustum.GetPlanes(planes);
+
+	for (uint p = 0; p < CULL_PLANES; p++)
+	{
+		nx[p] = planes[p].normal.x;
+		ny[p] = planes[p].normal.y;
+		nz[p] = planes[p].normal.z;
+		d[p] = planes[p].d;
+		ax[p] = Abs(nx[p]);
+		ay[p] = Abs(ny[p]);
+		az[p] = Abs(nz[p]);
+	}
+}
+// ---------------------------------------------------
+
+// CULLING KERNELS -----------------------------------
+static inline bool IsOutside(const CullPlanes& planes, uint p, float cx, float cy, float cz, float ex, float ey, float ez)
+{
+	float dist = planes.nx[p] * cx + planes.ny[p] * cy + planes.nz[p] * cz - planes.d[p];
+	float radius = planes.ax[p] * ex + planes.ay[p] * ey + planes.az[p] * ez;
+	return dist > radius;
+}
+
+static void CullScalar(const CullPlanes& planes, const float* cx, const float* cy, const float* cz,
+	const float* ex, const float* ey, const float* ez, uchar* hints, uint first, uint count, uint32* visible)
+{
+	for (uint i = first; i < count; i++)
+	{
+		// Plane that rejected it last time first
+		bool outside = IsOutside(planes, hints[i], cx[i], cy[i], cz[i], ex[i], ey[i], ez[i]);
+
+		for (uint p = 0; p < CULL_PLANES && !outside; p++)
+		{
+			if (p != hints[i] && IsOutside(planes, p, cx[i], cy[i], cz[i], ex[i], ey[i], ez[i]))
+			{
+				outside = true;
+				hints[i] = p;
+			}
+		}
+
+		if (!outside)
+		{
+			visible[i >> 5] |= 1u << (i & 31);
+		}
+	}
+}
+
+#ifdef CULLING_SSE
+#define GATHER_SSE(arr) _mm_setr_ps(arr[h[0]], arr[h[1]], arr[h[2]], arr[h[3]])
+
+static inline __m128 OutsideSSE(__m128 nx, __m128 ny, __m128 nz, __m128 d, __m128 ax, __m128 ay, __m128 az,
+	__m128 cx, __m128 cy, __m128 cz, __m128 ex, __m128 ey, __m128 ez)
+{
+	__m128 dist = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_mul_ps(nz, cz)), d);
+	__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, ex), _mm_mul_ps(ay, ey)), _mm_mul_ps(az, ez));
+	return _mm_cmpgt_ps(dist, radius);
+}
+
+// 4 boxes per iteration, returns the number of boxes processed
+static uint CullSSE(const CullPlanes& planes, const float* cx, const float* cy, const float* cz,
+	const float* ex, const float* ey, const float* ez, uchar* hints, uint count, uint32* visible)
+{
+	uint i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 c_x = _mm_loadu_ps(cx + i);
+		__m128 c_y = _mm_loadu_ps(cy + i);
+		__m128 c_z = _mm_loadu_ps(cz + i);
+		__m128 e_x = _mm_loadu_ps(ex + i);
+		__m128 e_y = _mm_loadu_ps(ey + i);
+		__m128 e_z = _mm_loadu_ps(ez + i);
+
+		// Plane coherency: each box against the plane that rejected it last time
+		const uchar* h = hints + i;
+		int out_mask = _mm_movemask_ps(OutsideSSE(GATHER_SSE(planes.nx), GATHER_SSE(planes.ny), GATHER_SSE(planes.nz), GATHER_SSE(planes.d),
+			GATHER_SSE(planes.ax), GATHER_SSE(planes.ay), GATHER_SSE(planes.az), c_x, c_y, c_z, e_x, e_y, e_z));
+
+		// Test all planes until all 4 boxes are out
+		for (uint p = 0; p < CULL_PLANES && out_mask != 0xF; p++)
+		{
+			int plane_mask = _mm_movemask_ps(OutsideSSE(_mm_set1_ps(planes.nx[p]), _mm_set1_ps(planes.ny[p]), _mm_set1_ps(planes.nz[p]), _mm_set1_ps(planes.d[p]),
+				_mm_set1_ps(planes.ax[p]), _mm_set1_ps(planes.ay[p]), _mm_set1_ps(planes.az[p]), c_x, c_y, c_z, e_x, e_y, e_z)) & ~out_mask;
+
+			if (plane_mask != 0)
+			{
+				for (uint lane = 0; lane < 4; lane++)
+				{
+					if (plane_mask & (1 << lane))
+					{
+						hints[i + lane] = p;
+					}
+				}
+				out_mask |= plane_mask;
+			}
+		}
+
+		visible[i >> 5] |= (uint32)(~out_mask & 0xF) << (i & 31);
+	}
+	return i;
+}
+#endif
+
+#ifdef CULLING_AVX
+#define GATHER_AVX(arr) _mm256_setr_ps(arr[h[0]], arr[h[1]], arr[h[2]], arr[h[3]], arr[h[4]], arr[h[5]], arr[h[6]], arr[h[7]])
+
+static inline __m256 OutsideAVX(__m256 nx, __m256 ny, __m256 nz, __m256 d, __m256 ax, __m256 ay, __m256 az,
+	__m256 cx, __m256 cy, __m256 cz, __m256 ex, __m256 ey, __m256 ez)
+{
+	__m256 dist = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, cx), _mm256_mul_ps(ny, cy)), _mm256_mul_ps(nz, cz)), d);
+	__m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax, ex), _mm256_mul_ps(ay, ey)), _mm256_mul_ps(az, ez));
+	return _mm256_cmp_ps(dist, radius, _CMP_GT_OQ);
+}
+
+// 8 boxes per iteration, returns the number of boxes processed
+static uint CullAVX(const CullPlanes& planes, const float* cx, const float* cy, const float* cz,
+	const float* ex, const float* ey, const float* ez, uchar* hints, uint count, uint32* visible)
+{
+	uint i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 c_x = _mm256_loadu_ps(cx + i);
+		__m256 c_y = _mm256_loadu_ps(cy + i);
+		__m256 c_z = _mm256_loadu_ps(cz + i);
+		__m256 e_x = _mm256_loadu_ps(ex + i);
+		__m256 e_y = _mm256_loadu_ps(ey + i);
+		__m256 e_z = _mm256_loadu_ps(ez + i);
+
+		// Plane coherency: each box against the plane that rejected it last time
+		const uchar* h = hints + i;
+		int out_mask = _mm256_movemask_ps(OutsideAVX(GATHER_AVX(planes.nx), GATHER_AVX(planes.ny), GATHER_AVX(planes.nz), GATHER_AVX(planes.d),
+			GATHER_AVX(planes.ax), GATHER_AVX(planes.ay), GATHER_AVX(planes.az), c_x, c_y, c_z, e_x, e_y, e_z));
+
+		// Test all planes until all 8 boxes are out
+		for (uint p = 0; p < CULL_PLANES && out_mask != 0xFF; p++)
+		{
+			int plane_mask = _mm256_movemask_ps(OutsideAVX(_mm256_set1_ps(planes.nx[p]), _mm256_set1_ps(planes.ny[p]), _mm256_set1_ps(planes.nz[p]), _mm256_set1_ps(planes.d[p]),
+				_mm256_set1_ps(planes.ax[p]), _mm256_set1_ps(planes.ay[p]), _mm256_set1_ps(planes.az[p]), c_x, c_y, c_z, e_x, e_y, e_z)) & ~out_mask;
+
+			if (plane_mask != 0)
+			{
+				for (uint lane = 0; lane < 8; lane++)
+				{
+					if (plane_mask & (1 << lane))
+					{
+						hints[i + lane] = p;
+					}
+				}
+				out_mask |= plane_mask;
+			}
+		}
+
+		visible[i >> 5] |= (uint32)(~out_mask & 0xFF) << (i & 31);
+	}
+	return i;
+}
+#endif
+
+void CullAABBs(const CullPlanes& planes, const float* cx, const float* cy, const float* cz,
+	const float* ex, const float* ey, const float* ez, uchar* hints, uint count, uint32* visible)
+{
+	memset(visible, 0, ((count + 31) >> 5) * sizeof(uint32));
+
+	uint done = 0;
+#if defined(CULLING_AVX)
+	done = CullAVX(planes, cx, cy, cz, ex, ey, ez, hints, count, visible);
+#elif defined(CULLING_SSE)
+	done = CullSSE(planes, cx, cy, cz, ex, ey, ez, hints, count, visible);
+#endif
+
+	// Remaining boxes (or all of them without SIMD)
+	CullScalar(planes, cx, cy, cz, ex, ey, ez, hints, done, count, visible);
+}
+// ---------------------------------------------------
+
+// CULL BATCH ----------------------------------------
+CullBatch::CullBatch()
+{
+}
+
+CullBatch::~CullBatch()
+{
+}
+
+void CullBatch::Clear()
+{
+	cx.clear(); cy.clear(); cz.clear();
+	ex.clear(); ey.clear(); ez.clear();
+	hints.clear();
+	visible.clear();
+	num_visible = 0;
+}
+
+void CullBatch::Reserve(uint size)
+{
+	cx.reserve(size); cy.reserve(size); cz.reserve(size);
+	ex.reserve(size); ey.reserve(size); ez.reserve(size);
+	hints.reserve(size);
+}
+
+void CullBatch::Add(const AABB& box, uchar hint)
+{
+	float3 center = box.CenterPoint();
+	float3 half = box.HalfSize();
+
+	cx.push_back(center.x); cy.push_back(center.y); cz.push_back(center.z);
+	ex.push_back(half.x); ey.push_back(half.y); ez.push_back(half.z);
+	hints.push_back(hint < CULL_PLANES ? hint : 0);
+}
+
+uint CullBatch::Size() const
+{
+	return cx.size();
+}
+
+void CullBatch::Cull(const CullPlanes& planes, JobSystem* jobs)
+{
+	uint count = cx.size();
+	visible.resize((count + 31) >> 5);
+	num_visible = 0;
+
+	if (count == 0)
+	{
+		return;
+	}
+
+	if (jobs == nullptr)
+	{
+		CullAABBs(planes, &cx[0], &cy[0], &cz[0], &ex[0], &ey[0], &ez[0], &hints[0], count, &visible[0]);
+	}
+	else
+	{
+		// Ranges start at a multiple of 32, so each job writes its own words of the bitmask
+		jobs->ParallelFor("Culling", count, CULL_JOB_GRAIN, [this, &planes](uint begin, uint end)
+		{
+			CullAABBs(planes, &cx[begin], &cy[begin], &cz[begin], &ex[begin], &ey[begin], &ez[begin], &hints[begin], end - begin, &visible[begin >> 5]);
+		});
+	}
+
+	// Count bits set
+	for (uint i = 0; i < visible.size(); i++)
+	{
+		uint32 bits = visible[i];
+		bits = bits - ((bits >> 1) & 0x55555555);
+		bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+		num_visible += (((bits + (bits >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+	}
+}
+
+bool CullBatch::IsVisible(uint index) const
+{
+	return (visible[index >> 5] & (1u << (index & 31))) != 0;
+}
+
+uint CullBatch::GetNumVisible() const
+{
+	return num_visible;
+}
+// ---------------------------------------------------
+
+// BENCHMARK -----------------------------------------
+bool CullingBenchmark(uint num_boxes, uint iterations)
+{
+	if (num_boxes == 0 || iterations == 0)
+	{
+		return false;
+	}
+
+	// Default camera looking to +Z
+	CompCamera camera(C_CAMERA, nullptr);
+	camera.frustum.pos.Set(0.0f, 0.0f, 0.0f);
+
+	std::vector<AABB> boxes;
+	boxes.reserve(num_boxes);
+	for (uint i = 0; i < num_boxes; i++)
+	{
+		float3 center(App->random->Float(-500.0f, 500.0f), App->random->Float(-50.0f, 50.0f), App->random->Float(-500.0f, 500.0f));
+		float3 size(App->random->Float(0.5f, 5.0f), App->random->Float(0.5f, 5.0f), App->random->Float(0.5f, 5.0f));
+		AABB box;
+		box.SetFromCenterAndSize(center, size);
+		boxes.push_back(box);
+	}
+
+	PerfTimer timer;
+
+	// Current path: 8 corners x 6 planes for each box
+	std::vector<bool> legacy_visible(num_boxes);
+	timer.Start();
+	for (uint it = 0; it < iterations; it++)
+	{
+		for (uint i = 0; i < num_boxes; i++)
+		{
+			legacy_visible[i] = (camera.ContainsAABox(boxes[i]) != CULL_OUT);
+		}
+	}
+	double legacy_ms = timer.ReadMs() / iterations;
+
+	// Batch kernel (planes extracted once per iteration)
+	CullBatch batch;
+	batch.Reserve(num_boxes);
+	for (uint i = 0; i < num_boxes; i++)
+	{
+		batch.Add(boxes[i]);
+	}
+
+	CullPlanes planes;
+	timer.Start();
+	for (uint it = 0; it < iterations; it++)
+	{
+		planes.Set(camera.frustum);
+		batch.Cull(planes);
+	}
+	double batch_ms = timer.ReadMs() / iterations;
+
+	uint mismatches = 0;
+	for (uint i = 0; i < num_boxes; i++)
+	{
+		if (legacy_visible[i] != batch.IsVisible(i))
+		{
+			mismatches++;
+		}
+	}
+
+#if defined(CULLING_AVX)
+	const char* path = "AVX";
+#elif defined(CULLING_SSE)
+	const char* path = "SSE";
+#else
+	const char* path = "Scalar";
+#endif
+
+	LOG("Culling Benchmark (%i boxes, %i iterations):", num_boxes, iterations);
+	LOG("- ContainsAABox: %.4f ms", legacy_ms);
+	LOG("- Batch %s: %.4f ms (x%.1f)", path, batch_ms, batch_ms > 0.0 ? legacy_ms / batch_ms : 0.0);
+	LOG("- Visible: %i / %i - Mismatches: %i", batch.GetNumVisible(), num_boxes, mismatches);
+	return mismatches == 0;
+}
+// ---------------------------------------------------
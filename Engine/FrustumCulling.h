@@ -0,0 +1,72 @@
+#ifndef _FRUSTUM_CULLING_
+#define _FRUSTUM_CULLING_
+
+#include "Globals.h"
+#include "MathGeoLib.h"
+#include <vector>
+
+class JobSystem;
+
+#if defined(__AVX__)
+#define CULLING_AVX
+#endif
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#define CULLING_SSE
+#endif
+
+#define CULL_PLANES 6
+#define CULL_JOB_GRAIN 2048 // Boxes per job, multiple of 32 (one word of the bitmask)
+
+// Frustum planes extracted once per frame (SoA) ------------
+// A box is outside when: dot(normal, center) - d > dot(|normal|, extents)
+struct CullPlanes
+{
+	float nx[CULL_PLANES];
+	float ny[CULL_PLANES];
+	float nz[CULL_PLANES];
+	float d[CULL_PLANES];
+	float ax[CULL_PLANES]; // Absolute values of the normal
+	float ay[CULL_PLANES];
+	float az[CULL_PLANES];
+
+	void Set(const Frustum& frustum);
+};
+
+// Batch of AABBs in SoA layout (center & half size) ---------
+// "hints" keeps the plane that rejected each box last time (plane coherency),
+// it's tested first because objects usually stay out by the same plane.
+class CullBatch
+{
+public:
+	CullBatch();
+	~CullBatch();
+
+	void Clear();
+	void Reserve(uint size);
+	void Add(const AABB& box, uchar hint = 0);
+	uint Size() const;
+
+	// Fill the visible bitmask (1 bit per box), big batches are split in jobs
+	void Cull(const CullPlanes& planes, JobSystem* jobs = nullptr);
+	bool IsVisible(uint index) const;
+	uint GetNumVisible() const;
+
+public:
+	std::vector<float> cx, cy, cz;
+	std::vector<float> ex, ey, ez;
+	std::vector<uchar> hints;
+	std::vector<uint32> visible;
+
+private:
+	uint num_visible = 0;
+};
+
+// Culling kernel: works with any SoA arrays (count boxes), writes the visibility bitmask
+void CullAABBs(const CullPlanes& planes, const float* cx, const float* cy, const float* cz,
+	const float* ex, const float* ey, const float* ez, uchar* hints, uint count, uint32* visible);
+
+// Compare the batch kernel with CompCamera::ContainsAABox using random boxes (times to the console),
+// false if a box gets a different result
+bool CullingBenchmark(uint num_boxes, uint iterations);
+
+#endif
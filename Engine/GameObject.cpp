@@ -14,17 +14,23 @@
 #include "CompMaterial.h"
 #include "CompCamera.h"
 #include "CompScript.h"
+#include "JSONWriter.h"
+
+// Increased when any active flag or parent changes, the cached isActiveInHierarchy() are recalculated
+static uint hierarchy_version = 1;
 
 GameObject::GameObject(GameObject* parent) :parent(parent)
 {
 	Enable();
 	SetVisible(true);
 	uid = App->random->Int();
+	App->scene->RegisterUUID(this);
 
 	if (parent != nullptr)
 	{
 		// Push this game object into the childs list of its parent
 		parent->childs.push_back(this);
+		prefab_template = parent->isPrefabTemplate();
 	}
 }
 
@@ -34,12 +40,14 @@ GameObject::GameObject(char* nameGameObject, uint uuid)
 	SetVisible(true);
 	uid = uuid;
 	name = nameGameObject;
+	App->scene->RegisterUUID(this);
 }
 
 GameObject::GameObject(const GameObject& copy, bool haveparent, GameObject* parent_)
 {
 	// New UUID and name for this copy
 	uid = App->random->Int();
+	App->scene->RegisterUUID(this);
 	std::string nametemp = copy.GetName();
 	size_t EndName = nametemp.find_last_of("(");
 	nametemp = nametemp.substr(0, EndName - 1);
@@ -69,11 +77,14 @@ GameObject::GameObject(const GameObject& copy, bool haveparent, GameObject* pare
 		//Create from copy constructor all childs of the game object to copy
 		childs.push_back(new GameObject(*copy.GetChildbyIndex(i), haveparent, parent_));
 		childs[i]->parent = this;
+		childs[i]->LinkTransformToParent();
 	}
 }
 
 GameObject::~GameObject()
 {
+	App->scene->octree.Remove(this);
+	App->scene->UnregisterUUID(this);
 	RELEASE_ARRAY(name);
 	delete bounding_box;
 	bounding_box = nullptr;
@@ -194,7 +205,11 @@ GameObject* GameObject::GetGameObjectbyuid(uint uid)
 		//Check child Game Objects -------------------
 		for (uint i = 0; i < childs.size(); i++)
 		{
-			childs[i]->GetGameObjectbyuid(uid);
+			GameObject* ret = childs[i]->GetGameObjectbyuid(uid);
+			if (ret != nullptr)
+			{
+				return ret;
+			}
 		}
 	}
 	return nullptr;
@@ -230,26 +245,20 @@ void GameObject::Init()
 {
 }
 
+// Only the deletions, the components are updated by the Scene from their pools
 void GameObject::preUpdate(float dt)
 {
 	fixedDelete = false;
 
 	if (active)
 	{
-		//preUpdate Components --------------------------
+		//Delete Components --------------------------
 		for (uint i = 0; i < components.size(); i++)
 		{
 			if (components[i]->WantDelete())
 			{
 				DeleteComponent(components[i]);
 			}
-			else
-			{
-				if (components[i]->isActive())
-				{
-					components[i]->preUpdate(dt);
-				}
-			}
 		}
 
 		//preUpdate child Game Objects -------------------
@@ -270,44 +279,6 @@ void GameObject::preUpdate(float dt)
 	}
 }
 
-void GameObject::Update(float dt)
-{
-	if (active)
-	{
-		//Update Components --------------------------
-		for (uint i = 0; i < components.size(); i++)
-		{
-			if (components[i]->isActive())
-			{
-				components[i]->Update(dt);
-			}
-		}
-
-		//Update child Game Objects -------------------
-		for (uint i = 0; i < childs.size(); i++)
-		{
-			if (childs[i]->isActive())
-			{
-				childs[i]->Update(dt);
-			}
-		}
-
-		// BOUNDING BOX -----------------
-		if (bounding_box != nullptr)
-		{
-			//CompMesh* mesh = (CompMesh*)(FindComponentByType(C_MESH));
-			CompTransform* transform = (CompTransform*)(FindComponentByType(C_TRANSFORM));
-			if (transform != nullptr)
-			{
-				//Resize the Bounding Box
-				//bounding_box->SetFromCenterAndSize(transform->GetPos(), transform->GetScale()*2);
-				box_fixed = *bounding_box;
-				box_fixed.TransformAsAABB(transform->GetGlobalTransform());
-			}
-		}
-	}
-}
-
 void GameObject::postUpdate()
 {
 }
@@ -373,6 +344,7 @@ bool GameObject::Enable()
 	if (!active)
 	{
 		active = true;
+		hierarchy_version++;
 	}
 
 	return active;
@@ -383,6 +355,7 @@ bool GameObject::Disable()
 	if (active)
 	{
 		active = false;
+		hierarchy_version++;
 	}
 	return active;
 }
@@ -637,7 +610,10 @@ void GameObject::ShowInspectorInfo()
 		ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(5, 3));
 
 		/* ENABLE-DISABLE CHECKBOX*/
-		ImGui::Checkbox("##1", &active);
+		if (ImGui::Checkbox("##1", &active))
+		{
+			hierarchy_version++;
+		}
 
 		/* NAME OF THE GAMEOBJECT */
 		ImGui::SameLine();
@@ -856,7 +832,11 @@ void GameObject::ShowFreezeChildsWindow(bool freeze, bool& active)
 
 void GameObject::SetActive(bool active)
 {
-	this->active = active;
+	if (this->active != active)
+	{
+		this->active = active;
+		hierarchy_version++;
+	}
 }
 
 void GameObject::SetVisible(bool visible)
@@ -874,6 +854,17 @@ bool GameObject::isActive() const
 	return active;
 }
 
+// The parents are calculated once per version too, so each call is O(1) until something changes
+bool GameObject::isActiveInHierarchy() const
+{
+	if (active_version != hierarchy_version)
+	{
+		active_in_hierarchy = active && (parent == nullptr || parent->isActiveInHierarchy());
+		active_version = hierarchy_version;
+	}
+	return active_in_hierarchy;
+}
+
 bool GameObject::isVisible() const
 {
 	return visible;
@@ -884,34 +875,44 @@ bool GameObject::isStatic() const
 	return static_obj;
 }
 
-Component* GameObject::FindComponentByType(Comp_Type type) const
+void GameObject::SetPrefabTemplate()
 {
-	Component* comp = nullptr;
+	prefab_template = true;
+}
 
-	for (uint i = 0; i < components.size(); i++)
+bool GameObject::isPrefabTemplate() const
+{
+	return prefab_template;
+}
+
+Component* GameObject::FindComponentByType(Comp_Type type) const
+{
+	// We need to check if the component is ACTIVE first?
+	if (type < 0 || type >= MAX_COMP_TYPES)
 	{
-		if (components[i]->GetType() == type) // We need to check if the component is ACTIVE first?
-		{
-			comp = components[i];
-			break;
-		}
+		return nullptr;
 	}
+	return component_slots[type];
+}
 
-	return comp;
+// Components are stored in the pools of the scene, the vector keeps the order and the slots the type
+void GameObject::PushComponent(Component* component)
+{
+	components.push_back(component);
+	if (component->GetType() >= 0 && component->GetType() < MAX_COMP_TYPES)
+	{
+		component_slots[component->GetType()] = component;
+	}
 }
 
 Component* GameObject::AddComponent(Comp_Type type, bool isFromLoader)
 {
+	//We need to check if there is already a component of that type (no duplication)
 	bool dupe = false;
-	for (uint i = 0; i < components.size(); i++)
+	if (FindComponentByType(type) != nullptr)
 	{
-		//We need to check if there is already a component of that type (no duplication)
-		if (components[i]->GetType() == type) 
-		{
-			dupe = true;
-			LOG("There's already one component of this type in '%s'.", name);
-			break;
-		}
+		dupe = true;
+		LOG("There's already one component of this type in '%s'.", name);
 	}
 
 	if (!dupe)
@@ -919,8 +920,8 @@ Component* GameObject::AddComponent(Comp_Type type, bool isFromLoader)
 		if (type == Comp_Type::C_MESH)
 		{
 			LOG("Adding MESH COMPONENT.");
-			CompMesh* mesh = new CompMesh(type, this);
-			components.push_back(mesh);
+			CompMesh* mesh = (CompMesh*)App->scene->component_pools.Create(type, this);
+			PushComponent(mesh);
 			/* Link Material to the Mesh if exists */
 			const CompMaterial* material_link = (CompMaterial*)FindComponentByType(Comp_Type::C_MATERIAL);
 			if (material_link != nullptr)
@@ -937,16 +938,16 @@ Component* GameObject::AddComponent(Comp_Type type, bool isFromLoader)
 		else if (type == Comp_Type::C_TRANSFORM)
 		{
 			LOG("Adding TRANSFORM COMPONENT.");
-			CompTransform* transform = new CompTransform(type, this);
-			components.push_back(transform);
+			CompTransform* transform = (CompTransform*)App->scene->component_pools.Create(type, this);
+			PushComponent(transform);
 			return transform;
 		}
 
 		else if (type == Comp_Type::C_MATERIAL)
 		{
 			LOG("Adding MATERIAL COMPONENT.");
-			CompMaterial* material = new CompMaterial(type, this);
-			components.push_back(material);
+			CompMaterial* material = (CompMaterial*)App->scene->component_pools.Create(type, this);
+			PushComponent(material);
 
 			/* Link Material to the Mesh if exists */
 			CompMesh* mesh_to_link = (CompMesh*)FindComponentByType(Comp_Type::C_MESH);
@@ -964,20 +965,20 @@ Component* GameObject::AddComponent(Comp_Type type, bool isFromLoader)
 		else if (type == Comp_Type::C_CAMERA)
 		{
 			LOG("Adding CAMERA COMPONENT.");
-			CompCamera* camera = new CompCamera(type, this);
-			components.push_back(camera);
+			CompCamera* camera = (CompCamera*)App->scene->component_pools.Create(type, this);
+			PushComponent(camera);
 			return camera;
 		}
 
 		else if (type == Comp_Type::C_SCRIPT)
 		{
 			LOG("Adding SCRIPT COMPONENT.");
-			CompScript* script = new CompScript(type, this);
+			CompScript* script = (CompScript*)App->scene->component_pools.Create(type, this);
 			if (isFromLoader == false)
 			{
 				script->Init();
 			}
-			components.push_back(script);
+			PushComponent(script);
 			return script;
 		}
 	}
@@ -991,14 +992,14 @@ void GameObject::AddComponentCopy(const Component& copy)
 	{
 	case (Comp_Type::C_TRANSFORM):
 	{
-		CompTransform* transform = new CompTransform((CompTransform&)copy, this); //Transform copy constructor
-		components.push_back(transform);
+		CompTransform* transform = (CompTransform*)App->scene->component_pools.Copy(copy, this); //Transform copy constructor
+		PushComponent(transform);
 		break;
 	}
 	case (Comp_Type::C_MESH):
 	{
-		CompMesh* mesh = new CompMesh((CompMesh&)copy, this); //Mesh copy constructor
-		components.push_back(mesh);
+		CompMesh* mesh = (CompMesh*)App->scene->component_pools.Copy(copy, this); //Mesh copy constructor
+		PushComponent(mesh);
 		/* Link Material to the Mesh (if exists) */
 		CompMaterial* material_link = (CompMaterial*)FindComponentByType(Comp_Type::C_MATERIAL);
 		if (material_link != nullptr)
@@ -1013,8 +1014,8 @@ void GameObject::AddComponentCopy(const Component& copy)
 	}
 	case (Comp_Type::C_MATERIAL):
 	{
-		CompMaterial* material = new CompMaterial((CompMaterial&)copy, this); //Material copy constructor
-		components.push_back(material);
+		CompMaterial* material = (CompMaterial*)App->scene->component_pools.Copy(copy, this); //Material copy constructor
+		PushComponent(material);
 		/* Link Mesh to the Material (if exists) */
 		CompMesh* mesh_to_link = (CompMesh*)FindComponentByType(Comp_Type::C_MESH);
 		if (mesh_to_link != nullptr)
@@ -1029,14 +1030,14 @@ void GameObject::AddComponentCopy(const Component& copy)
 	}
 	case (Comp_Type::C_CAMERA):
 	{
-		CompCamera* camera = new CompCamera((CompCamera&)copy, this); //Camera copy constructor
-		components.push_back(camera);
+		CompCamera* camera = (CompCamera*)App->scene->component_pools.Copy(copy, this); //Camera copy constructor
+		PushComponent(camera);
 		break;
 	}
 	case (Comp_Type::C_SCRIPT):
 	{
-		CompScript* script = new CompScript((CompScript&)copy, this); //Script copy constructor
-		components.push_back(script);
+		CompScript* script = (CompScript*)App->scene->component_pools.Copy(copy, this); //Script copy constructor
+		PushComponent(script);
 		break;
 	}
 	default:
@@ -1044,22 +1045,28 @@ void GameObject::AddComponentCopy(const Component& copy)
 	}
 }
 
-void GameObject::SaveComponents(JSON_Object* object, std::string name, bool saveScene, uint& countResources) const
+void GameObject::SaveComponents(JSONWriter& writer, bool saveScene) const
 {
+	writer.BeginObject("Components");
 	for (int i = 0; i < components.size(); i++)
 	{
-		std::string temp = name + "Component " + std::to_string(i) + ".";
-		components[i]->Save(object, temp, saveScene, countResources);
+		writer.BeginObject("Component ", i);
+		components[i]->Save(writer, saveScene);
+		writer.EndObject();
 	}
+	writer.EndObject();
 }
 
 void GameObject::LoadComponents(const JSON_Object* object, std::string name, uint numComponents)
 {
+	static const JSON_Key key_type = json_key("Type");
+	const JSON_Object* node = json_object_dotget_node_with_std(object, name);
+
 	// First Add All components by type
 	for (int i = 0; i < numComponents; i++)
 	{
-		std::string temp = name + "Component " + std::to_string(i) + ".";
-		Comp_Type type = (Comp_Type)(int)json_object_dotget_number_with_std(object, temp + "Type");
+		std::string temp = "Component " + std::to_string(i);
+		Comp_Type type = (Comp_Type)(int)json_object_get_number_by_key(json_object_get_object(node, temp.c_str()), &key_type);
 		switch (type)
 		{
 		case Comp_Type::C_UNKNOWN:
@@ -1131,9 +1138,13 @@ void GameObject::DeleteAllComponents()
 	for (int i = 0; i < components.size(); i++)
 	{
 		components[i]->Clear();
-		delete components[i];
+		App->scene->component_pools.Release(components[i]);
 	}
 	components.clear();
+	for (int i = 0; i < MAX_COMP_TYPES; i++)
+	{
+		component_slots[i] = nullptr;
+	}
 }
 
 void GameObject::DeleteComponent(Component* component)
@@ -1150,7 +1161,11 @@ void GameObject::DeleteComponent(Component* component)
 			}
 			item++;
 		}
-		RELEASE(component);
+		if (FindComponentByType(component->GetType()) == component)
+		{
+			component_slots[component->GetType()] = nullptr;
+		}
+		App->scene->component_pools.Release(component);
 	}
 }
 
@@ -1227,19 +1242,21 @@ std::vector<GameObject*>* GameObject::GetChildsPtr()
 void GameObject::AddChildGameObject_Copy(const GameObject* child)
 {
 	GameObject* temp = new GameObject(*child);
-	temp->uid = App->random->Int();
+	temp->SetUUIDRandom();
 	std::string temp_name = temp->name;
 	temp_name += " (1)";
 	temp->name = App->GetCharfromConstChar(temp_name.c_str());
 	temp_name.clear();
 	temp->parent = this;
 	childs.push_back(temp);
+	temp->LinkTransformToParent();
 }
 
 void GameObject::AddChildGameObject_Load(GameObject* child)
 {
 	child->parent = this;
 	childs.push_back(child);
+	child->LinkTransformToParent();
 }
 
 void GameObject::AddChildGameObject_Replace(GameObject* child)
@@ -1247,13 +1264,18 @@ void GameObject::AddChildGameObject_Replace(GameObject* child)
 	child->parent = this;
 	childs.push_back(child);
 	App->scene->gameobjects.pop_back();
+	child->LinkTransformToParent();
 }
 
-void GameObject::UpdateChildsMatrices()
+// Update the parent of the transform inside the Scene hierarchy, childs are recalculated with it.
+// Also invalidates the cached isActiveInHierarchy(), all the reparenting goes through here
+void GameObject::LinkTransformToParent()
 {
-	for (uint i = 0; i < childs.size(); i++)
+	hierarchy_version++;
+	CompTransform* transform = GetComponentTransform();
+	if (transform != nullptr)
 	{
-		childs[i]->GetComponentTransform()->UpdateGlobalMatrixRecursive();
+		transform->LinkParent();
 	}
 }
 
@@ -1273,8 +1295,34 @@ void GameObject::AddBoundingBox(const ResourceMesh* mesh)
 	{
 		bounding_box = new AABB();
 	}
-	bounding_box->SetNegativeInfinity();
-	bounding_box->Enclose(mesh->vertices, mesh->num_vertices);
+	mesh->geometry.GetBounds(*bounding_box);
+	UpdateBoundingBox();
+}
+
+// Resize the Bounding Box with the global transform
+void GameObject::UpdateBoundingBox()
+{
+	// Prefab templates aren't in the scene, they can't be culled or picked
+	if (RefreshBoundingBox() && prefab_template == false)
+	{
+		// Insert or move it inside the octree
+		App->scene->octree.Insert(this);
+	}
+}
+
+bool GameObject::RefreshBoundingBox()
+{
+	if (bounding_box != nullptr)
+	{
+		CompTransform* transform = GetComponentTransform();
+		if (transform != nullptr)
+		{
+			box_fixed = *bounding_box;
+			box_fixed.TransformAsAABB(transform->GetGlobalTransform());
+			return true;
+		}
+	}
+	return false;
 }
 
 void GameObject::DrawBoundingBox()
@@ -1309,12 +1357,14 @@ uint GameObject::GetUUID() const
 
 void GameObject::SetUUID(uint uuid)
 {
+	App->scene->UnregisterUUID(this);
 	uid = uuid;
+	App->scene->RegisterUUID(this);
 }
 
 void GameObject::SetUUIDRandom()
 {
-	uid = App->random->Int();
+	SetUUID(App->random->Int());
 }
 
 bool GameObject::WanttoDelete() const
@@ -27,12 +27,11 @@ public:
 	bool CheckScripts(int & numfails);
 	void StartScripts();
 	void ClearAllVariablesScript();
-	GameObject* GetGameObjectbyuid(uint uid);
+	GameObject* GetGameObjectbyuid(uint uid); // Only this object and its childs, use Scene::GetGameObjectbyuid for all
 	GameObject* GetGameObjectfromScene(int);
 
 	void Init();
-	void preUpdate(float dt);
-	void Update(float dt);
+	void preUpdate(float dt);	/* Deletes the childs & components marked */
 	void postUpdate();
 	bool CleanUp();
 
@@ -60,9 +59,15 @@ public:
 	void SetStatic(bool set_static);
 
 	bool isActive() const;
+	bool isActiveInHierarchy() const; // This and all its parents are active (cached until an active flag or a parent changes)
 	bool isVisible() const;
 	bool isStatic() const;
 
+	// Prefab templates (models being imported) are outside the scene: no transform
+	// hierarchy, octree or picking. Set it before adding components, childs inherit it.
+	void SetPrefabTemplate();
+	bool isPrefabTemplate() const;
+
 	// Components -----------------------------
 	Component* AddComponent(Comp_Type type, bool isFromLoader = false);
 	void AddComponentCopy(const Component& copy);
@@ -76,7 +81,7 @@ public:
 	void DeleteAllComponents();
 	void DeleteComponent(Component* component);
 
-	void SaveComponents(JSON_Object* object, std::string name, bool saveScene, uint& countResources) const;
+	void SaveComponents(JSONWriter& writer, bool saveScene) const;
 	void LoadComponents(const JSON_Object * object, std::string name, uint numComponents);
 
 	// Childs ---------------------------------
@@ -92,7 +97,7 @@ public:
 	void AddChildGameObject_Replace(GameObject* child);
 
 	// Transform Modifications -----------------
-	void UpdateChildsMatrices();
+	void LinkTransformToParent();
 
 	// Parent ----------------
 	GameObject* GetParent() const; //Not const pointer to enable parent variables modification
@@ -100,9 +105,12 @@ public:
 
 	// Bounding Box -----------------------
 	void AddBoundingBox(const ResourceMesh* mesh);
+	void UpdateBoundingBox();
+	bool RefreshBoundingBox(); // Only box_fixed (can run in a job), false if there isn't a box
 	void DrawBoundingBox();
 	AABB* bounding_box = nullptr;
 	AABB  box_fixed;
+	int octree_handle = -1; // Item of this object inside the dynamic octree of the Scene
 	void SetAABBActive(bool active);
 	bool isAABBActive() const;
 
@@ -116,6 +124,10 @@ public:
 	void RemoveScriptReference(GameObject* go);
 
 	bool beingUsedByScript = false;
+
+private:
+	void PushComponent(Component* component);
+
 private:
 	uint uid = 0;
 	char* name = "CHANGE THIS";
@@ -125,9 +137,13 @@ private:
 	bool toDelete = false; 
 	bool fixedDelete = false;
 	bool bb_active = false;
+	bool prefab_template = false;
+	mutable bool active_in_hierarchy = false;
+	mutable uint active_version = 0;	/* Version of active_in_hierarchy */
 
 	GameObject* parent = nullptr;
 	std::vector<Component*> components;
+	Component* component_slots[MAX_COMP_TYPES] = { nullptr }; // Component of each type (index = Comp_Type)
 	std::vector<GameObject*> childs;
 	
 
@@ -51,7 +51,7 @@ enum SIMDCapability
 
 SIMDCapability DetectSIMDCapability()
 {
-#ifdef WIN32 ///\todo SIMD detection for other x86 platforms.
+#ifdef _WIN32 ///\todo SIMD detection for other x86 platforms.
 
 #ifdef MATH_SSE
 	int CPUInfo[4] = {-1};
@@ -98,11 +98,14 @@ SIMDCapability DetectSIMDCapability()
 //			bSSE3Instructions = (CPUInfo[2] & 0x1) || false;
 //			bSupplementalSSE3 = (CPUInfo[2] & 0x200) || false;
 //			bCMPXCHG16B= (CPUInfo[2] & 0x2000) || false;
-//			bSSE41Extensions = (CPUInfo[2] & 0x80000) || false;
+#ifdef MATH_SSE41
+			bSSE41Extensions = (CPUInfo[2] & 0x80000) || false;
+#endif
 //			bSSE42Extensions = (CPUInfo[2] & 0x100000) || false;
 //			bPOPCNT= (CPUInfo[2] & 0x800000) || false;
 #ifdef MATH_AVX
-			hasAVX = (CPUInfo[2] & 0x10000000) || false;
+			// The OS must also save the YMM registers (OSXSAVE + XCR0 bits 1 and 2)
+			hasAVX = (CPUInfo[2] & 0x10000000) && (CPUInfo[2] & 0x08000000) && ((_xgetbv(0) & 0x6) == 0x6);
 #endif
 			nFeatureInfo = CPUInfo[3];
 		}
@@ -11,6 +11,7 @@
 #define LOG(format, ...) log(__FILE__, __LINE__, format, __VA_ARGS__);
 
 void log(const char file[], int line, const char* format, ...);
+void FlushLog(); // Move the logs of other threads to the console (main thread)
 
 #define CAP(n) ((n <= 0.0f) ? n=0.0f : (n >= 1.0f) ? n=1.0f : n=n)
 #define PI 3.14159265
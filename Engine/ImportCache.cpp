@@ -0,0 +1,325 @@
+#include "ImportCache.h"
+#include "Application.h"
+#include "ModuleFS.h"
+#include "ImportMesh.h"
+#include "ModuleImporter.h"
+
+#include <experimental/filesystem>
+#include <algorithm>
+
+// XXH64 ---------------------------------------------------------
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+
+static inline uint64 XXH_Rotl(uint64 x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64 XXH_Read64(const uchar* p)
+{
+	uint64 v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32 XXH_Read32(const uchar* p)
+{
+	uint32 v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint64 XXH_Round(uint64 acc, uint64 input)
+{
+	acc += input * XXH_PRIME64_2;
+	acc = XXH_Rotl(acc, 31);
+	return acc * XXH_PRIME64_1;
+}
+
+static inline uint64 XXH_MergeRound(uint64 acc, uint64 val)
+{
+	acc ^= XXH_Round(0, val);
+	return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+static uint64 XXH64(const void* input, size_t len, uint64 seed)
+{
+	const uchar* p = (const uchar*)input;
+	const uchar* end = p + len;
+	uint64 h64;
+
+	if (len >= 32)
+	{
+		const uchar* limit = end - 32;
+		uint64 v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+		uint64 v2 = seed + XXH_PRIME64_2;
+		uint64 v3 = seed;
+		uint64 v4 = seed - XXH_PRIME64_1;
+		do
+		{
+			v1 = XXH_Round(v1, XXH_Read64(p)); p += 8;
+			v2 = XXH_Round(v2, XXH_Read64(p)); p += 8;
+			v3 = XXH_Round(v3, XXH_Read64(p)); p += 8;
+			v4 = XXH_Round(v4, XXH_Read64(p)); p += 8;
+		} while (p <= limit);
+
+		h64 = XXH_Rotl(v1, 1) + XXH_Rotl(v2, 7) + XXH_Rotl(v3, 12) + XXH_Rotl(v4, 18);
+		h64 = XXH_MergeRound(h64, v1);
+		h64 = XXH_MergeRound(h64, v2);
+		h64 = XXH_MergeRound(h64, v3);
+		h64 = XXH_MergeRound(h64, v4);
+	}
+	else
+	{
+		h64 = seed + XXH_PRIME64_5;
+	}
+
+	h64 += (uint64)len;
+
+	while (p + 8 <= end)
+	{
+		h64 ^= XXH_Round(0, XXH_Read64(p));
+		h64 = XXH_Rotl(h64, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+		p += 8;
+	}
+	if (p + 4 <= end)
+	{
+		h64 ^= (uint64)XXH_Read32(p) * XXH_PRIME64_1;
+		h64 = XXH_Rotl(h64, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+		p += 4;
+	}
+	while (p < end)
+	{
+		h64 ^= (*p) * XXH_PRIME64_5;
+		h64 = XXH_Rotl(h64, 11) * XXH_PRIME64_1;
+		p++;
+	}
+
+	// Avalanche
+	h64 ^= h64 >> 33;
+	h64 *= XXH_PRIME64_2;
+	h64 ^= h64 >> 29;
+	h64 *= XXH_PRIME64_3;
+	h64 ^= h64 >> 32;
+	return h64;
+}
+
+ImportCache::ImportCache()
+{
+}
+
+ImportCache::~ImportCache()
+{
+}
+
+void ImportCache::Load()
+{
+	entries.clear();
+	JSON_Value* config_file = json_parse_file(IMPORT_CACHE_FILE);
+	if (config_file == nullptr)
+	{
+		return;
+	}
+
+	JSON_Object* config = json_value_get_object(config_file);
+	JSON_Array* array = json_object_dotget_array(config, "Import Cache.Entries");
+	if ((int)json_object_dotget_number(config, "Import Cache.Version") == IMPORT_CACHE_VERSION && array != nullptr)
+	{
+		for (uint i = 0; i < json_array_get_count(array); i++)
+		{
+			JSON_Object* node = json_array_get_object(array, i);
+			const char* hash = json_object_get_string(node, "Hash");
+			JSON_Array* uuids = json_object_get_array(node, "UUIDs");
+			if (hash == nullptr || uuids == nullptr)
+			{
+				continue;
+			}
+
+			// Hashes are saved as hex strings, a JSON number (double) can't keep 64 bits
+			ImportCacheEntry entry;
+			entry.type = (Resource::Type)(int)json_object_get_number(node, "Type");
+			for (uint u = 0; u < json_array_get_count(uuids); u++)
+			{
+				entry.uuids.push_back((uint)json_array_get_number(uuids, u));
+			}
+			entries[strtoull(hash, nullptr, 16)] = entry;
+		}
+	}
+	json_value_free(config_file);
+	modified = false;
+	LOG("Import Cache: %i entries", entries.size());
+}
+
+void ImportCache::Save()
+{
+	if (modified == false)
+	{
+		return;
+	}
+
+	JSON_Value* config_file = json_value_init_object();
+	JSON_Object* config = json_value_get_object(config_file);
+	json_object_dotset_number(config, "Import Cache.Version", IMPORT_CACHE_VERSION);
+	JSON_Value* array_value = json_value_init_array();
+	JSON_Array* array = json_value_get_array(array_value);
+
+	char hash[17];
+	for (std::map<uint64, ImportCacheEntry>::const_iterator it = entries.begin(); it != entries.end(); it++)
+	{
+		JSON_Value* node_value = json_value_init_object();
+		JSON_Object* node = json_value_get_object(node_value);
+		sprintf_s(hash, sizeof(hash), "%016llx", it->first);
+		json_object_set_string(node, "Hash", hash);
+		json_object_set_number(node, "Type", (int)it->second.type);
+		JSON_Value* uuids_value = json_value_init_array();
+		JSON_Array* uuids = json_value_get_array(uuids_value);
+		for (uint i = 0; i < it->second.uuids.size(); i++)
+		{
+			json_array_append_number(uuids, it->second.uuids[i]);
+		}
+		json_object_set_value(node, "UUIDs", uuids_value);
+		json_array_append_value(array, node_value);
+	}
+	json_object_dotset_value(config, "Import Cache.Entries", array_value);
+
+	json_serialize_to_file(config_file, IMPORT_CACHE_FILE);
+	json_value_free(config_file);
+	modified = false;
+}
+
+uint64 ImportCache::Hash(const char* buffer, uint size, Resource::Type type) const
+{
+	return XXH64(buffer, size, GetSettingsSeed(type));
+}
+
+uint64 ImportCache::HashFile(const char* file, Resource::Type type) const
+{
+	uint64 hash = 0;
+	MappedFile mapped;
+	if (App->fs->MapFile(file, mapped))
+	{
+		hash = Hash(mapped.data, mapped.size, type);
+		App->fs->UnmapFile(mapped);
+	}
+	return hash;
+}
+
+const ImportCacheEntry* ImportCache::Find(uint64 hash) const
+{
+	std::map<uint64, ImportCacheEntry>::const_iterator it = entries.find(hash);
+	if (it == entries.end())
+	{
+		return nullptr;
+	}
+
+	// Library can be deleted or changed outside the engine
+	for (uint i = 0; i < it->second.uuids.size(); i++)
+	{
+		if (ExistArtifact(it->second.uuids[i], it->second.type) == false)
+		{
+			return nullptr;
+		}
+	}
+	return &it->second;
+}
+
+void ImportCache::Add(uint64 hash, Resource::Type type, const std::vector<uint>& uuids)
+{
+	if (hash == 0 || uuids.size() == 0)
+	{
+		return;
+	}
+
+	// Reimports overwrite the same Library files, forget the old content of these uuids
+	std::map<uint64, ImportCacheEntry>::iterator it = entries.begin();
+	while (it != entries.end())
+	{
+		bool shared = false;
+		for (uint i = 0; i < it->second.uuids.size() && shared == false; i++)
+		{
+			shared = std::find(uuids.begin(), uuids.end(), it->second.uuids[i]) != uuids.end();
+		}
+		if (shared && it->first != hash)
+		{
+			it = entries.erase(it);
+		}
+		else
+		{
+			it++;
+		}
+	}
+
+	ImportCacheEntry& entry = entries[hash];
+	entry.type = type;
+	entry.uuids = uuids;
+	modified = true;
+}
+
+bool ImportCache::IsUpToDate(const char* file, Resource::Type type, const std::vector<uint>& uuids) const
+{
+	const ImportCacheEntry* entry = Find(HashFile(file, type));
+	if (entry == nullptr || entry->type != type || entry->uuids.size() != uuids.size())
+	{
+		return false;
+	}
+
+	// The metas can keep other order than the import
+	std::vector<uint> cached = entry->uuids;
+	std::vector<uint> current = uuids;
+	std::sort(cached.begin(), cached.end());
+	std::sort(current.begin(), current.end());
+	return cached == current;
+}
+
+bool ImportCache::ExistArtifact(uint uuid, Resource::Type type) const
+{
+	return App->fs->CheckIsFileExist(GetArtifactPath(uuid, type));
+}
+
+// Duplicate the Library file of the same content with other uuid (same asset imported twice)
+bool ImportCache::CopyArtifact(uint from, uint to, Resource::Type type) const
+{
+	namespace stdfs = std::experimental::filesystem;
+	std::error_code error;
+	stdfs::copy_file(GetArtifactPath(from, type), GetArtifactPath(to, type), stdfs::copy_options::overwrite_existing, error);
+	if (error)
+	{
+		LOG("Import Cache: can't copy %i to %i", from, to);
+		return false;
+	}
+	return true;
+}
+
+// Everything that changes the files written in Library
+uint64 ImportCache::GetSettingsSeed(Resource::Type type) const
+{
+	uint64 seed = ((uint64)IMPORT_CACHE_VERSION << 32) | (uint64)type;
+	switch (type)
+	{
+	case Resource::Type::MESH:
+	{
+		seed ^= (uint64)MESH_FILE_VERSION << 8;
+		seed ^= (uint64)(App->importer->iMesh->quantize ? 1 : 0) << 16;
+		break;
+	}
+	case Resource::Type::MATERIAL:
+	{
+		// Always DXT5 for now
+		break;
+	}
+	}
+	return XXH64(&seed, sizeof(seed), 0);
+}
+
+std::string ImportCache::GetArtifactPath(uint uuid, Resource::Type type) const
+{
+	if (type == Resource::Type::MATERIAL)
+	{
+		return App->fs->AddDirectorybyType(std::to_string(uuid) + ".dds", IMPORT_DIRECTORY_LIBRARY_MATERIALS);
+	}
+	return App->fs->AddDirectorybyType(std::to_string(uuid), IMPORT_DIRECTORY_LIBRARY_MESHES);
+}
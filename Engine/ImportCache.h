@@ -0,0 +1,55 @@
+#ifndef _IMPORT_CACHE_
+#define _IMPORT_CACHE_
+
+#include "Globals.h"
+#include "Resource_.h"
+#include <map>
+#include <vector>
+#include <string>
+
+#define IMPORT_CACHE_FILE "Library/ImportCache.json"
+#define IMPORT_CACHE_VERSION 1 // Change it when the importers write different files
+
+// Library files generated by an import (meshes in the order of the import)
+struct ImportCacheEntry
+{
+	Resource::Type type = Resource::Type::UNKNOWN;
+	std::vector<uint> uuids;
+};
+
+// Import Cache ----------------------------------------------------
+// Maps the content hash of an asset (+ import settings) to the files already
+// in Library, then an unchanged asset doesn't need to be imported again.
+class ImportCache
+{
+public:
+	ImportCache();
+	~ImportCache();
+
+	void Load();
+	void Save();
+
+	// XXH64 of the content, seeded with the import settings of the type
+	uint64 Hash(const char* buffer, uint size, Resource::Type type) const;
+	uint64 HashFile(const char* file, Resource::Type type) const;
+
+	// nullptr if the content wasn't imported or its Library files are missing
+	const ImportCacheEntry* Find(uint64 hash) const;
+	void Add(uint64 hash, Resource::Type type, const std::vector<uint>& uuids);
+
+	// The asset still generates these same Library files
+	bool IsUpToDate(const char* file, Resource::Type type, const std::vector<uint>& uuids) const;
+
+	bool ExistArtifact(uint uuid, Resource::Type type) const;
+	bool CopyArtifact(uint from, uint to, Resource::Type type) const;
+
+private:
+	uint64 GetSettingsSeed(Resource::Type type) const;
+	std::string GetArtifactPath(uint uuid, Resource::Type type) const;
+
+private:
+	std::map<uint64, ImportCacheEntry> entries;
+	bool modified = false;
+};
+
+#endif
@@ -4,10 +4,12 @@
 #include "ModuleGUI.h"
 #include "JSONSerialization.h"
 #include "ResourceMaterial.h"
+#include "ImportCache.h"
 
 #include "Devil/include/il.h"
 #include "Devil/include/ilu.h"
 #include "Devil/include/ilut.h"
+#include "Profiler.h"
 
 #pragma comment(lib, "Devil/libx86/DevIl.lib")
 #pragma comment(lib, "Devil/libx86/ILU.lib")
@@ -15,19 +17,121 @@
 
 ImportMaterial::ImportMaterial()
 {
+	// DevIL isn't thread safe, all the conversions are done by the same thread
+	texture_thread = std::thread(&ImportMaterial::ConvertTextures, this);
 }
 
 
 ImportMaterial::~ImportMaterial()
 {
+	StopConversions();
 }
 
+// Resource & meta are created now, the DDS conversion is done in the texture thread
+// (the file is read & hashed here to skip the conversion of the content already imported)
 bool ImportMaterial::Import(const char* file, uint uuid)
 {
-	bool ret = false;
-	char* buffer;
-	uint size_file = App->fs->LoadFile(file, &buffer);
-	if (ilLoadL(IL_TYPE_UNKNOWN, (const void*)buffer, size_file))
+	PROFILE_FUNCTION();
+	uint uuid_mesh = 0;
+	if (uuid == 0) // if direfent create a new resource with the resource deleted
+	{
+		uuid_mesh = App->random->Int();
+	}
+	else
+	{
+		uuid_mesh = uuid;
+	}
+	ResourceMaterial* res_material = (ResourceMaterial*)App->resource_manager->CreateNewResource(Resource::Type::MATERIAL, uuid_mesh);
+	res_material->InitInfo(App->fs->FixName_directory(file).c_str());
+	std::string Newdirectory = ((Project*)App->gui->winManager[WindowName::PROJECT])->GetDirectory();
+	Newdirectory += "\\" +App->fs->FixName_directory(file);
+	App->Json_seria->SaveMaterial(res_material, ((Project*)App->gui->winManager[WindowName::PROJECT])->GetDirectory(), Newdirectory.c_str());
+	std::string name = std::to_string(uuid_mesh);
+	name = App->fs->FixName_directory(name);//?
+	name = App->fs->FixExtension(name, ".dds");
+
+	// Same content imported before: reuse its .dds
+	TextureConversion conversion;
+	conversion.size = App->fs->LoadFile(file, &conversion.buffer);
+	uint64 hash = 0;
+	if (conversion.buffer != nullptr)
+	{
+		hash = App->importer->cache->Hash(conversion.buffer, conversion.size, Resource::Type::MATERIAL);
+	}
+	const ImportCacheEntry* cached = App->importer->cache->Find(hash);
+	if (cached != nullptr && (cached->uuids[0] == uuid_mesh || App->importer->cache->CopyArtifact(cached->uuids[0], uuid_mesh, Resource::Type::MATERIAL)))
+	{
+		LOG("Import Cache: texture %s reused", file);
+		RELEASE_ARRAY(conversion.buffer);
+	}
+	else
+	{
+		conversion.file = file;
+		conversion.name = name;
+		mutex.lock();
+		conversions.push_back(conversion);
+		mutex.unlock();
+		work_cond.notify_one();
+	}
+	App->importer->cache->Add(hash, Resource::Type::MATERIAL, std::vector<uint>(1, uuid_mesh));
+
+	return false;
+}
+
+// Block until all the textures queued are converted (before using the files of Library)
+void ImportMaterial::WaitConversions()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	done_cond.wait(lock, [this]() { return conversions.size() == 0 && converting == false; });
+}
+
+void ImportMaterial::StopConversions()
+{
+	if (texture_thread.joinable() == false)
+	{
+		return;
+	}
+	mutex.lock();
+	quit = true;
+	mutex.unlock();
+	work_cond.notify_all();
+	texture_thread.join();
+}
+
+// TEXTURE THREAD -----------------------------
+void ImportMaterial::ConvertTextures()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		work_cond.wait(lock, [this]() { return conversions.size() > 0 || quit; });
+
+		// Finish the queue before quitting, the resources are already created
+		if (conversions.size() == 0)
+		{
+			break;
+		}
+
+		TextureConversion conversion = conversions.front();
+		conversions.pop_front();
+		converting = true;
+		lock.unlock();
+
+		Convert(conversion);
+
+		lock.lock();
+		converting = false;
+		if (conversions.size() == 0)
+		{
+			done_cond.notify_all();
+		}
+	}
+}
+
+void ImportMaterial::Convert(const TextureConversion& conversion)
+{
+	char* buffer = conversion.buffer; // Read by Import
+	if (buffer != nullptr && ilLoadL(IL_TYPE_UNKNOWN, (const void*)buffer, conversion.size))
 	{
 		ILuint size;
 		ILubyte *data;
@@ -36,35 +140,19 @@ bool ImportMaterial::Import(const char* file, uint uuid)
 		if (size > 0)
 		{
 			data = new ILubyte[size]; // allocate data buffer
-			uint uuid_mesh = 0;
-			if (uuid == 0) // if direfent create a new resource with the resource deleted
-			{
-				uuid_mesh = App->random->Int();
-			}
-			else
-			{
-				uuid_mesh = uuid;
-			}
-			ResourceMaterial* res_material = (ResourceMaterial*)App->resource_manager->CreateNewResource(Resource::Type::MATERIAL, uuid_mesh);
-			res_material->InitInfo(App->fs->FixName_directory(file).c_str());
-			std::string Newdirectory = ((Project*)App->gui->winManager[WindowName::PROJECT])->GetDirectory();
-			Newdirectory += "\\" +App->fs->FixName_directory(file);
-			App->Json_seria->SaveMaterial(res_material, ((Project*)App->gui->winManager[WindowName::PROJECT])->GetDirectory(), Newdirectory.c_str());
-			std::string name = std::to_string(uuid_mesh);
-			name = App->fs->FixName_directory(name);//?
-			name = App->fs->FixExtension(name, ".dds");
 			if (ilSaveL(IL_DDS, data, size) > 0) // Save to buffer with the ilSaveIL function
-				ret = App->fs->SaveFile((char*)data, name, size, IMPORT_DIRECTORY_LIBRARY_MATERIALS);
+				App->fs->SaveFile((char*)data, conversion.name, size, IMPORT_DIRECTORY_LIBRARY_MATERIALS);
 			RELEASE_ARRAY(data);
 		}
 	}
+	else
+	{
+		LOG("Cannot convert texture %s", conversion.file.c_str());
+	}
 	RELEASE_ARRAY(buffer);
-	//return ret;
-
-	return false;
 }
 
-Texture ImportMaterial::Load(const char* file)
+Texture ImportMaterial::Load(const char* file, const char* buffer, uint size)
 {
 	Texture texture;
 	ILuint textureID;
@@ -75,9 +163,17 @@ Texture ImportMaterial::Load(const char* file)
 	glGenTextures(1, &textureID);
 	glBindTexture(GL_TEXTURE_2D, textureID);
 
-	std::string temp = file;
-	temp = DIRECTORY_LIBRARY_MATERIALS + temp + ".dds";
-	success = ilLoadImage(temp.c_str());
+	if (buffer != nullptr)
+	{
+		// File already read (resource streaming)
+		success = ilLoadL(IL_DDS, buffer, size);
+	}
+	else
+	{
+		std::string temp = file;
+		temp = DIRECTORY_LIBRARY_MATERIALS + temp + ".dds";
+		success = ilLoadImage(temp.c_str());
+	}
 
 	if (success)
 	{
@@ -114,6 +210,7 @@ Texture ImportMaterial::Load(const char* file)
 			ilGetInteger(IL_IMAGE_FORMAT),
 			GL_UNSIGNED_BYTE,
 			ilGetData());
+		texture.size = ilGetInteger(IL_IMAGE_WIDTH) * ilGetInteger(IL_IMAGE_HEIGHT) * ilGetInteger(IL_IMAGE_BPP);
 
 		LOG("Texture Application Successful.");
 	}
@@ -143,9 +240,10 @@ Texture ImportMaterial::Load(const char* file)
 	return texture;
 }
 
-bool ImportMaterial::LoadResource(const char* file, ResourceMaterial* resourceMaterial)
+bool ImportMaterial::LoadResource(const char* file, ResourceMaterial* resourceMaterial, const char* buffer, uint size)
 {
-	Texture texture = Load(file);
+	PROFILE_FUNCTION();
+	Texture texture = Load(file, buffer, size);
 	LOG("Resources: %s, Loaded in Memory!", resourceMaterial->name);
 	if (texture.id > 0)
 	{
@@ -4,10 +4,23 @@
 #include "Module.h"
 #include "Application.h"
 #include "ModuleImporter.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 
 struct Texture;
 class ResourceMaterial;
 
+// Image of Assets to convert to .dds in Library
+struct TextureConversion
+{
+	std::string file;
+	std::string name;
+	char* buffer = nullptr; // Content of the file (released by the texture thread)
+	uint size = 0;
+};
+
 class ImportMaterial
 {
 public:
@@ -16,9 +29,24 @@ public:
 
 	//bool Import(const char* file, const char* path, std::string& output_file);
 	bool Import(const char* file, uint uuid = 0);
-	Texture Load(const char * file);
-	bool LoadResource(const char * file, ResourceMaterial* resourceMaterial);
+	// buffer: content of the file if it's already read (resource streaming)
+	Texture Load(const char * file, const char* buffer = nullptr, uint size = 0);
+	bool LoadResource(const char * file, ResourceMaterial* resourceMaterial, const char* buffer = nullptr, uint size = 0);
+	void WaitConversions();
+	void StopConversions();
+
+private:
+	void ConvertTextures();
+	void Convert(const TextureConversion& conversion);
 
+private:
+	std::thread texture_thread;
+	std::mutex mutex;
+	std::condition_variable work_cond;
+	std::condition_variable done_cond;
+	std::deque<TextureConversion> conversions;
+	bool converting = false;
+	bool quit = false;
 
 };
 
@@ -10,6 +10,10 @@
 #include "CompMaterial.h"
 #include "CompTransform.h"
 #include "ModuleTextures.h"
+#include "MeshQuantization.h"
+#include "ImportCache.h"
+#include "Profiler.h"
+#include "JobSystem.h"
 
 #include <filesystem>
 #include <iostream>
@@ -31,23 +35,17 @@ bool ImportMesh::Load(const char* exported_file, Texture* resource)
 }
 
 // Import Mesh -----------------------------------------------------------------------------------------------------------------------------
+// Components & resource are created now, the data is serialized later by ProcessImportJobs (in parallel)
 bool ImportMesh::Import(const aiScene* scene, const aiMesh* mesh, GameObject* obj, const char* name, uint uuid)
 {
+	PROFILE_FUNCTION();
 	bool ret = true;
-	uint num_vertices = 0;
-	uint num_indices = 0;
-	uint num_normals = 0;
-	uint num_textures = 0;
-
-	float3* vertices = nullptr;
-	uint* indices = nullptr;
-	float3* vert_normals = nullptr;
-	float2* tex_coords = nullptr;
 
 	for (uint i = 0; i < mesh->mNumFaces; i++)
 	{
 		if (mesh->mFaces[i].mNumIndices != 3)
 		{
+			LOG("WARNING, Geometry face with != 3 indices!");
 			return false;
 		}
 	}
@@ -58,74 +56,15 @@ bool ImportMesh::Import(const aiScene* scene, const aiMesh* mesh, GameObject* ob
 	if (mesh != nullptr)
 	{
 		LOG("Importing Mesh %s", name);
-		
-		// SET VERTEX DATA -------------------------------
-		num_vertices = mesh->mNumVertices;
-		vertices = new float3[num_vertices];
-		memcpy(vertices, mesh->mVertices, sizeof(float3) * num_vertices);
-		LOG("- Imported all vertex from data, total vertex: %i", num_vertices);
-
-		// SET INDEX DATA -----------------------------------------
-		if (mesh->HasFaces())
-		{
-			num_indices = mesh->mNumFaces * 3;
-			indices = new uint[num_indices];
-			for (uint i = 0; i < mesh->mNumFaces; i++)
-			{
-				if (mesh->mFaces[i].mNumIndices != 3)
-				{
-					LOG("WARNING, Geometry face with != 3 indices!");
-					return false;
-				}
-				else
-				{
-					memcpy(&indices[i * 3], mesh->mFaces[i].mIndices, sizeof(uint) * 3);
-				}
-			}
-			LOG("- Imported all index from data, total indices: %i", num_indices);
-		}
-		else
-		{
-			LOG("- Mesh %s hasn't got Faces", mesh->mName.C_Str());
-		}
-
-		// SET NORMAL DATA -------------------------------
-		if (mesh->HasNormals())
+		LOG("- Vertices: %i, Indices: %i", mesh->mNumVertices, mesh->mNumFaces * 3);
+		if (mesh->HasNormals() == false)
 		{
-			num_normals = num_vertices;
-			vert_normals = new float3[num_normals];
-			memcpy(vert_normals, mesh->mNormals, sizeof(float3) * num_normals);
-			LOG("- Imported all Normals from data");
-		}
-		else
-		{
-			num_normals = 0;
 			LOG("- Mesh %s hasn't got Normals", mesh->mName.C_Str());
 		}
-
-		// SET TEX COORD DATA -------------------------------
-		//num_tex_coords = num_vertices;
-		tex_coords = new float2[num_vertices];
-		if (mesh->mTextureCoords[0])
+		if (mesh->mTextureCoords[0] == nullptr)
 		{
-			for (uint i = 0; i < num_vertices; i++)
-			{
-				tex_coords[i].x = mesh->mTextureCoords[0][i].x;
-				tex_coords[i].y = mesh->mTextureCoords[0][i].y;
-			}
-			//memcpy(tex_coords, mesh->mTextureCoords[0], sizeof(float2) * num_tex_coords);
-			LOG("- Imported all Tex Coords from data");
-		}
-		else
-		{
-			for (uint i = 0; i < num_vertices; i++)
-			{
-				tex_coords[i] = float2(0, 0);
-			}
-
 			LOG("- Mesh %s hasn't got Tex Coords", mesh->mName.C_Str());
 		}
-		LOG("Imported all data");
 	}
 	else
 	{
@@ -151,11 +90,8 @@ bool ImportMesh::Import(const aiScene* scene, const aiMesh* mesh, GameObject* ob
 			ResourceMaterial* resource_mat = (ResourceMaterial*)App->resource_manager->GetResource(normalPath.c_str());
 			if (resource_mat != nullptr)
 			{
-				if (resource_mat->IsLoadedToMemory() == Resource::State::UNLOADED)
-				{
-					std::string temp = std::to_string(resource_mat->GetUUID());
-					App->importer->iMaterial->LoadResource(temp.c_str(), resource_mat);
-				}
+				// The imported object is only saved as a prefab, the texture is loaded when it's used
+				// (it may still be converting in the texture thread)
 				materialComp->resourceMaterial = resource_mat;
 				resource_mat->path_assets = normalPath;
 			}
@@ -176,98 +112,124 @@ bool ImportMesh::Import(const aiScene* scene, const aiMesh* mesh, GameObject* ob
 	ResourceMesh* res_mesh = (ResourceMesh*)App->resource_manager->CreateNewResource(Resource::Type::MESH, uuid_mesh);
 	meshComp->SetResource(res_mesh, true);
 
+	// Set Info ResoruceMesh
+	res_mesh->InitInfo(name);
+	//std::string path_assets = name;
+	//res_mesh->path_assets = App->fs->GetFullPath(path_assets);
 
-	// ALLOCATING DATA INTO BUFFER ------------------------
-	uint ranges[3] = { num_vertices, num_indices, num_normals }; //,num_tex_coords };
-
-	uint size = sizeof(ranges) + sizeof(float3) *  num_vertices + sizeof(uint) * num_indices + sizeof(float3) *  num_normals + sizeof(float2) *  num_vertices;
-
-	// Allocating all data 
-	char* data = new char[size];
-	char* cursor = data;
+	// Serialize & Save Mesh (ProcessImportJobs) --
+	MeshImportJob job;
+	job.mesh = mesh;
+	job.uuid = uuid_mesh;
+	import_jobs.push_back(job);
 
-	// Storing Ranges
-	uint bytes = sizeof(ranges);
-	memcpy(cursor, ranges, bytes);
+	return ret;
+}
 
-	// Storing Vertices
-	cursor += bytes;
-	bytes = sizeof(float3) * num_vertices;
-	memcpy(cursor, vertices, bytes);
+// Serialize all the meshes imported (the aiScene has to be alive) and write the files in a batch.
+// Each stage is shared between the cores, a job only touches its own mesh & buffer.
+// cached: Library files of the same content imported before, they are reused instead of serializing.
+void ImportMesh::ProcessImportJobs(std::vector<uint>& uuids, const ImportCacheEntry* cached)
+{
+	if (import_jobs.size() == 0)
+	{
+		return;
+	}
 
-	// Storing Indices
-	cursor += bytes;
-	bytes = sizeof(uint) * num_indices;
-	memcpy(cursor, indices, bytes);
+	for (uint i = 0; i < import_jobs.size(); i++)
+	{
+		uuids.push_back(import_jobs[i].uuid);
+	}
 
-	// Storing Normals
-	cursor += bytes;
-	bytes = sizeof(float3) * num_normals;
-	memcpy(cursor, vert_normals, bytes);
+	// Meshes are always imported in the same order, the same content gives the same jobs
+	if (cached != nullptr && cached->uuids.size() == import_jobs.size())
+	{
+		uint reused = 0;
+		for (uint i = 0; i < import_jobs.size(); i++)
+		{
+			MeshImportJob& job = import_jobs[i];
+			if (cached->uuids[i] == job.uuid || App->importer->cache->CopyArtifact(cached->uuids[i], job.uuid, Resource::Type::MESH))
+			{
+				job.cached = true;
+				reused++;
+			}
+		}
+		LOG("Import Cache: %i/%i meshes reused", reused, import_jobs.size());
+	}
 
-	// Storing Tex Coords
-	cursor += bytes;
-	bytes = sizeof(float2) * num_vertices; //num_tex_coords;
-	memcpy(cursor, tex_coords, bytes);
+	// One job per mesh, the meshes have very different sizes
+	LOG("Serializing %i meshes with %i worker threads", import_jobs.size(), App->jobs->GetNumThreads());
+	App->jobs->ParallelFor("Serialize Meshes", import_jobs.size(), 1, [this](uint begin, uint end)
+	{
+		for (uint i = begin; i < end; i++)
+		{
+			if (import_jobs[i].cached == false)
+			{
+				SerializeMesh(import_jobs[i]);
+			}
+		}
+	});
 
-	// Release all pointers
-	RELEASE_ARRAY(vertices);
-	RELEASE_ARRAY(indices);
-	RELEASE_ARRAY(vert_normals);
-	RELEASE_ARRAY(tex_coords);
-	//RELEASE(texture);
+	// Batch of writes
+	App->jobs->ParallelFor("Write Meshes", import_jobs.size(), 1, [this](uint begin, uint end)
+	{
+		for (uint i = begin; i < end; i++)
+		{
+			MeshImportJob& job = import_jobs[i];
+			if (job.data != nullptr)
+			{
+				App->fs->SaveFile(job.data, std::to_string(job.uuid), job.size, IMPORT_DIRECTORY_LIBRARY_MESHES);
+				RELEASE_ARRAY(job.data);
+			}
+		}
+	});
 
-	// Set Info ResoruceMesh
-	std::string fileName = std::to_string(uuid_mesh);
-	res_mesh->InitInfo(name);
-	//std::string path_assets = name;
-	//res_mesh->path_assets = App->fs->GetFullPath(path_assets);
+	import_jobs.clear();
+}
 
-	//Save Mesh
-	App->fs->SaveFile(data, fileName, size, IMPORT_DIRECTORY_LIBRARY_MESHES);
+// Extract the data of the aiMesh and write it with the .mesh v2 layout (worker threads)
+void ImportMesh::SerializeMesh(MeshImportJob& job) const
+{
+	const aiMesh* mesh = job.mesh;
+	uint num_vertices = mesh->mNumVertices;
 
-	RELEASE_ARRAY(data);
+	// SET INDEX DATA -----------------------------------------
+	std::vector<uint> indices;
+	if (mesh->HasFaces())
+	{
+		indices.resize(mesh->mNumFaces * 3);
+		for (uint i = 0; i < mesh->mNumFaces; i++)
+		{
+			memcpy(&indices[i * 3], mesh->mFaces[i].mIndices, sizeof(uint) * 3);
+		}
+	}
 
+	// SET TEX COORD DATA -------------------------------
+	std::vector<float2> tex_coords;
+	if (mesh->mTextureCoords[0])
+	{
+		tex_coords.resize(num_vertices);
+		for (uint i = 0; i < num_vertices; i++)
+		{
+			tex_coords[i].x = mesh->mTextureCoords[0][i].x;
+			tex_coords[i].y = mesh->mTextureCoords[0][i].y;
+		}
+	}
 
-	return ret;
+	// Vertices & normals have the same layout than float3
+	job.data = SaveMeshData(num_vertices, indices.size(), (const float3*)mesh->mVertices, indices.data(),
+		mesh->HasNormals() ? (const float3*)mesh->mNormals : nullptr,
+		(tex_coords.size() > 0) ? tex_coords.data() : nullptr, job.size);
 }
 
 // Import Primitive -----------------------------------------------------------------------------------------------------------------------------
 void ImportMesh::Import(uint num_vertices, uint num_indices, uint num_normals, std::vector<uint> indices, std::vector<float3> vertices, uint uuid)
 {
 	// ALLOCATING DATA INTO BUFFER ------------------------
-	uint ranges[3] = { num_vertices, num_indices, num_normals }; //,num_tex_coords };
-
-	uint size = sizeof(ranges) + sizeof(float3) *  num_vertices + sizeof(uint) * num_indices + sizeof(float3) *  num_normals + sizeof(float2) *  num_vertices;
-
-
-	float3* vert_normals = nullptr;
-	// Allocating all data 
-	char* data = new char[size];
-	char* cursor = data;
-
-	// Storing Ranges
-	uint bytes = sizeof(ranges);
-	memcpy(cursor, ranges, bytes);
-
-	// Storing Vertices
-	float3* vertices_ = new float3[num_vertices];
-	memcpy(vertices_, vertices.data(), sizeof(float3) * num_vertices);
-	cursor += bytes;
-	bytes = sizeof(float3) * num_vertices;
-	memcpy(cursor, vertices_, bytes);
-
-	// Storing Indices
-	uint* indices_ = new uint[num_indices];
-	memcpy(indices_, indices.data(), sizeof(uint) * num_indices);
-	cursor += bytes;
-	bytes = sizeof(uint) * num_indices;
-	memcpy(cursor, indices_, bytes);
+	uint size = 0;
+	char* data = SaveMeshData(num_vertices, num_indices, vertices.data(), indices.data(), nullptr, nullptr, size);
 
 	// Release all pointers
-	RELEASE_ARRAY(vertices_);
-	RELEASE_ARRAY(indices_);
-	RELEASE_ARRAY(vert_normals);
 	indices.clear();
 	vertices.clear();
 
@@ -285,72 +247,297 @@ void ImportMesh::Import(uint num_vertices, uint num_indices, uint num_normals, s
 
 bool ImportMesh::LoadResource(const char* file, ResourceMesh* resourceMesh)
 {
-	char* buffer = nullptr;
-	uint num_vertices = 0;
-	uint num_indices = 0;
-	uint num_normals = 0;
-	//uint num_tex_coords = 0;
-
-	float3* vertices = nullptr;
-	uint* indices = nullptr;
-	float3* vert_normals = nullptr;
-	float2* tex_coords = nullptr;
-	//Texture* texture = nullptr;
-	// Loading File
-	uint size = App->fs->LoadFile(file, &buffer, IMPORT_DIRECTORY_LIBRARY_MESHES);
-
-	if (buffer != nullptr && size > 0)
-	{
-		char* cursor = buffer;
-
-		// Amount vertices, amount indices, amount normals
-		uint ranges[3];
-		uint bytes = sizeof(ranges);
-		memcpy(ranges, cursor, bytes);
-
-		// Set Amounts
-		num_vertices = ranges[0];
-		num_indices = ranges[1];
-		num_normals = ranges[2];
-		//num_tex_coords = ranges[3];
-
-		//Load Vertices
-		cursor += bytes;
-		bytes = sizeof(float3) * num_vertices;
-		vertices = new float3[num_vertices];
-		memcpy(vertices, cursor, bytes);
-
-		//Load Indices
-		cursor += bytes;
-		bytes = sizeof(uint) * num_indices;
-		indices = new uint[num_indices];
-		memcpy(indices, cursor, bytes);
-
-		//Load Normals
-		if (num_normals > 0)
-		{
-			cursor += bytes;
-			bytes = sizeof(float3) * num_normals;
-			vert_normals = new float3[num_normals];
-			memcpy(vert_normals, cursor, bytes);
-		}
+	PROFILE_FUNCTION();
+	// The file stays mapped until the upload, the resource reads the arrays from it (no intermediate copies)
+	MappedFile mapped;
+	if (App->fs->MapFile(file, mapped, IMPORT_DIRECTORY_LIBRARY_MESHES) == false)
+	{
+		return false;
+	}
 
-		//Load Tex Coords
-		cursor += bytes;
-		bytes = sizeof(float2) * num_vertices; //num_tex_coords;
-		tex_coords = new float2[num_vertices];
-		memcpy(tex_coords, cursor, bytes);
+	bool ret = false;
+	if (mapped.size >= sizeof(MeshFileHeader) && *(const uint*)mapped.data == MESH_FILE_ID)
+	{
+		ret = LoadMeshData(mapped.data, mapped.size, resourceMesh);
+	}
+	else
+	{
+		ret = LoadMeshDataOld(mapped.data, mapped.size, resourceMesh);
+	}
 
-		resourceMesh->InitRanges(num_vertices, num_indices, num_normals);
-		resourceMesh->Init(vertices, indices, vert_normals, tex_coords);
+	if (ret)
+	{
 		resourceMesh->LoadToMemory();
-		RELEASE_ARRAY(vertices);
-		RELEASE_ARRAY(indices);
-		RELEASE_ARRAY(vert_normals);
-		RELEASE_ARRAY(tex_coords);
-		//RELEASE_ARRAY(cursor);
 		LOG("Mesh %s Loaded!", file);
 	}
-	RELEASE_ARRAY(buffer);
+
+	App->fs->UnmapFile(mapped);
+	return ret;
+}
+
+// Same as LoadResource without the upload (no GL calls, used by the streaming threads).
+// The data is staged and the triangles hierarchy built, then ResourceMesh::LoadToMemory finishes it.
+bool ImportMesh::PrepareResource(const char* file, ResourceMesh* resourceMesh)
+{
+	PROFILE_FUNCTION();
+	MappedFile mapped;
+	if (App->fs->MapFile(file, mapped, IMPORT_DIRECTORY_LIBRARY_MESHES) == false)
+	{
+		return false;
+	}
+
+	bool ret = false;
+	if (mapped.size >= sizeof(MeshFileHeader) && *(const uint*)mapped.data == MESH_FILE_ID)
+	{
+		ret = LoadMeshData(mapped.data, mapped.size, resourceMesh);
+	}
+	else
+	{
+		ret = LoadMeshDataOld(mapped.data, mapped.size, resourceMesh);
+	}
+
+	if (ret)
+	{
+		resourceMesh->StageUpload();
+		resourceMesh->bvh.Build(resourceMesh->geometry);
+	}
+
+	App->fs->UnmapFile(mapped);
+	return ret;
+}
+
+// Write the mesh with the .mesh v2 layout (see MeshFileHeader), the buffer is released by the caller
+char* ImportMesh::SaveMeshData(uint num_vertices, uint num_indices, const float3* vertices, const uint* indices,
+	const float3* normals, const float2* tex_coords, uint& size) const
+{
+	MeshFileHeader header;
+	header.num_vertices = num_vertices;
+	header.num_indices = num_indices;
+	if (normals != nullptr)
+	{
+		header.flags |= MESH_FILE_NORMALS;
+	}
+	if (tex_coords != nullptr)
+	{
+		header.flags |= MESH_FILE_TEX_COORDS;
+	}
+	if (num_vertices <= 0xFFFF)
+	{
+		header.flags |= MESH_FILE_INDICES_16;
+	}
+
+	// Same scale in all axis, then the modelview can decode the positions without deforming the normals
+	float extent = 1.0f;
+	if (quantize && num_vertices > 0)
+	{
+		header.flags |= MESH_FILE_QUANTIZED;
+
+		AABB box;
+		box.SetNegativeInfinity();
+		box.Enclose(vertices, num_vertices);
+		float3 center = box.CenterPoint();
+		float3 half = box.HalfSize();
+		extent = Max(half.x, Max(half.y, half.z));
+		if (extent <= 0.0f)
+		{
+			extent = 1.0f;
+		}
+
+		header.offset[0] = center.x;
+		header.offset[1] = center.y;
+		header.offset[2] = center.z;
+		header.scale = extent / 32767.0f;
+	}
+
+	bool quantized = (header.flags & MESH_FILE_QUANTIZED) != 0;
+	uint vertex_bytes = quantized ? sizeof(short) * 3 : sizeof(float3);
+	uint normal_bytes = quantized ? sizeof(signed char) * 2 : sizeof(float3);
+	uint tex_coord_bytes = quantized ? sizeof(unsigned short) * 2 : sizeof(float2);
+	uint index_bytes = (header.flags & MESH_FILE_INDICES_16) ? sizeof(unsigned short) : sizeof(uint);
+
+	size = sizeof(header) + vertex_bytes * num_vertices + index_bytes * num_indices;
+	size += (normals != nullptr) ? normal_bytes * num_vertices : 0;
+	size += (tex_coords != nullptr) ? tex_coord_bytes * num_vertices : 0;
+
+	// Allocating all data
+	char* data = new char[size];
+	char* cursor = data;
+
+	// Storing Header
+	memcpy(cursor, &header, sizeof(header));
+	cursor += sizeof(header);
+
+	// Storing Vertices
+	if (quantized)
+	{
+		short* pos = (short*)cursor;
+		float3 center(header.offset);
+		for (uint i = 0; i < num_vertices; i++)
+		{
+			float3 relative = (vertices[i] - center) / extent;
+			pos[i * 3] = FloatToSnorm16(relative.x);
+			pos[i * 3 + 1] = FloatToSnorm16(relative.y);
+			pos[i * 3 + 2] = FloatToSnorm16(relative.z);
+		}
+	}
+	else
+	{
+		memcpy(cursor, vertices, vertex_bytes * num_vertices);
+	}
+	cursor += vertex_bytes * num_vertices;
+
+	// Storing Normals
+	if (normals != nullptr)
+	{
+		if (quantized)
+		{
+			for (uint i = 0; i < num_vertices; i++)
+			{
+				OctEncode(normals[i], (signed char*)cursor + i * 2);
+			}
+		}
+		else
+		{
+			memcpy(cursor, normals, normal_bytes * num_vertices);
+		}
+		cursor += normal_bytes * num_vertices;
+	}
+
+	// Storing Tex Coords
+	if (tex_coords != nullptr)
+	{
+		if (quantized)
+		{
+			unsigned short* tex = (unsigned short*)cursor;
+			for (uint i = 0; i < num_vertices; i++)
+			{
+				tex[i * 2] = FloatToHalf(tex_coords[i].x);
+				tex[i * 2 + 1] = FloatToHalf(tex_coords[i].y);
+			}
+		}
+		else
+		{
+			memcpy(cursor, tex_coords, tex_coord_bytes * num_vertices);
+		}
+		cursor += tex_coord_bytes * num_vertices;
+	}
+
+	// Storing Indices
+	if (header.flags & MESH_FILE_INDICES_16)
+	{
+		unsigned short* ind = (unsigned short*)cursor;
+		for (uint i = 0; i < num_indices; i++)
+		{
+			ind[i] = (unsigned short)indices[i];
+		}
+	}
+	else
+	{
+		memcpy(cursor, indices, index_bytes * num_indices);
+	}
+
+	return data;
+}
+
+bool ImportMesh::LoadMeshData(const char* buffer, uint size, ResourceMesh* resourceMesh) const
+{
+	MeshFileHeader header;
+	memcpy(&header, buffer, sizeof(header));
+	if (header.version > MESH_FILE_VERSION)
+	{
+		LOG("Mesh file version %i not supported (max version %i)", header.version, MESH_FILE_VERSION);
+		return false;
+	}
+
+	bool quantized = (header.flags & MESH_FILE_QUANTIZED) != 0;
+	bool has_normals = (header.flags & MESH_FILE_NORMALS) != 0;
+	bool has_tex_coords = (header.flags & MESH_FILE_TEX_COORDS) != 0;
+	uint num_vertices = header.num_vertices;
+	uint num_indices = header.num_indices;
+
+	uint vertex_bytes = quantized ? sizeof(short) * 3 : sizeof(float3);
+	uint normal_bytes = quantized ? sizeof(signed char) * 2 : sizeof(float3);
+	uint tex_coord_bytes = quantized ? sizeof(unsigned short) * 2 : sizeof(float2);
+	uint index_bytes = (header.flags & MESH_FILE_INDICES_16) ? sizeof(unsigned short) : sizeof(uint);
+
+	uint expected = sizeof(header) + vertex_bytes * num_vertices + index_bytes * num_indices;
+	expected += has_normals ? normal_bytes * num_vertices : 0;
+	expected += has_tex_coords ? tex_coord_bytes * num_vertices : 0;
+	if (size < expected)
+	{
+		LOG("Mesh file is corrupted (%i bytes, expected %i)", size, expected);
+		return false;
+	}
+
+	const char* cursor = buffer + sizeof(header);
+	const char* vertices = cursor;
+	cursor += vertex_bytes * num_vertices;
+
+	const char* normals = nullptr;
+	if (has_normals)
+	{
+		normals = cursor;
+		cursor += normal_bytes * num_vertices;
+	}
+
+	const char* tex_coords = nullptr;
+	if (has_tex_coords)
+	{
+		tex_coords = cursor;
+		cursor += tex_coord_bytes * num_vertices;
+	}
+
+	const char* indices = cursor;
+	bool indices_16 = (header.flags & MESH_FILE_INDICES_16) != 0;
+
+	resourceMesh->InitRanges(num_vertices, num_indices, has_normals ? num_vertices : 0);
+	if (quantized)
+	{
+		resourceMesh->InitQuantized(float3(header.offset), header.scale, (const short*)vertices, indices, indices_16,
+			(const signed char*)normals, (const unsigned short*)tex_coords);
+	}
+	else
+	{
+		resourceMesh->Init((const float3*)vertices, indices, indices_16, (const float3*)normals, (const float2*)tex_coords);
+	}
+	return true;
+}
+
+// Old layout: ranges (vertices, indices, normals) + float arrays
+bool ImportMesh::LoadMeshDataOld(const char* buffer, uint size, ResourceMesh* resourceMesh) const
+{
+	uint ranges[3];
+	if (size < sizeof(ranges))
+	{
+		LOG("Mesh file is corrupted (%i bytes)", size);
+		return false;
+	}
+	memcpy(ranges, buffer, sizeof(ranges));
+
+	// Set Amounts
+	uint num_vertices = ranges[0];
+	uint num_indices = ranges[1];
+	uint num_normals = ranges[2];
+
+	// Primitives were saved without tex coords
+	uint expected = sizeof(ranges) + sizeof(float3) * num_vertices + sizeof(uint) * num_indices + sizeof(float3) * num_normals;
+	if (size < expected)
+	{
+		LOG("Mesh file is corrupted (%i bytes, expected %i)", size, expected);
+		return false;
+	}
+	bool has_tex_coords = (size >= expected + sizeof(float2) * num_vertices);
+
+	const char* cursor = buffer + sizeof(ranges);
+	const float3* vertices = (const float3*)cursor;
+	cursor += sizeof(float3) * num_vertices;
+	const uint* indices = (const uint*)cursor;
+	cursor += sizeof(uint) * num_indices;
+	const float3* vert_normals = (const float3*)cursor;
+	cursor += sizeof(float3) * num_normals;
+	const float2* tex_coords = has_tex_coords ? (const float2*)cursor : nullptr;
+
+	resourceMesh->InitRanges(num_vertices, num_indices, num_normals);
+	resourceMesh->Init(vertices, indices, false, (num_normals > 0) ? vert_normals : nullptr, tex_coords);
 	return true;
 }
@@ -7,6 +7,41 @@
 
 struct Texture;
 class ResourceMesh;
+struct ImportCacheEntry;
+
+// .mesh v2 ------------------------------------------------
+// Header + arrays: positions, normals (optional), tex coords (optional), indices.
+// Quantized: positions are shorts relative to the bounds (pos = offset + pos * scale),
+// normals are octahedral (2 snorm8) and tex coords half floats.
+// Files without the header are the old layout (ranges + float arrays), still loaded.
+#define MESH_FILE_ID 0x48534D43 // "CMSH"
+#define MESH_FILE_VERSION 2
+
+#define MESH_FILE_NORMALS		(1 << 0)
+#define MESH_FILE_TEX_COORDS	(1 << 1)
+#define MESH_FILE_QUANTIZED		(1 << 2)
+#define MESH_FILE_INDICES_16	(1 << 3)
+
+struct MeshFileHeader
+{
+	uint id = MESH_FILE_ID;
+	uint version = MESH_FILE_VERSION;
+	uint flags = 0;
+	uint num_vertices = 0;
+	uint num_indices = 0;
+	float offset[3] = { 0.0f, 0.0f, 0.0f };
+	float scale = 1.0f;
+};
+
+// Mesh of the scene being imported, serialized by ProcessImportJobs
+struct MeshImportJob
+{
+	const aiMesh* mesh = nullptr;
+	uint uuid = 0;
+	char* data = nullptr;
+	uint size = 0;
+	bool cached = false; // Library file reused from the import cache
+};
 
 class ImportMesh
 {
@@ -20,8 +55,21 @@ public:
 	bool Import(const aiScene * scene, const aiMesh* mesh, GameObject* obj, const char* name, uint uuid = 0);
 	void Import(uint num_vertices, uint num_indices, uint num_normals, std::vector<uint> indices, std::vector<float3> vertices, uint uid = 0);
 	bool LoadResource(const char * file, ResourceMesh* resourceMesh);
+	bool PrepareResource(const char * file, ResourceMesh* resourceMesh);
+	void ProcessImportJobs(std::vector<uint>& uuids, const ImportCacheEntry* cached = nullptr);
+	char* SaveMeshData(uint num_vertices, uint num_indices, const float3* vertices, const uint* indices,
+		const float3* normals, const float2* tex_coords, uint& size) const; // Also used by the benchmark
+
+public:
+	bool quantize = true; // Save the meshes with the compact layout
+
+private:
+	void SerializeMesh(MeshImportJob& job) const;
+	bool LoadMeshData(const char* buffer, uint size, ResourceMesh* resourceMesh) const;
+	bool LoadMeshDataOld(const char* buffer, uint size, ResourceMesh* resourceMesh) const;
 
 private:
+	std::vector<MeshImportJob> import_jobs;
 
 };
 
@@ -10,6 +10,7 @@
 #include "CSharpScript.h"
 #include "Globals.h"
 #include "Timer.h"
+#include "Profiler.h"
 
 #include <direct.h>
 #pragma comment(lib, "mono-2.0-sgen.lib")
@@ -73,6 +74,7 @@ void ImportScript::ShutdownMono()
 
 bool ImportScript::Import(const char* file, uint uuid)
 {
+	PROFILE_FUNCTION();
 	uint uuid_script = 0;
 	if (uuid == 0) // if direfent create a new resource with the resource deleted
 	{
@@ -134,6 +136,7 @@ bool ImportScript::Import(const char* file, uint uuid)
 
 bool ImportScript::LoadResource(const char* file, ResourceScript* resourceScript)
 {
+	PROFILE_FUNCTION();
 	if (resourceScript != nullptr)
 	{
 		std::string path_dll;
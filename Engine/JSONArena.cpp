@@ -0,0 +1,118 @@
+#include "JSONArena.h"
+#include "parson.h"
+#include "MemoryTracker.h"
+#include <stdlib.h>
+
+#define JSON_ARENA_ALIGN 16
+
+thread_local JSONArena* JSONArena::current = nullptr;
+
+JSONArena::JSONArena()
+{
+	previous = current;
+	current = this;
+	json_set_allocation_functions(ParsonMalloc, ParsonFree);
+}
+
+JSONArena::~JSONArena()
+{
+	current = previous;
+	Reset();
+}
+
+void* JSONArena::Alloc(size_t size)
+{
+	size = (size + JSON_ARENA_ALIGN - 1) & ~(size_t)(JSON_ARENA_ALIGN - 1);
+	if (blocks.size() == 0 || offset + size > blocks.back().size)
+	{
+		if (NewBlock(size) == false)
+		{
+			return nullptr; // parson handles the failed allocation
+		}
+	}
+
+	void* ptr = blocks.back().data + offset;
+	offset += size;
+	used += size;
+	return ptr;
+}
+
+bool JSONArena::Owns(const void* ptr) const
+{
+	const char* address = (const char*)ptr;
+	for (uint i = 0; i < blocks.size(); i++)
+	{
+		if (address >= blocks[i].data && address < blocks[i].data + blocks[i].size)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Release all the blocks, everything allocated from the arena is invalid after this
+void JSONArena::Reset()
+{
+	for (uint i = 0; i < blocks.size(); i++)
+	{
+		MemoryAdd(MEMORY_JSON, MEMORY_CPU, -(__int64)blocks[i].size);
+		free(blocks[i].data);
+	}
+	blocks.clear();
+	offset = 0;
+	next_size = JSON_ARENA_FIRST_BLOCK;
+	used = 0;
+}
+
+uint JSONArena::GetUsed() const
+{
+	return used;
+}
+
+// Big requests (ex: the text of the file) get a block of their size
+bool JSONArena::NewBlock(size_t min_size)
+{
+	Block block;
+	block.size = (min_size > next_size) ? min_size : next_size;
+	block.data = (char*)malloc(block.size);
+	if (block.data == nullptr)
+	{
+		return false;
+	}
+	blocks.push_back(block);
+	offset = 0;
+	MemoryAdd(MEMORY_JSON, MEMORY_CPU, block.size);
+
+	if (next_size < JSON_ARENA_MAX_BLOCK)
+	{
+		next_size *= 2;
+	}
+	return true;
+}
+
+void* JSONArena::ParsonMalloc(size_t size)
+{
+	if (current != nullptr)
+	{
+		return current->Alloc(size);
+	}
+	return malloc(size);
+}
+
+void JSONArena::ParsonFree(void* ptr)
+{
+	if (ptr == nullptr)
+	{
+		return;
+	}
+
+	// Memory of an arena of this thread is released with the arena
+	for (const JSONArena* arena = current; arena != nullptr; arena = arena->previous)
+	{
+		if (arena->Owns(ptr))
+		{
+			return;
+		}
+	}
+	free(ptr);
+}
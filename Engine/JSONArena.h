@@ -0,0 +1,58 @@
+#ifndef _JSON_ARENA_
+#define _JSON_ARENA_
+
+#include "Globals.h"
+#include <vector>
+
+#define JSON_ARENA_FIRST_BLOCK 65536
+#define JSON_ARENA_MAX_BLOCK 16777216
+
+// JSON Arena ------------------------------------------------------
+// While an arena is alive, parson allocations of its thread come from big
+// blocks (bump pointer) and frees are ignored, then the whole document is
+// released at once when the arena is destroyed.
+// All JSON_Values parsed inside the scope must be finished inside it
+// (strings that are kept have to be copied, like App->GetCharfromConstChar does).
+//	{
+//		JSONArena arena;
+//		JSON_Value* config_file = json_parse_file("Scene_1.json");
+//		...
+//		json_value_free(config_file); // Nothing to do, memory is released with the arena
+//	}
+class JSONArena
+{
+public:
+	JSONArena();
+	~JSONArena();
+
+	void* Alloc(size_t size);
+	bool Owns(const void* ptr) const;
+	void Reset();
+
+	uint GetUsed() const;
+
+private:
+	bool NewBlock(size_t min_size);
+
+	// Installed with json_set_allocation_functions, other threads still use malloc/free
+	static void* ParsonMalloc(size_t size);
+	static void ParsonFree(void* ptr);
+
+private:
+	struct Block
+	{
+		char* data = nullptr;
+		size_t size = 0;
+	};
+
+	std::vector<Block> blocks; // Each block doubles the previous one (only a few to check in Owns)
+	size_t offset = 0; // In the last block
+	size_t next_size = JSON_ARENA_FIRST_BLOCK;
+	uint used = 0;
+
+	JSONArena* previous = nullptr; // Arenas can be nested in the same thread
+
+	static thread_local JSONArena* current;
+};
+
+#endif
@@ -6,6 +6,16 @@
 #include "ModuleResourceManager.h"
 #include "Scene.h"
 #include "GameObject.h"
+#include "CompMesh.h"
+#include "ResourceMesh.h"
+#include "JSONArena.h"
+#include <unordered_map>
+
+// Fields of each GameObject (hash calculated once)
+static const JSON_Key key_name = json_key("Name");
+static const JSON_Key key_uuid = json_key("UUID");
+static const JSON_Key key_parent = json_key("Parent");
+static const JSON_Key key_num_components = json_key("Number of Components");
 
 JSONSerialization::JSONSerialization()
 {
@@ -17,270 +27,80 @@ JSONSerialization::~JSONSerialization()
 	namesScene.clear();
 }
 
-void JSONSerialization::SaveScene()
+void JSONSerialization::SavePrefab(const GameObject& gameObject, const char* directory, const char* fileName)
 {
-	LOG("SAVING SCENE -----");
+	LOG("SAVING PREFAB %s -----", gameObject.GetName());
 
-	JSON_Value* config_file;
-	JSON_Object* config;
-	JSON_Object* config_node;
+	std::string nameJson = directory;
+	nameJson += "/";
+	nameJson +=	gameObject.GetName();
+	nameJson += ".meta.json";
 
-	config_file = json_parse_file("Scene_1.json");
+	writer.Clear();
+	writer.BeginObject();
+	writer.BeginObject("Prefab");
 
 	uint count = 0;
-	uint countResources = 0; // no use!
-	if (config_file != nullptr)
-	{
-		config = json_value_get_object(config_file);
-		config_node = json_object_get_object(config, "Scene");
-		json_object_clear(config_node);
-		json_object_dotset_number_with_std(config_node, "Info.Number of GameObjects", App->scene->gameobjects.size());
+	SaveChildPrefab(gameObject, -1, count);
 
-		// Update GameObjects
-		for (uint i = 0; i < App->scene->gameobjects.size(); i++)
-		{
-			std::string name = "GameObject" + std::to_string(count++);
-			name += ".";
-			// UUID--------
-			json_object_dotset_number_with_std(config_node, name + "UUID", App->scene->gameobjects[i]->GetUUID());
-			// Parent UUID------------
-			json_object_dotset_number_with_std(config_node, name + "Parent", -1);
-			// Name --------
-			json_object_dotset_string_with_std(config_node, name + "Name", App->scene->gameobjects[i]->GetName());
-			// Bounding Box ---------
-			json_object_dotset_boolean_with_std(config_node, name + "Bounding Box", App->scene->gameobjects[i]->isAABBActive());
-			// Static ---------
-			json_object_dotset_boolean_with_std(config_node, name + "Static", App->scene->gameobjects[i]->isStatic());
-
-			// Components  ------------
-			std::string components = name;
-			json_object_dotset_number_with_std(config_node, components + "Number of Components", App->scene->gameobjects[i]->GetNumComponents());
-			if (App->scene->gameobjects[i]->GetNumComponents() > 0)
-			{
-				components += "Components.";
-				App->scene->gameobjects[i]->SaveComponents(config_node, components, true, countResources);
-			}
-			if (App->scene->gameobjects[i]->GetNumChilds() > 0)
-			{
-				for (int j = 0; j < App->scene->gameobjects[i]->GetNumChilds(); j++)
-				{
-					SaveChildGameObject(config_node, *App->scene->gameobjects[i]->GetChildbyIndex(j), count, countResources);
-				}
-			}
-		}
-	}
-	json_object_dotset_number_with_std(config_node, "Info.Number of GameObjects", count);
-	json_serialize_to_file(config_file, "Scene_1.json");
-	json_value_free(config_file);
+	// Info with the resources used (next we use this info for Reimport this prefab)
+	writer.BeginObject("Info");
+	writer.Number("Number of GameObjects", count);
+	writer.String("Directory Prefab", fileName);
+	writer.BeginObject("Resources");
+	uint countResources = 0;
+	SavePrefabResources(gameObject, countResources);
+	writer.Number("Number of Resources", countResources);
+	writer.EndObject();
+	writer.EndObject();
+
+	writer.EndObject();
+	writer.EndObject();
+	writer.SaveFile(nameJson.c_str());
 }
 
-void JSONSerialization::SaveChildGameObject(JSON_Object* config_node, const GameObject& gameObject, uint& count, uint& countResources)
+void JSONSerialization::SaveChildPrefab(const GameObject& gameObject, int uuidParent, uint& count)
 {
-	// Update GameObjects
-	std::string name = "GameObject" + std::to_string(count++);
-	name += ".";
+	writer.BeginObject("GameObject", count++);
 	// UUID--------
-	json_object_dotset_number_with_std(config_node, name + "UUID", gameObject.GetUUID());
+	writer.Number("UUID", gameObject.GetUUID());
 	// Parent UUID------------
-	int uuidParent = -1;
-	if (gameObject.GetParent() != nullptr)
-	{
-		uuidParent = gameObject.GetParent()->GetUUID();
-	}
-	json_object_dotset_number_with_std(config_node, name + "Parent", uuidParent);
+	writer.Number("Parent", uuidParent);
 	// Name- --------
-	json_object_dotset_string_with_std(config_node, name + "Name", gameObject.GetName());
-	// Bounding Box ---------
-	json_object_dotset_boolean_with_std(config_node, name + "Bounding Box", gameObject.isAABBActive());
-	// Static ---------
-	json_object_dotset_boolean_with_std(config_node, name + "Static", gameObject.isStatic());
-
+	writer.String("Name", gameObject.GetName());
 
 	// Components  ------------
-	std::string components = name;
-	json_object_dotset_number_with_std(config_node, components + "Number of Components", gameObject.GetNumComponents());
+	writer.Number("Number of Components", gameObject.GetNumComponents());
 	if (gameObject.GetNumComponents() > 0)
 	{
-		components += "Components.";
-		gameObject.SaveComponents(config_node, components, true, countResources);
-	}
-	if (gameObject.GetNumChilds() > 0)
-	{
-		for (int i = 0; i < gameObject.GetNumChilds(); i++)
-		{
-			SaveChildGameObject(config_node, *gameObject.GetChildbyIndex(i), count, countResources);
-		}
-	}
-}
-
-void JSONSerialization::LoadScene()
-{
-	LOG("LOADING SCENE -----");
-
-	JSON_Value* config_file;
-	JSON_Object* config;
-	JSON_Object* config_node;
-
-	config_file = json_parse_file("Scene_1.json");
-	if (config_file != nullptr)
-	{
-		config = json_value_get_object(config_file);
-		config_node = json_object_get_object(config, "Scene");
-		int NUmberGameObjects = json_object_dotget_number(config_node, "Info.Number of GameObjects");
-		if (NUmberGameObjects > 0)
-		{
-			for (int i = 0; i < NUmberGameObjects; i++)
-			{
-				std::string name = "GameObject" + std::to_string(i);
-				name += ".";
-				char* nameGameObject = App->GetCharfromConstChar(json_object_dotget_string_with_std(config_node, name + "Name"));
-				uint uid = json_object_dotget_number_with_std(config_node, name + "UUID");
-				GameObject* obj = new GameObject(nameGameObject, uid);
-				bool static_obj = json_object_dotget_boolean_with_std(config_node, name + "Static");
-				obj->SetStatic(static_obj);
-				bool aabb_active = json_object_dotget_boolean_with_std(config_node, name + "Bounding Box");
-				obj->SetAABBActive(aabb_active);
-
-				//Load Components
-				int NumberofComponents = json_object_dotget_number_with_std(config_node, name + "Number of Components");
-				if (NumberofComponents > 0)
-				{
-					obj->LoadComponents(config_node, name + "Components.", NumberofComponents);
-				}
-				int uuid_parent = json_object_dotget_number_with_std(config_node, name + "Parent");
-
-				//Add GameObject
-				if (uuid_parent == -1)
-				{
-					App->scene->gameobjects.push_back(obj);
-				}
-				else
-				{
-					for (int x = 0; x < App->scene->gameobjects.size(); x++)
-					{
-						LoadChilds(*App->scene->gameobjects[x], *obj, uuid_parent);
-					}
-				}
-			}
-		}
+		gameObject.SaveComponents(writer, false);
 	}
-	json_value_free(config_file);
-}
+	writer.EndObject();
 
-void JSONSerialization::LoadChilds(GameObject& parent, GameObject& child, int uuidParent)
-{
-	if (parent.GetNumChilds() > 0)
-	{
-		for (int i = 0; i < parent.GetNumChilds(); i++)
-		{
-			if (parent.GetUUID() == uuidParent)
-			{
-				parent.AddChildGameObject_Load(&child);
-				return;
-			}
-			else
-			{
-				LoadChilds(*parent.GetChildbyIndex(i), child, uuidParent);
-			}
-		}
-	}
-	else
+	for (int i = 0; i < gameObject.GetNumChilds(); i++)
 	{
-		if (parent.GetUUID() == uuidParent)
-		{
-			parent.AddChildGameObject_Load(&child);
-			return;
-		}
+		SaveChildPrefab(*gameObject.GetChildbyIndex(i), gameObject.GetUUID(), count);
 	}
 }
 
-
-void JSONSerialization::SavePrefab(const GameObject& gameObject, const char* directory, const char* fileName)
+// Mesh resources in the same order as the GameObjects
+void JSONSerialization::SavePrefabResources(const GameObject& gameObject, uint& countResources)
 {
-	LOG("SAVING PREFAB %s -----", gameObject.GetName());
-
-	JSON_Value* config_file;
-	JSON_Object* config;
-	JSON_Object* config_node;
-
-	std::string nameJson = directory;
-	nameJson += "/";
-	nameJson +=	gameObject.GetName();
-	nameJson += ".meta.json";
-	config_file = json_value_init_object();
-
-	uint count = 0;
-	uint countResources = 0;
-	if (config_file != nullptr)
+	for (int i = 0; i < gameObject.GetNumComponents(); i++)
 	{
-		config = json_value_get_object(config_file);
-		json_object_clear(config);
-		json_object_dotset_number_with_std(config, "Prefab.Info.Number of GameObjects", count);
-		json_object_dotset_string_with_std(config, "Prefab.Info.Directory Prefab", fileName);
-		json_object_dotset_number_with_std(config, "Prefab.Info.Resources.Number of Resources", countResources);
-		config_node = json_object_get_object(config, "Prefab");
-		std::string name = "GameObject" + std::to_string(count++);
-		name += ".";
-		// UUID--------
-		json_object_dotset_number_with_std(config_node, name + "UUID", gameObject.GetUUID());
-		// Parent UUID------------
-		json_object_dotset_number_with_std(config_node, name + "Parent", -1);
-		// Name- --------
-		json_object_dotset_string_with_std(config_node, name + "Name", gameObject.GetName());
-
-		// Components  ------------
-		std::string components = name;
-		json_object_dotset_number_with_std(config_node, components + "Number of Components", gameObject.GetNumComponents());
-		if (gameObject.GetNumComponents() > 0)
+		const Component* component = gameObject.GetComponentbyIndex(i);
+		if (component->GetType() == Comp_Type::C_MESH && ((const CompMesh*)component)->resourceMesh != nullptr)
 		{
-			components += "Components.";
-			gameObject.SaveComponents(config_node, components, false, countResources);
-		}
-		// Childs --------------
-		if (gameObject.GetNumChilds() > 0)
-		{
-			for (int j = 0; j < gameObject.GetNumChilds(); j++)
-			{
-				SaveChildPrefab(config_node, *gameObject.GetChildbyIndex(j), count, countResources);
-			}
+			const ResourceMesh* resource = ((const CompMesh*)component)->resourceMesh;
+			writer.BeginObject("Resource ", countResources++);
+			writer.Number("UUID Resource", resource->GetUUID());
+			writer.String("Name", resource->name);
+			writer.EndObject();
 		}
-		json_object_dotset_number_with_std(config_node, "Info.Number of GameObjects", count);
-		json_object_dotset_number_with_std(config, "Prefab.Info.Resources.Number of Resources", countResources);
-		json_serialize_to_file(config_file, nameJson.c_str());
-	}
-	json_value_free(config_file);
-}
-
-void JSONSerialization::SaveChildPrefab(JSON_Object* config_node, const GameObject& gameObject, uint& count, uint& countResources)
-{
-	// Update GameObjects
-	std::string name = "GameObject" + std::to_string(count++);
-	name += ".";
-	// UUID--------
-	json_object_dotset_number_with_std(config_node, name + "UUID", gameObject.GetUUID());
-	// Parent UUID------------
-	int uuidParent = -1;
-	if (gameObject.GetParent() != nullptr)
-		uuidParent = gameObject.GetParent()->GetUUID();
-
-	json_object_dotset_number_with_std(config_node, name + "Parent", uuidParent);
-	// Name- --------
-	json_object_dotset_string_with_std(config_node, name + "Name", gameObject.GetName());
-
-	// Components  ------------
-	std::string components = name;
-	json_object_dotset_number_with_std(config_node, components + "Number of Components", gameObject.GetNumComponents());
-	if (gameObject.GetNumComponents() > 0)
-	{
-		components += "Components.";
-		gameObject.SaveComponents(config_node, components, false, countResources);
 	}
-	if (gameObject.GetNumChilds() > 0)
+	for (int i = 0; i < gameObject.GetNumChilds(); i++)
 	{
-		for (int i = 0; i < gameObject.GetNumChilds(); i++)
-		{
-			SaveChildPrefab(config_node, *gameObject.GetChildbyIndex(i), count, countResources);
-		}
+		SavePrefabResources(*gameObject.GetChildbyIndex(i), countResources);
 	}
 }
 
@@ -288,6 +108,7 @@ void JSONSerialization::LoadPrefab(const char* prefab)
 {
 	LOG("LOADING PREFAB %s -----", prefab);
 
+	JSONArena arena; // All the document is released at the end
 	JSON_Value* config_file;
 	JSON_Object* config;
 	JSON_Object* config_node;
@@ -310,23 +131,27 @@ void JSONSerialization::LoadPrefab(const char* prefab)
 			// Now GetAll Names from Scene
 			GetAllNames(App->scene->gameobjects);
 
+			// The UUIDs of the file can be already in the scene (same prefab loaded before),
+			// then parents are found in the objects of this prefab only
+			std::unordered_map<uint, GameObject*> loaded;
 			GameObject* mainParent = nullptr;
 			for (int i = 0; i < NUmberGameObjects; i++)
 			{
 				std::string name = "GameObject" + std::to_string(i);
-				name += ".";
-				char* nameGameObject = App->GetCharfromConstChar(json_object_dotget_string_with_std(config_node, name + "Name"));
-				uint uid = json_object_dotget_number_with_std(config_node, name + "UUID");
+				const JSON_Object* node = json_object_get_object(config_node, name.c_str());
+				char* nameGameObject = App->GetCharfromConstChar(json_object_get_string_by_key(node, &key_name));
+				uint uid = json_object_get_number_by_key(node, &key_uuid);
 				GameObject* obj = new GameObject(nameGameObject, uid);
+				loaded[uid] = obj;
 				// Now Check that the name is not repet
 				CheckChangeName(*obj);
 				//Load Components
-				int NumberofComponents = json_object_dotget_number_with_std(config_node, name + "Number of Components");
+				int NumberofComponents = json_object_get_number_by_key(node, &key_num_components);
 				if (NumberofComponents > 0)
 				{
-					obj->LoadComponents(config_node, name + "Components.", NumberofComponents);
+					obj->LoadComponents(node, "Components.", NumberofComponents);
 				}
-				int uuid_parent = json_object_dotget_number_with_std(config_node, name + "Parent");
+				int uuid_parent = json_object_get_number_by_key(node, &key_parent);
 
 				//Add GameObject
 				if (uuid_parent == -1)
@@ -336,7 +161,11 @@ void JSONSerialization::LoadPrefab(const char* prefab)
 				}
 				else
 				{
-					LoadChildLoadPrefab(*mainParent, *obj, uuid_parent);
+					std::unordered_map<uint, GameObject*>::iterator parent = loaded.find(uuid_parent);
+					if (parent != loaded.end())
+					{
+						parent->second->AddChildGameObject_Load(obj);
+					}
 				}
 			}
 			// Now Iterate All GameObjects and Components and create a new UUID!
@@ -352,57 +181,24 @@ void JSONSerialization::LoadPrefab(const char* prefab)
 	json_value_free(config_file);
 }
 
-void JSONSerialization::LoadChildLoadPrefab(GameObject& parent, GameObject& child, int uuidParent)
-{
-	if (parent.GetNumChilds() > 0)
-	{
-		for (int i = 0; i < parent.GetNumChilds(); i++)
-		{
-			if (parent.GetUUID() == uuidParent)
-			{
-				parent.AddChildGameObject_Load(&child);
-				return;
-			}
-			else
-			{
-				LoadChildLoadPrefab(*parent.GetChildbyIndex(i), child, uuidParent);
-			}
-		}
-	}
-	else
-	{
-		if (parent.GetUUID() == uuidParent)
-		{
-			parent.AddChildGameObject_Load(&child);
-			return;
-		}
-	}
-}
-
 void JSONSerialization::SaveMaterial(const ResourceMaterial* material, const char* directory, const char* fileName)
 {
 	LOG("SAVING Material %s -----", material->name);
 
-	JSON_Value* config_file;
-	JSON_Object* config;
-
 	std::string nameJson = directory;
 	nameJson += "/";
 	nameJson += material->name;
 	nameJson += ".meta.json";
-	config_file = json_value_init_object();
 
-	uint count = 0;
-	if (config_file != nullptr)
-	{
-		config = json_value_get_object(config_file);
-		json_object_clear(config);
-		json_object_dotset_string_with_std(config, "Material.Directory Material", fileName);
-		json_object_dotset_number_with_std(config, "Material.UUID Resource", material->GetUUID());
-		json_object_dotset_string_with_std(config, "Material.Name", material->name);
-		json_serialize_to_file(config_file, nameJson.c_str());
-	}
-	json_value_free(config_file);
+	writer.Clear();
+	writer.BeginObject();
+	writer.BeginObject("Material");
+	writer.String("Directory Material", fileName);
+	writer.Number("UUID Resource", material->GetUUID());
+	writer.String("Name", material->name);
+	writer.EndObject();
+	writer.EndObject();
+	writer.SaveFile(nameJson.c_str());
 }
 
 
@@ -413,30 +209,25 @@ void JSONSerialization::SaveScript(const ResourceScript* script, const char * di
 {
 	LOG("SAVING Script %s -----", script->name);
 
-	JSON_Value* config_file;
-	JSON_Object* config;
-
 	std::string nameJson = directory;
 	nameJson += "/";
 	nameJson += script->name;
 	nameJson += ".meta.json";
-	config_file = json_value_init_object();
 
-	uint count = 0;
-	if (config_file != nullptr)
-	{
-		config = json_value_get_object(config_file);
-		json_object_clear(config);
-		json_object_dotset_string_with_std(config, "Material.Directory Script", fileName);
-		json_object_dotset_number_with_std(config, "Material.UUID Resource", script->GetUUID());
-		json_object_dotset_string_with_std(config, "Material.Name", script->name);
-		json_serialize_to_file(config_file, nameJson.c_str());
-	}
-	json_value_free(config_file);
+	writer.Clear();
+	writer.BeginObject();
+	writer.BeginObject("Material");
+	writer.String("Directory Script", fileName);
+	writer.Number("UUID Resource", script->GetUUID());
+	writer.String("Name", script->name);
+	writer.EndObject();
+	writer.EndObject();
+	writer.SaveFile(nameJson.c_str());
 }
 
 ReImport JSONSerialization::GetUUIDPrefab(const char* file, uint id)
 {
+	JSONArena arena;
 	JSON_Value* config_file;
 	JSON_Object* config;
 	JSON_Object* config_node;
@@ -450,14 +241,16 @@ ReImport JSONSerialization::GetUUIDPrefab(const char* file, uint id)
 	{
 		config = json_value_get_object(config_file);
 		config_node = json_object_get_object(config, "Prefab");
-		std::string temp = "Info.Resources";
-		int numResources = json_object_dotget_number_with_std(config_node, temp + ".Number of Resources");
-		info.directoryObj = App->fs->ConverttoConstChar(json_object_dotget_string_with_std(config, "Prefab.Info.Directory Prefab"));
+		JSON_Object* info_node = json_object_get_object(config_node, "Info");
+		JSON_Object* resources = json_object_get_object(info_node, "Resources");
+		int numResources = json_object_get_number(resources, "Number of Resources");
+		info.directoryObj = App->fs->ConverttoConstChar(json_object_get_string(info_node, "Directory Prefab"));
 		if (id < numResources)
 		{
-			temp += ".Resource " + std::to_string(id);
-			info.uuid = json_object_dotget_number_with_std(config_node, temp + ".UUID Resource");
-			info.nameMesh = App->fs->ConverttoConstChar(json_object_dotget_string_with_std(config_node, temp + ".Name"));
+			std::string temp = "Resource " + std::to_string(id);
+			JSON_Object* resource = json_object_get_object(resources, temp.c_str());
+			info.uuid = json_object_get_number(resource, "UUID Resource");
+			info.nameMesh = App->fs->ConverttoConstChar(json_object_get_string(resource, "Name"));
 			if (strcmp(file, info.directoryObj) == 0)
 			{
 				json_value_free(config_file);
@@ -476,6 +269,7 @@ ReImport JSONSerialization::GetUUIDPrefab(const char* file, uint id)
 
 ReImport JSONSerialization::GetUUIDMaterial(const char* file)
 {
+	JSONArena arena;
 	JSON_Value* config_file;
 	JSON_Object* config;
 
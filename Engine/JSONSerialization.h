@@ -3,6 +3,7 @@
 
 #include "parson.h"
 #include "Globals.h"
+#include "JSONWriter.h"
 #include <vector>
 
 class GameObject;
@@ -16,18 +17,14 @@ public:
 	JSONSerialization();
 	~JSONSerialization();
 
-	// SAVE & LOAD SCENE --------------------------
-	void SaveScene();
-	void SaveChildGameObject(JSON_Object* config_node, const GameObject& gameObject, uint& count, uint& countResources);
-	void LoadScene();
-	void LoadChilds(GameObject& parent, GameObject& child, int uuidParent);
-	// --------------------------------------
+	// Scenes are saved in binary (BinarySerialization), old JSON scenes are
+	// converted with BinarySerialization::ConvertScene
 
 	// SAVE & LOAD PREFAB --------------------------
 	void SavePrefab(const GameObject& gameObject, const char* directory, const char* fileName);
-	void SaveChildPrefab(JSON_Object* config_node, const GameObject& gameObject, uint& count, uint& countResources);
+	void SaveChildPrefab(const GameObject& gameObject, int uuidParent, uint& count);
+	void SavePrefabResources(const GameObject& gameObject, uint& countResources);
 	void LoadPrefab(const char* prefab);
-	void LoadChildLoadPrefab(GameObject& parent, GameObject& child, int uuidParent);
 	// --------------------------------------
 
 	// SAVE & LOAD MATERIAL --------------------------
@@ -54,6 +51,7 @@ private:
 
 private:
 	std::vector<const char*> namesScene;
+	JSONWriter writer; // Buffer reused by all saves
 };
 
 #endif
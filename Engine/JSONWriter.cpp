@@ -0,0 +1,229 @@
+#include "JSONWriter.h"
+#include "MemoryTracker.h"
+#include <stdio.h>
+#include <string.h>
+
+#define JSON_NUMBER_FORMAT "%1.17g" // Same as parson
+
+JSONWriter::JSONWriter()
+{
+	buffer.reserve(JSON_WRITER_RESERVE);
+	Clear();
+}
+
+JSONWriter::~JSONWriter()
+{
+	MemoryAdd(MEMORY_JSON, MEMORY_CPU, -(__int64)reported);
+}
+
+void JSONWriter::Clear()
+{
+	buffer.clear();
+	buffer.push_back('\0');
+	first.clear();
+	MemoryAdd(MEMORY_JSON, MEMORY_CPU, (__int64)buffer.capacity() - reported);
+	reported = buffer.capacity();
+}
+
+void JSONWriter::BeginObject()
+{
+	Separator();
+	Append("{", 1);
+	first.push_back(true);
+}
+
+void JSONWriter::BeginObject(const char* name)
+{
+	Name(name);
+	Append("{", 1);
+	first.push_back(true);
+}
+
+void JSONWriter::BeginObject(const char* name, uint index)
+{
+	Name(name, index);
+	Append("{", 1);
+	first.push_back(true);
+}
+
+void JSONWriter::EndObject()
+{
+	Append("}", 1);
+	if (first.size() > 0)
+	{
+		first.pop_back();
+	}
+}
+
+void JSONWriter::BeginArray(const char* name)
+{
+	Name(name);
+	Append("[", 1);
+	first.push_back(true);
+}
+
+void JSONWriter::EndArray()
+{
+	Append("]", 1);
+	if (first.size() > 0)
+	{
+		first.pop_back();
+	}
+}
+
+void JSONWriter::Number(const char* name, double value)
+{
+	Name(name);
+	char number[32];
+	int length = sprintf_s(number, sizeof(number), JSON_NUMBER_FORMAT, value);
+	Append(number, length > 0 ? length : 0);
+}
+
+void JSONWriter::Number(double value)
+{
+	Separator();
+	char number[32];
+	int length = sprintf_s(number, sizeof(number), JSON_NUMBER_FORMAT, value);
+	Append(number, length > 0 ? length : 0);
+}
+
+void JSONWriter::String(const char* name, const char* value)
+{
+	Name(name);
+	Escaped(value != nullptr ? value : "");
+}
+
+void JSONWriter::Boolean(const char* name, bool value)
+{
+	Name(name);
+	if (value)
+	{
+		Append("true", 4);
+	}
+	else
+	{
+		Append("false", 5);
+	}
+}
+
+void JSONWriter::Floats(const char* name, const float* values, uint count)
+{
+	BeginArray(name);
+	for (uint i = 0; i < count; i++)
+	{
+		Number(values[i]);
+	}
+	EndArray();
+}
+
+bool JSONWriter::SaveFile(const char* file) const
+{
+	FILE* fp = nullptr;
+	if (fopen_s(&fp, file, "w") != 0 || fp == nullptr)
+	{
+		LOG("[error] Can't open %s to write.", file);
+		return false;
+	}
+
+	uint size = GetSize();
+	bool ret = fwrite(buffer.data(), 1, size, fp) == size;
+	fclose(fp);
+	return ret;
+}
+
+const char* JSONWriter::GetBuffer() const
+{
+	return buffer.data();
+}
+
+uint JSONWriter::GetSize() const
+{
+	return buffer.size() - 1;
+}
+
+void JSONWriter::Name(const char* name)
+{
+	Separator();
+	Escaped(name);
+	Append(":", 1);
+}
+
+void JSONWriter::Name(const char* name, uint index)
+{
+	char full_name[128];
+	sprintf_s(full_name, sizeof(full_name), "%s%u", name, index);
+	Name(full_name);
+}
+
+// Comma before all values except the first one of each object/array
+void JSONWriter::Separator()
+{
+	if (first.size() == 0)
+	{
+		return;
+	}
+	if (first.back())
+	{
+		first.back() = false;
+	}
+	else
+	{
+		Append(",", 1);
+	}
+}
+
+void JSONWriter::Escaped(const char* string)
+{
+	static const char hex[] = "0123456789abcdef";
+
+	Append("\"", 1);
+	const char* start = string;
+	for (const char* c = string; *c != '\0'; c++)
+	{
+		const char* escape = nullptr;
+		char unicode[7] = { '\\', 'u', '0', '0', hex[(*c >> 4) & 0xF], hex[*c & 0xF], '\0' };
+		switch (*c)
+		{
+		case '\"': escape = "\\\""; break;
+		case '\\': escape = "\\\\"; break;
+		case '/': escape = "\\/"; break;
+		case '\b': escape = "\\b"; break;
+		case '\f': escape = "\\f"; break;
+		case '\n': escape = "\\n"; break;
+		case '\r': escape = "\\r"; break;
+		case '\t': escape = "\\t"; break;
+		default:
+			if ((uchar)*c < 0x20)
+			{
+				escape = unicode;
+			}
+			break;
+		}
+
+		// Copy the characters without escape in one go
+		if (escape != nullptr)
+		{
+			Append(start, c - start);
+			Append(escape, strlen(escape));
+			start = c + 1;
+		}
+	}
+	const char* end = string + strlen(string);
+	Append(start, end - start);
+	Append("\"", 1);
+}
+
+// The buffer always ends with '\0', new text is inserted before it
+void JSONWriter::Append(const char* string, uint length)
+{
+	if (length == 0)
+	{
+		return;
+	}
+	buffer.insert(buffer.end() - 1, string, string + length);
+	if (buffer.capacity() != reported)
+	{
+		MemoryAdd(MEMORY_JSON, MEMORY_CPU, (__int64)buffer.capacity() - reported);
+		reported = buffer.capacity();
+	}
+}
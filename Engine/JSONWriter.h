@@ -0,0 +1,55 @@
+#ifndef _JSON_WRITER_
+#define _JSON_WRITER_
+
+#include "Globals.h"
+#include <vector>
+
+#define JSON_WRITER_RESERVE 65536
+
+// JSON Writer -----------------------------------------------------
+// Writes the JSON text directly (compact, same format as parson) into a buffer
+// that is reused between saves. No DOM is built, then saving a big scene only
+// needs the memory of the text. Names are written as they are (no dot notation).
+// Functions with a name are for object members, without name for array values.
+class JSONWriter
+{
+public:
+	JSONWriter();
+	~JSONWriter();
+
+	void Clear();
+
+	void BeginObject();
+	void BeginObject(const char* name);
+	void BeginObject(const char* name, uint index); // name + index, ex: "GameObject" 3 -> "GameObject3"
+	void EndObject();
+
+	void BeginArray(const char* name);
+	void EndArray();
+
+	void Number(const char* name, double value);
+	void String(const char* name, const char* value);
+	void Boolean(const char* name, bool value);
+	void Floats(const char* name, const float* values, uint count); // array of numbers
+	void Number(double value);
+
+	bool SaveFile(const char* file) const;
+
+	// Null terminated
+	const char* GetBuffer() const;
+	uint GetSize() const;
+
+private:
+	void Name(const char* name);
+	void Name(const char* name, uint index);
+	void Separator();
+	void Escaped(const char* string);
+	void Append(const char* string, uint length);
+
+private:
+	std::vector<char> buffer;
+	std::vector<bool> first; // One per open object/array, true until it has a value
+	uint reported = 0; // Capacity of the buffer added to MEMORY_JSON
+};
+
+#endif
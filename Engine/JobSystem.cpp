@@ -0,0 +1,357 @@
+#include "JobSystem.h"
+#include "PerfTimer.h"
+#include "Profiler.h"
+#include "ImGui/imgui.h"
+#include <assert.h>
+
+// JOB GRAPH -----------------------------------------
+JobGraph::JobGraph()
+{
+}
+
+JobGraph::~JobGraph()
+{
+	Clear();
+}
+
+Job* JobGraph::Add(const char* name, std::function<void()> function)
+{
+	jobs.emplace_back();
+	Job* job = &jobs.back();
+	job->name = (name != nullptr) ? name : "Job";
+	job->function = function;
+	job->dependencies = 0;
+	return job;
+}
+
+void JobGraph::Depends(Job* job, Job* dependency)
+{
+	if (job == nullptr || dependency == nullptr || job == dependency)
+	{
+		return;
+	}
+	job->dependencies++;
+	dependency->dependents.push_back(job);
+}
+
+void JobGraph::Clear()
+{
+	jobs.clear();
+}
+
+uint JobGraph::GetNumJobs() const
+{
+	return jobs.size();
+}
+// ---------------------------------------------------
+
+// JOB SYSTEM ----------------------------------------
+JobSystem::JobSystem()
+{
+	num_queued = 0;
+	num_remaining = 0;
+	running = false;
+	queues.push_back(new WorkQueue()); // Main thread
+}
+
+JobSystem::~JobSystem()
+{
+	Stop();
+	for (uint i = 0; i < queues.size(); i++)
+	{
+		RELEASE(queues[i]);
+	}
+	queues.clear();
+}
+
+void JobSystem::Start(uint num_threads)
+{
+	if (threads.size() > 0)
+	{
+		return;
+	}
+
+	// The main thread also runs jobs
+	if (num_threads == 0)
+	{
+		uint cores = std::thread::hardware_concurrency();
+		num_threads = (cores > 1) ? cores - 1 : 0;
+	}
+	num_threads = (num_threads > JOBS_MAX_THREADS) ? JOBS_MAX_THREADS : num_threads;
+
+	quit = false;
+	for (uint i = 0; i < num_threads; i++)
+	{
+		queues.push_back(new WorkQueue());
+	}
+	for (uint i = 0; i < num_threads; i++)
+	{
+		threads.push_back(std::thread(&JobSystem::Work, this, i + 1));
+	}
+	LOG("Job system: %i worker threads", num_threads);
+}
+
+void JobSystem::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		quit = true;
+	}
+	sleep_cond.notify_all();
+
+	for (uint i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+	threads.clear();
+
+	// Keep only the queue of the main thread
+	for (uint i = 1; i < queues.size(); i++)
+	{
+		RELEASE(queues[i]);
+	}
+	queues.resize(1);
+}
+
+void JobSystem::Run(JobGraph& graph)
+{
+	if (graph.jobs.size() == 0)
+	{
+		return;
+	}
+	assert(running == false && "JobSystem::Run called from a job");
+	running = true;
+
+	// Find the first jobs before pushing any, a finished job could release others meanwhile
+	std::vector<Job*> ready;
+	for (uint i = 0; i < graph.jobs.size(); i++)
+	{
+		if (graph.jobs[i].dependencies == 0)
+		{
+			ready.push_back(&graph.jobs[i]);
+		}
+	}
+
+	num_remaining += graph.jobs.size();
+	for (uint i = 0; i < ready.size(); i++)
+	{
+		Push(0, ready[i]);
+	}
+
+	// Help the workers until all the jobs are finished
+	while (num_remaining > 0)
+	{
+		Job* job = Pop(0);
+		if (job != nullptr)
+		{
+			Execute(job, 0);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	graph.Clear();
+	running = false;
+}
+
+void JobSystem::ParallelFor(const char* name, uint count, uint grain, const std::function<void(uint begin, uint end)>& function)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// Nested calls would add jobs to the graph being run (and records to the queue of the main thread)
+	assert(running == false && "JobSystem::ParallelFor called from a job");
+	if (running)
+	{
+		function(0, count);
+		return;
+	}
+
+	PROFILE_SCOPE(name);
+	grain = (grain > 0) ? grain : JOBS_DEFAULT_GRAIN;
+	if (count <= grain || threads.size() == 0)
+	{
+		PerfTimer timer;
+		function(0, count);
+
+		JobRecord record;
+		record.name = (name != nullptr) ? name : "Job";
+		record.ms = timer.ReadMs();
+		queues[0]->records.push_back(record);
+		return;
+	}
+
+	for (uint begin = 0; begin < count; begin += grain)
+	{
+		uint end = (begin + grain < count) ? begin + grain : count;
+		parallel_for.Add(name, [&function, begin, end]() { function(begin, end); });
+	}
+	Run(parallel_for);
+}
+
+void JobSystem::BeginFrame()
+{
+	for (uint i = 0; i < queues.size(); i++)
+	{
+		queues[i]->records.clear();
+	}
+}
+
+// Group the records of the frame by job name (workers are idle between graphs)
+void JobSystem::EndFrame()
+{
+	last_frame.clear();
+	for (uint q = 0; q < queues.size(); q++)
+	{
+		const std::vector<JobRecord>& records = queues[q]->records;
+		for (uint i = 0; i < records.size(); i++)
+		{
+			JobTiming* timing = nullptr;
+			for (uint t = 0; t < last_frame.size(); t++)
+			{
+				if (last_frame[t].name == records[i].name)
+				{
+					timing = &last_frame[t];
+					break;
+				}
+			}
+			if (timing == nullptr)
+			{
+				last_frame.push_back(JobTiming());
+				timing = &last_frame.back();
+				timing->name = records[i].name;
+			}
+
+			timing->total_ms += records[i].ms;
+			timing->max_ms = (records[i].ms > timing->max_ms) ? records[i].ms : timing->max_ms;
+			timing->count++;
+			timing->threads |= 1u << q;
+		}
+	}
+}
+
+void JobSystem::ShowPerformance()
+{
+	if (ImGui::TreeNodeEx("JOBS"))
+	{
+		ImGui::Text("Worker threads: %i", threads.size());
+		for (uint i = 0; i < last_frame.size(); i++)
+		{
+			const JobTiming& timing = last_frame[i];
+			uint num_threads = 0;
+			for (uint bits = timing.threads; bits != 0; bits &= bits - 1)
+			{
+				num_threads++;
+			}
+			ImGui::TextColored(ImVec4(0.25f, 1.00f, 0.00f, 1.00f), "%s - %.4f ms", timing.name.c_str(), timing.total_ms);
+			ImGui::SameLine();
+			ImGui::Text("(%i jobs, max %.4f ms, %i threads)", timing.count, timing.max_ms, num_threads);
+		}
+		ImGui::TreePop();
+	}
+}
+
+uint JobSystem::GetNumThreads() const
+{
+	return threads.size();
+}
+
+void JobSystem::Work(uint index)
+{
+	char thread_name[PROFILER_NAME_SIZE];
+	snprintf(thread_name, PROFILER_NAME_SIZE, "Worker %i", index);
+	Profiler::SetThreadName(thread_name);
+
+	while (true)
+	{
+		Job* job = Pop(index);
+		if (job != nullptr)
+		{
+			Execute(job, index);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		sleep_cond.wait(lock, [this]() { return quit || num_queued > 0; });
+		if (quit)
+		{
+			return;
+		}
+	}
+}
+
+void JobSystem::Push(uint index, Job* job)
+{
+	{
+		std::lock_guard<std::mutex> lock(queues[index]->mutex);
+		queues[index]->jobs.push_back(job);
+	}
+
+	// Lock so a worker going to sleep can't miss the notification
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		num_queued++;
+	}
+	sleep_cond.notify_one();
+}
+
+// Own queue first (last pushed, still in cache), then steal the oldest job of the others
+Job* JobSystem::Pop(uint index)
+{
+	Job* job = nullptr;
+	{
+		WorkQueue* queue = queues[index];
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (queue->jobs.size() > 0)
+		{
+			job = queue->jobs.back();
+			queue->jobs.pop_back();
+		}
+	}
+
+	for (uint i = 1; i < queues.size() && job == nullptr; i++)
+	{
+		WorkQueue* queue = queues[(index + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (queue->jobs.size() > 0)
+		{
+			job = queue->jobs.front();
+			queue->jobs.pop_front();
+		}
+	}
+
+	if (job != nullptr)
+	{
+		num_queued--;
+	}
+	return job;
+}
+
+void JobSystem::Execute(Job* job, uint index)
+{
+	PerfTimer timer;
+	{
+		PROFILE_SCOPE(job->name);
+		job->function();
+	}
+
+	JobRecord record;
+	record.name = job->name;
+	record.ms = timer.ReadMs();
+	queues[index]->records.push_back(record);
+
+	// Release the jobs waiting this one
+	for (uint i = 0; i < job->dependents.size(); i++)
+	{
+		if (--job->dependents[i]->dependencies == 0)
+		{
+			Push(index, job->dependents[i]);
+		}
+	}
+	num_remaining--;
+}
+// ---------------------------------------------------
@@ -0,0 +1,117 @@
+#ifndef _JOB_SYSTEM_
+#define _JOB_SYSTEM_
+
+#include "Globals.h"
+#include <vector>
+#include <deque>
+#include <string>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define JOBS_MAX_THREADS 31
+#define JOBS_DEFAULT_GRAIN 256
+
+struct Job
+{
+	const char* name = nullptr;
+	std::function<void()> function;
+	std::atomic<int> dependencies;	/* Jobs that must finish before this one */
+	std::vector<Job*> dependents;	/* Jobs waiting this one */
+};
+
+// Jobs of one frame phase and their dependencies -----------
+// The graph owns the jobs until JobSystem::Run() finishes them.
+class JobGraph
+{
+public:
+	JobGraph();
+	~JobGraph();
+
+	Job* Add(const char* name, std::function<void()> function);
+
+	// 'job' won't start until 'dependency' is finished
+	void Depends(Job* job, Job* dependency);
+
+	void Clear();
+	uint GetNumJobs() const;
+
+private:
+	friend class JobSystem;
+	std::deque<Job> jobs; // Addresses don't change when adding more jobs
+};
+
+// Work-stealing job scheduler ------------------------------
+// Each thread pushes & pops its own queue from the back and steals from the front
+// of the other queues. The main thread works too while it waits a graph, so with
+// 0 worker threads everything runs serially in the main thread.
+// Graphs are only run from the main thread, jobs can't start other graphs or ParallelFor.
+class JobSystem
+{
+public:
+	JobSystem();
+	~JobSystem();
+
+	void Start(uint num_threads = 0); // 0 = depends on the CPU
+	void Stop();
+
+	// Run all the jobs of the graph (respecting the dependencies) and wait them, the graph is cleared after
+	void Run(JobGraph& graph);
+
+	// Split [0, count) in jobs of 'grain' elements and wait them (small ranges run in the calling thread).
+	// Not from a job: all the calls share the same graph.
+	void ParallelFor(const char* name, uint count, uint grain, const std::function<void(uint begin, uint end)>& function);
+
+	// Timings of the jobs are grouped by name for each frame
+	void BeginFrame();
+	void EndFrame();
+	void ShowPerformance();
+
+	uint GetNumThreads() const;
+
+private:
+	void Work(uint index);
+	void Push(uint index, Job* job);
+	Job* Pop(uint index);
+	void Execute(Job* job, uint index);
+
+private:
+	struct JobRecord
+	{
+		const char* name = nullptr;
+		double ms = 0.0;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		std::deque<Job*> jobs;
+		std::vector<JobRecord> records; /* Only written by the thread of the queue */
+	};
+
+	struct JobTiming
+	{
+		std::string name;
+		double total_ms = 0.0;
+		double max_ms = 0.0;
+		uint count = 0;
+		uint threads = 0; /* Bitmask of the threads that ran it */
+	};
+
+	std::vector<std::thread> threads;
+	std::vector<WorkQueue*> queues; /* 0 = main thread */
+
+	std::mutex sleep_mutex;
+	std::condition_variable sleep_cond;
+	std::atomic<int> num_queued;
+	std::atomic<int> num_remaining;
+	bool quit = false;
+	std::atomic<bool> running;	/* A graph is being run, nested Run/ParallelFor are not allowed */
+
+	std::vector<JobTiming> last_frame;
+	JobGraph parallel_for;
+};
+
+#endif
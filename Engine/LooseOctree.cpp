@@ -0,0 +1,365 @@
+#include "LooseOctree.h"
+#include "GameObject.h"
+#include "GL3W/include/glew.h"
+
+LooseOctree::LooseOctree()
+{
+}
+
+LooseOctree::~LooseOctree()
+{
+	Clear();
+}
+
+void LooseOctree::Init(const float3& center, float half_size, uint max_depth)
+{
+	// Keep the objects already inserted
+	std::vector<GameObject*> objects;
+	CollectObjects(objects);
+	Clear();
+
+	this->max_depth = max_depth;
+
+	LooseOctreeNode root;
+	root.center = center;
+	root.half_size = half_size;
+	nodes.push_back(root);
+	num_nodes = 1;
+
+	for (uint i = 0; i < objects.size(); i++)
+	{
+		objects[i]->octree_handle = OCTREE_NONE;
+		Insert(objects[i]);
+	}
+}
+
+void LooseOctree::Clear()
+{
+	for (uint i = 0; i < items.size(); i++)
+	{
+		if (items[i].object != nullptr)
+		{
+			items[i].object->octree_handle = OCTREE_NONE;
+		}
+	}
+
+	nodes.clear();
+	free_blocks.clear();
+	items.clear();
+	free_items.clear();
+	inserted.clear();
+	num_objects = 0;
+	num_nodes = 0;
+}
+
+void LooseOctree::Insert(GameObject* obj)
+{
+	if (nodes.size() == 0 || obj->bounding_box == nullptr)
+	{
+		return;
+	}
+
+	if (obj->octree_handle != OCTREE_NONE)
+	{
+		Move(obj);
+		return;
+	}
+
+	int handle = 0;
+	if (free_items.size() > 0)
+	{
+		handle = free_items.back();
+		free_items.pop_back();
+	}
+	else
+	{
+		handle = items.size();
+		items.push_back(LooseOctreeItem());
+	}
+
+	items[handle].object = obj;
+	obj->octree_handle = handle;
+	Link(handle, FindNode(obj->box_fixed));
+	num_objects++;
+
+	// Keep the list bounded, if it grows too much just send all objects
+	inserted.push_back(handle);
+	if (inserted.size() > items.size())
+	{
+		inserted.clear();
+		for (uint i = 0; i < items.size(); i++)
+		{
+			if (items[i].object != nullptr)
+			{
+				inserted.push_back(i);
+			}
+		}
+	}
+}
+
+void LooseOctree::Remove(GameObject* obj)
+{
+	int handle = obj->octree_handle;
+	if (handle == OCTREE_NONE || handle >= (int)items.size() || items[handle].object != obj)
+	{
+		return;
+	}
+
+	int node = items[handle].node;
+	Unlink(handle);
+	ReleaseEmpty(node);
+	items[handle].object = nullptr;
+	free_items.push_back(handle);
+	obj->octree_handle = OCTREE_NONE;
+	num_objects--;
+}
+
+void LooseOctree::Move(GameObject* obj)
+{
+	int handle = obj->octree_handle;
+	if (handle == OCTREE_NONE)
+	{
+		Insert(obj);
+		return;
+	}
+
+	int node = FindNode(obj->box_fixed);
+	int old_node = items[handle].node;
+	if (node != old_node)
+	{
+		// Release the empty branch after linking, this way the common parents don't release the new node
+		Unlink(handle);
+		Link(handle, node);
+		ReleaseEmpty(old_node);
+	}
+}
+
+GameObject* LooseOctree::GetObjectByHandle(int handle) const
+{
+	if (handle < 0 || handle >= (int)items.size())
+	{
+		return nullptr;
+	}
+	return items[handle].object;
+}
+
+uint LooseOctree::GetNumObjects() const
+{
+	return num_objects;
+}
+
+uint LooseOctree::GetNumNodes() const
+{
+	return num_nodes;
+}
+
+uint LooseOctree::GetMemory() const
+{
+	return nodes.capacity() * sizeof(LooseOctreeNode) + items.capacity() * sizeof(LooseOctreeItem) +
+		(free_blocks.capacity() + free_items.capacity() + inserted.capacity() + stack.capacity()) * sizeof(int);
+}
+
+void LooseOctree::CollectInserted(std::vector<int>& handles)
+{
+	handles.insert(handles.end(), inserted.begin(), inserted.end());
+	inserted.clear();
+}
+
+void LooseOctree::CollectObjects(std::vector<GameObject*>& objects) const
+{
+	for (uint i = 0; i < items.size(); i++)
+	{
+		if (items[i].object != nullptr)
+		{
+			objects.push_back(items[i].object);
+		}
+	}
+}
+
+void LooseOctree::DebugDraw() const
+{
+	glBegin(GL_LINES);
+	glLineWidth(3.0f);
+	glColor4f(0.00f, 0.761f, 1.00f, 1.00f);
+
+	// Only draw cells with objects
+	for (uint i = 0; i < nodes.size(); i++)
+	{
+		if (nodes[i].num_items > 0)
+		{
+			AABB box;
+			box.SetFromCenterAndSize(nodes[i].center, float3(nodes[i].half_size * 2.0f));
+			for (uint e = 0; e < 12; e++)
+			{
+				glVertex3f(box.Edge(e).a.x, box.Edge(e).a.y, box.Edge(e).a.z);
+				glVertex3f(box.Edge(e).b.x, box.Edge(e).b.y, box.Edge(e).b.z);
+			}
+		}
+	}
+
+	glEnd();
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+}
+
+// Go down from the root to the deepest cell that contains the center of the box
+// while the box still fits inside the loose bounds of the child
+int LooseOctree::FindNode(const AABB& box)
+{
+	float3 center = box.CenterPoint();
+	float3 half = box.HalfSize();
+	float radius = Max(half.x, Max(half.y, half.z));
+
+	int node = 0;
+	float3 offset = center - nodes[0].center;
+	float root_size = nodes[0].half_size;
+
+	// Objects out of the limits stay in the root
+	if (Abs(offset.x) > root_size || Abs(offset.y) > root_size || Abs(offset.z) > root_size)
+	{
+		return node;
+	}
+
+	for (uint depth = 0; depth < max_depth; depth++)
+	{
+		float child_half = nodes[node].half_size * 0.5f;
+		if (radius > child_half)
+		{
+			break;
+		}
+
+		if (nodes[node].childs == OCTREE_NONE)
+		{
+			CreateChilds(node);
+		}
+
+		int child = 0;
+		if (center.x >= nodes[node].center.x) child |= 1;
+		if (center.y >= nodes[node].center.y) child |= 2;
+		if (center.z >= nodes[node].center.z) child |= 4;
+		node = nodes[node].childs + child;
+	}
+
+	return node;
+}
+
+void LooseOctree::CreateChilds(int node)
+{
+	int block = 0;
+	if (free_blocks.size() > 0)
+	{
+		block = free_blocks.back();
+		free_blocks.pop_back();
+	}
+	else
+	{
+		block = nodes.size();
+		nodes.resize(nodes.size() + 8);
+	}
+
+	float half = nodes[node].half_size * 0.5f;
+	float3 center = nodes[node].center;
+
+	for (int i = 0; i < 8; i++)
+	{
+		LooseOctreeNode& child = nodes[block + i];
+		child = LooseOctreeNode();
+		child.parent = node;
+		child.half_size = half;
+		child.center.Set(center.x + ((i & 1) ? half : -half),
+			center.y + ((i & 2) ? half : -half),
+			center.z + ((i & 4) ? half : -half));
+	}
+
+	nodes[node].childs = block;
+	num_nodes += 8;
+}
+
+// Return the childs block to the pool (all of them have to be empty)
+void LooseOctree::ReleaseChilds(int node)
+{
+	int block = nodes[node].childs;
+	if (block == OCTREE_NONE)
+	{
+		return;
+	}
+
+	for (int i = 0; i < 8; i++)
+	{
+		ReleaseChilds(block + i);
+	}
+
+	nodes[node].childs = OCTREE_NONE;
+	free_blocks.push_back(block);
+	num_nodes -= 8;
+}
+
+void LooseOctree::Link(int item, int node)
+{
+	LooseOctreeItem& it = items[item];
+	it.node = node;
+	it.prev = OCTREE_NONE;
+	it.next = nodes[node].first_item;
+	if (it.next != OCTREE_NONE)
+	{
+		items[it.next].prev = item;
+	}
+	nodes[node].first_item = item;
+	nodes[node].num_items++;
+
+	for (int n = node; n != OCTREE_NONE; n = nodes[n].parent)
+	{
+		nodes[n].num_total++;
+	}
+}
+
+void LooseOctree::Unlink(int item)
+{
+	LooseOctreeItem& it = items[item];
+	int node = it.node;
+
+	if (it.prev != OCTREE_NONE)
+	{
+		items[it.prev].next = it.next;
+	}
+	else
+	{
+		nodes[node].first_item = it.next;
+	}
+	if (it.next != OCTREE_NONE)
+	{
+		items[it.next].prev = it.prev;
+	}
+	nodes[node].num_items--;
+
+	for (int n = node; n != OCTREE_NONE; n = nodes[n].parent)
+	{
+		nodes[n].num_total--;
+	}
+
+	it.node = it.prev = it.next = OCTREE_NONE;
+}
+
+// Release the highest branch without items above this node
+void LooseOctree::ReleaseEmpty(int node)
+{
+	int empty = OCTREE_NONE;
+	for (int n = node; n != OCTREE_NONE; n = nodes[n].parent)
+	{
+		if (nodes[n].num_total == 0)
+		{
+			empty = n;
+		}
+	}
+
+	if (empty != OCTREE_NONE)
+	{
+		ReleaseChilds(empty);
+	}
+}
+
+AABB LooseOctree::GetLooseBox(int node) const
+{
+	AABB box;
+	box.SetFromCenterAndSize(nodes[node].center, float3(nodes[node].half_size * 4.0f));
+	return box;
+}
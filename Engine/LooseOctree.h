@@ -0,0 +1,151 @@
+#ifndef _LOOSE_OCTREE_
+#define _LOOSE_OCTREE_
+
+#include "Globals.h"
+#include "Geometry/AABB.h"
+#include "GameObject.h"
+#include <vector>
+
+#define OCTREE_SIZE 512.0f
+#define OCTREE_MAX_DEPTH 6
+#define OCTREE_NONE -1
+
+// Loose Octree for dynamic objects ---------------------------
+// Nodes live in a pooled array (childs are blocks of 8 consecutive nodes) and
+// each GameObject stores the handle of its item, so Insert/Remove/Move don't search.
+// Loose bounds of a node are twice the size of its cell, then an object only
+// depends on its center & size to find its node (no splitting or re-distribution).
+
+struct LooseOctreeNode
+{
+	float3 center = float3::zero;
+	float half_size = 0.0f;		// Half size of the cell (loose bounds are the double)
+	int parent = OCTREE_NONE;
+	int childs = OCTREE_NONE;	// First node of the 8 childs block
+	int first_item = OCTREE_NONE;
+	uint num_items = 0;			// Items in this node
+	uint num_total = 0;			// Items in this node and all its childs
+};
+
+struct LooseOctreeItem
+{
+	GameObject* object = nullptr;
+	int node = OCTREE_NONE;
+	int prev = OCTREE_NONE;
+	int next = OCTREE_NONE;
+};
+
+class LooseOctree
+{
+public:
+	LooseOctree();
+	virtual ~LooseOctree();
+
+	void Init(const float3& center, float half_size, uint max_depth);
+	void Clear();
+
+	void Insert(GameObject* obj);
+	void Remove(GameObject* obj);
+	void Move(GameObject* obj);
+
+	GameObject* GetObjectByHandle(int handle) const;
+	uint GetNumObjects() const;
+	uint GetNumNodes() const;
+	uint GetMemory() const;
+
+	// Handles inserted since the last call (to update objects that never were checked)
+	void CollectInserted(std::vector<int>& handles);
+
+	// test_objects = false only checks the nodes (objects are tested later, ex: culling batch)
+	template<typename TYPE>
+	int CollectCandidates(std::vector<int>& handles, const TYPE& primitive, bool test_objects = true) const;
+
+	void CollectObjects(std::vector<GameObject*>& objects) const;
+
+	void DebugDraw() const;
+
+private:
+	int FindNode(const AABB& box);
+	void CreateChilds(int node);
+	void ReleaseChilds(int node);
+	void ReleaseEmpty(int node);
+	void Link(int item, int node);
+	void Unlink(int item);
+	AABB GetLooseBox(int node) const;
+
+private:
+	std::vector<LooseOctreeNode> nodes;
+	std::vector<int> free_blocks;
+
+	std::vector<LooseOctreeItem> items;
+	std::vector<int> free_items;
+	std::vector<int> inserted;
+	uint num_objects = 0;
+	uint num_nodes = 0;
+	uint max_depth = OCTREE_MAX_DEPTH;
+
+	mutable std::vector<int> stack;
+};
+
+template<typename TYPE>
+inline int LooseOctree::CollectCandidates(std::vector<int>& handles, const TYPE& primitive, bool test_objects) const
+{
+	int tests = 0;
+	if (nodes.size() == 0)
+	{
+		return tests;
+	}
+
+	stack.clear();
+	stack.push_back(0);
+
+	while (stack.size() > 0)
+	{
+		int index = stack.back();
+		stack.pop_back();
+		const LooseOctreeNode& node = nodes[index];
+
+		// Skip empty branches, root is always checked (objects outside the limits stay there)
+		if (node.num_total == 0)
+		{
+			continue;
+		}
+		if (index != 0)
+		{
+			tests++;
+			if (!primitive.Intersects(GetLooseBox(index)))
+			{
+				continue;
+			}
+		}
+
+		// Check objects of this node
+		for (int item = node.first_item; item != OCTREE_NONE; item = items[item].next)
+		{
+			if (test_objects == false)
+			{
+				handles.push_back(item);
+				continue;
+			}
+
+			tests++;
+			if (primitive.Intersects(items[item].object->box_fixed))
+			{
+				handles.push_back(item);
+			}
+		}
+
+		// Then its childs
+		if (node.childs != OCTREE_NONE)
+		{
+			for (int i = 0; i < 8; i++)
+			{
+				stack.push_back(node.childs + i);
+			}
+		}
+	}
+
+	return tests;
+}
+
+#endif
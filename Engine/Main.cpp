@@ -1,9 +1,8 @@
 #include <stdlib.h>
 #include "Application.h"
 #include "Globals.h"
-
-#include "Brofiler\Brofiler.h"
-#pragma comment( lib, "Brofiler/ProfilerCore32.lib" )
+#include "Benchmark.h"
+#include "MemoryAllocator.h"
 
 #include "SDL/include/SDL.h"
 #pragma comment( lib, "SDL/libx86/SDL2.lib" )
@@ -28,6 +27,16 @@ Application* App = NULL;
 
 int main(int argc, char ** argv)
 {
+	// Headless benchmark, the modules are created but not initialized (see Benchmark.h)
+	BenchmarkConfig benchmark;
+	if (ParseBenchmarkArgs(argc, argv, benchmark))
+	{
+		App = new Application();
+		int benchmark_return = RunBenchmark(benchmark);
+		delete App;
+		return benchmark_return;
+	}
+
 	LOG("Starting game '%s'...", TITLE);
 
 	int main_return = EXIT_FAILURE;
@@ -35,7 +44,6 @@ int main(int argc, char ** argv)
 
 	while (state != MAIN_EXIT)
 	{
-		//BROFILER_FRAME("MAIN");
 		switch (state)
 		{
 		case MAIN_CREATION:
@@ -97,5 +105,8 @@ int main(int argc, char ** argv)
 
 	delete App;
 
+	// What is still allocated (statics included) are the leaks
+	AllocatorWriteReport(ALLOCATOR_LEAKS_FILE);
+
 	return main_return;
 }
\ No newline at end of file
@@ -0,0 +1,449 @@
+#include "MathBenchmark.h"
+#include "CpuFeatures.h"
+#include "MathGeoLib.h"
+#include "PerfTimer.h"
+#include <vector>
+
+#define BENCH_MATRICES 4096
+#define BENCH_TRIANGLES 1024
+#define BENCH_RAYS 256
+
+// Scalar references -----------------------------------
+static void RefMul(const float4x4& a, const float4x4& b, float4x4& out)
+{
+	for (int r = 0; r < 4; r++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			out.v[r][c] = a.v[r][0] * b.v[0][c] + a.v[r][1] * b.v[1][c] + a.v[r][2] * b.v[2][c] + a.v[r][3] * b.v[3][c];
+		}
+	}
+}
+
+// Inverse with the 2x2 sub-determinants of the upper and lower rows
+static bool RefInverse(const float4x4& a, float4x4& out)
+{
+	const float(*m)[4] = a.v;
+
+	float s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+	float s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+	float s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+	float s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+	float s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+	float s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+	float c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+	float c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+	float c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+	float c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+	float c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+	float c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+	float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	if (Abs(det) < 1e-6f)
+	{
+		return false;
+	}
+	float inv = 1.0f / det;
+
+	out.v[0][0] = (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * inv;
+	out.v[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * inv;
+	out.v[0][2] = (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * inv;
+	out.v[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * inv;
+
+	out.v[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * inv;
+	out.v[1][1] = (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * inv;
+	out.v[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * inv;
+	out.v[1][3] = (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * inv;
+
+	out.v[2][0] = (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * inv;
+	out.v[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * inv;
+	out.v[2][2] = (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * inv;
+	out.v[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * inv;
+
+	out.v[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * inv;
+	out.v[3][1] = (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * inv;
+	out.v[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * inv;
+	out.v[3][3] = (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * inv;
+	return true;
+}
+
+static Quat RefQuatMul(const Quat& a, const Quat& b)
+{
+	return Quat(a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+		a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+}
+
+static float3 RefQuatTransform(const Quat& q, const float3& v)
+{
+	float3 axis(q.x, q.y, q.z);
+	float3 t = 2.0f * axis.Cross(v);
+	return v + q.w * t + axis.Cross(t);
+}
+
+// Affine transform: new center & new extents with the absolute values of the 3x3 part
+static AABB RefTransformAABB(const AABB& box, const float4x4& m)
+{
+	float3 c = box.CenterPoint();
+	float3 h = box.HalfSize();
+	float3 center, half;
+	for (int r = 0; r < 3; r++)
+	{
+		center[r] = m.v[r][0] * c.x + m.v[r][1] * c.y + m.v[r][2] * c.z + m.v[r][3];
+		half[r] = Abs(m.v[r][0]) * h.x + Abs(m.v[r][1]) * h.y + Abs(m.v[r][2]) * h.z;
+	}
+	return AABB(center - half, center + half);
+}
+
+static float RefIntersectRay(const std::vector<Triangle>& tris, const Ray& ray)
+{
+	float nearest = FLOAT_INF;
+	float u, v;
+	for (uint i = 0; i < tris.size(); i++)
+	{
+		float d = Triangle::IntersectLineTri(ray.pos, ray.dir, tris[i].a, tris[i].b, tris[i].c, u, v);
+		if (d >= 0.0f && d < nearest)
+		{
+			nearest = d;
+		}
+	}
+	return nearest;
+}
+
+// Comparisons (relative tolerance for big values) -------
+static bool Near(float a, float b, float epsilon)
+{
+	if (a == b) // Also both infinite
+	{
+		return true;
+	}
+	return Abs(a - b) <= epsilon * Max(1.0f, Max(Abs(a), Abs(b)));
+}
+
+static bool NearMatrix(const float4x4& a, const float4x4& b, float epsilon)
+{
+	for (int r = 0; r < 4; r++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			if (Near(a.v[r][c], b.v[r][c], epsilon) == false)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static bool NearQuat(const Quat& a, const Quat& b, float epsilon)
+{
+	return Near(a.x, b.x, epsilon) && Near(a.y, b.y, epsilon) && Near(a.z, b.z, epsilon) && Near(a.w, b.w, epsilon);
+}
+
+static bool NearFloat3(const float3& a, const float3& b, float epsilon)
+{
+	return Near(a.x, b.x, epsilon) && Near(a.y, b.y, epsilon) && Near(a.z, b.z, epsilon);
+}
+
+static void LogResult(const char* name, double ref_ms, double lib_ms, uint errors, uint tests)
+{
+	LOG("- %s: scalar %.4f ms / MathGeoLib %.4f ms (x%.1f) - Errors: %i / %i", name,
+		ref_ms, lib_ms, lib_ms > 0.0 ? ref_ms / lib_ms : 0.0, errors, tests);
+}
+
+// MATH BENCHMARK --------------------------------------
+bool MathBenchmark(uint iterations)
+{
+	if (iterations == 0)
+	{
+		return true;
+	}
+
+	// Same seed every time, results can be compared between builds
+	LCG lcg(1234);
+	PerfTimer timer;
+	uint total_errors = 0;
+
+	LOG("Math Benchmark (%i iterations, SIMD build: %s):", iterations, GetBuildSIMDLevel());
+
+	// Affine matrices with scale, they are always invertible
+	std::vector<float4x4> mat_a(BENCH_MATRICES);
+	std::vector<float4x4> mat_b(BENCH_MATRICES);
+	std::vector<float4x4> ref_out(BENCH_MATRICES);
+	std::vector<float4x4> lib_out(BENCH_MATRICES);
+	std::vector<Quat> quat_a(BENCH_MATRICES);
+	std::vector<Quat> quat_b(BENCH_MATRICES);
+	std::vector<float3> points(BENCH_MATRICES);
+	for (uint i = 0; i < BENCH_MATRICES; i++)
+	{
+		quat_a[i] = Quat::RandomRotation(lcg);
+		quat_b[i] = Quat::RandomRotation(lcg);
+		points[i] = float3::RandomBox(lcg, -100.0f, 100.0f);
+		mat_a[i] = float4x4::FromTRS(float3::RandomBox(lcg, -100.0f, 100.0f), quat_a[i], float3::RandomBox(lcg, 0.5f, 2.0f));
+		mat_b[i] = float4x4::FromTRS(float3::RandomBox(lcg, -100.0f, 100.0f), quat_b[i], float3::RandomBox(lcg, 0.5f, 2.0f));
+	}
+
+	// float4x4 * float4x4 -------------------------
+	{
+		timer.Start();
+		for (uint it = 0; it < iterations; it++)
+		{
+			for (uint i = 0; i < BENCH_MATRICES; i++)
+			{
+				RefMul(mat_a[i], mat_b[i], ref_out[i]);
+			}
+		}
+		double ref_ms = timer.ReadMs() / iterations;
+
+		timer.Start();
+		for (uint it = 0; it < iterations; it++)
+		{
+			for (uint i = 0; i < BENCH_MATRICES; i++)
+			{
+				lib_out[i] = mat_a[i] * mat_b[i];
+			}
+		}
+		double lib_ms = timer.ReadMs() / iterations;
+
+		uint errors = 0;
+		for (uint i = 0; i < BENCH_MATRICES; i++)
+		{
+			if (NearMatrix(ref_out[i], lib_out[i], 1e-4f) == false)
+			{
+				errors++;
+			}
+		}
+		LogResult("float4x4 * float4x4", ref_ms, lib_ms, errors, BENCH_MATRICES);
+		total_errors += errors;
+	}
+
+	// float4x4::Inverted ---------------------------
+	{
+		timer.Start();
+		for (uint it = 0; it < iterations; it++)
+		{
+			for (uint i = 0; i < BENCH_MATRICES; i++)
+			{
+				RefInverse(mat_a[i], ref_out[i]);
+			}
+		}
+		double ref_ms = timer.ReadMs() / iterations;
+
+		timer.Start();
+		for (uint it = 0; it < iterations; it++)
+		{
+			for (uint i = 0; i < BENCH_MATRICES; i++)
+			{
+				lib_out[i] = mat_a[i].Inverted();
+			}
+		}
+		double lib_ms = timer.ReadMs() / iterations;
+
+		// Also check M * M^-1 = I (the reference could be wrong too)
+		uint errors = 0;
+		float4x4 identity;
+		for (uint i = 0; i < BENCH_MATRICES; i++)
+		{
+			RefMul(mat_a[i], lib_out[i], identity);
+			if (NearMatrix(ref_out[i], lib_out[i], 1e-3f) == false || NearMatrix(identity, float4x4::identity, 1e-3f) == false)
+			{
+				errors++;
+			}
+		}
+		LogResult("float4x4::Inverted", ref_ms, lib_ms, errors, BENCH_MATRICES);
+		total_errors += errors;
+	}
+
+	// Quat * Quat ----------------------------------
+	{
+		std::vector<Quat> ref_quat(BENCH_MATRICES);
+		std::vector<Quat> lib_quat(BENCH_MATRICES);
+
+		timer.Start();
+		for (uint it = 0; it < iterations; it++)
+		{
+			for (uint i = 0; i < BENCH_MATRICES; i++)
+			{
+				ref_quat[i] = RefQuatMul(quat_a[i], quat_b[i]);
+			}
+		}
+		double ref_ms = timer.ReadMs() / iterations;
+
+		timer.Start();
+		for (uint it = 0; it < iterations; it++)
+		{
+			for (uint i = 0; i < BENCH_MATRICES; i++)
+			{
+				lib_quat[i] = quat_a[i] * quat_b[i];
+			}
+		}
+		double lib_ms = timer.ReadMs() / iterations;
+
+		uint errors = 0;
+		for (uint i = 0; i < BENCH_MATRICES; i++)
+		{
+			if (NearQuat(ref_quat[i], lib_quat[i], 1e-4f) == false)
+			{
+				errors++;
+			}
+		}
+		LogResult("Quat * Quat", ref_ms, lib_ms, errors, BENCH_MATRICES);
+		total_errors += errors;
+	}
+
+	// Quat::Transform ------------------------------
+	{
+		std::vector<float3> ref_point(BENCH_MATRICES);
+		std::vector<float3> lib_point(BENCH_MATRICES);
+
+		timer.Start();
+		for (uint it = 0; it < iterations; it++)
+		{
+			for (uint i = 0; i < BENCH_MATRICES; i++)
+			{
+				ref_point[i] = RefQuatTransform(quat_a[i], points[i]);
+			}
+		}
+		double ref_ms = timer.ReadMs() / iterations;
+
+		timer.Start();
+		for (uint it = 0; it < iterations; it++)
+		{
+			for (uint i = 0; i < BENCH_MATRICES; i++)
+			{
+				lib_point[i] = quat_a[i].Transform(points[i]);
+			}
+		}
+		double lib_ms = timer.ReadMs() / iterations;
+
+		uint errors = 0;
+		for (uint i = 0; i < BENCH_MATRICES; i++)
+		{
+			if (NearFloat3(ref_point[i], lib_point[i], 1e-4f) == false)
+			{
+				errors++;
+			}
+		}
+		LogResult("Quat::Transform", ref_ms, lib_ms, errors, BENCH_MATRICES);
+		total_errors += errors;
+	}
+
+	// AABB::TransformAsAABB ------------------------
+	{
+		std::vector<AABB> boxes(BENCH_MATRICES);
+		std::vector<AABB> ref_box(BENCH_MATRICES);
+		std::vector<AABB> lib_box(BENCH_MATRICES);
+		for (uint i = 0; i < BENCH_MATRICES; i++)
+		{
+			boxes[i].SetFromCenterAndSize(points[i], float3::RandomBox(lcg, 0.5f, 10.0f));
+		}
+
+		timer.Start();
+		for (uint it = 0; it < iterations; it++)
+		{
+			for (uint i = 0; i < BENCH_MATRICES; i++)
+			{
+				ref_box[i] = RefTransformAABB(boxes[i], mat_a[i]);
+			}
+		}
+		double ref_ms = timer.ReadMs() / iterations;
+
+		timer.Start();
+		for (uint it = 0; it < iterations; it++)
+		{
+			for (uint i = 0; i < BENCH_MATRICES; i++)
+			{
+				lib_box[i] = boxes[i];
+				lib_box[i].TransformAsAABB(mat_a[i]);
+			}
+		}
+		double lib_ms = timer.ReadMs() / iterations;
+
+		uint errors = 0;
+		for (uint i = 0; i < BENCH_MATRICES; i++)
+		{
+			if (NearFloat3(ref_box[i].minPoint, lib_box[i].minPoint, 1e-4f) == false ||
+				NearFloat3(ref_box[i].maxPoint, lib_box[i].maxPoint, 1e-4f) == false)
+			{
+				errors++;
+			}
+		}
+		LogResult("AABB::TransformAsAABB", ref_ms, lib_ms, errors, BENCH_MATRICES);
+		total_errors += errors;
+	}
+
+	// TriangleMesh::IntersectRay --------------------
+	{
+		// Padded with degenerate triangles like TriangleMesh::Set(Polyhedron) (SoA layouts need blocks of 4/8)
+		std::vector<Triangle> tris;
+		tris.reserve(BENCH_TRIANGLES);
+		for (uint i = 0; i < BENCH_TRIANGLES; i++)
+		{
+			float3 center = float3::RandomBox(lcg, -10.0f, 10.0f);
+			tris.push_back(Triangle(center + float3::RandomBox(lcg, -1.0f, 1.0f),
+				center + float3::RandomBox(lcg, -1.0f, 1.0f), center + float3::RandomBox(lcg, -1.0f, 1.0f)));
+		}
+		float3 degen(-FLOAT_INF, -FLOAT_INF, -FLOAT_INF);
+		while (tris.size() % 8 != 0)
+		{
+			tris.push_back(Triangle(degen, degen, degen));
+		}
+
+		TriangleMesh mesh;
+		mesh.Set(&tris[0], tris.size());
+
+		// Rays from a sphere around the triangles pointing to the center area
+		std::vector<Ray> rays(BENCH_RAYS);
+		for (uint i = 0; i < BENCH_RAYS; i++)
+		{
+			rays[i].pos = float3::RandomDir(lcg, 30.0f);
+			rays[i].dir = (float3::RandomBox(lcg, -5.0f, 5.0f) - rays[i].pos).Normalized();
+		}
+
+		std::vector<float> ref_dist(BENCH_RAYS);
+		std::vector<float> lib_dist(BENCH_RAYS);
+
+		timer.Start();
+		for (uint it = 0; it < iterations; it++)
+		{
+			for (uint i = 0; i < BENCH_RAYS; i++)
+			{
+				ref_dist[i] = RefIntersectRay(tris, rays[i]);
+			}
+		}
+		double ref_ms = timer.ReadMs() / iterations;
+
+		timer.Start();
+		for (uint it = 0; it < iterations; it++)
+		{
+			for (uint i = 0; i < BENCH_RAYS; i++)
+			{
+				lib_dist[i] = mesh.IntersectRay(rays[i]);
+			}
+		}
+		double lib_ms = timer.ReadMs() / iterations;
+
+		uint errors = 0;
+		uint hits = 0;
+		for (uint i = 0; i < BENCH_RAYS; i++)
+		{
+			if (Near(ref_dist[i], lib_dist[i], 1e-3f) == false)
+			{
+				errors++;
+			}
+			if (ref_dist[i] < FLOAT_INF)
+			{
+				hits++;
+			}
+		}
+		LogResult("TriangleMesh::IntersectRay", ref_ms, lib_ms, errors, BENCH_RAYS);
+		LOG("  (%i triangles, %i / %i rays hit)", (int)tris.size(), hits, BENCH_RAYS);
+		total_errors += errors;
+	}
+
+	LOG("Math Benchmark: %s", total_errors == 0 ? "all results match" : "ERRORS FOUND");
+	return total_errors == 0;
+}
+// ---------------------------------------------------
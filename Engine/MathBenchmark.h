@@ -0,0 +1,13 @@
+#ifndef _MATH_BENCHMARK_
+#define _MATH_BENCHMARK_
+
+#include "Globals.h"
+
+// Math correctness & performance suite ---------------------
+// Each MathGeoLib operation (SIMD when the build enables it, see MathBuildConfig.h)
+// is compared with a plain scalar reference: float4x4 multiply/inverse, Quat multiply/transform,
+// AABB::TransformAsAABB and TriangleMesh::IntersectRay. It doesn't need the App (headless).
+// Returns false if any result differs more than the tolerance. Results to the console.
+bool MathBenchmark(uint iterations);
+
+#endif
@@ -110,6 +110,16 @@
 //#define MATH_SSE2
 //#define MATH_SSE // SSE1.
 
+// The engine selects the level from the build configuration ("ReleaseSIMD" defines ENGINE_SIMD_SSE41).
+// Default configurations stay scalar: with SIMD the matrices/quaternions are aligned to 16 (32 with AVX) bytes.
+#if defined(ENGINE_SIMD_AVX)
+#define MATH_AVX
+#elif defined(ENGINE_SIMD_SSE41)
+#define MATH_SSE41
+#elif defined(ENGINE_SIMD_SSE2)
+#define MATH_SSE2
+#endif
+
 ///\todo Test iOS support.
 ///\todo Enable NEON only on ARMv7, not older.
 //#if (defined(ANDROID) && defined(__ARM_ARCH_7A__)) || (defined(WIN8RT) && defined(_M_ARM))
@@ -0,0 +1,544 @@
+#include "MemoryAllocator.h"
+#include <algorithm>
+
+#ifdef ENGINE_MEMORY_TRACKING
+
+#include <Windows.h>
+#include <DbgHelp.h>
+#include <atomic>
+#include <new>
+#include <thread>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#pragma comment(lib, "dbghelp.lib")
+
+#define ALLOCATOR_COUNTED 1
+#define ALLOCATOR_SKIP_FRAMES 3		/* SampleAllocation, TrackedAlloc & operator new */
+
+// 16 bytes, keeps the alignment of malloc
+struct AllocatorHeader
+{
+	uint64 size;
+	uint sample;	/* Slot in the samples + 1, 0: not sampled */
+	uint flags;
+};
+
+// Counters of one thread, only the owner writes them (they are kept until the end)
+struct AllocatorThread
+{
+	std::atomic<__int64> bytes;
+	std::atomic<__int64> count;
+	std::atomic<uint64> total;
+	__int64 countdown;		/* Bytes until the next sample */
+	uint interval;			/* Sample interval of the countdown */
+	uint64 unsampled;		/* Bytes since the last sample (its weight) */
+	uint random;
+	AllocatorThread* next;
+};
+
+// The tables are PODs, they are zero before any constructor allocates
+struct AllocatorSample
+{
+	uint callsite;
+	uint64 weight;
+};
+
+struct AllocatorSite
+{
+	void* frames[ALLOCATOR_FRAMES];
+	ULONG hash;
+	uint num_frames;
+	uint live_samples;
+	uint64 live_bytes;
+	uint64 total_samples;
+};
+
+static std::atomic<bool> enabled(true);
+static std::atomic<uint> sample_interval(ALLOCATOR_SAMPLE_INTERVAL);
+static std::atomic<AllocatorThread*> thread_list(nullptr);
+static std::atomic<uint> num_threads(0);
+static thread_local AllocatorThread* local_thread = nullptr;
+static thread_local bool sampling = false;
+
+// Samples & callsites (only sampled allocations lock them)
+static std::atomic_flag lock = ATOMIC_FLAG_INIT;
+static AllocatorSample samples[ALLOCATOR_MAX_SAMPLES];
+static uint free_samples[ALLOCATOR_MAX_SAMPLES];
+static uint num_free_samples = 0;
+static uint used_samples = 0;
+static uint live_samples = 0;
+static uint dropped = 0;
+static AllocatorSite sites[ALLOCATOR_MAX_CALLSITES];
+static bool site_used[ALLOCATOR_MAX_CALLSITES];
+static uint num_sites = 0;
+
+// Updated by the main thread in AllocatorEndFrame
+static std::atomic<__int64> peak_bytes(0);
+static uint64 last_total = 0;
+static std::atomic<uint64> frame_count(0);
+
+static void Lock()
+{
+	while (lock.test_and_set(std::memory_order_acquire))
+	{
+		std::this_thread::yield();
+	}
+}
+
+static void Unlock()
+{
+	lock.clear(std::memory_order_release);
+}
+
+// Next countdown between interval / 2 and interval * 3 / 2, the jitter
+// avoids following the pattern of allocations of a loop
+static __int64 NextCountdown(AllocatorThread* thread)
+{
+	uint interval = sample_interval.load(std::memory_order_relaxed);
+	thread->interval = interval;
+	if (interval == 0)
+	{
+		return LLONG_MAX;
+	}
+	thread->random ^= thread->random << 13;
+	thread->random ^= thread->random >> 17;
+	thread->random ^= thread->random << 5;
+	return interval / 2 + thread->random % interval + 1;
+}
+
+static AllocatorThread* GetThread()
+{
+	if (local_thread == nullptr)
+	{
+		void* memory = malloc(sizeof(AllocatorThread));
+		if (memory == nullptr)
+		{
+			return nullptr; /* Not counted, tried again on the next allocation */
+		}
+		AllocatorThread* thread = new (memory) AllocatorThread(); /* Zeroed */
+		thread->random = 2463534242u + num_threads.fetch_add(1, std::memory_order_relaxed) * 747796405u;
+		thread->countdown = NextCountdown(thread);
+
+		thread->next = thread_list.load(std::memory_order_relaxed);
+		while (thread_list.compare_exchange_weak(thread->next, thread, std::memory_order_release) == false)
+		{
+		}
+		local_thread = thread;
+	}
+	return local_thread;
+}
+
+// Only the owner writes the counters: load + store, without a locked add
+static void AddCounters(AllocatorThread* thread, __int64 bytes, __int64 count)
+{
+	thread->bytes.store(thread->bytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+	thread->count.store(thread->count.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+	if (count > 0)
+	{
+		thread->total.store(thread->total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+}
+
+static uint FindSite(void** frames, uint num_frames, ULONG hash)
+{
+	uint index = hash % ALLOCATOR_MAX_CALLSITES;
+	for (uint i = 0; i < ALLOCATOR_MAX_CALLSITES; i++)
+	{
+		AllocatorSite& site = sites[index];
+		if (site_used[index] == false)
+		{
+			// Keep some slots free, the probes stay short
+			if (num_sites >= ALLOCATOR_MAX_CALLSITES * 3 / 4)
+			{
+				return ALLOCATOR_MAX_CALLSITES;
+			}
+			memcpy(site.frames, frames, num_frames * sizeof(void*));
+			site.hash = hash;
+			site.num_frames = num_frames;
+			site_used[index] = true;
+			num_sites++;
+			return index;
+		}
+		if (site.hash == hash && site.num_frames == num_frames && memcmp(site.frames, frames, num_frames * sizeof(void*)) == 0)
+		{
+			return index;
+		}
+		index = (index + 1) % ALLOCATOR_MAX_CALLSITES;
+	}
+	return ALLOCATOR_MAX_CALLSITES;
+}
+
+// Returns the slot + 1 of the sample (0: dropped)
+static __declspec(noinline) uint SampleAllocation(uint64 weight)
+{
+	void* frames[ALLOCATOR_FRAMES];
+	ULONG hash = 0;
+	uint num_frames = CaptureStackBackTrace(ALLOCATOR_SKIP_FRAMES, ALLOCATOR_FRAMES, frames, &hash);
+
+	uint slot = 0;
+	Lock();
+	uint site = FindSite(frames, num_frames, hash);
+	if (site == ALLOCATOR_MAX_CALLSITES || (num_free_samples == 0 && used_samples == ALLOCATOR_MAX_SAMPLES))
+	{
+		dropped++;
+	}
+	else
+	{
+		uint index = (num_free_samples > 0) ? free_samples[--num_free_samples] : used_samples++;
+		samples[index].callsite = site;
+		samples[index].weight = weight;
+		sites[site].live_samples++;
+		sites[site].live_bytes += weight;
+		sites[site].total_samples++;
+		live_samples++;
+		slot = index + 1;
+	}
+	Unlock();
+	return slot;
+}
+
+static void RemoveSample(uint slot)
+{
+	Lock();
+	AllocatorSample& sample = samples[slot - 1];
+	sites[sample.callsite].live_samples--;
+	sites[sample.callsite].live_bytes -= sample.weight;
+	free_samples[num_free_samples++] = slot - 1;
+	live_samples--;
+	Unlock();
+}
+
+static __declspec(noinline) void* TrackedAlloc(size_t size)
+{
+	AllocatorHeader* header = (AllocatorHeader*)malloc(sizeof(AllocatorHeader) + size);
+	if (header == nullptr)
+	{
+		return nullptr;
+	}
+	header->size = size;
+	header->sample = 0;
+	header->flags = 0;
+
+	AllocatorThread* thread = enabled.load(std::memory_order_relaxed) ? GetThread() : nullptr;
+	if (thread != nullptr)
+	{
+		AddCounters(thread, size, 1);
+		header->flags = ALLOCATOR_COUNTED;
+
+		// The interval changed (0 never counts down): start again with the new one
+		if (thread->interval != sample_interval.load(std::memory_order_relaxed))
+		{
+			thread->countdown = NextCountdown(thread);
+			thread->unsampled = 0;
+		}
+
+		thread->countdown -= size + 1;
+		thread->unsampled += size + 1;
+		if (thread->countdown <= 0 && sampling == false)
+		{
+			// Nothing called while sampling takes another sample (the lock isn't reentrant)
+			sampling = true;
+			header->sample = SampleAllocation(thread->unsampled);
+			thread->countdown = NextCountdown(thread);
+			thread->unsampled = 0;
+			sampling = false;
+		}
+	}
+	return header + 1;
+}
+
+static void TrackedFree(void* memory)
+{
+	if (memory == nullptr)
+	{
+		return;
+	}
+	AllocatorHeader* header = (AllocatorHeader*)memory - 1;
+	AllocatorThread* thread = (header->flags & ALLOCATOR_COUNTED) ? GetThread() : nullptr;
+	if (thread != nullptr)
+	{
+		AddCounters(thread, -(__int64)header->size, -1);
+	}
+	if (header->sample != 0)
+	{
+		RemoveSample(header->sample);
+	}
+	free(header);
+}
+
+// Exceptions are disabled in the project, an allocation that fails stops the engine
+void* operator new(size_t size)
+{
+	void* memory = TrackedAlloc(size);
+	if (memory == nullptr)
+	{
+		abort();
+	}
+	return memory;
+}
+
+void* operator new[](size_t size)
+{
+	void* memory = TrackedAlloc(size);
+	if (memory == nullptr)
+	{
+		abort();
+	}
+	return memory;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return TrackedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return TrackedAlloc(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	TrackedFree(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	TrackedFree(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	TrackedFree(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	TrackedFree(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	TrackedFree(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+	TrackedFree(memory);
+}
+
+// ---------------------------------------------------
+bool AllocatorIsCompiled()
+{
+	return true;
+}
+
+void AllocatorSetEnabled(bool enable)
+{
+	enabled.store(enable, std::memory_order_relaxed);
+}
+
+bool AllocatorIsEnabled()
+{
+	return enabled.load(std::memory_order_relaxed);
+}
+
+void AllocatorSetSampleInterval(uint bytes)
+{
+	sample_interval.store(bytes, std::memory_order_relaxed);
+}
+
+uint AllocatorGetSampleInterval()
+{
+	return sample_interval.load(std::memory_order_relaxed);
+}
+
+void AllocatorEndFrame()
+{
+	AllocatorStats stats;
+	AllocatorGetStats(stats);
+	if (stats.live_bytes > peak_bytes.load(std::memory_order_relaxed))
+	{
+		peak_bytes.store(stats.live_bytes, std::memory_order_relaxed);
+	}
+	frame_count.store(stats.total_count - last_total, std::memory_order_relaxed);
+	last_total = stats.total_count;
+}
+
+void AllocatorGetStats(AllocatorStats& stats)
+{
+	stats = AllocatorStats();
+	for (AllocatorThread* thread = thread_list.load(std::memory_order_acquire); thread != nullptr; thread = thread->next)
+	{
+		stats.live_bytes += thread->bytes.load(std::memory_order_relaxed);
+		stats.live_count += thread->count.load(std::memory_order_relaxed);
+		stats.total_count += thread->total.load(std::memory_order_relaxed);
+		stats.threads++;
+	}
+	stats.peak_bytes = std::max(peak_bytes.load(std::memory_order_relaxed), stats.live_bytes);
+	stats.frame_count = frame_count.load(std::memory_order_relaxed);
+
+	Lock();
+	stats.samples = live_samples;
+	stats.dropped = dropped;
+	Unlock();
+}
+
+void AllocatorGetCallsites(std::vector<AllocatorCallsite>& callsites)
+{
+	// Reserved before the lock: the vector can't allocate (or free a sampled block) while it's taken
+	Lock();
+	uint count = num_sites;
+	Unlock();
+	callsites.clear();
+	callsites.reserve(count);
+
+	Lock();
+	for (uint i = 0; i < ALLOCATOR_MAX_CALLSITES && callsites.size() < callsites.capacity(); i++)
+	{
+		const AllocatorSite& site = sites[i];
+		if (site_used[i] && site.live_samples > 0)
+		{
+			AllocatorCallsite callsite;
+			memcpy(callsite.frames, site.frames, sizeof(site.frames));
+			callsite.num_frames = site.num_frames;
+			callsite.live_samples = site.live_samples;
+			callsite.live_bytes = site.live_bytes;
+			callsite.total_samples = site.total_samples;
+			callsites.push_back(callsite);
+		}
+	}
+	Unlock();
+
+	std::sort(callsites.begin(), callsites.end(), [](const AllocatorCallsite& a, const AllocatorCallsite& b)
+	{
+		return a.live_bytes > b.live_bytes;
+	});
+}
+
+bool AllocatorGetSymbol(void* address, char* name, uint size)
+{
+	static bool initialized = false;
+	static bool symbols = false;
+	if (initialized == false)
+	{
+		initialized = true;
+		SymSetOptions(SYMOPT_UNDNAME | SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES);
+		symbols = (SymInitialize(GetCurrentProcess(), NULL, TRUE) != FALSE);
+	}
+
+	char buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+	SYMBOL_INFO* symbol = (SYMBOL_INFO*)buffer;
+	memset(symbol, 0, sizeof(SYMBOL_INFO));
+	symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+	symbol->MaxNameLen = MAX_SYM_NAME;
+
+	DWORD64 displacement = 0;
+	if (symbols == false || SymFromAddr(GetCurrentProcess(), (DWORD64)address, &displacement, symbol) == FALSE)
+	{
+		snprintf(name, size, "0x%p", address);
+		return false;
+	}
+
+	IMAGEHLP_LINE64 line;
+	memset(&line, 0, sizeof(line));
+	line.SizeOfStruct = sizeof(IMAGEHLP_LINE64);
+	DWORD line_displacement = 0;
+	if (SymGetLineFromAddr64(GetCurrentProcess(), (DWORD64)address, &line_displacement, &line))
+	{
+		const char* file = strrchr(line.FileName, '\\');
+		snprintf(name, size, "%s (%s:%lu)", symbol->Name, (file != nullptr) ? file + 1 : line.FileName, line.LineNumber);
+	}
+	else
+	{
+		snprintf(name, size, "%s", symbol->Name);
+	}
+	return true;
+}
+
+bool AllocatorWriteReport(const char* file)
+{
+	FILE* output = nullptr;
+	if (fopen_s(&output, file, "w") != 0 || output == nullptr)
+	{
+		return false;
+	}
+
+	AllocatorStats stats;
+	AllocatorGetStats(stats);
+	std::vector<AllocatorCallsite> callsites;
+	AllocatorGetCallsites(callsites);
+
+	fprintf(output, "Live allocations: %lld (%lld bytes), per-frame peak %lld bytes\n", stats.live_count, stats.live_bytes, stats.peak_bytes);
+	fprintf(output, "Sampled every %u bytes: %u live samples in %u callsites (%u dropped)\n\n",
+		AllocatorGetSampleInterval(), stats.samples, (uint)callsites.size(), stats.dropped);
+
+	char name[512];
+	for (uint i = 0; i < callsites.size(); i++)
+	{
+		const AllocatorCallsite& callsite = callsites[i];
+		fprintf(output, "~%llu bytes, %u samples (%llu since start)\n", callsite.live_bytes, callsite.live_samples, callsite.total_samples);
+		for (uint f = 0; f < callsite.num_frames; f++)
+		{
+			AllocatorGetSymbol(callsite.frames[f], name, sizeof(name));
+			fprintf(output, "\t%s\n", name);
+		}
+		fprintf(output, "\n");
+	}
+	fclose(output);
+	return true;
+}
+
+#else
+
+bool AllocatorIsCompiled()
+{
+	return false;
+}
+
+void AllocatorSetEnabled(bool enable)
+{
+}
+
+bool AllocatorIsEnabled()
+{
+	return false;
+}
+
+void AllocatorSetSampleInterval(uint bytes)
+{
+}
+
+uint AllocatorGetSampleInterval()
+{
+	return 0;
+}
+
+void AllocatorEndFrame()
+{
+}
+
+void AllocatorGetStats(AllocatorStats& stats)
+{
+	stats = AllocatorStats();
+}
+
+void AllocatorGetCallsites(std::vector<AllocatorCallsite>& callsites)
+{
+	callsites.clear();
+}
+
+bool AllocatorGetSymbol(void* address, char* name, uint size)
+{
+	return false;
+}
+
+bool AllocatorWriteReport(const char* file)
+{
+	return false;
+}
+
+#endif
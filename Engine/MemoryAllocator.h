@@ -0,0 +1,60 @@
+#ifndef _MEMORY_ALLOCATOR_
+#define _MEMORY_ALLOCATOR_
+
+#include "Globals.h"
+#include <vector>
+
+// Tracking Allocator ------------------------------------------
+// Replaces the global operator new/delete when ENGINE_MEMORY_TRACKING is
+// defined (Debug configuration). Each block has a small header with its size,
+// the counters are kept per thread (no locks or shared cache lines on the hot
+// path) and added when they are read. Callsites are sampled: about one
+// allocation every sample interval bytes captures its stack, only the samples
+// take a lock. With the tracking disabled at runtime new/delete only add the
+// header. Without ENGINE_MEMORY_TRACKING the functions below do nothing.
+
+#define ALLOCATOR_FRAMES 12					/* Return addresses kept per callsite */
+#define ALLOCATOR_MAX_SAMPLES 16384			/* Live sampled allocations */
+#define ALLOCATOR_MAX_CALLSITES 2048
+#define ALLOCATOR_SAMPLE_INTERVAL 65536		/* Default, bytes between samples (mean) */
+#define ALLOCATOR_LEAKS_FILE "memory_leaks.txt"		/* Written at exit */
+#define ALLOCATOR_REPORT_FILE "memory_callsites.txt"	/* Written from the Memory panel */
+
+struct AllocatorStats
+{
+	__int64 live_bytes = 0;
+	__int64 live_count = 0;
+	__int64 peak_bytes = 0;		/* Per-frame peak: live bytes checked at the end of each frame */
+	uint64 total_count = 0;
+	uint64 frame_count = 0;		/* Allocations of the last frame */
+	uint threads = 0;
+	uint samples = 0;			/* Live sampled allocations */
+	uint dropped = 0;			/* Samples lost, the tables were full */
+};
+
+struct AllocatorCallsite
+{
+	void* frames[ALLOCATOR_FRAMES];
+	uint num_frames = 0;
+	uint live_samples = 0;
+	uint64 live_bytes = 0;		/* Estimated, a sample stands for the bytes allocated since the previous one */
+	uint64 total_samples = 0;
+};
+
+bool AllocatorIsCompiled();
+void AllocatorSetEnabled(bool enabled);
+bool AllocatorIsEnabled();
+void AllocatorSetSampleInterval(uint bytes);	/* 0: no sampling */
+uint AllocatorGetSampleInterval();
+
+void AllocatorEndFrame();
+void AllocatorGetStats(AllocatorStats& stats);
+void AllocatorGetCallsites(std::vector<AllocatorCallsite>& callsites); /* With live samples, the biggest first */
+
+// Function & line of a return address (DbgHelp, main thread only)
+bool AllocatorGetSymbol(void* address, char* name, uint size);
+
+// Live sampled callsites with their stacks, at exit they are the leaks
+bool AllocatorWriteReport(const char* file);
+
+#endif
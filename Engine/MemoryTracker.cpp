@@ -0,0 +1,315 @@
+#include "MemoryTracker.h"
+#include "Application.h"
+#include "Scene.h"
+#include "ModuleConsole.h"
+#include "ModuleResourceManager.h"
+#include "ModuleFramebuffers.h"
+#include "Profiler.h"
+#include "FrameStats.h"
+#include "MemoryAllocator.h"
+#include "Resource_.h"
+#include "parson.h"
+#include "ImGui/imgui.h"
+#include <atomic>
+#include <algorithm>
+#include <string>
+#include <string.h>
+#include <vector>
+
+#define MEMORY_MB (1024.0 * 1024.0)
+
+static std::atomic<__int64> used[MEMORY_TAG_MAX][MEMORY_POOL_MAX];
+static std::atomic<__int64> peak[MEMORY_TAG_MAX][MEMORY_POOL_MAX];
+
+static const char* tag_names[MEMORY_TAG_MAX] = { "Meshes", "Textures", "Scripts", "Scene", "JSON", "Editor" };
+
+void MemoryAdd(MemoryTag tag, MemoryPool pool, __int64 bytes)
+{
+	__int64 value = used[tag][pool].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	__int64 max = peak[tag][pool].load(std::memory_order_relaxed);
+	while (value > max && peak[tag][pool].compare_exchange_weak(max, value, std::memory_order_relaxed) == false)
+	{
+	}
+}
+
+__int64 MemoryGetUsed(MemoryTag tag, MemoryPool pool)
+{
+	return used[tag][pool].load(std::memory_order_relaxed);
+}
+
+__int64 MemoryGetPeak(MemoryTag tag, MemoryPool pool)
+{
+	return peak[tag][pool].load(std::memory_order_relaxed);
+}
+
+const char* MemoryTagName(MemoryTag tag)
+{
+	return tag_names[tag];
+}
+
+// MEMORY TRACKER ------------------------------------
+MemoryTracker::MemoryTracker()
+{
+	for (uint t = 0; t < MEMORY_TAG_MAX; t++)
+	{
+		budgets[t] = 0.0f;
+		over_budget[t] = false;
+		measured[t][MEMORY_CPU] = measured[t][MEMORY_GPU] = 0;
+	}
+}
+
+MemoryTracker::~MemoryTracker()
+{
+}
+
+void MemoryTracker::Load(const JSON_Object* node)
+{
+	for (uint t = 0; t < MEMORY_TAG_MAX; t++)
+	{
+		std::string name = std::string("Memory Budgets.") + tag_names[t];
+		budgets[t] = (float)json_object_dotget_number(node, name.c_str());
+	}
+
+	// Missing in old configs: the allocator keeps its defaults
+	if (json_object_has_value(node, "Memory Tracking"))
+	{
+		AllocatorSetEnabled(json_object_get_boolean(node, "Memory Tracking") == 1);
+	}
+	if (json_object_has_value(node, "Memory Sample Interval"))
+	{
+		AllocatorSetSampleInterval((uint)json_object_get_number(node, "Memory Sample Interval"));
+	}
+}
+
+void MemoryTracker::Save(JSON_Object* node) const
+{
+	for (uint t = 0; t < MEMORY_TAG_MAX; t++)
+	{
+		std::string name = std::string("Memory Budgets.") + tag_names[t];
+		json_object_dotset_number(node, name.c_str(), budgets[t]);
+	}
+	if (AllocatorIsCompiled())
+	{
+		json_object_set_boolean(node, "Memory Tracking", AllocatorIsEnabled());
+		json_object_set_number(node, "Memory Sample Interval", AllocatorGetSampleInterval());
+	}
+}
+
+void MemoryTracker::Update()
+{
+	AllocatorEndFrame();
+	if (timer.ReadMs() >= MEMORY_TRACKER_INTERVAL)
+	{
+		timer.Start();
+		Measure();
+		CheckBudgets();
+	}
+}
+
+// Scene & editor don't report each change, they are measured (the difference is added)
+void MemoryTracker::Measure()
+{
+	__int64 now[MEMORY_TAG_MAX][MEMORY_POOL_MAX] = {};
+
+	now[MEMORY_SCENE][MEMORY_CPU] = App->scene->GetMemory();
+
+	now[MEMORY_EDITOR][MEMORY_CPU] = App->console->GetMemory() + App->profiler->GetMemory() + App->frame_stats->GetMemory();
+	if (App->scene->sceneBuff != nullptr)
+	{
+		// RGBA8 color + 24 bits depth (stored in 32)
+		now[MEMORY_EDITOR][MEMORY_GPU] += (__int64)App->scene->sceneBuff->width * App->scene->sceneBuff->height * 8;
+	}
+	ImFontAtlas* fonts = ImGui::GetIO().Fonts;
+	if (fonts != nullptr)
+	{
+		now[MEMORY_EDITOR][MEMORY_GPU] += (__int64)fonts->TexWidth * fonts->TexHeight * 4;
+	}
+
+	const MemoryTag sampled[] = { MEMORY_SCENE, MEMORY_EDITOR };
+	for (uint i = 0; i < 2; i++)
+	{
+		for (uint p = 0; p < MEMORY_POOL_MAX; p++)
+		{
+			MemoryTag tag = sampled[i];
+			MemoryAdd(tag, (MemoryPool)p, now[tag][p] - measured[tag][p]);
+			measured[tag][p] = now[tag][p];
+		}
+	}
+}
+
+void MemoryTracker::CheckBudgets()
+{
+	for (uint t = 0; t < MEMORY_TAG_MAX; t++)
+	{
+		double total = (double)(MemoryGetUsed((MemoryTag)t, MEMORY_CPU) + MemoryGetUsed((MemoryTag)t, MEMORY_GPU)) / MEMORY_MB;
+		bool over = (budgets[t] > 0.0f && total > budgets[t]);
+		if (over && over_budget[t] == false)
+		{
+			LOG("WARNING: %s memory over budget: %.1f MB / %.1f MB", tag_names[t], total, budgets[t]);
+		}
+		over_budget[t] = over;
+	}
+}
+
+void MemoryTracker::ShowMemory()
+{
+	ImGui::BulletText("BY SUBSYSTEM (MB)");
+	ImGui::Columns(6, "memory_tags");
+	ImGui::Text("Tag"); ImGui::NextColumn();
+	ImGui::Text("CPU"); ImGui::NextColumn();
+	ImGui::Text("GPU"); ImGui::NextColumn();
+	ImGui::Text("Peak CPU"); ImGui::NextColumn();
+	ImGui::Text("Peak GPU"); ImGui::NextColumn();
+	ImGui::Text("Budget"); ImGui::NextColumn();
+	ImGui::Separator();
+	for (uint t = 0; t < MEMORY_TAG_MAX; t++)
+	{
+		MemoryTag tag = (MemoryTag)t;
+		double cpu = MemoryGetUsed(tag, MEMORY_CPU) / MEMORY_MB;
+		double gpu = MemoryGetUsed(tag, MEMORY_GPU) / MEMORY_MB;
+		ImVec4 color = over_budget[t] ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImVec4(0.0f, 1.0f, 0.08f, 1.0f);
+
+		ImGui::Text("%s", tag_names[t]); ImGui::NextColumn();
+		ImGui::TextColored(color, "%.2f", cpu); ImGui::NextColumn();
+		ImGui::TextColored(color, "%.2f", gpu); ImGui::NextColumn();
+		ImGui::Text("%.2f", MemoryGetPeak(tag, MEMORY_CPU) / MEMORY_MB); ImGui::NextColumn();
+		ImGui::Text("%.2f", MemoryGetPeak(tag, MEMORY_GPU) / MEMORY_MB); ImGui::NextColumn();
+		ImGui::PushID(t);
+		ImGui::PushItemWidth(-1);
+		ImGui::DragFloat("##budget", &budgets[t], 1.0f, 0.0f, 65536.0f, budgets[t] > 0.0f ? "%.0f" : "-");
+		ImGui::PopItemWidth();
+		ImGui::PopID();
+		ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+	ImGui::Spacing();
+
+	// Resources that use more memory ---------------
+	std::vector<Resource*> resources;
+	App->resource_manager->GetResources(resources);
+	std::sort(resources.begin(), resources.end(), [](const Resource* a, const Resource* b)
+	{
+		return a->GetCPUMemory() + a->GetGPUMemory() > b->GetCPUMemory() + b->GetGPUMemory();
+	});
+
+	ImGui::BulletText("TOP RESOURCES (KB)");
+	ImGui::Columns(4, "memory_resources");
+	ImGui::Text("Resource"); ImGui::NextColumn();
+	ImGui::Text("Type"); ImGui::NextColumn();
+	ImGui::Text("CPU"); ImGui::NextColumn();
+	ImGui::Text("GPU"); ImGui::NextColumn();
+	ImGui::Separator();
+	for (uint i = 0; i < resources.size() && i < MEMORY_TRACKER_TOP; i++)
+	{
+		const Resource* resource = resources[i];
+		if (resource->GetCPUMemory() + resource->GetGPUMemory() == 0)
+		{
+			break;
+		}
+		ImGui::Text("%s", resource->name); ImGui::NextColumn();
+		ImGui::Text("%s", (resource->GetType() == Resource::Type::MESH) ? "Mesh" :
+			(resource->GetType() == Resource::Type::MATERIAL) ? "Texture" : "Script"); ImGui::NextColumn();
+		ImGui::Text("%.1f", resource->GetCPUMemory() / 1024.0); ImGui::NextColumn();
+		ImGui::Text("%.1f", resource->GetGPUMemory() / 1024.0); ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+}
+
+// ALLOCATOR ------------------------------------------
+void MemoryTracker::ShowAllocator()
+{
+	if (AllocatorIsCompiled() == false)
+	{
+		ImGui::TextDisabled("Allocation tracking is only built in Debug (ENGINE_MEMORY_TRACKING)");
+		return;
+	}
+
+	bool enabled = AllocatorIsEnabled();
+	if (ImGui::Checkbox("Track Allocations", &enabled))
+	{
+		AllocatorSetEnabled(enabled);
+	}
+	ImGui::SameLine();
+	int interval = AllocatorGetSampleInterval() / 1024;
+	ImGui::PushItemWidth(120);
+	if (ImGui::DragInt("Sample every (KB)", &interval, 1.0f, 0, 16384))
+	{
+		AllocatorSetSampleInterval(interval * 1024);
+	}
+	ImGui::PopItemWidth();
+	ImGui::SameLine();
+	if (ImGui::Button("Write Report"))
+	{
+		if (AllocatorWriteReport(ALLOCATOR_REPORT_FILE))
+		{
+			LOG("Allocation callsites written to %s", ALLOCATOR_REPORT_FILE);
+		}
+	}
+
+	AllocatorStats stats;
+	AllocatorGetStats(stats);
+	ImVec4 color(0.0f, 1.0f, 0.08f, 1.0f);
+	ImGui::BulletText("ALLOCATIONS");
+	ImGui::Text("- Live memory:"); ImGui::SameLine();
+	ImGui::TextColored(color, "%.2f MB (per-frame peak %.2f MB)", stats.live_bytes / MEMORY_MB, stats.peak_bytes / MEMORY_MB);
+	ImGui::Text("- Live allocations:"); ImGui::SameLine();
+	ImGui::TextColored(color, "%lld", stats.live_count);
+	ImGui::Text("- Last frame:"); ImGui::SameLine();
+	ImGui::TextColored(color, "%llu (%llu since start)", stats.frame_count, stats.total_count);
+	ImGui::Text("- Samples:"); ImGui::SameLine();
+	ImGui::TextColored(color, "%u live, %u dropped, %u threads", stats.samples, stats.dropped, stats.threads);
+	ImGui::Spacing();
+
+	// Callsites with more live memory (estimated from the samples) ---------------
+	std::vector<AllocatorCallsite> callsites;
+	AllocatorGetCallsites(callsites);
+
+	ImGui::BulletText("TOP CALLSITES (KB)");
+	ImGui::Columns(3, "memory_callsites");
+	ImGui::SetColumnWidth(0, ImGui::GetWindowWidth() - 180.0f);
+	ImGui::Text("Callsite"); ImGui::NextColumn();
+	ImGui::Text("Live"); ImGui::NextColumn();
+	ImGui::Text("Samples"); ImGui::NextColumn();
+	ImGui::Separator();
+	for (uint i = 0; i < callsites.size() && i < MEMORY_TRACKER_TOP; i++)
+	{
+		const AllocatorCallsite& callsite = callsites[i];
+
+		// The first frame outside the STL (containers & strings allocate for their owner)
+		const char* name = "?";
+		for (uint f = 0; f < callsite.num_frames; f++)
+		{
+			name = GetSymbol(callsite.frames[f]);
+			if (strncmp(name, "std::", 5) != 0)
+			{
+				break;
+			}
+		}
+		ImGui::Text("%s", name);
+		if (ImGui::IsItemHovered())
+		{
+			ImGui::BeginTooltip();
+			for (uint f = 0; f < callsite.num_frames; f++)
+			{
+				ImGui::Text("%s", GetSymbol(callsite.frames[f]));
+			}
+			ImGui::EndTooltip();
+		}
+		ImGui::NextColumn();
+		ImGui::Text("%.1f", callsite.live_bytes / 1024.0); ImGui::NextColumn();
+		ImGui::Text("%u", callsite.live_samples); ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+}
+
+const char* MemoryTracker::GetSymbol(void* address)
+{
+	std::map<void*, std::string>::iterator it = symbols.find(address);
+	if (it == symbols.end())
+	{
+		char name[512];
+		AllocatorGetSymbol(address, name, sizeof(name));
+		it = symbols.insert(std::pair<void*, std::string>(address, name)).first;
+	}
+	return it->second.c_str();
+}
@@ -0,0 +1,73 @@
+#ifndef _MEMORY_TRACKER_
+#define _MEMORY_TRACKER_
+
+#include "Globals.h"
+#include "PerfTimer.h"
+#include <map>
+#include <string>
+
+#define MEMORY_TRACKER_INTERVAL 1000.0	/* ms between measures of the scene & editor */
+#define MEMORY_TRACKER_TOP 15			/* Resources & callsites listed in the panel */
+
+typedef struct json_object_t JSON_Object;
+
+enum MemoryTag
+{
+	MEMORY_MESHES = 0,
+	MEMORY_TEXTURES,
+	MEMORY_SCRIPTS,
+	MEMORY_SCENE,		/* GameObjects, component pools, transforms & octree */
+	MEMORY_JSON,		/* JSONWriter buffers & JSONArena blocks */
+	MEMORY_EDITOR,		/* Console, profiler, frame stats, scene framebuffer & fonts */
+	MEMORY_TAG_MAX
+};
+
+enum MemoryPool
+{
+	MEMORY_CPU = 0,
+	MEMORY_GPU,
+	MEMORY_POOL_MAX
+};
+
+// Bytes added (negative: released) to a tag, from any thread
+void MemoryAdd(MemoryTag tag, MemoryPool pool, __int64 bytes);
+__int64 MemoryGetUsed(MemoryTag tag, MemoryPool pool);
+__int64 MemoryGetPeak(MemoryTag tag, MemoryPool pool);
+const char* MemoryTagName(MemoryTag tag);
+
+// Memory Tracker ---------------------------------------------
+// Resources & buffers report their bytes when they change (MemoryAdd or
+// Resource::SetMemory), the scene & the editor are measured every
+// MEMORY_TRACKER_INTERVAL. When a tag goes over its budget (CPU + GPU)
+// a warning is logged once, until it goes under it again.
+// The allocations of new/delete are counted by the tracking allocator
+// (MemoryAllocator.h) in Debug builds, its totals & callsites are shown here.
+class MemoryTracker
+{
+public:
+	MemoryTracker();
+	~MemoryTracker();
+
+	void Load(const JSON_Object* node);		/* "Memory Budgets" & allocator settings of the Application config */
+	void Save(JSON_Object* node) const;
+
+	void Update();
+	void ShowMemory();
+	void ShowAllocator();
+
+private:
+	void Measure();
+	void CheckBudgets();
+	const char* GetSymbol(void* address);
+
+public:
+	float budgets[MEMORY_TAG_MAX];	/* MB, 0 = no budget */
+
+private:
+	__int64 measured[MEMORY_TAG_MAX][MEMORY_POOL_MAX]; /* Last measure of the sampled tags */
+	bool over_budget[MEMORY_TAG_MAX];
+	PerfTimer timer;
+	std::map<void*, std::string> symbols;	/* Resolved return addresses of the callsites */
+};
+
+#endif
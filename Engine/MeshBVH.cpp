@@ -0,0 +1,365 @@
+#include "MeshBVH.h"
+#include "MeshGeometry.h"
+#include "MathGeoLib.h"
+
+MeshBVH::MeshBVH()
+{
+}
+
+MeshBVH::~MeshBVH()
+{
+	Clear();
+}
+
+void MeshBVH::Build(const MeshGeometry& geometry)
+{
+	Clear();
+
+	uint num_triangles = geometry.GetNumIndices() / 3;
+	if (num_triangles == 0)
+	{
+		return;
+	}
+
+	// Bounds & centroids of all triangles (only needed while building)
+	std::vector<AABB> boxes(num_triangles);
+	std::vector<float3> centroids(num_triangles);
+	triangles.resize(num_triangles);
+	for (uint i = 0; i < num_triangles; i++)
+	{
+		float3 a = geometry.GetVertex(geometry.GetIndex(i * 3));
+		float3 b = geometry.GetVertex(geometry.GetIndex(i * 3 + 1));
+		float3 c = geometry.GetVertex(geometry.GetIndex(i * 3 + 2));
+		boxes[i].minPoint = a.Min(b).Min(c);
+		boxes[i].maxPoint = a.Max(b).Max(c);
+		centroids[i] = (a + b + c) / 3.0f;
+		triangles[i] = i;
+	}
+
+	// A binary tree never has more than 2n - 1 nodes
+	nodes.reserve(num_triangles * 2);
+	nodes.push_back(BVHNode());
+	nodes[0].left_first = 0;
+	nodes[0].count = num_triangles;
+	UpdateBounds(0, boxes);
+
+	// Split iteratively (node, depth), deep trees would overflow the call stack
+	std::vector<std::pair<uint, uint>> stack;
+	stack.push_back(std::pair<uint, uint>(0, 1));
+	while (stack.size() > 0)
+	{
+		uint node = stack.back().first;
+		uint node_depth = stack.back().second;
+		stack.pop_back();
+
+		if (node_depth > depth)
+		{
+			depth = node_depth;
+		}
+
+		// Keep the depth under the size of the traversal stack
+		if (node_depth >= BVH_STACK_SIZE - 1)
+		{
+			continue;
+		}
+
+		Subdivide(node, boxes, centroids);
+		if (nodes[node].count == 0)
+		{
+			stack.push_back(std::pair<uint, uint>(nodes[node].left_first, node_depth + 1));
+			stack.push_back(std::pair<uint, uint>(nodes[node].left_first + 1, node_depth + 1));
+		}
+	}
+
+	// Usually much less nodes than reserved
+	std::vector<BVHNode>(nodes).swap(nodes);
+}
+
+void MeshBVH::Clear()
+{
+	nodes.clear();
+	triangles.clear();
+	depth = 0;
+}
+
+bool MeshBVH::IsBuilt() const
+{
+	return nodes.size() > 0;
+}
+
+// Slab test, t_near is the entry distance (0 if the origin is inside)
+static inline bool IntersectNode(const BVHNode& node, const float3& origin, const float3& inv_dir, float max_t, float& t_near)
+{
+	float t1 = (node.min_point.x - origin.x) * inv_dir.x;
+	float t2 = (node.max_point.x - origin.x) * inv_dir.x;
+	float t_min = Min(t1, t2);
+	float t_max = Max(t1, t2);
+
+	t1 = (node.min_point.y - origin.y) * inv_dir.y;
+	t2 = (node.max_point.y - origin.y) * inv_dir.y;
+	t_min = Max(t_min, Min(t1, t2));
+	t_max = Min(t_max, Max(t1, t2));
+
+	t1 = (node.min_point.z - origin.z) * inv_dir.z;
+	t2 = (node.max_point.z - origin.z) * inv_dir.z;
+	t_min = Max(t_min, Min(t1, t2));
+	t_max = Min(t_max, Max(t1, t2));
+
+	t_near = Max(t_min, 0.0f);
+	return t_max >= t_near && t_near <= max_t;
+}
+
+bool MeshBVH::RayCast(const Ray& ray, float max_distance, const MeshGeometry& geometry,
+	float& distance, uint* triangle) const
+{
+	if (nodes.size() == 0)
+	{
+		return false;
+	}
+
+	float3 inv_dir(1.0f / ray.dir.x, 1.0f / ray.dir.y, 1.0f / ray.dir.z);
+	float best = max_distance;
+	bool ret = false;
+
+	float t_near = 0.0f;
+	if (IntersectNode(nodes[0], ray.pos, inv_dir, best, t_near) == false)
+	{
+		return false;
+	}
+
+	// Nodes pending to visit with their entry distance
+	uint stack[BVH_STACK_SIZE];
+	float stack_t[BVH_STACK_SIZE];
+	int top = 0;
+	stack[top] = 0;
+	stack_t[top++] = t_near;
+
+	while (top > 0)
+	{
+		top--;
+		if (stack_t[top] > best)
+		{
+			continue;
+		}
+		const BVHNode& node = nodes[stack[top]];
+
+		// Leaf: test its triangles
+		if (node.count > 0)
+		{
+			float u, v;
+			for (uint i = node.left_first; i < node.left_first + node.count; i++)
+			{
+				uint tri = triangles[i];
+				float t = Triangle::IntersectLineTri(ray.pos, ray.dir, geometry.GetVertex(geometry.GetIndex(tri * 3)),
+					geometry.GetVertex(geometry.GetIndex(tri * 3 + 1)), geometry.GetVertex(geometry.GetIndex(tri * 3 + 2)), u, v);
+				if (t >= 0.0f && t <= best)
+				{
+					best = t;
+					ret = true;
+					if (triangle != nullptr)
+					{
+						*triangle = tri;
+					}
+				}
+			}
+			continue;
+		}
+
+		// Push the farthest child first, then the nearest is visited before
+		float t_left = 0.0f, t_right = 0.0f;
+		bool hit_left = IntersectNode(nodes[node.left_first], ray.pos, inv_dir, best, t_left);
+		bool hit_right = IntersectNode(nodes[node.left_first + 1], ray.pos, inv_dir, best, t_right);
+		if (hit_left && hit_right)
+		{
+			bool left_first = t_left <= t_right;
+			stack[top] = left_first ? node.left_first + 1 : node.left_first;
+			stack_t[top++] = left_first ? t_right : t_left;
+			stack[top] = left_first ? node.left_first : node.left_first + 1;
+			stack_t[top++] = left_first ? t_left : t_right;
+		}
+		else if (hit_left)
+		{
+			stack[top] = node.left_first;
+			stack_t[top++] = t_left;
+		}
+		else if (hit_right)
+		{
+			stack[top] = node.left_first + 1;
+			stack_t[top++] = t_right;
+		}
+	}
+
+	if (ret)
+	{
+		distance = best;
+	}
+	return ret;
+}
+
+uint MeshBVH::GetNumNodes() const
+{
+	return nodes.size();
+}
+
+uint MeshBVH::GetDepth() const
+{
+	return depth;
+}
+
+uint MeshBVH::GetMemory() const
+{
+	return nodes.capacity() * sizeof(BVHNode) + triangles.capacity() * sizeof(uint);
+}
+
+// Split a leaf with the Surface Area Heuristic evaluated in BVH_BINS bins per axis.
+// The node stays as a leaf when splitting is more expensive than testing its triangles.
+void MeshBVH::Subdivide(uint node, const std::vector<AABB>& boxes, const std::vector<float3>& centroids)
+{
+	uint first = nodes[node].left_first;
+	uint count = nodes[node].count;
+	if (count <= BVH_LEAF_SIZE)
+	{
+		return;
+	}
+
+	// The bins are distributed along the bounds of the centroids
+	float3 centroid_min = centroids[triangles[first]];
+	float3 centroid_max = centroid_min;
+	for (uint i = first + 1; i < first + count; i++)
+	{
+		centroid_min = centroid_min.Min(centroids[triangles[i]]);
+		centroid_max = centroid_max.Max(centroids[triangles[i]]);
+	}
+
+	int best_axis = -1;
+	int best_bin = 0;
+	float best_cost = FLOAT_INF;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float extent = centroid_max[axis] - centroid_min[axis];
+		if (extent <= 0.0f)
+		{
+			continue;
+		}
+
+		AABB bin_box[BVH_BINS];
+		uint bin_count[BVH_BINS];
+		for (int b = 0; b < BVH_BINS; b++)
+		{
+			bin_box[b].SetNegativeInfinity();
+			bin_count[b] = 0;
+		}
+
+		float scale = BVH_BINS / extent;
+		for (uint i = first; i < first + count; i++)
+		{
+			uint tri = triangles[i];
+			int b = Min(BVH_BINS - 1, (int)((centroids[tri][axis] - centroid_min[axis]) * scale));
+			bin_count[b]++;
+			bin_box[b].Enclose(boxes[tri]);
+		}
+
+		// Sweep from both sides to get the area & count at each side of every plane
+		float left_area[BVH_BINS - 1];
+		uint left_count[BVH_BINS - 1];
+		AABB accum;
+		accum.SetNegativeInfinity();
+		uint sum = 0;
+		for (int b = 0; b < BVH_BINS - 1; b++)
+		{
+			sum += bin_count[b];
+			if (bin_count[b] > 0)
+			{
+				accum.Enclose(bin_box[b]);
+			}
+			left_count[b] = sum;
+			left_area[b] = (sum > 0) ? accum.SurfaceArea() : 0.0f;
+		}
+
+		accum.SetNegativeInfinity();
+		sum = 0;
+		for (int b = BVH_BINS - 1; b > 0; b--)
+		{
+			sum += bin_count[b];
+			if (bin_count[b] > 0)
+			{
+				accum.Enclose(bin_box[b]);
+			}
+
+			// Plane between bins b - 1 and b
+			if (sum > 0 && left_count[b - 1] > 0)
+			{
+				float cost = left_count[b - 1] * left_area[b - 1] + sum * accum.SurfaceArea();
+				if (cost < best_cost)
+				{
+					best_cost = cost;
+					best_axis = axis;
+					best_bin = b - 1;
+				}
+			}
+		}
+	}
+
+	if (best_axis == -1)
+	{
+		return;
+	}
+
+	AABB node_box(nodes[node].min_point, nodes[node].max_point);
+	float leaf_cost = count * node_box.SurfaceArea();
+	if (best_cost >= leaf_cost && count <= BVH_MAX_LEAF_SIZE)
+	{
+		return;
+	}
+
+	// Partition the triangles of the node (same bin calculation as above)
+	float scale = BVH_BINS / (centroid_max[best_axis] - centroid_min[best_axis]);
+	int i = first;
+	int j = first + count - 1;
+	while (i <= j)
+	{
+		int b = Min(BVH_BINS - 1, (int)((centroids[triangles[i]][best_axis] - centroid_min[best_axis]) * scale));
+		if (b <= best_bin)
+		{
+			i++;
+		}
+		else
+		{
+			uint tmp = triangles[i];
+			triangles[i] = triangles[j];
+			triangles[j--] = tmp;
+		}
+	}
+
+	uint num_left = i - first;
+	if (num_left == 0 || num_left == count)
+	{
+		return;
+	}
+
+	uint left = nodes.size();
+	nodes.push_back(BVHNode());
+	nodes.push_back(BVHNode());
+	nodes[left].left_first = first;
+	nodes[left].count = num_left;
+	nodes[left + 1].left_first = i;
+	nodes[left + 1].count = count - num_left;
+	nodes[node].left_first = left;
+	nodes[node].count = 0;
+
+	UpdateBounds(left, boxes);
+	UpdateBounds(left + 1, boxes);
+}
+
+void MeshBVH::UpdateBounds(uint node, const std::vector<AABB>& boxes)
+{
+	AABB box;
+	box.SetNegativeInfinity();
+	for (uint i = nodes[node].left_first; i < nodes[node].left_first + nodes[node].count; i++)
+	{
+		box.Enclose(boxes[triangles[i]]);
+	}
+	nodes[node].min_point = box.minPoint;
+	nodes[node].max_point = box.maxPoint;
+}
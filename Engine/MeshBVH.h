@@ -0,0 +1,58 @@
+#ifndef _MESH_BVH_
+#define _MESH_BVH_
+
+#include "Globals.h"
+#include "Math/float3.h"
+#include "MathGeoLibFwd.h"
+#include <vector>
+
+class MeshGeometry;
+
+#define BVH_BINS 12
+#define BVH_LEAF_SIZE 4		// Leafs with less triangles are not split
+#define BVH_MAX_LEAF_SIZE 32	// Leafs with more triangles are always split (if possible)
+#define BVH_STACK_SIZE 64
+
+// Node of 32 bytes: internal nodes have count = 0 and their childs
+// are consecutive (left_first & left_first + 1), leafs point to their first triangle.
+struct BVHNode
+{
+	float3 min_point;
+	uint left_first = 0;
+	float3 max_point;
+	uint count = 0;
+};
+
+// Bounding Volume Hierarchy of the triangles of a mesh ---------
+// Built once (binned SAH) when the mesh is loaded, then ray casts only test
+// the triangles of the leafs the ray crosses. Vertices & indices are not copied,
+// the same geometry used in Build() has to be passed to RayCast().
+class MeshBVH
+{
+public:
+	MeshBVH();
+	~MeshBVH();
+
+	void Build(const MeshGeometry& geometry);
+	void Clear();
+	bool IsBuilt() const;
+
+	// Nearest hit with t in [0, max_distance] (ray direction normalized, local space of the mesh)
+	bool RayCast(const Ray& ray, float max_distance, const MeshGeometry& geometry,
+		float& distance, uint* triangle = nullptr) const;
+
+	uint GetNumNodes() const;
+	uint GetDepth() const;
+	uint GetMemory() const;	/* Bytes of the nodes & triangle indices */
+
+private:
+	void Subdivide(uint node, const std::vector<AABB>& boxes, const std::vector<float3>& centroids);
+	void UpdateBounds(uint node, const std::vector<AABB>& boxes);
+
+private:
+	std::vector<BVHNode> nodes;
+	std::vector<uint> triangles;	// Triangle index (first index / 3) sorted by leafs
+	uint depth = 0;
+};
+
+#endif
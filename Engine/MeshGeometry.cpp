@@ -0,0 +1,129 @@
+#include "MeshGeometry.h"
+#include "MathGeoLib.h"
+
+MeshGeometry::MeshGeometry()
+{
+}
+
+MeshGeometry::~MeshGeometry()
+{
+}
+
+// Exact positions, the file isn't quantized
+void MeshGeometry::Set(const float3* vertices, uint num_vertices, const void* indices, bool indices_16, uint num_indices)
+{
+	quantized = false;
+	this->num_vertices = num_vertices;
+	offset = float3::zero;
+	scale = 1.0f;
+	positions.assign(vertices, vertices + num_vertices);
+	std::vector<short>().swap(positions_16);
+
+	AABB box;
+	box.SetNegativeInfinity();
+	box.Enclose(vertices, num_vertices);
+	min_point = (num_vertices > 0) ? box.minPoint : float3::zero;
+	max_point = (num_vertices > 0) ? box.maxPoint : float3::zero;
+
+	SetIndices(indices, indices_16, num_indices);
+}
+
+// The same values of the quantized file, decoded by GetVertex()
+void MeshGeometry::SetQuantized(const float3& offset, float scale, const short* vertices, uint num_vertices,
+	const void* indices, bool indices_16, uint num_indices)
+{
+	quantized = true;
+	this->num_vertices = num_vertices;
+	this->offset = offset;
+	this->scale = scale;
+	positions_16.assign(vertices, vertices + num_vertices * 3);
+	std::vector<float3>().swap(positions);
+
+	min_point = max_point = (num_vertices > 0) ? GetVertex(0) : float3::zero;
+	for (uint i = 1; i < num_vertices; i++)
+	{
+		float3 vertex = GetVertex(i);
+		min_point = min_point.Min(vertex);
+		max_point = max_point.Max(vertex);
+	}
+
+	SetIndices(indices, indices_16, num_indices);
+}
+
+// 16 bits when all the vertices can be addressed, whatever the size of the source
+void MeshGeometry::SetIndices(const void* indices, bool indices_16, uint num_indices)
+{
+	use_indices_16 = (num_vertices <= 0xFFFF);
+	std::vector<unsigned short>().swap(this->indices_16);
+	std::vector<uint>().swap(indices_32);
+
+	if (use_indices_16)
+	{
+		this->indices_16.resize(num_indices);
+		for (uint i = 0; i < num_indices; i++)
+		{
+			this->indices_16[i] = indices_16 ? ((const unsigned short*)indices)[i] : (unsigned short)((const uint*)indices)[i];
+		}
+	}
+	else if (indices_16)
+	{
+		const unsigned short* src = (const unsigned short*)indices;
+		indices_32.assign(src, src + num_indices);
+	}
+	else
+	{
+		const uint* src = (const uint*)indices;
+		indices_32.assign(src, src + num_indices);
+	}
+}
+
+void MeshGeometry::Clear()
+{
+	std::vector<float3>().swap(positions);
+	std::vector<short>().swap(positions_16);
+	std::vector<unsigned short>().swap(indices_16);
+	std::vector<uint>().swap(indices_32);
+	offset = min_point = max_point = float3::zero;
+	scale = 1.0f;
+	num_vertices = 0;
+	quantized = false;
+	use_indices_16 = true;
+}
+
+uint MeshGeometry::GetNumVertices() const
+{
+	return num_vertices;
+}
+
+uint MeshGeometry::GetNumIndices() const
+{
+	return use_indices_16 ? indices_16.size() : indices_32.size();
+}
+
+bool MeshGeometry::IsIndices16() const
+{
+	return use_indices_16;
+}
+
+const void* MeshGeometry::GetIndices() const
+{
+	return use_indices_16 ? (const void*)indices_16.data() : (const void*)indices_32.data();
+}
+
+void MeshGeometry::GetBounds(AABB& box) const
+{
+	if (num_vertices == 0)
+	{
+		box.SetNegativeInfinity();
+	}
+	else
+	{
+		box.minPoint = min_point;
+		box.maxPoint = max_point;
+	}
+}
+
+uint MeshGeometry::GetMemory() const
+{
+	return positions.capacity() * sizeof(float3) + positions_16.capacity() * sizeof(short) + indices_16.capacity() * sizeof(unsigned short) + indices_32.capacity() * sizeof(uint);
+}
@@ -0,0 +1,63 @@
+#ifndef _MESH_GEOMETRY_
+#define _MESH_GEOMETRY_
+
+#include "Globals.h"
+#include "Math/float3.h"
+#include "MathGeoLibFwd.h"
+#include <vector>
+
+// Positions & indices of a mesh kept in RAM (picking, BVH & bounding box) ---
+// Positions keep the format of the .mesh file: float, or 16 bit relative to the
+// bounds of the mesh (pos = offset + pos * scale) decoded when they are read.
+// Indices use 16 bits when all the vertices can be addressed.
+class MeshGeometry
+{
+public:
+	MeshGeometry();
+	~MeshGeometry();
+
+	void Set(const float3* vertices, uint num_vertices, const void* indices, bool indices_16, uint num_indices);
+	void SetQuantized(const float3& offset, float scale, const short* vertices, uint num_vertices,
+		const void* indices, bool indices_16, uint num_indices);
+	void Clear();
+
+	inline float3 GetVertex(uint vertex) const
+	{
+		if (quantized == false)
+		{
+			return positions[vertex];
+		}
+		const short* pos = &positions_16[vertex * 3];
+		return offset + float3(pos[0], pos[1], pos[2]) * scale;
+	}
+
+	inline uint GetIndex(uint index) const
+	{
+		return use_indices_16 ? indices_16[index] : indices_32[index];
+	}
+
+	uint GetNumVertices() const;
+	uint GetNumIndices() const;
+	bool IsIndices16() const;
+	const void* GetIndices() const;	/* unsigned short or uint (IsIndices16), the GPU format */
+	void GetBounds(AABB& box) const;	/* Negative infinity without vertices */
+	uint GetMemory() const;
+
+private:
+	void SetIndices(const void* indices, bool indices_16, uint num_indices);
+
+private:
+	std::vector<float3> positions;		/* Not quantized */
+	std::vector<short> positions_16;	/* Quantized: x, y, z of each vertex */
+	std::vector<unsigned short> indices_16;
+	std::vector<uint> indices_32;	/* Only with more than 0xFFFF vertices */
+	float3 offset = float3::zero;
+	float scale = 1.0f;
+	float3 min_point = float3::zero;
+	float3 max_point = float3::zero;
+	uint num_vertices = 0;
+	bool quantized = false;
+	bool use_indices_16 = true;
+};
+
+#endif
@@ -0,0 +1,148 @@
+#include "MeshQuantization.h"
+#include <string.h>
+#include <math.h>
+
+unsigned short FloatToHalf(float value)
+{
+	uint bits = 0;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint sign = (bits >> 16) & 0x8000;
+	uint exponent_bits = (bits >> 23) & 0xFF;
+	uint mantissa = bits & 0x7FFFFF;
+	int exponent = (int)exponent_bits - 127 + 15;
+
+	// Inf / NaN
+	if (exponent_bits == 0xFF)
+	{
+		return (unsigned short)(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+	}
+
+	// Too big, clamp to Inf
+	if (exponent >= 31)
+	{
+		return (unsigned short)(sign | 0x7C00);
+	}
+
+	// Denormal half (or zero)
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+		{
+			return (unsigned short)sign;
+		}
+		mantissa |= 0x800000;
+		uint shift = 14 - exponent;
+		uint half = mantissa >> shift;
+		if ((mantissa >> (shift - 1)) & 1)
+		{
+			half++;
+		}
+		return (unsigned short)(sign | half);
+	}
+
+	// Round to nearest, the carry can go to the exponent (that's still correct)
+	uint half = sign | (exponent << 10) | (mantissa >> 13);
+	if (mantissa & 0x1000)
+	{
+		half++;
+	}
+	return (unsigned short)half;
+}
+
+float HalfToFloat(unsigned short value)
+{
+	uint sign = (uint)(value & 0x8000) << 16;
+	int exponent = (value >> 10) & 0x1F;
+	uint mantissa = value & 0x3FF;
+	uint bits = 0;
+
+	if (exponent == 0)
+	{
+		if (mantissa == 0)
+		{
+			bits = sign;
+		}
+		else
+		{
+			// Denormal half, normalize it
+			exponent = 1;
+			while ((mantissa & 0x400) == 0)
+			{
+				mantissa <<= 1;
+				exponent--;
+			}
+			mantissa &= 0x3FF;
+			bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		}
+	}
+	else if (exponent == 31)
+	{
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+
+	float result = 0.0f;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+void OctEncode(const float3& normal, signed char* oct)
+{
+	float length = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+	if (length <= 0.0f)
+	{
+		oct[0] = oct[1] = 0;
+		return;
+	}
+
+	float x = normal.x / length;
+	float y = normal.y / length;
+
+	// Lower hemisphere is folded over the diagonals
+	if (normal.z < 0.0f)
+	{
+		float fold_x = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		float fold_y = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = fold_x;
+		y = fold_y;
+	}
+
+	oct[0] = FloatToSnorm8(x);
+	oct[1] = FloatToSnorm8(y);
+}
+
+float3 OctDecode(const signed char* oct)
+{
+	float x = oct[0] / 127.0f;
+	float y = oct[1] / 127.0f;
+	float3 normal(x, y, 1.0f - fabsf(x) - fabsf(y));
+
+	if (normal.z < 0.0f)
+	{
+		normal.x = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		normal.y = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	float length = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+	if (length > 0.0f)
+	{
+		normal /= length;
+	}
+	return normal;
+}
+
+signed char FloatToSnorm8(float value)
+{
+	value = (value > 1.0f) ? 1.0f : ((value < -1.0f) ? -1.0f : value);
+	return (signed char)floorf(value * 127.0f + 0.5f);
+}
+
+short FloatToSnorm16(float value)
+{
+	value = (value > 1.0f) ? 1.0f : ((value < -1.0f) ? -1.0f : value);
+	return (short)floorf(value * 32767.0f + 0.5f);
+}
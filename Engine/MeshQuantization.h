@@ -0,0 +1,21 @@
+#ifndef _MESH_QUANTIZATION_
+#define _MESH_QUANTIZATION_
+
+#include "Globals.h"
+#include "Math/float3.h"
+
+// Compression helpers of the mesh data (.mesh v2) ---------
+// Half floats: IEEE 754 binary16 (tex coords)
+// Octahedral normals: unit vector projected on an octahedron and unfolded to 2 snorm8 values
+
+unsigned short FloatToHalf(float value);
+float HalfToFloat(unsigned short value);
+
+void OctEncode(const float3& normal, signed char* oct);
+float3 OctDecode(const signed char* oct);
+
+// Float in [-1, 1] to snorm (127 or 32767 steps)
+signed char FloatToSnorm8(float value);
+short FloatToSnorm16(float value);
+
+#endif
@@ -15,6 +15,7 @@
 
 #include "ImGui/imgui.h"
 #include "Geometry/Frustum.h"
+#include "Geometry/Ray.h"
 #include <map>
 
 #define ASPECT_RATIO 16/9
@@ -89,8 +90,6 @@ bool ModuleCamera3D::CleanUp()
 // -----------------------------------------------------------------
 update_status ModuleCamera3D::Update(float dt)
 {
-	perf_timer.Start();
-
 	if (App->engineState == EngineState::STOP) //Block camera movement while game is executing
 	{
 		ImGuiIO& io = ImGui::GetIO();
@@ -161,7 +160,6 @@ update_status ModuleCamera3D::Update(float dt)
 		}		
 	}
 
-	Update_t = perf_timer.ReadMs();
 	return UPDATE_CONTINUE;
 }
 
@@ -274,14 +272,14 @@ void ModuleCamera3D::MousePick(float x, float y, float w, float h)
 	// Generate camera ray
 	ray = cam->frustum.UnProjectLineSegment(norm_x, norm_y);
 
-	// Iterate all AABB of gameobjects
-	entry_dist = 0.0f;
-	exit_dist = ray.Length();
+	// Get the objects of the octree crossed by the ray (all the objects with AABB are inside)
+	pick_candidates.clear();
+	App->scene->octree.CollectCandidates(pick_candidates, ray, false);
 
-	for (uint i = 0; i < App->scene->gameobjects.size(); i++)
+	for (uint i = 0; i < pick_candidates.size(); i++)
 	{
 		// Check intersection ray-AABB
-		CheckAABBIntersection(App->scene->gameobjects[i], entry_dist, exit_dist);
+		CheckAABBIntersection(App->scene->octree.GetObjectByHandle(pick_candidates[i]), entry_dist, exit_dist);
 	}
 
 	if (possible_intersections.size() > 0)
@@ -293,23 +291,14 @@ void ModuleCamera3D::MousePick(float x, float y, float w, float h)
 
 void ModuleCamera3D::CheckAABBIntersection(GameObject* candidate, float& entry_dist, float& exit_dist)
 {
-	if (candidate->isActive())
+	if (candidate != nullptr && candidate->bounding_box != nullptr && candidate->isActiveInHierarchy())
 	{
-		if (candidate->bounding_box != nullptr)
-		{
-			box = &candidate->box_fixed;
-			bool hit = ray.Intersects(*box, entry_dist, exit_dist);
-			if (hit)
-			{
-				// Set a list of possible intersections (sorted from closest to farthest)
-				possible_intersections.insert(std::pair<float, GameObject*>(entry_dist, candidate));
-			}
-		}
-
-		// Check intersection for childs
-		for (uint i = 0; i < candidate->GetChildsVec().size(); i++)
+		box = &candidate->box_fixed;
+		bool hit = ray.Intersects(*box, entry_dist, exit_dist);
+		if (hit)
 		{
-			CheckAABBIntersection(candidate->GetChildsVec()[i], entry_dist, exit_dist);
+			// Set a list of possible intersections (sorted from closest to farthest)
+			possible_intersections.insert(std::pair<float, GameObject*>(entry_dist, candidate));
 		}
 	}
 }
@@ -318,43 +307,58 @@ void ModuleCamera3D::CheckGeometryIntersection()
 {
 	// RESET VARIABLES
 	hit = false;
-	entry_dist = 0;
 	hit_point = float3::zero;
 	min_distance = INFINITY;
-	ray_local_space = ray;
 	best_candidate = nullptr;
 	const CompTransform* trans = nullptr;
 	const CompMesh* mesh = nullptr;
-	Triangle tri;
 
 	for (it = possible_intersections.begin(); it != possible_intersections.end(); ++it)
 	{
-		if (it->second->GetComponentTransform() != nullptr && it->second->FindComponentByType(C_MESH))
+		// Sorted by the entry distance to the AABB, the next ones can't be closer than the current hit
+		if (it->first > min_distance)
+		{
+			break;
+		}
+
+		trans = it->second->GetComponentTransform();
+		mesh = (CompMesh*)it->second->FindComponentByType(C_MESH);
+		// Meshes still streaming aren't picked
+		if (trans == nullptr || mesh == nullptr || mesh->resourceMesh == nullptr ||
+			mesh->resourceMesh->IsLoadedToMemory() != Resource::State::LOADED)
 		{
-			trans = it->second->GetComponentTransform();
-			mesh = (CompMesh*)it->second->FindComponentByType(C_MESH);
+			continue;
+		}
+		ResourceMesh* resource = mesh->resourceMesh;
 
-			// Transform ray coordinates into local space coordinates of the object
-			float4x4 object_transform = it->second->GetComponentTransform()->GetGlobalTransform();
-			ray_local_space.Transform(object_transform.Inverted());
+		// Transform ray coordinates into local space coordinates of the object (always from the world ray)
+		ray_local_space = ray;
+		ray_local_space.Transform(trans->GetGlobalTransform().Inverted());
+		float length = ray_local_space.Length();
+		if (length <= 0.0f)
+		{
+			continue;
+		}
 
-			for (uint i = 0; i < mesh->resourceMesh->num_indices; i += 3)
-			{
-				// Set Triangle vertices
-				tri.a = mesh->resourceMesh->vertices[mesh->resourceMesh->indices[i]].pos;
-				tri.b = mesh->resourceMesh->vertices[mesh->resourceMesh->indices[i + 1]].pos;
-				tri.c = mesh->resourceMesh->vertices[mesh->resourceMesh->indices[i + 2]].pos;
-				hit = ray_local_space.Intersects(tri, &entry_dist, &hit_point);
+		if (resource->bvh.IsBuilt() == false)
+		{
+			resource->bvh.Build(resource->geometry);
+			resource->UpdateMemory();
+		}
 
-				if (hit)
-				{
-					if (entry_dist < min_distance)
-					{
-						// Set the Game Objet to be picked
-						min_distance = entry_dist;
-						best_candidate = it->second;
-					}
-				}
+		float distance = 0.0f;
+		Ray local_ray(ray_local_space.a, (ray_local_space.b - ray_local_space.a) / length);
+		if (resource->bvh.RayCast(local_ray, length, resource->geometry, distance))
+		{
+			// Distance as a fraction of the segment, the same in local and world space
+			distance /= length;
+			if (distance < min_distance)
+			{
+				// Set the Game Objet to be picked
+				hit = true;
+				min_distance = distance;
+				hit_point = ray.GetPoint(distance);
+				best_candidate = it->second;
 			}
 		}
 	}
@@ -5,6 +5,7 @@
 #include "Globals.h"
 #include "Geometry/LineSegment.h"
 #include <map>
+#include <vector>
 
 #define MARGE_MIN 5
 #define MARGE_MAX 25
@@ -70,7 +71,8 @@ private:
 	float3 point_to_look = { 0, 0, 0 };
 
 	/* Mouse Picking */
-	std::map<float, GameObject*> possible_intersections;
+	std::multimap<float, GameObject*> possible_intersections;
+	std::vector<int> pick_candidates;
 	const AABB* box = nullptr;
 	float norm_x = 0.0f;
 	float norm_y = 0.0f;
@@ -81,7 +83,7 @@ private:
 	float min_distance = INFINITY;
 	LineSegment ray_local_space = ray;
 	GameObject* best_candidate = nullptr;
-	std::map<float, GameObject*>::iterator it;
+	std::multimap<float, GameObject*>::iterator it;
 
 	/* Camera Movement */
 	float3 cam_move = { 0, 0, 0 };
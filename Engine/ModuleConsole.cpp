@@ -56,14 +56,11 @@ Console::~Console()
 
 update_status Console::Update(float dt)
 {
-	perf_timer.Start();
-
 	if (App->input->GetKey(SDL_SCANCODE_GRAVE) == KEY_UP)
 	{
 		OpenClose();
 	}
 
-	Update_t = perf_timer.ReadMs();
 	return UPDATE_CONTINUE;
 }
 
@@ -98,6 +95,20 @@ void Console::ClearLog()
 	ScrollToBottom = true;
 }
 
+uint Console::GetMemory() const
+{
+	uint memory = (Items.Capacity + History.Capacity) * sizeof(char*);
+	for (int i = 0; i < Items.Size; i++)
+	{
+		memory += strlen(Items[i]) + 1;
+	}
+	for (int i = 0; i < History.Size; i++)
+	{
+		memory += strlen(History[i]) + 1;
+	}
+	return memory;
+}
+
 void Console::AddLog(const char* fmt, ...) IM_PRINTFARGS(2)
 {
 	char buf[1024];
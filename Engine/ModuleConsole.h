@@ -23,6 +23,7 @@ public:
 	bool IsOpen();
 
 	void ClearLog();
+	uint GetMemory() const;		/* Bytes of the lines & history */
 	void AddLog(const char*, ...) IM_PRINTFARGS(2);
 
 	void Draw(const char* title);
@@ -7,6 +7,13 @@
 #include "JSONSerialization.h"
 #include "TextEditor.h"
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 ModuleFS::ModuleFS(bool start_enabled) : Module(start_enabled)
 {
 	Start_enabled = true;
@@ -73,8 +80,6 @@ bool ModuleFS::Start()
 
 update_status ModuleFS::PreUpdate(float dt)
 {
-	perf_timer.Start();
-
 	if (App->input->GetKey(SDL_SCANCODE_N) == KEY_DOWN)
 	{
 		//App->resource_manager->resourcesToReimport.push_back(App->Json_seria->GetUUIDPrefab(allfilesAsstes[0].directory_name, 0));
@@ -100,7 +105,6 @@ update_status ModuleFS::PreUpdate(float dt)
 		//AnyfileModificated(allfilesAsstes); 
 	}
 
-	preUpdate_t = perf_timer.ReadMs();
 	return UPDATE_CONTINUE;
 }
 
@@ -662,36 +666,26 @@ bool ModuleFS::DeleteFileLibrary(const char* file, DIRECTORY_IMPORT directory)
 	return false;
 }
 
-uint ModuleFS::LoadFile(const char* file, char** buffer, DIRECTORY_IMPORT directory)
+// Name of the file in the directory (relative to the working directory)
+std::string ModuleFS::GetDirectoryPath(const std::string& file, DIRECTORY_IMPORT directory) const
 {
-	// First apply direcotry
-	std::string temp = file;
 	switch (directory)
 	{
-	case IMPORT_DEFAULT:
-	{
-		break;
+	case IMPORT_DIRECTORY_ASSETS:				return DIRECTORY_ASSETS + file;
+	case IMPORT_DIRECTORY_LIBRARY:				return DIRECTORY_LIBRARY + file;
+	case IMPORT_DIRECTORY_LIBRARY_MESHES:		return DIRECTORY_LIBRARY_MESHES + file;
+	case IMPORT_DIRECTORY_LIBRARY_MATERIALS:	return DIRECTORY_LIBRARY_MATERIALS + file;
+	default:									return file;
 	}
-	case IMPORT_DIRECTORY_ASSETS:
-	{
-		temp = DIRECTORY_ASSETS + temp;
-		break;
-	}
-	case IMPORT_DIRECTORY_LIBRARY:
-	{
-		temp = DIRECTORY_LIBRARY + temp;
-		break;
-	}
-	case IMPORT_DIRECTORY_LIBRARY_MESHES:
-	{
-		temp = DIRECTORY_LIBRARY_MESHES + temp;
-		break;
-	}
-	case IMPORT_DIRECTORY_LIBRARY_MATERIALS:
+}
+
+uint ModuleFS::LoadFile(const char* file, char** buffer, DIRECTORY_IMPORT directory)
+{
+	// Materials of the library are read by uuid (saved with their .dds)
+	std::string temp = GetDirectoryPath(file, directory);
+	if (directory == IMPORT_DIRECTORY_LIBRARY_MATERIALS)
 	{
-		temp = DIRECTORY_LIBRARY_MATERIALS + temp + ".dds";
-		break;
-	}
+		temp += ".dds";
 	}
 	std::ifstream is(temp, std::ifstream::binary);
 	int length = 0;
@@ -724,43 +718,123 @@ uint ModuleFS::LoadFile(const char* file, char** buffer, DIRECTORY_IMPORT direct
 	return length;
 }
 
-bool ModuleFS::SaveFile(const char* data, std::string name, uint size, DIRECTORY_IMPORT directory)
+bool ModuleFS::MapFile(const char* file, MappedFile& mapped, DIRECTORY_IMPORT directory)
 {
-	// First apply direcotry
-	switch (directory)
+	// Materials of the library are read by uuid (saved with their .dds)
+	std::string temp = GetDirectoryPath(file, directory);
+	if (directory == IMPORT_DIRECTORY_LIBRARY_MATERIALS)
 	{
-	case IMPORT_DEFAULT:
+		temp += ".dds";
+	}
+
+	mapped = MappedFile();
+#ifdef _WIN32
+	HANDLE handle = CreateFileA(temp.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (handle == INVALID_HANDLE_VALUE)
 	{
-		break;
+		LOG("Error to Map File -> %s", file);
+		return false;
 	}
-	case IMPORT_DIRECTORY_ASSETS:
+
+	// Empty files can't be mapped
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(handle, &size) == FALSE || size.QuadPart == 0 || size.HighPart != 0)
 	{
-		name = DIRECTORY_ASSETS + name;
-		break;
+		LOG("Error to Map File (size) -> %s", file);
+		CloseHandle(handle);
+		return false;
 	}
-	case IMPORT_DIRECTORY_LIBRARY:
+
+	HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
 	{
-		name = DIRECTORY_LIBRARY + name;
-		break;
+		LOG("Error to Map File (mapping) -> %s", file);
+		CloseHandle(handle);
+		return false;
 	}
-	case IMPORT_DIRECTORY_LIBRARY_MESHES:
+
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == NULL)
 	{
-		name = DIRECTORY_LIBRARY_MESHES + name;
-		break;
+		LOG("Error to Map File (view) -> %s", file);
+		CloseHandle(mapping);
+		CloseHandle(handle);
+		return false;
 	}
-	case IMPORT_DIRECTORY_LIBRARY_MATERIALS:
+
+	mapped.data = (const char*)view;
+	mapped.size = size.LowPart;
+	mapped.file = handle;
+	mapped.mapping = mapping;
+#else
+	int handle = open(temp.c_str(), O_RDONLY);
+	if (handle < 0)
 	{
-		name = DIRECTORY_LIBRARY_MATERIALS + name;
-		break;
+		LOG("Error to Map File -> %s", file);
+		return false;
+	}
+
+	// Empty files can't be mapped
+	struct stat info;
+	if (fstat(handle, &info) != 0 || info.st_size == 0 || (uint64)info.st_size > 0xFFFFFFFF)
+	{
+		LOG("Error to Map File (size) -> %s", file);
+		close(handle);
+		return false;
+	}
+
+	// The mapping keeps the file open
+	void* view = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+	close(handle);
+	if (view == MAP_FAILED)
+	{
+		LOG("Error to Map File (view) -> %s", file);
+		return false;
 	}
+
+	mapped.data = (const char*)view;
+	mapped.size = (uint)info.st_size;
+#endif
+	return true;
+}
+
+void ModuleFS::UnmapFile(MappedFile& mapped)
+{
+#ifdef _WIN32
+	if (mapped.data != nullptr)
+	{
+		UnmapViewOfFile(mapped.data);
+	}
+	if (mapped.mapping != nullptr)
+	{
+		CloseHandle(mapped.mapping);
+	}
+	if (mapped.file != nullptr)
+	{
+		CloseHandle(mapped.file);
+	}
+#else
+	if (mapped.data != nullptr)
+	{
+		munmap((void*)mapped.data, mapped.size);
 	}
+#endif
+	mapped = MappedFile();
+}
+
+bool ModuleFS::SaveFile(const char* data, std::string name, uint size, DIRECTORY_IMPORT directory)
+{
+	name = GetDirectoryPath(name, directory);
 	// Open or Created ----------------------------------------
 	std::ofstream outfile(name, std::ofstream::binary);
 
-	if (outfile.good())
+	bool ret = outfile.good();
+	if (ret)
 	{
 		// write to outfile
 		outfile.write(data, size);
+		ret = outfile.good();
 		LOG("Save File %s", name.c_str());
 	}
 	else
@@ -770,7 +844,7 @@ bool ModuleFS::SaveFile(const char* data, std::string name, uint size, DIRECTORY
 
 	outfile.close();
 	// ------------------------------------------------------------
-	return false;
+	return ret;
 }
 
 // Only Scripting!!! ------------------------------------------
@@ -1044,7 +1118,7 @@ JSON_Status ModuleFS::json_array_dotset_float2(JSON_Object *object, std::string
 	return JSONSuccess;
 }
 
-JSON_Status ModuleFS::json_array_dotset_float4(JSON_Object *object, std::string name, float4 transform)
+JSON_Status ModuleFS::json_array_dotset_float4(JSON_Object *object, std::string name, const float4& transform)
 {
 	JSON_Value* value = json_value_init_array();
 	if (value == NULL) {
@@ -1092,4 +1166,25 @@ float4 ModuleFS::json_array_dotget_float4_string(const JSON_Object* object, std:
 	transform.w = (float)json_value_get_number(json_array_get_value(array, 3));
 
 	return transform;
-}
\ No newline at end of file
+}
+float3 ModuleFS::json_array_get_float3_by_key(const JSON_Object* object, const JSON_Key& key)
+{
+	JSON_Array* array = json_object_get_array_by_key(object, &key);
+	float3 transform;
+	transform.x = (float)json_value_get_number(json_array_get_value(array, 0));
+	transform.y = (float)json_value_get_number(json_array_get_value(array, 1));
+	transform.z = (float)json_value_get_number(json_array_get_value(array, 2));
+
+	return transform;
+}
+float4 ModuleFS::json_array_get_float4_by_key(const JSON_Object* object, const JSON_Key& key)
+{
+	JSON_Array* array = json_object_get_array_by_key(object, &key);
+	float4 transform;
+	transform.x = (float)json_value_get_number(json_array_get_value(array, 0));
+	transform.y = (float)json_value_get_number(json_array_get_value(array, 1));
+	transform.z = (float)json_value_get_number(json_array_get_value(array, 2));
+	transform.w = (float)json_value_get_number(json_array_get_value(array, 3));
+
+	return transform;
+}
@@ -29,6 +29,15 @@ enum DIRECTORY_IMPORT
 	IMPORT_DIRECTORY_LIBRARY_SCRIPTS
 };
 
+// Read only view of a file mapped in memory (MapFile / UnmapFile)
+struct MappedFile
+{
+	const char* data = nullptr;
+	uint size = 0;
+	void* file = nullptr;		/* HANDLE of the file (Windows) */
+	void* mapping = nullptr;	/* HANDLE of the mapping (Windows) */
+};
+
 struct AllFiles
 {
 	const char* directory_name = nullptr;
@@ -52,9 +61,13 @@ public:
 
 	//update_status UpdateConfig(float dt);
 
+	std::string GetDirectoryPath(const std::string& file, DIRECTORY_IMPORT directory) const;
 	uint LoadFile(const char* file, char** buffer, DIRECTORY_IMPORT directory = IMPORT_DEFAULT);
+	// Map the file instead of copying it (the pages are read on demand), release it with UnmapFile
+	bool MapFile(const char* file, MappedFile& mapped, DIRECTORY_IMPORT directory = IMPORT_DEFAULT);
+	void UnmapFile(MappedFile& mapped);
 	
-	//Name of the file (NOT DIRECTORY) ------------------
+	//Name of the file (NOT DIRECTORY), false if it can't be written ------------------
 	bool SaveFile(const char* data, std::string name, uint size, DIRECTORY_IMPORT directory = IMPORT_DEFAULT);
 	// Only Scripting!!! ---------------
 	bool SaveScript(std::string name, TextEditor& editor, DIRECTORY_IMPORT directory = IMPORT_DEFAULT);
@@ -110,12 +123,16 @@ public:
 	/* float2 */
 	JSON_Status json_array_dotset_float2(JSON_Object *object, std::string name, float2 transform);
 	/* Color - (r,g,b,w) or (x,y,z,w).*/
-	JSON_Status json_array_dotset_float4(JSON_Object *object, std::string name, float4 transform);
+	JSON_Status json_array_dotset_float4(JSON_Object *object, std::string name, const float4& transform);
 
 	float3 json_array_dotget_float3_string(const JSON_Object* object, std::string name);
 	float2 json_array_dotget_float2_string(const JSON_Object* object, std::string name);
 	float4 json_array_dotget_float4_string(const JSON_Object* object, std::string name);
 
+	// Same with a node already resolved (see json_object_dotget_node)
+	float3 json_array_get_float3_by_key(const JSON_Object* object, const JSON_Key& key);
+	float4 json_array_get_float4_by_key(const JSON_Object* object, const JSON_Key& key);
+
 
 	//Don't used for now -------------------------
 	std::string GetAssetsDirectory();
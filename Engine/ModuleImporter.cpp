@@ -3,6 +3,7 @@
 #include "ImportMesh.h"
 #include "ImportMaterial.h"
 #include "ImportScript.h"
+#include "ImportCache.h"
 #include "CompMaterial.h"
 #include "CompTransform.h"
 #include "ModuleFS.h"
@@ -11,6 +12,7 @@
 #include "ModuleGUI.h"
 #include "ModuleWindow.h"
 #include "JSONSerialization.h"
+#include "Profiler.h"
 
 #include <direct.h>
 #include <mono/jit/jit.h>
@@ -32,6 +34,7 @@ ModuleImporter::~ModuleImporter()
 	RELEASE(iMesh);
 	RELEASE(iMaterial);
 	RELEASE(iScript);
+	RELEASE(cache);
 }
 
 bool ModuleImporter::Init(JSON_Object* node)
@@ -48,6 +51,7 @@ bool ModuleImporter::Init(JSON_Object* node)
 	iMesh = new ImportMesh();
 	iMaterial = new ImportMaterial();
 	iScript = new ImportScript();
+	cache = new ImportCache();
 
 	Awake_t = perf_timer.ReadMs();
 	return true;
@@ -57,6 +61,8 @@ bool ModuleImporter::Start()
 {
 	perf_timer.Start();
 
+	cache->Load();
+
 	struct aiLogStream stream;
 	stream = aiGetPredefinedLogStream(aiDefaultLogStream_DEBUGGER, nullptr);
 	aiAttachLogStream(&stream);
@@ -77,15 +83,12 @@ bool ModuleImporter::Start()
 
 update_status ModuleImporter::PreUpdate(float dt)
 {
-	perf_timer.Start();
-
 	if (App->input->GetKey(SDL_SCANCODE_B) == KEY_DOWN)
 	{
 		//ImportMesh* imp = new ImportMesh();
 		//imp->Load("Baker_house.rin");
 	}
 
-	preUpdate_t = perf_timer.ReadMs();
 	return UPDATE_CONTINUE;
 }
 
@@ -93,6 +96,10 @@ GameObject* ModuleImporter::ProcessNode(aiNode* node, const aiScene* scene, Game
 {	
 	static int count = 0;
 	GameObject* objChild = new GameObject(obj);
+	if (obj == nullptr)
+	{
+		objChild->SetPrefabTemplate(); // Only saved as a prefab, it isn't added to the scene
+	}
 	objChild->SetName(App->GetCharfromConstChar(node->mName.C_Str()));
 
 	CompTransform* trans = (CompTransform*)objChild->AddComponent(C_TRANSFORM);
@@ -106,6 +113,10 @@ GameObject* ModuleImporter::ProcessNode(aiNode* node, const aiScene* scene, Game
 		if (node->mNumMeshes > 1)
 		{
 			newObj = new GameObject(obj);
+			if (obj == nullptr)
+			{
+				newObj->SetPrefabTemplate();
+			}
 			std::string newName = "Submesh" + std::to_string(i);
 			newObj->SetName(App->GetCharfromConstChar(newName.c_str()));
 			CompTransform* newTrans = (CompTransform*)newObj->AddComponent(C_TRANSFORM);
@@ -134,6 +145,10 @@ GameObject* ModuleImporter::ProcessNode(aiNode* node, const aiScene* scene, Game
 {
 	static int count = 0;
 	GameObject* objChild = new GameObject(obj);
+	if (obj == nullptr)
+	{
+		objChild->SetPrefabTemplate(); // Only saved as a prefab, it isn't added to the scene
+	}
 	objChild->SetName(App->GetCharfromConstChar(node->mName.C_Str()));
 
 	CompTransform* trans = (CompTransform*)objChild->AddComponent(C_TRANSFORM);
@@ -147,6 +162,10 @@ GameObject* ModuleImporter::ProcessNode(aiNode* node, const aiScene* scene, Game
 		if (node->mNumMeshes > 1)
 		{
 			newObj = new GameObject(obj);
+			if (obj == nullptr)
+			{
+				newObj->SetPrefabTemplate();
+			}
 			std::string newName = "Submesh" + std::to_string(i);
 			newObj->SetName(App->GetCharfromConstChar(newName.c_str()));
 			CompTransform* newTrans = (CompTransform*)newObj->AddComponent(C_TRANSFORM);
@@ -183,6 +202,17 @@ GameObject* ModuleImporter::ProcessNode(aiNode* node, const aiScene* scene, Game
 	return objChild;
 }
 
+void ModuleImporter::SaveMeshes(const char* file)
+{
+	uint64 hash = cache->HashFile(file, Resource::Type::MESH);
+	const ImportCacheEntry* cached = cache->Find(hash);
+
+	// Serialize & save the meshes (threads)
+	std::vector<uint> uuids;
+	iMesh->ProcessImportJobs(uuids, cached);
+	cache->Add(hash, Resource::Type::MESH, uuids);
+}
+
 void ModuleImporter::ProcessTransform(aiNode* node, CompTransform* trans)
 {
 	aiVector3D aiPos;
@@ -211,12 +241,15 @@ void ModuleImporter::ProcessTransform(CompTransform* trans)
 
 bool ModuleImporter::CleanUp()
 {
+	iMaterial->StopConversions();
+	cache->Save();
 	aiDetachAllLogStreams();
 	return true;
 }
 
 bool ModuleImporter::Import(const char* file, Resource::Type type)
 {
+	PROFILE_FUNCTION();
 	bool ret = true;
 
 	switch (type)
@@ -231,6 +264,7 @@ bool ModuleImporter::Import(const char* file, Resource::Type type)
 		if (scene != nullptr)
 		{
 			GameObject* obj = ProcessNode(scene->mRootNode, scene, nullptr);
+			SaveMeshes(file);
 			obj->SetName(App->GetCharfromConstChar(App->fs->FixName_directory(file).c_str()));
 
 			//Now Save Serialitzate OBJ -> Prefab
@@ -280,6 +314,7 @@ bool ModuleImporter::Import(const char* file, Resource::Type type)
 
 bool ModuleImporter::Import(const char* file, Resource::Type type, std::vector<ReImport>& resourcesToReimport)
 {
+	PROFILE_FUNCTION();
 	bool ret = true;
 
 	switch (type)
@@ -294,6 +329,7 @@ bool ModuleImporter::Import(const char* file, Resource::Type type, std::vector<R
 		if (scene != nullptr)
 		{
 			GameObject* obj = ProcessNode(scene->mRootNode, scene, nullptr, resourcesToReimport);
+			SaveMeshes(file);
 			obj->SetName(App->GetCharfromConstChar(App->fs->FixName_directory(file).c_str()));
 
 			//Now Save Serialitzate OBJ -> Prefab
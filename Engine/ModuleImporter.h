@@ -16,6 +16,7 @@
 class ImportMesh;
 class ImportMaterial;
 class ImportScript;
+class ImportCache;
 class CompTransform;
 struct ReImport;
 
@@ -46,6 +47,8 @@ public:
 
 	bool Import(const char* file, Resource::Type type);
 	bool Import(const char* file, Resource::Type type, std::vector<ReImport>& resourcesToReimport);
+	// Serialize the meshes processed from the scene, reusing the Library files of the same content
+	void SaveMeshes(const char* file);
 	//FileTypeImport CheckFileType(char* filedir);
 	//bool Import();
 
@@ -56,6 +59,7 @@ public:
 	ImportMesh* iMesh = nullptr;
 	ImportMaterial* iMaterial = nullptr;
 	ImportScript* iScript = nullptr;
+	ImportCache* cache = nullptr;
 
 private:
 
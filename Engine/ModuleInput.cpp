@@ -54,8 +54,6 @@ bool ModuleInput::Init(JSON_Object* node)
 // Called every draw update
 update_status ModuleInput::PreUpdate(float dt)
 {
-	perf_timer.Start();
-
 	SDL_PumpEvents();
 	const Uint8* keys = SDL_GetKeyboardState(NULL);
 	
@@ -189,7 +187,6 @@ update_status ModuleInput::PreUpdate(float dt)
 	if(quit == true || keyboard[SDL_SCANCODE_ESCAPE] == KEY_UP)
 		return UPDATE_STOP;
 
-	preUpdate_t = perf_timer.ReadMs();
 	return UPDATE_CONTINUE;
 }
 
@@ -9,6 +9,9 @@
 #include "SkyBox.h"
 #include "ModuleWindow.h"
 #include "ModuleCamera3D.h"
+#include "RenderBackendGL.h"
+#include "RenderBackendCore.h"
+#include "Profiler.h"
 
 #include "SDL/include/SDL_opengl.h"
 #include "GL3W/include/glew.h"
@@ -28,11 +31,18 @@ ModuleRenderer3D::ModuleRenderer3D(bool start_enabled) : Module(start_enabled)
 	haveConfig = true;
 
 	name = "Renderer";
+	fixed_backend = new RenderBackendGL();
+	core_backend = new RenderBackendCore();
+	backend = fixed_backend;
 }
 
 // Destructor
 ModuleRenderer3D::~ModuleRenderer3D()
-{}
+{
+	backend = nullptr;
+	RELEASE(fixed_backend);
+	RELEASE(core_backend);
+}
 
 // Called before render is available
 bool ModuleRenderer3D::Init(JSON_Object* node)
@@ -127,6 +137,7 @@ bool ModuleRenderer3D::Init(JSON_Object* node)
 		wireframe = json_object_get_boolean(node, "Wireframe");
 		normals = json_object_get_boolean(node, "Normals");
 		smooth = json_object_get_boolean(node, "Smooth");
+		core_renderer = json_object_get_boolean(node, "Core Renderer") != 0; /* -1 if not saved yet */
 		
 		node = json_object_get_object(node, "Fog");
 		fog_active = json_object_get_boolean(node, "Active");
@@ -155,6 +166,8 @@ bool ModuleRenderer3D::Start()
 		glFogfv(GL_FOG_DENSITY, &fog_density);
 	}
 
+	SetCoreRenderer(core_renderer);
+
 	Start_t = perf_timer.ReadMs();
 	return true;
 }
@@ -162,8 +175,6 @@ bool ModuleRenderer3D::Start()
 // PreUpdate: clear buffer
 update_status ModuleRenderer3D::PreUpdate(float dt)
 {
-	perf_timer.Start();
-
 	// 
 	App->scene->sceneBuff->Bind("Scene");
 
@@ -182,7 +193,6 @@ update_status ModuleRenderer3D::PreUpdate(float dt)
 	for(uint i = 0; i < MAX_LIGHTS; ++i)
 		lights[i].Render();
 
-	preUpdate_t = perf_timer.ReadMs();
 	return UPDATE_CONTINUE;
 }
 
@@ -196,8 +206,6 @@ update_status ModuleRenderer3D::PreUpdate(float dt)
 // PostUpdate present buffer to screen
 update_status ModuleRenderer3D::PostUpdate(float dt)
 {
-	perf_timer.Start();
-	
 	// Draw Skybox (direct mode for now)
 	if (App->scene->draw_skybox)
 	{
@@ -209,18 +217,37 @@ update_status ModuleRenderer3D::PostUpdate(float dt)
 	// Draw Plane
 	App->scene->DrawPlane();
 
-	// Draw GameObjects
-	for (uint i = 0; i < App->scene->gameobjects.size(); i++)
+	// Draw GameObjects (meshes are only submitted to the render queue)
+	render_queue.Clear();
 	{
-		App->scene->gameobjects[i]->Draw();
+		PROFILE_SCOPE("Submit Meshes");
+		for (uint i = 0; i < App->scene->gameobjects.size(); i++)
+		{
+			App->scene->gameobjects[i]->Draw();
+		}
 	}
 
+	// Draw the meshes sorted by texture, material & mesh
+	render_queue.Sort();
+	RenderFrame frame;
+	frame.view_projection = active_camera->frustum.ViewProjMatrix();
+	frame.light_position = active_camera->frustum.pos;
+	frame.lighting = lighting;
+	frame.wireframe = wireframe;
+	render_queue.Execute(*backend, frame);
+
 	// Draw Quadtree
 	if (App->scene->quadtree_draw)
 	{
 		App->scene->quadtree.DebugDraw();
 	}
 
+	// Draw Octree
+	if (App->scene->octree_draw)
+	{
+		App->scene->octree.DebugDraw();
+	}
+
 	// Draw Mouse Picking Ray
 	//glBegin(GL_LINES);
 	//glLineWidth(3.0f);
@@ -263,7 +290,6 @@ update_status ModuleRenderer3D::PostUpdate(float dt)
 
 	SDL_GL_SwapWindow(App->window->window);
 
-	postUpdate_t = perf_timer.ReadMs();
 	return UPDATE_CONTINUE;
 }
 
@@ -295,6 +321,23 @@ update_status ModuleRenderer3D::UpdateConfig(float dt)
 
 	ImGui::Checkbox("Normals", &normals);
 
+	if (ImGui::Checkbox("Core Renderer (GL 3.3)", &core_renderer))
+	{
+		SetCoreRenderer(core_renderer);
+	}
+	ImGui::Text("Render Queue: %i meshes / %i draw calls / %i state changes", render_queue.GetNumCommands(), render_queue.GetNumBatches(), render_queue.GetNumStateChanges());
+	/* Sort & merge random draws with the null backend (output to console) */
+	if (ImGui::Button("RENDER QUEUE BENCHMARK"))
+	{
+		RenderQueueBenchmark(10000, 100, 20);
+	}
+	ImGui::Text("Instancing: %i meshes in %i instanced draws", render_queue.GetNumInstanced(), render_queue.GetNumInstancedBatches());
+	/* Prefab copies: grouping & instance buffer contents (output to console) */
+	if (ImGui::Button("INSTANCING TEST"))
+	{
+		RenderQueueInstancingTest(50, 200);
+	}
+
 	if (ImGui::Checkbox("Smooth", &smooth))
 	{
 		(smooth) ? glShadeModel(GL_SMOOTH) : glShadeModel(GL_FLAT);
@@ -338,6 +381,7 @@ bool ModuleRenderer3D::SaveConfig(JSON_Object * node)
 	json_object_set_boolean(node, "Wireframe", wireframe);
 	json_object_set_boolean(node, "Normals", normals);
 	json_object_set_boolean(node, "Smooth", smooth);
+	json_object_set_boolean(node, "Core Renderer", core_renderer);
 
 	node = json_object_get_object(node, "Fog");
 	json_object_set_boolean(node, "Active", fog_active);
@@ -350,11 +394,28 @@ bool ModuleRenderer3D::CleanUp()
 {
 	LOG("Destroying 3D Renderer");
 
+	core_backend->CleanUp();
+	backend = fixed_backend;
 	SDL_GL_DeleteContext(context);
 
 	return true;
 }
 
+void ModuleRenderer3D::SetCoreRenderer(bool active)
+{
+	backend = fixed_backend;
+	core_renderer = false;
+	if (active && core_backend->Init())
+	{
+		backend = core_backend;
+		core_renderer = true;
+	}
+	else
+	{
+		core_backend->CleanUp();
+	}
+}
+
 void ModuleRenderer3D::SetActiveCamera(CompCamera* cam)
 {
 	active_camera = cam;
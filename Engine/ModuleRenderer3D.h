@@ -4,6 +4,7 @@
 #include "Module.h"
 #include "Globals.h"
 #include "Light.h"
+#include "RenderQueue.h"
 #include "parson.h"
 #include "GL3W/include/glew.h"
 
@@ -13,6 +14,9 @@
 #define MAX_LIGHTS 8
 
 class CompCamera;
+class RenderBackend;
+class RenderBackendGL;
+class RenderBackendCore;
 
 class ModuleRenderer3D : public Module
 {
@@ -35,6 +39,7 @@ public:
 	void SetGameCamera(CompCamera* cam);
 
 	void UpdateProjection(CompCamera* cam);
+	void SetCoreRenderer(bool active);
 
 	void OnResize(int width, int height);
 	
@@ -58,7 +63,14 @@ public:
 	bool normals = false;
 	bool bounding_box = false;
 	GLfloat fog_density = 0;
+	bool core_renderer = true;	/* Shader backend (GL 3.3), fixed function if not supported */
 	// --------------------------
+
+	// Meshes submitted by CompMesh::Draw, drawn after the scene ---
+	RenderQueue render_queue;
+	RenderBackend* backend = nullptr;	/* fixed_backend or core_backend */
+	RenderBackendGL* fixed_backend = nullptr;
+	RenderBackendCore* core_backend = nullptr;
 };
 
 #endif
\ No newline at end of file
@@ -4,9 +4,13 @@
 #include "ResourceMesh.h"
 #include "ResourceScript.h"
 #include "ImportMesh.h"
+#include "ImportMaterial.h"
+#include "ImportCache.h"
+#include "JSONArena.h"
 #include "ModuleFS.h"
 #include "ModuleInput.h"
 #include "ModuleGUI.h"
+#include "Profiler.h"
 
 ModuleResourceManager::ModuleResourceManager(bool start_enabled): Module(start_enabled)
 {
@@ -43,6 +47,7 @@ bool ModuleResourceManager::Start()
 	// Create Resource Cube
 	CreateResourceCube();
 	Load();
+	loader.Start();
 
 	Start_t = perf_timer.ReadMs();
 	return true;
@@ -51,7 +56,8 @@ bool ModuleResourceManager::Start()
 
 update_status ModuleResourceManager::PreUpdate(float dt)
 {
-	perf_timer.Start();
+	// Finish the resources streamed (upload to GPU) with a budget, the frame time stays bounded
+	loader.Update(STREAMING_BUDGET_MS);
 
 	if (App->input->dropedfiles.size() > 0)
 	{
@@ -59,6 +65,12 @@ update_status ModuleResourceManager::PreUpdate(float dt)
 		App->input->dropedfiles.clear();
 	}
 
+	// Assets with a new date but the same content don't need to be imported again
+	if (resourcesToReimport.size() > 0 && reimportNow == false)
+	{
+		SkipUnchangedReimports();
+	}
+
 	if (resourcesToReimport.size() > 0)
 	{
 		// Now ReImport the new Resources ------
@@ -76,6 +88,7 @@ update_status ModuleResourceManager::PreUpdate(float dt)
 		for (int i = 0; i < resourcesToReimport.size(); i++)
 		{
 			it = resources.find(resourcesToReimport[i].uuid);
+			loader.Cancel(it->second);
 			it->second->SetState(Resource::State::REIMPORTED);
 			//delete it->second;
 			//resources.erase(it);
@@ -105,6 +118,7 @@ update_status ModuleResourceManager::PreUpdate(float dt)
 		for (int i = 0; i < filestoDelete.size(); i++)
 		{
 			it = resources.find(filestoDelete[i]);
+			loader.Cancel(it->second);
 			it->second->SetState(Resource::State::WANTDELETE);
 		}
 		deleteNow = true;
@@ -114,7 +128,6 @@ update_status ModuleResourceManager::PreUpdate(float dt)
 		scriptsSetNormal = true;
 		reimportedScripts = false;
 	}
-	preUpdate_t = perf_timer.ReadMs();
 	return UPDATE_CONTINUE;
 }
 
@@ -225,6 +238,7 @@ update_status ModuleResourceManager::PostUpdate(float dt)
 
 bool ModuleResourceManager::CleanUp()
 {
+	loader.Stop();
 	Save();
 	std::map<uint, Resource*>::iterator it = resources.begin();
 	for (int i = 0; i < resources.size(); i++)
@@ -237,6 +251,7 @@ bool ModuleResourceManager::CleanUp()
 
 void ModuleResourceManager::ImportFile(std::list<const char*>& file)
 {
+	PROFILE_FUNCTION();
 	std::list<const char*>::iterator& it = file.begin();
 	for (int i = 0; i < file.size(); i++)
 	{
@@ -271,12 +286,16 @@ void ModuleResourceManager::ImportFile(std::list<const char*>& file)
 			LOG("[error] This file: %s with this format %s is incorrect!", App->fs->FixName_directory(it._Ptr->_Myval).c_str(), App->fs->GetExtension(it._Ptr->_Myval));
 		}
 	}
+	// Textures are converted in the background, Library has to be complete before continuing
+	App->importer->iMaterial->WaitConversions();
+	App->importer->cache->Save();
 	((Project*)App->gui->winManager[WindowName::PROJECT])->UpdateNow();
 	App->fs->UpdateFilesAsstes();
 }
 
 void ModuleResourceManager::ImportFile(std::vector<const char*>& file, std::vector<ReImport>& resourcesToReimport)
 {
+	PROFILE_FUNCTION();
 	for (int i = 0; i < file.size(); i++)
 	{
 		// Get Type file
@@ -296,10 +315,59 @@ void ModuleResourceManager::ImportFile(std::vector<const char*>& file, std::vect
 			LOG("[error] This file: %s with this format %s is incorrect!", App->fs->FixName_directory(file[i]).c_str(), App->fs->GetExtension(file[i]));
 		}
 	}
+	// Textures are converted in the background, Library has to be complete before continuing
+	App->importer->iMaterial->WaitConversions();
+	App->importer->cache->Save();
 	((Project*)App->gui->winManager[WindowName::PROJECT])->UpdateNow();
 	App->fs->UpdateFilesAsstes();
 }
 
+// Remove from resourcesToReimport the assets that generate the same Library files (import cache)
+void ModuleResourceManager::SkipUnchangedReimports()
+{
+	uint skipped = 0;
+	uint i = 0;
+	while (i < resourcesToReimport.size())
+	{
+		// All the resources of the same asset are together
+		const char* file = resourcesToReimport[i].directoryObj;
+		uint end = i + 1;
+		while (end < resourcesToReimport.size() && file != nullptr && resourcesToReimport[end].directoryObj != nullptr &&
+			strcmp(file, resourcesToReimport[end].directoryObj) == 0)
+		{
+			end++;
+		}
+
+		std::vector<uint> uuids;
+		for (uint j = i; j < end; j++)
+		{
+			uuids.push_back(resourcesToReimport[j].uuid);
+		}
+
+		if (file != nullptr && App->importer->cache->IsUpToDate(file, CheckFileType(file), uuids))
+		{
+			LOG("Import Cache: %s not changed.", App->fs->FixName_directory(file).c_str());
+			for (uint j = i; j < end; j++)
+			{
+				RELEASE_ARRAY(resourcesToReimport[j].directoryObj);
+				RELEASE_ARRAY(resourcesToReimport[j].nameMesh);
+			}
+			resourcesToReimport.erase(resourcesToReimport.begin() + i, resourcesToReimport.begin() + end);
+			skipped++;
+		}
+		else
+		{
+			i = end;
+		}
+	}
+
+	if (skipped > 0)
+	{
+		// Keep the new dates, next check doesn't have to hash them again
+		App->fs->UpdateFilesAsstes();
+	}
+}
+
 Resource* ModuleResourceManager::CreateNewResource(Resource::Type type, uint uuid)
 {
 	Resource* ret = nullptr;
@@ -328,6 +396,14 @@ Resource* ModuleResourceManager::GetResource(uint id)
 	return nullptr;
 }
 
+void ModuleResourceManager::GetResources(std::vector<Resource*>& list) const
+{
+	for (std::map<uint, Resource*>::const_iterator it = resources.begin(); it != resources.end(); ++it)
+	{
+		list.push_back(it->second);
+	}
+}
+
 Resource* ModuleResourceManager::GetResource(const char* material)
 {
 	std::map<uint, Resource*>::iterator it = resources.begin();
@@ -385,6 +461,27 @@ Resource::Type ModuleResourceManager::CheckFileType(const char* filedir)
 	}
 }
 
+void ModuleResourceManager::RequestLoad(Resource* resource)
+{
+	if (resource == nullptr || resource->IsLoadedToMemory() != Resource::State::UNLOADED)
+	{
+		return;
+	}
+
+	if (loader.Request(resource) == false)
+	{
+		std::string file = std::to_string(resource->GetUUID());
+		if (resource->GetType() == Resource::Type::MESH)
+		{
+			App->importer->iMesh->LoadResource(file.c_str(), (ResourceMesh*)resource);
+		}
+		else if (resource->GetType() == Resource::Type::MATERIAL)
+		{
+			App->importer->iMaterial->LoadResource(file.c_str(), (ResourceMaterial*)resource);
+		}
+	}
+}
+
 void ModuleResourceManager::Init_IndexVertex(float3* vertex_triangulate, uint num_index, std::vector<uint>& indices, std::vector<float3>& vertices)
 {
 	bool temp = false;
@@ -634,6 +731,7 @@ void ModuleResourceManager::Load()
 {
 	LOG("----- LOADING RESOURCES -----");
 
+	JSONArena arena; // All the document is released at the end
 	JSON_Value* config_file;
 	JSON_Object* config;
 	JSON_Object* config_node;
@@ -3,6 +3,7 @@
 
 #include "Module.h"
 #include "Resource_.h"
+#include "ResourceLoader.h"
 #include <map>
 #include <vector>
 #include <list>
@@ -33,12 +34,17 @@ public:
 
 	void ImportFile(std::list<const char*>& file);
 	void ImportFile(std::vector<const char*>& file, std::vector<ReImport>& resourcesToReimport);
+	void SkipUnchangedReimports();
 	
 	Resource* CreateNewResource(Resource::Type type, uint uuid = 0);
 	Resource* GetResource(uint id);
 	Resource* GetResource(const char* material); //Only Use in ImportMesh -> Add ResourceMaterial
+	void GetResources(std::vector<Resource*>& list) const;
 	Resource::Type CheckFileType(const char* filedir);
 
+	// Load in the streaming threads (meshes & materials), the others are loaded now
+	void RequestLoad(Resource* resource);
+
 	void Init_IndexVertex(float3* vertex_triangulate, uint num_index, std::vector<uint>& indices, std::vector<float3>& vertices);
 	void CreateResourceCube();
 
@@ -54,6 +60,7 @@ public:
 	std::vector<uint> filestoDelete;
 private:
 	std::map<uint, Resource*> resources;
+	ResourceLoader loader;
 	std::vector<const char*> filesReimport;
 	bool reimportNow = false;
 	bool deleteNow = false;
@@ -0,0 +1,338 @@
+#include "Profiler.h"
+#include "JSONWriter.h"
+#include "ImGui/imgui.h"
+#include "SDL/include/SDL_timer.h"
+#include <atomic>
+#include <mutex>
+#include <string.h>
+#include <stdio.h>
+#include <string>
+
+struct ProfilerThread
+{
+	ProfilerEvent events[PROFILER_EVENTS];
+	std::atomic<uint> head;		/* Events written, only the owner thread adds */
+	uint read = 0;				/* Events collected by the main thread */
+	uint depth = 0;
+	uint id = 0;
+	char name[PROFILER_NAME_SIZE];
+};
+
+// All the threads that opened a zone (they are kept until the end, the ids don't change)
+struct ProfilerThreads
+{
+	~ProfilerThreads()
+	{
+		for (uint i = 0; i < list.size(); i++)
+		{
+			delete list[i];
+		}
+	}
+
+	std::mutex mutex;
+	std::vector<ProfilerThread*> list;
+};
+
+static ProfilerThreads threads;
+static thread_local ProfilerThread* local_thread = nullptr;
+
+static ProfilerThread* GetThread()
+{
+	if (local_thread == nullptr)
+	{
+		ProfilerThread* thread = new ProfilerThread();
+		thread->head = 0;
+
+		std::lock_guard<std::mutex> lock(threads.mutex);
+		thread->id = threads.list.size();
+		snprintf(thread->name, PROFILER_NAME_SIZE, "Thread %i", thread->id);
+		threads.list.push_back(thread);
+		local_thread = thread;
+	}
+	return local_thread;
+}
+
+static double TicksToMs(uint64 ticks)
+{
+	static const double frequency = (double)SDL_GetPerformanceFrequency();
+	return 1000.0 * (double)ticks / frequency;
+}
+
+// ZONE ----------------------------------------------
+ProfilerZone::ProfilerZone(const char* name)
+{
+	this->name = (name != nullptr) ? name : "?";
+	thread = GetThread();
+	depth = thread->depth++;
+	begin = SDL_GetPerformanceCounter();
+}
+
+ProfilerZone::~ProfilerZone()
+{
+	uint64 end = SDL_GetPerformanceCounter();
+	uint head = thread->head.load(std::memory_order_relaxed);
+
+	ProfilerEvent& event = thread->events[head % PROFILER_EVENTS];
+	strncpy(event.name, name, PROFILER_NAME_SIZE - 1);
+	event.name[PROFILER_NAME_SIZE - 1] = '\0';
+	event.begin = begin;
+	event.end = end;
+	event.depth = depth;
+	event.thread = thread->id;
+
+	// Publish the event to the main thread
+	thread->head.store(head + 1, std::memory_order_release);
+	thread->depth--;
+}
+
+double ProfilerZone::ReadMs() const
+{
+	return TicksToMs(SDL_GetPerformanceCounter() - begin);
+}
+
+// PROFILER ------------------------------------------
+Profiler::Profiler()
+{
+	start = SDL_GetPerformanceCounter();
+	frame_begin = start;
+	SetThreadName("Main");
+}
+
+Profiler::~Profiler()
+{
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	ProfilerThread* thread = GetThread();
+	std::lock_guard<std::mutex> lock(threads.mutex);
+	strncpy(thread->name, name, PROFILER_NAME_SIZE - 1);
+	thread->name[PROFILER_NAME_SIZE - 1] = '\0';
+}
+
+void Profiler::BeginFrame()
+{
+	frame_begin = SDL_GetPerformanceCounter();
+}
+
+// Zones that ended since the last frame. If a thread writes more than
+// PROFILER_EVENTS in a frame the oldest ones are lost.
+void Profiler::EndFrame()
+{
+	uint64 frame_end = SDL_GetPerformanceCounter();
+	std::vector<ProfilerThread*> list;
+	{
+		std::lock_guard<std::mutex> lock(threads.mutex);
+		list = threads.list;
+	}
+
+	if (pause == false)
+	{
+		last_frame.clear();
+		view_begin = frame_begin;
+		view_end = frame_end;
+	}
+
+	for (uint i = 0; i < list.size(); i++)
+	{
+		ProfilerThread* thread = list[i];
+		uint head = thread->head.load(std::memory_order_acquire);
+		if (head - thread->read > PROFILER_EVENTS)
+		{
+			lost_events += head - thread->read - PROFILER_EVENTS;
+			thread->read = head - PROFILER_EVENTS;
+		}
+
+		for (; thread->read != head; thread->read++)
+		{
+			const ProfilerEvent& event = thread->events[thread->read % PROFILER_EVENTS];
+			if (pause == false)
+			{
+				last_frame.push_back(event);
+			}
+			if (record_frames > 0)
+			{
+				recorded.push_back(event);
+			}
+		}
+	}
+
+	if (record_frames > 0 && --record_frames == 0)
+	{
+		if (ExportChromeTrace(PROFILER_TRACE_FILE))
+		{
+			LOG("Profiler: %i zones saved to %s", recorded.size(), PROFILER_TRACE_FILE);
+		}
+		recorded.clear();
+	}
+}
+
+void Profiler::Record(uint frames)
+{
+	recorded.clear();
+	record_frames = frames;
+}
+
+// Complete events ("ph":"X") in microseconds, one tid per thread
+bool Profiler::ExportChromeTrace(const char* file) const
+{
+	JSONWriter writer;
+	writer.BeginObject();
+	writer.BeginArray("traceEvents");
+	{
+		std::lock_guard<std::mutex> lock(threads.mutex);
+		for (uint i = 0; i < threads.list.size(); i++)
+		{
+			writer.BeginObject();
+			writer.String("name", "thread_name");
+			writer.String("ph", "M");
+			writer.Number("pid", 0);
+			writer.Number("tid", threads.list[i]->id);
+			writer.BeginObject("args");
+			writer.String("name", threads.list[i]->name);
+			writer.EndObject();
+			writer.EndObject();
+		}
+	}
+
+	for (uint i = 0; i < recorded.size(); i++)
+	{
+		const ProfilerEvent& event = recorded[i];
+		writer.BeginObject();
+		writer.String("name", event.name);
+		writer.String("cat", "engine");
+		writer.String("ph", "X");
+		writer.Number("ts", 1000.0 * TicksToMs((event.begin > start) ? event.begin - start : 0));
+		writer.Number("dur", 1000.0 * TicksToMs(event.end - event.begin));
+		writer.Number("pid", 0);
+		writer.Number("tid", event.thread);
+		writer.EndObject();
+	}
+	writer.EndArray();
+	writer.String("displayTimeUnit", "ms");
+	writer.EndObject();
+
+	return writer.SaveFile(file);
+}
+
+void Profiler::ShowPerformance()
+{
+	if (ImGui::TreeNodeEx("PROFILER"))
+	{
+		ImGui::Checkbox("Pause", &pause);
+		ImGui::SameLine();
+		if (record_frames > 0)
+		{
+			ImGui::Text("Recording... %i frames", record_frames);
+		}
+		else if (ImGui::Button("RECORD CHROME TRACE"))
+		{
+			Record();
+		}
+		if (lost_events > 0)
+		{
+			ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%i zones lost (ring buffer full)", lost_events);
+		}
+		ImGui::Text("Frame: %.3f ms, %i zones", TicksToMs(view_end - view_begin), last_frame.size());
+
+		std::vector<std::pair<uint, std::string>> names;
+		{
+			std::lock_guard<std::mutex> lock(threads.mutex);
+			for (uint i = 0; i < threads.list.size(); i++)
+			{
+				names.push_back(std::pair<uint, std::string>(threads.list[i]->id, threads.list[i]->name));
+			}
+		}
+
+		float width = ImGui::GetContentRegionAvailWidth();
+		for (uint i = 0; i < names.size(); i++)
+		{
+			ShowFlame(names[i].first, names[i].second.c_str(), width);
+		}
+		ImGui::TreePop();
+	}
+}
+
+const std::vector<ProfilerEvent>& Profiler::GetLastFrame() const
+{
+	return last_frame;
+}
+
+bool Profiler::IsPaused() const
+{
+	return pause;
+}
+
+uint Profiler::GetMemory() const
+{
+	uint memory = (last_frame.capacity() + recorded.capacity()) * sizeof(ProfilerEvent);
+	std::lock_guard<std::mutex> lock(threads.mutex);
+	return memory + threads.list.size() * sizeof(ProfilerThread);
+}
+
+// One row per depth, the width is the frame
+bool Profiler::ShowFlame(uint thread, const char* name, float width)
+{
+	int max_depth = -1;
+	for (uint i = 0; i < last_frame.size(); i++)
+	{
+		if (last_frame[i].thread == thread && (int)last_frame[i].depth > max_depth)
+		{
+			max_depth = last_frame[i].depth;
+		}
+	}
+	if (max_depth < 0)
+	{
+		return false;
+	}
+
+	ImGui::Text("%s", name);
+	float row = ImGui::GetTextLineHeightWithSpacing();
+	ImVec2 pos = ImGui::GetCursorScreenPos();
+	ImDrawList* draw = ImGui::GetWindowDrawList();
+	double frame_ticks = (view_end > view_begin) ? (double)(view_end - view_begin) : 1.0;
+
+	for (uint i = 0; i < last_frame.size(); i++)
+	{
+		const ProfilerEvent& event = last_frame[i];
+		if (event.thread != thread)
+		{
+			continue;
+		}
+
+		// Zones that started in the previous frame are clipped to the left
+		double begin = (event.begin > view_begin) ? (double)(event.begin - view_begin) / frame_ticks : 0.0;
+		double end = (event.end > view_begin) ? (double)(event.end - view_begin) / frame_ticks : 0.0;
+		begin = (begin > 1.0) ? 1.0 : begin;
+		end = (end < begin) ? begin : (end > 1.0) ? 1.0 : end;
+
+		ImVec2 min(pos.x + (float)begin * width, pos.y + row * event.depth);
+		ImVec2 max(pos.x + (float)end * width, min.y + row - 1.0f);
+		if (max.x - min.x < 1.0f)
+		{
+			max.x = min.x + 1.0f;
+		}
+
+		// Same color for the same name
+		uint hash = 2166136261u;
+		for (const char* c = event.name; *c != '\0'; c++)
+		{
+			hash = (hash ^ (uchar)*c) * 16777619u;
+		}
+		draw->AddRectFilled(min, max, ImColor::HSV((hash % 360) / 360.0f, 0.5f, 0.85f));
+		if (max.x - min.x > 20.0f)
+		{
+			draw->PushClipRect(min, max, true);
+			draw->AddText(ImVec2(min.x + 2.0f, min.y), IM_COL32(0, 0, 0, 255), event.name);
+			draw->PopClipRect();
+		}
+
+		if (ImGui::IsMouseHoveringRect(min, max))
+		{
+			ImGui::SetTooltip("%s: %.3f ms", event.name, TicksToMs(event.end - event.begin));
+		}
+	}
+
+	ImGui::Dummy(ImVec2(width, row * (max_depth + 1)));
+	return true;
+}
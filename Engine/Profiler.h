@@ -0,0 +1,83 @@
+#ifndef _PROFILER_
+#define _PROFILER_
+
+#include "Globals.h"
+#include <vector>
+
+#define PROFILER_EVENTS 16384			/* Ring buffer of each thread */
+#define PROFILER_NAME_SIZE 32
+#define PROFILER_RECORD_FRAMES 120		/* Frames of a Chrome trace */
+#define PROFILER_TRACE_FILE "profiler_trace.json"
+
+// Zone from here to the end of the scope (the name is copied when the zone ends)
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) ProfilerZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+
+struct ProfilerThread;
+
+struct ProfilerEvent
+{
+	char name[PROFILER_NAME_SIZE];
+	uint64 begin = 0;		/* Ticks of SDL_GetPerformanceCounter */
+	uint64 end = 0;
+	uint depth = 0;			/* Zones open in the thread when it started */
+	uint thread = 0;
+};
+
+class ProfilerZone
+{
+public:
+	ProfilerZone(const char* name);
+	~ProfilerZone();
+
+	double ReadMs() const;	/* Time since the zone started */
+
+private:
+	ProfilerThread* thread = nullptr;
+	const char* name = nullptr;
+	uint64 begin = 0;
+	uint depth = 0;
+};
+
+// Profiler -------------------------------------------
+// Each thread writes its zones in its own ring buffer without locks. At the end
+// of the frame the main thread collects them: the last frame is shown as a flame
+// view and the recorded frames are exported as Chrome trace JSON
+// (chrome://tracing or ui.perfetto.dev).
+class Profiler
+{
+public:
+	Profiler();
+	~Profiler();
+
+	static void SetThreadName(const char* name); /* Of the calling thread */
+
+	void BeginFrame();
+	void EndFrame();
+
+	void Record(uint frames = PROFILER_RECORD_FRAMES); /* Saved to PROFILER_TRACE_FILE when done */
+	bool ExportChromeTrace(const char* file) const;
+
+	void ShowPerformance();
+	const std::vector<ProfilerEvent>& GetLastFrame() const;
+	bool IsPaused() const;	/* The last frame isn't updated */
+	uint GetMemory() const;	/* Ring buffers & collected zones */
+
+private:
+	bool ShowFlame(uint thread, const char* name, float width); /* false if the thread has no zones */
+
+private:
+	uint64 start = 0;			/* Time 0 of the traces */
+	uint64 frame_begin = 0;
+	uint64 view_begin = 0;		/* Frame of last_frame */
+	uint64 view_end = 0;
+	std::vector<ProfilerEvent> last_frame;
+	std::vector<ProfilerEvent> recorded;
+	uint record_frames = 0;
+	uint lost_events = 0;
+	bool pause = false;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "RenderBackend.h"
+
+float3x3 NormalMatrix(const float4x4& transform)
+{
+	return transform.Float3x3Part().InverseTransposed();
+}
+
+void WriteInstances(RenderInstance* instances, const float4x4* transforms, uint count)
+{
+	for (uint i = 0; i < count; i++)
+	{
+		instances[i].transform = transforms[i];
+		instances[i].normal = NormalMatrix(transforms[i]);
+	}
+}
+
+RenderBackendNull::RenderBackendNull()
+{
+}
+
+RenderBackendNull::~RenderBackendNull()
+{
+}
+
+void RenderBackendNull::Begin(const RenderFrame& frame)
+{
+	RenderCall call;
+	call.type = CALL_BEGIN;
+	call.value = frame.num_instances;
+	calls.push_back(call);
+	instances.clear();
+	instances.reserve(frame.num_instances);
+}
+
+void RenderBackendNull::SetTexture(uint texture)
+{
+	RenderCall call;
+	call.type = CALL_TEXTURE;
+	call.value = texture;
+	calls.push_back(call);
+	num_state_changes++;
+}
+
+void RenderBackendNull::SetColor(const Color& color)
+{
+	RenderCall call;
+	call.type = CALL_COLOR;
+	call.color = color;
+	calls.push_back(call);
+	num_state_changes++;
+}
+
+void RenderBackendNull::SetMesh(const ResourceMesh* mesh)
+{
+	this->mesh = mesh;
+
+	RenderCall call;
+	call.type = CALL_MESH;
+	call.mesh = mesh;
+	calls.push_back(call);
+	num_state_changes++;
+}
+
+void RenderBackendNull::DrawInstances(const float4x4* transforms, uint count)
+{
+	RenderCall call;
+	call.type = CALL_DRAW;
+	call.value = count;
+	call.first = instances.size();
+	call.mesh = mesh;
+	calls.push_back(call);
+	instances.resize(instances.size() + count);
+	WriteInstances(&instances[call.first], transforms, count);
+	num_draws++;
+	num_instances += count;
+}
+
+void RenderBackendNull::DrawNormals(const float4x4& transform)
+{
+	RenderCall call;
+	call.type = CALL_NORMALS;
+	call.mesh = mesh;
+	calls.push_back(call);
+}
+
+void RenderBackendNull::End()
+{
+	RenderCall call;
+	call.type = CALL_END;
+	calls.push_back(call);
+	mesh = nullptr;
+}
+
+void RenderBackendNull::Clear()
+{
+	calls.clear();
+	instances.clear();
+	num_state_changes = 0;
+	num_draws = 0;
+	num_instances = 0;
+	mesh = nullptr;
+}
@@ -0,0 +1,109 @@
+#ifndef _RENDER_BACKEND_
+#define _RENDER_BACKEND_
+
+#include "Globals.h"
+#include "Color.h"
+#include "Math/float3.h"
+#include "Math/float3x3.h"
+#include "Math/float4x4.h"
+#include <vector>
+
+class ResourceMesh;
+
+// Settings of the frame for the backend
+struct RenderFrame
+{
+	float4x4 view_projection = float4x4::identity;	/* Row major (MathGeoLib) */
+	float3 light_position = float3::zero;
+	bool lighting = false;
+	bool wireframe = false;
+	uint num_instances = 0;		/* Filled by the render queue */
+};
+
+// Renderer abstraction -------------------------------------
+// The render queue only talks to the backend with these calls, already
+// filtered so a state is only set when it changes.
+class RenderBackend
+{
+public:
+	RenderBackend() {}
+	virtual ~RenderBackend() {}
+
+	virtual void Begin(const RenderFrame& frame) = 0;
+	virtual void SetTexture(uint texture) = 0;
+	virtual void SetColor(const Color& color) = 0;
+	virtual void SetMesh(const ResourceMesh* mesh) = 0;
+
+	// Same mesh and material with 'count' global transforms (row major, MathGeoLib)
+	virtual void DrawInstances(const float4x4* transforms, uint count) = 0;
+	virtual void DrawNormals(const float4x4& transform) = 0;
+	virtual void End() = 0;
+};
+
+// Transforms the normals of a global transform: inverse transpose of the
+// rotation & scale
+float3x3 NormalMatrix(const float4x4& transform);
+
+// Instance as the core backend stores it (112 bytes): the normal matrix is
+// calculated once per instance instead of per vertex in the shader
+struct RenderInstance
+{
+	float4x4 transform;		/* Global transform (row major) */
+	float3x3 normal;		/* NormalMatrix(transform) */
+	float padding[3];
+};
+
+// Instances of a draw in the format of the instance buffer
+void WriteInstances(RenderInstance* instances, const float4x4* transforms, uint count);
+
+enum RenderCallType
+{
+	CALL_BEGIN = 0,
+	CALL_TEXTURE,
+	CALL_COLOR,
+	CALL_MESH,
+	CALL_DRAW,
+	CALL_NORMALS,
+	CALL_END
+};
+
+struct RenderCall
+{
+	RenderCallType type = CALL_BEGIN;
+	uint value = 0;					/* Texture id, instances of the draw or of the frame */
+	uint first = 0;					/* First instance of the draw */
+	const ResourceMesh* mesh = nullptr;
+	Color color;
+};
+
+// Null backend: doesn't need GL, it records the command stream and writes the
+// instances like the core backend does, so the queue can be checked without a GPU
+// (see RenderQueueBenchmark)
+class RenderBackendNull : public RenderBackend
+{
+public:
+	RenderBackendNull();
+	~RenderBackendNull();
+
+	void Begin(const RenderFrame& frame);
+	void SetTexture(uint texture);
+	void SetColor(const Color& color);
+	void SetMesh(const ResourceMesh* mesh);
+	void DrawInstances(const float4x4* transforms, uint count);
+	void DrawNormals(const float4x4& transform);
+	void End();
+
+	void Clear();
+
+public:
+	std::vector<RenderCall> calls;
+	std::vector<RenderInstance> instances;	/* Instance buffer of the frame */
+	uint num_state_changes = 0;
+	uint num_draws = 0;
+	uint num_instances = 0;
+
+private:
+	const ResourceMesh* mesh = nullptr;
+};
+
+#endif
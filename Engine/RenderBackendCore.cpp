@@ -0,0 +1,433 @@
+#include "RenderBackendCore.h"
+#include "ResourceMesh.h"
+#include "GL3W/include/glew.h"
+#include <string.h>
+#include <stddef.h>
+
+#define INSTANCE_ATTRIB_MODEL 3		/* mat4: locations 3 to 6 */
+#define INSTANCE_ATTRIB_NORMAL 7	/* mat3: locations 7 to 9 */
+#define CAMERA_BINDING 0
+
+// Same layout as the Camera block (std140)
+struct CameraBlock
+{
+	float4x4 view_projection;
+	float light_position[4];		/* w > 0: lighting enabled */
+};
+
+// 'model' & 'normal_matrix' are transposed (row major upload) and multiplied by the left,
+// the normal matrix comes with the instance (see WriteInstances)
+static const char* vertex_shader =
+"#version 330 core\n"
+"layout(location = 0) in vec3 position;\n"
+"layout(location = 1) in vec3 normal;\n"
+"layout(location = 2) in vec2 tex_coord;\n"
+"layout(location = 3) in mat4 model;\n"
+"layout(location = 7) in mat3 normal_matrix;\n"
+"layout(std140, row_major) uniform Camera\n"
+"{\n"
+"	mat4 view_projection;\n"
+"	vec4 light_position;\n"
+"};\n"
+"uniform vec4 quantization;\n"
+"out vec3 world_position;\n"
+"out vec3 world_normal;\n"
+"out vec2 uv;\n"
+"void main()\n"
+"{\n"
+"	vec4 world = vec4(quantization.xyz + position * quantization.w, 1.0) * model;\n"
+"	world_position = world.xyz;\n"
+"	world_normal = normal * normal_matrix;\n"
+"	uv = tex_coord;\n"
+"	gl_Position = view_projection * world;\n"
+"}\n";
+
+// Light 0 of the fixed function path: ambient 0.5, diffuse 0.75 on the camera
+static const char* fragment_shader =
+"#version 330 core\n"
+"layout(std140, row_major) uniform Camera\n"
+"{\n"
+"	mat4 view_projection;\n"
+"	vec4 light_position;\n"
+"};\n"
+"uniform vec4 color;\n"
+"uniform int use_texture;\n"
+"uniform sampler2D diffuse;\n"
+"in vec3 world_position;\n"
+"in vec3 world_normal;\n"
+"in vec2 uv;\n"
+"out vec4 frag_color;\n"
+"void main()\n"
+"{\n"
+"	vec4 result = color;\n"
+"	if (use_texture != 0)\n"
+"		result *= texture(diffuse, uv);\n"
+"	if (light_position.w > 0.0 && length(world_normal) > 0.0)\n"
+"	{\n"
+"		vec3 light_dir = normalize(light_position.xyz - world_position);\n"
+"		float diffuse_term = max(dot(normalize(world_normal), light_dir), 0.0);\n"
+"		result.rgb *= min(0.5 + 0.75 * diffuse_term, 1.0);\n"
+"	}\n"
+"	frag_color = result;\n"
+"}\n";
+
+RenderBackendCore::RenderBackendCore()
+{
+}
+
+RenderBackendCore::~RenderBackendCore()
+{
+}
+
+bool RenderBackendCore::Init()
+{
+	if (program != 0)
+	{
+		return true;
+	}
+	if (GLEW_VERSION_3_3 == GL_FALSE)
+	{
+		LOG("Core renderer needs OpenGL 3.3, using the fixed function renderer.");
+		return false;
+	}
+
+	// Shaders -------------------------------
+	uint vertex = CompileShader(GL_VERTEX_SHADER, vertex_shader);
+	uint fragment = CompileShader(GL_FRAGMENT_SHADER, fragment_shader);
+	if (vertex == 0 || fragment == 0)
+	{
+		glDeleteShader(vertex);
+		glDeleteShader(fragment);
+		return false;
+	}
+
+	program = glCreateProgram();
+	glAttachShader(program, vertex);
+	glAttachShader(program, fragment);
+	glLinkProgram(program);
+	glDeleteShader(vertex);
+	glDeleteShader(fragment);
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (linked == GL_FALSE)
+	{
+		char info[512];
+		glGetProgramInfoLog(program, sizeof(info), NULL, info);
+		LOG("[error] Core renderer: program not linked: %s", info);
+		glDeleteProgram(program);
+		program = 0;
+		return false;
+	}
+
+	color_location = glGetUniformLocation(program, "color");
+	use_texture_location = glGetUniformLocation(program, "use_texture");
+	quantization_location = glGetUniformLocation(program, "quantization");
+	glUniformBlockBinding(program, glGetUniformBlockIndex(program, "Camera"), CAMERA_BINDING);
+	glUseProgram(program);
+	glUniform1i(glGetUniformLocation(program, "diffuse"), 0);
+	glUseProgram(0);
+
+	// Camera of each frame --------------------
+	glGenBuffers(1, &camera_ubo);
+	glBindBuffer(GL_UNIFORM_BUFFER, camera_ubo);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	// Normals debug lines (model matrix as a constant attribute)
+	glGenVertexArrays(1, &lines_vao);
+	glBindVertexArray(lines_vao);
+	glEnableVertexAttribArray(MESH_ATTRIB_POSITION);
+	glBindVertexArray(0);
+
+	// Instances -------------------------------
+	persistent = (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage);
+	base_instance = (GLEW_VERSION_4_2 || GLEW_ARB_base_instance);
+	if (CreateInstanceBuffer(RENDER_MIN_INSTANCES) == false)
+	{
+		CleanUp();
+		return false;
+	}
+
+	LOG("Core renderer: persistent instance buffer %s, base instance %s", persistent ? "ON" : "OFF", base_instance ? "ON" : "OFF");
+	return true;
+}
+
+void RenderBackendCore::CleanUp()
+{
+	DeleteInstanceBuffer();
+	if (program != 0)			glDeleteProgram(program);
+	if (camera_ubo != 0)		glDeleteBuffers(1, &camera_ubo);
+	if (lines_vao != 0)			glDeleteVertexArrays(1, &lines_vao);
+	program = 0;
+	camera_ubo = 0;
+	lines_vao = 0;
+}
+
+bool RenderBackendCore::IsPersistent() const
+{
+	return persistent;
+}
+
+void RenderBackendCore::Begin(const RenderFrame& frame)
+{
+	wireframe = frame.wireframe;
+	mesh = nullptr;
+
+	if (frame.num_instances > capacity)
+	{
+		uint new_capacity = (capacity > 0) ? capacity : RENDER_MIN_INSTANCES;
+		while (new_capacity < frame.num_instances)
+		{
+			new_capacity *= 2;
+		}
+		CreateInstanceBuffer(new_capacity);
+	}
+
+	// Wait until the GPU has finished with this region (3 frames ago)
+	frame_index = (frame_index + 1) % RENDER_FRAMES_IN_FLIGHT;
+	region = frame_index * capacity;
+	cursor = 0;
+	if (fences[frame_index] != nullptr)
+	{
+		glClientWaitSync((GLsync)fences[frame_index], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		glDeleteSync((GLsync)fences[frame_index]);
+		fences[frame_index] = nullptr;
+	}
+
+	CameraBlock camera;
+	camera.view_projection = frame.view_projection;
+	camera.light_position[0] = frame.light_position.x;
+	camera.light_position[1] = frame.light_position.y;
+	camera.light_position[2] = frame.light_position.z;
+	camera.light_position[3] = frame.lighting ? 1.0f : 0.0f;
+	glBindBuffer(GL_UNIFORM_BUFFER, camera_ubo);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &camera);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BINDING, camera_ubo);
+
+	glUseProgram(program);
+	glActiveTexture(GL_TEXTURE0);
+	if (wireframe)
+	{
+		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	}
+}
+
+void RenderBackendCore::SetTexture(uint texture)
+{
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glUniform1i(use_texture_location, texture != 0 ? 1 : 0);
+}
+
+void RenderBackendCore::SetColor(const Color& color)
+{
+	glUniform4f(color_location, color.r, color.g, color.b, color.a);
+}
+
+void RenderBackendCore::SetMesh(const ResourceMesh* mesh)
+{
+	this->mesh = mesh;
+	glBindVertexArray(mesh->VAO);
+	if (base_instance)
+	{
+		SetInstanceAttributes(0);
+	}
+	SetQuantization(mesh);
+}
+
+void RenderBackendCore::DrawInstances(const float4x4* transforms, uint count)
+{
+	if (mesh == nullptr || mesh->VAO == 0 || program == 0)
+	{
+		return;
+	}
+	count = (cursor + count > capacity) ? capacity - cursor : count;
+	if (count == 0)
+	{
+		return;
+	}
+
+	uint first = region + cursor;
+	if (instances != nullptr)
+	{
+		WriteInstances(&instances[first], transforms, count);
+	}
+	else
+	{
+		staging.resize(count);
+		WriteInstances(staging.data(), transforms, count);
+		glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+		glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(RenderInstance), count * sizeof(RenderInstance), staging.data());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	GLenum index_type = mesh->indices_16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	if (base_instance)
+	{
+		glDrawElementsInstancedBaseInstance(GL_TRIANGLES, mesh->num_indices, index_type, NULL, count, first);
+	}
+	else
+	{
+		SetInstanceAttributes(first);
+		glDrawElementsInstanced(GL_TRIANGLES, mesh->num_indices, index_type, NULL, count);
+	}
+	cursor += count;
+}
+
+void RenderBackendCore::DrawNormals(const float4x4& transform)
+{
+	if (mesh == nullptr || mesh->vertices_norm_id == 0 || program == 0)
+	{
+		return;
+	}
+
+	glBindVertexArray(lines_vao);
+	glBindBuffer(GL_ARRAY_BUFFER, mesh->vertices_norm_id);
+	glVertexAttribPointer(MESH_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(float3), NULL);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// Lines aren't lit and are already decoded
+	glVertexAttrib3f(MESH_ATTRIB_NORMAL, 0.0f, 0.0f, 0.0f);
+	for (uint i = 0; i < 4; i++)
+	{
+		glVertexAttrib4fv(INSTANCE_ATTRIB_MODEL + i, transform.ptr() + i * 4);
+	}
+	glUniform4f(quantization_location, 0.0f, 0.0f, 0.0f, 1.0f);
+	glDrawArrays(GL_LINES, 0, mesh->num_vertices * 2);
+
+	// Back to the mesh for the next draws
+	glBindVertexArray(mesh->VAO);
+	SetQuantization(mesh);
+}
+
+void RenderBackendCore::End()
+{
+	if (persistent)
+	{
+		fences[frame_index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	glBindVertexArray(0);
+	glUseProgram(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	if (wireframe)
+	{
+		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	}
+	mesh = nullptr;
+}
+
+uint RenderBackendCore::CompileShader(uint type, const char* source) const
+{
+	uint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+
+	GLint compiled = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+	if (compiled == GL_FALSE)
+	{
+		char info[512];
+		glGetShaderInfoLog(shader, sizeof(info), NULL, info);
+		LOG("[error] Core renderer: shader not compiled: %s", info);
+		glDeleteShader(shader);
+		return 0;
+	}
+	return shader;
+}
+
+bool RenderBackendCore::CreateInstanceBuffer(uint new_capacity)
+{
+	DeleteInstanceBuffer();
+
+	GLsizeiptr size = (GLsizeiptr)new_capacity * RENDER_FRAMES_IN_FLIGHT * sizeof(RenderInstance);
+	glGenBuffers(1, &instance_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+	if (persistent)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, size, NULL, flags);
+		instances = (RenderInstance*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+		if (instances == nullptr)
+		{
+			// Immutable storage can't be reallocated, try again without the mapping
+			LOG("[error] Core renderer: instance buffer can't be mapped, using glBufferSubData.");
+			persistent = false;
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			glDeleteBuffers(1, &instance_buffer);
+			instance_buffer = 0;
+			return CreateInstanceBuffer(new_capacity);
+		}
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	capacity = new_capacity;
+	frame_index = 0;
+	return true;
+}
+
+void RenderBackendCore::DeleteInstanceBuffer()
+{
+	for (uint i = 0; i < RENDER_FRAMES_IN_FLIGHT; i++)
+	{
+		if (fences[i] != nullptr)
+		{
+			glClientWaitSync((GLsync)fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+			glDeleteSync((GLsync)fences[i]);
+			fences[i] = nullptr;
+		}
+	}
+
+	if (instance_buffer != 0)
+	{
+		if (instances != nullptr)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &instance_buffer);
+	}
+	instance_buffer = 0;
+	instances = nullptr;
+	capacity = 0;
+}
+
+// Model & normal matrices of the instances, inside the VAO of the mesh bound
+void RenderBackendCore::SetInstanceAttributes(uint first_instance)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+	size_t base = first_instance * sizeof(RenderInstance);
+	for (uint i = 0; i < 4; i++)
+	{
+		uint location = INSTANCE_ATTRIB_MODEL + i;
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(RenderInstance), (void*)(base + offsetof(RenderInstance, transform) + i * 4 * sizeof(float)));
+		glVertexAttribDivisor(location, 1);
+	}
+	for (uint i = 0; i < 3; i++)
+	{
+		uint location = INSTANCE_ATTRIB_NORMAL + i;
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, sizeof(RenderInstance), (void*)(base + offsetof(RenderInstance, normal) + i * 3 * sizeof(float)));
+		glVertexAttribDivisor(location, 1);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void RenderBackendCore::SetQuantization(const ResourceMesh* mesh)
+{
+	if (mesh->quantized)
+	{
+		glUniform4f(quantization_location, mesh->quant_offset.x, mesh->quant_offset.y, mesh->quant_offset.z, mesh->quant_scale);
+	}
+	else
+	{
+		glUniform4f(quantization_location, 0.0f, 0.0f, 0.0f, 1.0f);
+	}
+}
@@ -0,0 +1,67 @@
+#ifndef _RENDER_BACKEND_CORE_
+#define _RENDER_BACKEND_CORE_
+
+#include "RenderBackend.h"
+
+#define RENDER_FRAMES_IN_FLIGHT 3
+#define RENDER_MIN_INSTANCES 4096
+
+// Shader backend (GLSL 330 core, no fixed function state) ---
+// - Meshes are drawn with their VAO (ResourceMesh::CreateVAO)
+// - Camera & light of the frame in a uniform buffer
+// - Global transforms & normal matrices of the instances in a persistently mapped buffer
+//   (GL 4.4 / ARB_buffer_storage), one region per frame in flight protected
+//   with a fence. Without it the region is updated with glBufferSubData.
+// Matrices are uploaded row major as MathGeoLib stores them, the shaders
+// multiply by the left (vector * matrix) instead of transposing them.
+class RenderBackendCore : public RenderBackend
+{
+public:
+	RenderBackendCore();
+	~RenderBackendCore();
+
+	// Needs a GL 3.3 context, false if the backend can't be used
+	bool Init();
+	void CleanUp();
+	bool IsPersistent() const;
+
+	void Begin(const RenderFrame& frame);
+	void SetTexture(uint texture);
+	void SetColor(const Color& color);
+	void SetMesh(const ResourceMesh* mesh);
+	void DrawInstances(const float4x4* transforms, uint count);
+	void DrawNormals(const float4x4& transform);
+	void End();
+
+private:
+	uint CompileShader(uint type, const char* source) const;
+	bool CreateInstanceBuffer(uint new_capacity);
+	void DeleteInstanceBuffer();
+	void SetInstanceAttributes(uint first_instance);
+	void SetQuantization(const ResourceMesh* mesh);
+
+private:
+	uint program = 0;
+	uint camera_ubo = 0;
+	int color_location = -1;
+	int use_texture_location = -1;
+	int quantization_location = -1;
+
+	// Instances (RENDER_FRAMES_IN_FLIGHT regions of 'capacity' instances)
+	uint instance_buffer = 0;
+	RenderInstance* instances = nullptr;	/* Persistent mapping, nullptr if not supported */
+	std::vector<RenderInstance> staging;	/* Without the mapping, written with glBufferSubData */
+	void* fences[RENDER_FRAMES_IN_FLIGHT] = { nullptr };
+	uint capacity = 0;
+	uint frame_index = 0;
+	uint region = 0;		/* First instance of the region of this frame */
+	uint cursor = 0;		/* Instances written this frame */
+	bool base_instance = false;
+
+	uint lines_vao = 0;		/* Normals debug lines */
+	const ResourceMesh* mesh = nullptr;
+	bool wireframe = false;
+	bool persistent = false;
+};
+
+#endif
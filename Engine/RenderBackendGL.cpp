@@ -0,0 +1,140 @@
+#include "RenderBackendGL.h"
+#include "ResourceMesh.h"
+#include "GL3W/include/glew.h"
+#include <stddef.h>
+
+RenderBackendGL::RenderBackendGL()
+{
+}
+
+RenderBackendGL::~RenderBackendGL()
+{
+}
+
+// Camera & lights are already set in the fixed function state
+void RenderBackendGL::Begin(const RenderFrame& frame)
+{
+	wireframe = frame.wireframe;
+	mesh = nullptr;
+	normalize = glIsEnabled(GL_NORMALIZE) == GL_TRUE;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glMatrixMode(GL_MODELVIEW);
+
+	if (wireframe)
+	{
+		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	}
+}
+
+void RenderBackendGL::SetTexture(uint texture)
+{
+	glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void RenderBackendGL::SetColor(const Color& color)
+{
+	glColor4f(color.r, color.g, color.b, color.a);
+}
+
+void RenderBackendGL::SetMesh(const ResourceMesh* mesh)
+{
+	this->mesh = mesh;
+	SetPointers(mesh);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->indices_id);
+
+	// GL_NORMALIZE fixes the scale of the normals of the quantized meshes
+	if (mesh->quantized || normalize)
+	{
+		glEnable(GL_NORMALIZE);
+	}
+	else
+	{
+		glDisable(GL_NORMALIZE);
+	}
+}
+
+void RenderBackendGL::DrawInstances(const float4x4* transforms, uint count)
+{
+	if (mesh == nullptr)
+	{
+		return;
+	}
+
+	GLenum index_type = mesh->indices_16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	for (uint i = 0; i < count; i++)
+	{
+		float4x4 matrix = transforms[i].Transposed(); // OpenGL is column major
+		glPushMatrix();
+		glMultMatrixf(matrix.ptr());
+
+		// Decode the positions with the modelview
+		if (mesh->quantized)
+		{
+			glTranslatef(mesh->quant_offset.x, mesh->quant_offset.y, mesh->quant_offset.z);
+			glScalef(mesh->quant_scale, mesh->quant_scale, mesh->quant_scale);
+		}
+
+		glDrawElements(GL_TRIANGLES, mesh->num_indices, index_type, NULL);
+		glPopMatrix();
+	}
+}
+
+void RenderBackendGL::DrawNormals(const float4x4& transform)
+{
+	if (mesh == nullptr || mesh->vertices_norm_id == 0)
+	{
+		return;
+	}
+
+	float4x4 matrix = transform.Transposed();
+	glPushMatrix();
+	glMultMatrixf(matrix.ptr());
+	glBindBuffer(GL_ARRAY_BUFFER, mesh->vertices_norm_id);
+	glVertexPointer(3, GL_FLOAT, sizeof(float3), NULL);
+	glDrawArrays(GL_LINES, 0, mesh->num_vertices * 2);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glPopMatrix();
+
+	// Back to the vertices of the mesh for the next draws
+	SetPointers(mesh);
+}
+
+void RenderBackendGL::End()
+{
+	//Reset TextureColor
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	if (wireframe)
+	{
+		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	}
+	(normalize) ? glEnable(GL_NORMALIZE) : glDisable(GL_NORMALIZE);
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	mesh = nullptr;
+}
+
+void RenderBackendGL::SetPointers(const ResourceMesh* mesh)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, mesh->vertices_id); //VERTEX ID
+	if (mesh->quantized)
+	{
+		glVertexPointer(3, GL_SHORT, sizeof(VertexQuantized), (void*)offsetof(VertexQuantized, pos));
+		glNormalPointer(GL_BYTE, sizeof(VertexQuantized), (void*)offsetof(VertexQuantized, norm));
+		glTexCoordPointer(2, GL_HALF_FLOAT, sizeof(VertexQuantized), (void*)offsetof(VertexQuantized, texCoords));
+	}
+	else
+	{
+		glVertexPointer(3, GL_FLOAT, sizeof(Vertex), NULL);
+		glNormalPointer(GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, norm));
+		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,32 @@
+#ifndef _RENDER_BACKEND_GL_
+#define _RENDER_BACKEND_GL_
+
+#include "RenderBackend.h"
+
+// Fixed function backend (same GL calls CompMesh::Draw did for each mesh).
+// Without shaders the instances of a draw are issued one by one, but the
+// client states, buffers, texture and color are only set once per change.
+class RenderBackendGL : public RenderBackend
+{
+public:
+	RenderBackendGL();
+	~RenderBackendGL();
+
+	void Begin(const RenderFrame& frame);
+	void SetTexture(uint texture);
+	void SetColor(const Color& color);
+	void SetMesh(const ResourceMesh* mesh);
+	void DrawInstances(const float4x4* transforms, uint count);
+	void DrawNormals(const float4x4& transform);
+	void End();
+
+private:
+	void SetPointers(const ResourceMesh* mesh);
+
+private:
+	const ResourceMesh* mesh = nullptr;
+	bool wireframe = false;
+	bool normalize = false;		/* GL_NORMALIZE was enabled before the queue */
+};
+
+#endif
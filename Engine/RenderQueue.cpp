@@ -0,0 +1,459 @@
+#include "RenderQueue.h"
+#include "RenderBackend.h"
+#include "PerfTimer.h"
+#include "Profiler.h"
+#include "Math/Quat.h"
+#include "Math/TransformOps.h"
+#include "Algorithm/Random/LCG.h"
+#include <algorithm>
+#include <math.h>
+
+#define RENDER_KEY_MASK(bits) ((1ull << (bits)) - 1)
+
+// Color::operator== doesn't compare the alpha
+static bool SameColor(const Color& a, const Color& b)
+{
+	return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+RenderQueue::RenderQueue()
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+void RenderQueue::Clear()
+{
+	commands.clear();
+	sorted.clear();
+	transforms.clear();
+	sorted_transforms.clear();
+	order.clear();
+	batches.clear();
+	texture_ids.clear();
+	material_ids.clear();
+	mesh_ids.clear();
+	num_state_changes = 0;
+	num_instanced_batches = 0;
+	num_instanced = 0;
+}
+
+void RenderQueue::Submit(const ResourceMesh* mesh, uint texture, const Color& color, const float4x4& transform, float depth, bool normals)
+{
+	if (mesh == nullptr)
+	{
+		return;
+	}
+
+	RenderCommand command;
+	command.mesh = mesh;
+	command.texture = texture;
+	command.material = GetMaterialId(texture, color);
+	command.color = color;
+	command.transform = transforms.size();
+	command.normals = normals;
+
+	depth = (depth < 0.0f) ? 0.0f : (depth > 1.0f) ? 1.0f : depth;
+	uint64 texture_id = GetTextureId(texture);
+	uint64 material_id = command.material;
+	uint64 mesh_id = GetMeshId(mesh);
+	uint64 depth_id = (uint64)(depth * RENDER_KEY_MASK(RENDER_KEY_DEPTH_BITS));
+
+	command.key = (std::min(texture_id, RENDER_KEY_MASK(RENDER_KEY_TEXTURE_BITS)) << (RENDER_KEY_MATERIAL_BITS + RENDER_KEY_MESH_BITS + RENDER_KEY_DEPTH_BITS)) |
+		(std::min(material_id, RENDER_KEY_MASK(RENDER_KEY_MATERIAL_BITS)) << (RENDER_KEY_MESH_BITS + RENDER_KEY_DEPTH_BITS)) |
+		(std::min(mesh_id, RENDER_KEY_MASK(RENDER_KEY_MESH_BITS)) << RENDER_KEY_DEPTH_BITS) |
+		depth_id;
+
+	commands.push_back(command);
+	transforms.push_back(transform);
+}
+
+void RenderQueue::Sort()
+{
+	PROFILE_FUNCTION();
+	order.resize(commands.size());
+	for (uint i = 0; i < commands.size(); i++)
+	{
+		order[i].first = commands[i].key;
+		order[i].second = i;
+	}
+	std::sort(order.begin(), order.end());
+
+	// Commands and transforms in draw order, the instances of a batch are contiguous
+	sorted.resize(commands.size());
+	sorted_transforms.resize(commands.size());
+	for (uint i = 0; i < order.size(); i++)
+	{
+		sorted[i] = commands[order[i].second];
+		sorted_transforms[i] = transforms[sorted[i].transform];
+		sorted[i].transform = i;
+	}
+
+	// Merge the same mesh & material (ids can share the key, so compare them)
+	batches.clear();
+	for (uint i = 0; i < sorted.size(); i++)
+	{
+		if (batches.size() > 0)
+		{
+			const RenderCommand& first = sorted[batches.back().first];
+			if (first.mesh == sorted[i].mesh && first.material == sorted[i].material)
+			{
+				batches.back().count++;
+				continue;
+			}
+		}
+
+		RenderBatch batch;
+		batch.first = i;
+		batch.count = 1;
+		batches.push_back(batch);
+	}
+
+	num_instanced_batches = 0;
+	num_instanced = 0;
+	for (uint i = 0; i < batches.size(); i++)
+	{
+		if (batches[i].count > 1)
+		{
+			num_instanced_batches++;
+			num_instanced += batches[i].count;
+		}
+	}
+}
+
+void RenderQueue::Execute(RenderBackend& backend, const RenderFrame& frame)
+{
+	PROFILE_FUNCTION();
+	num_state_changes = 0;
+	if (batches.size() == 0)
+	{
+		return;
+	}
+
+	// The backend can reserve the instances of the frame at once
+	RenderFrame settings = frame;
+	settings.num_instances = sorted.size();
+	backend.Begin(settings);
+
+	const ResourceMesh* last_mesh = nullptr;
+	uint last_texture = 0;
+	Color last_color;
+	bool first = true;
+
+	for (uint i = 0; i < batches.size(); i++)
+	{
+		const RenderBatch& batch = batches[i];
+		const RenderCommand& command = sorted[batch.first];
+
+		if (first || command.texture != last_texture)
+		{
+			backend.SetTexture(command.texture);
+			last_texture = command.texture;
+			num_state_changes++;
+		}
+		if (first || !SameColor(last_color, command.color))
+		{
+			backend.SetColor(command.color);
+			last_color = command.color;
+			num_state_changes++;
+		}
+		if (first || command.mesh != last_mesh)
+		{
+			backend.SetMesh(command.mesh);
+			last_mesh = command.mesh;
+			num_state_changes++;
+		}
+		first = false;
+
+		backend.DrawInstances(&sorted_transforms[batch.first], batch.count);
+
+		// Debug lines of the normals
+		for (uint c = batch.first; c < batch.first + batch.count; c++)
+		{
+			if (sorted[c].normals)
+			{
+				backend.DrawNormals(sorted_transforms[c]);
+			}
+		}
+	}
+
+	backend.End();
+}
+
+uint RenderQueue::GetNumCommands() const
+{
+	return commands.size();
+}
+
+uint RenderQueue::GetNumBatches() const
+{
+	return batches.size();
+}
+
+uint RenderQueue::GetNumStateChanges() const
+{
+	return num_state_changes;
+}
+
+uint RenderQueue::GetNumInstancedBatches() const
+{
+	return num_instanced_batches;
+}
+
+uint RenderQueue::GetNumInstanced() const
+{
+	return num_instanced;
+}
+
+const std::vector<RenderCommand>& RenderQueue::GetCommands() const
+{
+	return sorted;
+}
+
+const std::vector<RenderBatch>& RenderQueue::GetBatches() const
+{
+	return batches;
+}
+
+const float4x4* RenderQueue::GetTransforms(const RenderBatch& batch) const
+{
+	return &sorted_transforms[batch.first];
+}
+
+uint RenderQueue::GetTextureId(uint texture)
+{
+	std::unordered_map<uint, uint>::iterator it = texture_ids.find(texture);
+	if (it != texture_ids.end())
+	{
+		return it->second;
+	}
+
+	uint id = texture_ids.size();
+	texture_ids[texture] = id;
+	return id;
+}
+
+// Colors are compared with 8 bits per channel (same color on screen)
+uint RenderQueue::GetMaterialId(uint texture, const Color& color)
+{
+	const float channels[4] = { color.r, color.g, color.b, color.a };
+	uint64 packed = 0;
+	for (uint i = 0; i < 4; i++)
+	{
+		float value = (channels[i] < 0.0f) ? 0.0f : (channels[i] > 1.0f) ? 1.0f : channels[i];
+		packed = (packed << 8) | (uint64)(value * 255.0f + 0.5f);
+	}
+	packed |= (uint64)texture << 32;
+
+	std::unordered_map<uint64, uint>::iterator it = material_ids.find(packed);
+	if (it != material_ids.end())
+	{
+		return it->second;
+	}
+
+	uint id = material_ids.size();
+	material_ids[packed] = id;
+	return id;
+}
+
+uint RenderQueue::GetMeshId(const ResourceMesh* mesh)
+{
+	std::unordered_map<const ResourceMesh*, uint>::iterator it = mesh_ids.find(mesh);
+	if (it != mesh_ids.end())
+	{
+		return it->second;
+	}
+
+	uint id = mesh_ids.size();
+	mesh_ids[mesh] = id;
+	return id;
+}
+
+// BENCHMARK -----------------------------------------
+bool RenderQueueBenchmark(uint num_draws, uint num_meshes, uint num_materials)
+{
+	if (num_draws == 0 || num_meshes == 0 || num_materials == 0)
+	{
+		return false;
+	}
+
+	// The queue and the null backend never read the meshes, any address works
+	std::vector<char> meshes(num_meshes);
+	math::LCG random(1234);
+
+	RenderQueue queue;
+	PerfTimer timer;
+	for (uint i = 0; i < num_draws; i++)
+	{
+		const ResourceMesh* mesh = (const ResourceMesh*)&meshes[random.Int(0, num_meshes - 1)];
+		uint material = random.Int(0, num_materials - 1);
+		Color color((material % 7) / 6.0f, (material % 5) / 4.0f, (material % 3) / 2.0f);
+		float4x4 transform = float4x4::FromTRS(float3::RandomBox(random, 0.0f, 1.0f), Quat::RandomRotation(random), float3::RandomBox(random, 0.5f, 2.0f));
+		queue.Submit(mesh, material / 2, color, transform, random.Float());
+	}
+	double submit_ms = timer.ReadMs();
+
+	timer.Start();
+	queue.Sort();
+	double sort_ms = timer.ReadMs();
+
+	RenderBackendNull backend;
+	timer.Start();
+	queue.Execute(backend, RenderFrame());
+	double execute_ms = timer.ReadMs();
+
+	// Check the command stream: all draws once, no state set to the value it already has
+	uint redundant = 0;
+	const RenderCall* texture = nullptr;
+	const RenderCall* color = nullptr;
+	const RenderCall* mesh = nullptr;
+	for (uint i = 0; i < backend.calls.size(); i++)
+	{
+		const RenderCall& call = backend.calls[i];
+		switch (call.type)
+		{
+		case CALL_TEXTURE:
+			redundant += (texture != nullptr && texture->value == call.value) ? 1 : 0;
+			texture = &call;
+			break;
+		case CALL_COLOR:
+			redundant += (color != nullptr && SameColor(color->color, call.color)) ? 1 : 0;
+			color = &call;
+			break;
+		case CALL_MESH:
+			redundant += (mesh != nullptr && mesh->mesh == call.mesh) ? 1 : 0;
+			mesh = &call;
+			break;
+		default:
+			break;
+		}
+	}
+
+	LOG("Render queue benchmark: %i draws (%i meshes, %i materials)", num_draws, num_meshes, num_materials);
+	LOG("- Submit %.3f ms, Sort %.3f ms, Execute (null) %.3f ms", submit_ms, sort_ms, execute_ms);
+	LOG("- Draw calls: %i -> %i, state changes: %i -> %i", num_draws, backend.num_draws, num_draws * 3, backend.num_state_changes);
+	// Each draw reads its own range of the instance buffer, in the sorted order
+	uint wrong_instances = 0;
+	for (uint i = 0; i < queue.GetBatches().size(); i++)
+	{
+		const RenderBatch& batch = queue.GetBatches()[i];
+		const float4x4* transforms = queue.GetTransforms(batch);
+		for (uint t = 0; t < batch.count; t++)
+		{
+			if (backend.instances[batch.first + t].transform.Equals(transforms[t]) == false)
+			{
+				wrong_instances++;
+			}
+		}
+	}
+
+	// The core backend sizes the instance region of the frame with Begin()
+	uint frame_instances = (backend.calls.size() > 0 && backend.calls[0].type == CALL_BEGIN) ? backend.calls[0].value : 0;
+
+	// Normal matrices of the instance buffer (the shader only multiplies them):
+	// normals of the instances (non uniform scale) stay perpendicular to the surface
+	uint wrong_normals = 0;
+	float3 tangent = float3(1.0f, 1.0f, 1.0f).Normalized();
+	float3 normal = float3(1.0f, -1.0f, 0.0f).Normalized();
+	for (uint i = 0; i < backend.instances.size(); i++)
+	{
+		float3 world_tangent = backend.instances[i].transform.TransformDir(tangent).Normalized();
+		float3 world_normal = (backend.instances[i].normal * normal).Normalized();
+		if (fabsf(world_tangent.Dot(world_normal)) > 1e-4f)
+		{
+			wrong_normals++;
+		}
+	}
+
+	if (backend.num_instances != num_draws || frame_instances != num_draws || backend.num_draws != queue.GetNumBatches() ||
+		redundant > 0 || wrong_instances > 0 || wrong_normals > 0)
+	{
+		LOG("[error] Render queue: %i instances drawn of %i (frame %i), %i redundant states, %i wrong instances, %i wrong normals",
+			backend.num_instances, num_draws, frame_instances, redundant, wrong_instances, wrong_normals);
+		return false;
+	}
+	return true;
+}
+
+bool RenderQueueInstancingTest(uint num_meshes, uint num_copies)
+{
+	if (num_meshes == 0 || num_copies == 0)
+	{
+		return false;
+	}
+
+	// Translation of each copy: (mesh, copy, texture). Odd meshes use two
+	// textures (two groups), the rest share one.
+	std::vector<char> meshes(num_meshes);
+	math::LCG random(4321);
+	uint num_groups = 0;
+	for (uint m = 0; m < num_meshes; m++)
+	{
+		num_groups += (m % 2 == 1 && num_copies > 1) ? 2 : 1;
+	}
+
+	RenderQueue queue;
+	for (uint c = 0; c < num_copies; c++)
+	{
+		for (uint m = 0; m < num_meshes; m++)
+		{
+			uint texture = (m % 2 == 1) ? 1 + c % 2 : 1;
+			float4x4 transform = float4x4::Translate((float)m, (float)c, (float)texture);
+			queue.Submit((const ResourceMesh*)&meshes[m], texture, Color(1.0f, 1.0f, 1.0f), transform, random.Float());
+		}
+	}
+	queue.Sort();
+
+	RenderBackendNull backend;
+	queue.Execute(backend, RenderFrame());
+
+	// Read the instances of each draw with the state set before it
+	std::vector<uint> seen(num_meshes * num_copies, 0);
+	uint wrong_instances = 0;
+	uint texture = 0;
+	const ResourceMesh* mesh = nullptr;
+	for (uint i = 0; i < backend.calls.size(); i++)
+	{
+		const RenderCall& call = backend.calls[i];
+		if (call.type == CALL_TEXTURE)
+		{
+			texture = call.value;
+		}
+		else if (call.type == CALL_MESH)
+		{
+			mesh = call.mesh;
+		}
+		else if (call.type == CALL_DRAW)
+		{
+			uint m = (const char*)mesh - &meshes[0];
+			for (uint t = call.first; t < call.first + call.value; t++)
+			{
+				float3 pos = backend.instances[t].transform.TranslatePart();
+				uint c = (uint)pos.y;
+				if ((uint)pos.x != m || (uint)pos.z != texture || c >= num_copies)
+				{
+					wrong_instances++;
+					continue;
+				}
+				seen[c * num_meshes + m]++;
+			}
+		}
+	}
+
+	uint missing = 0;
+	for (uint i = 0; i < seen.size(); i++)
+	{
+		missing += (seen[i] != 1) ? 1 : 0;
+	}
+
+	LOG("Render queue instancing: %i meshes x %i copies -> %i draws (%i expected), %i instanced draws", num_meshes, num_copies, backend.num_draws, num_groups, queue.GetNumInstancedBatches());
+	if (backend.num_draws != num_groups || wrong_instances > 0 || missing > 0)
+	{
+		LOG("[error] Render queue instancing: %i wrong instances, %i copies missing or repeated", wrong_instances, missing);
+		return false;
+	}
+	return true;
+}
+// ---------------------------------------------------
@@ -0,0 +1,103 @@
+#ifndef _RENDER_QUEUE_
+#define _RENDER_QUEUE_
+
+#include "Globals.h"
+#include "Color.h"
+#include "Math/float4x4.h"
+#include <vector>
+#include <unordered_map>
+
+class ResourceMesh;
+class RenderBackend;
+struct RenderFrame;
+
+// Sort key (64 bits): texture | material | mesh | depth
+// Ids are given in order of appearance each frame, when there are more than
+// the bits allow they share the last id (only the order changes, not the batches).
+#define RENDER_KEY_DEPTH_BITS 16
+#define RENDER_KEY_MESH_BITS 20
+#define RENDER_KEY_MATERIAL_BITS 14
+#define RENDER_KEY_TEXTURE_BITS 14
+
+struct RenderCommand
+{
+	uint64 key = 0;
+	const ResourceMesh* mesh = nullptr;
+	uint texture = 0;
+	uint material = 0;			/* Id of texture + color */
+	Color color;
+	uint transform = 0;			/* Index in the transforms of the queue */
+	bool normals = false;
+};
+
+// Consecutive sorted commands with the same mesh & material, drawn with one call
+struct RenderBatch
+{
+	uint first = 0;
+	uint count = 0;
+};
+
+// Render Queue --------------------------------------------
+// Meshes are submitted while the scene is traversed, then sorted by the key
+// and drawn in batches, setting the states only when they change:
+//	queue.Clear();
+//	queue.Submit(...); (each visible mesh)
+//	queue.Sort();
+//	queue.Execute(backend);
+class RenderQueue
+{
+public:
+	RenderQueue();
+	~RenderQueue();
+
+	void Clear();
+
+	// depth: distance to the camera (0 = near, 1 = far), only sorts draws of the same mesh & material
+	void Submit(const ResourceMesh* mesh, uint texture, const Color& color, const float4x4& transform, float depth, bool normals = false);
+
+	// Sort the commands and merge the batches
+	void Sort();
+	void Execute(RenderBackend& backend, const RenderFrame& frame);
+
+	uint GetNumCommands() const;
+	uint GetNumBatches() const;
+	uint GetNumStateChanges() const;	/* Of the last Execute */
+	uint GetNumInstancedBatches() const;	/* Batches with more than one mesh (one instanced draw each) */
+	uint GetNumInstanced() const;			/* Meshes drawn in those batches */
+
+	const std::vector<RenderCommand>& GetCommands() const;	/* Sorted after Sort() */
+	const std::vector<RenderBatch>& GetBatches() const;
+	const float4x4* GetTransforms(const RenderBatch& batch) const;	/* Contiguous for each batch */
+
+private:
+	uint GetTextureId(uint texture);
+	uint GetMaterialId(uint texture, const Color& color);
+	uint GetMeshId(const ResourceMesh* mesh);
+
+private:
+	std::vector<RenderCommand> commands;
+	std::vector<RenderCommand> sorted;
+	std::vector<float4x4> transforms;			/* Submission order */
+	std::vector<float4x4> sorted_transforms;	/* Batch order */
+	std::vector<std::pair<uint64, uint>> order;
+	std::vector<RenderBatch> batches;
+
+	// Ids of this frame
+	std::unordered_map<uint, uint> texture_ids;
+	std::unordered_map<uint64, uint> material_ids;	/* texture << 32 | RGBA8 color */
+	std::unordered_map<const ResourceMesh*, uint> mesh_ids;
+
+	uint num_state_changes = 0;
+	uint num_instanced_batches = 0;
+	uint num_instanced = 0;
+};
+
+// Sort & merge random draws and execute them with the null backend (times to the console),
+// false if a draw is lost, a state is set twice or an instance is wrong
+bool RenderQueueBenchmark(uint num_draws, uint num_meshes, uint num_materials);
+
+// Copies of the same meshes (prefabs) submitted in mixed order, checks that each
+// mesh & material is one draw and the instance buffer has every copy once
+bool RenderQueueInstancingTest(uint num_meshes, uint num_copies);
+
+#endif
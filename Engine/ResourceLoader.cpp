@@ -0,0 +1,270 @@
+#include "ResourceLoader.h"
+#include "Application.h"
+#include "ModuleImporter.h"
+#include "ModuleFS.h"
+#include "Scene.h"
+#include "ImportMesh.h"
+#include "ImportMaterial.h"
+#include "ResourceMesh.h"
+#include "ResourceMaterial.h"
+#include "PerfTimer.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+ResourceLoader::ResourceLoader()
+{
+}
+
+ResourceLoader::~ResourceLoader()
+{
+	Stop();
+}
+
+void ResourceLoader::Start(uint num_threads)
+{
+	if (threads.size() > 0)
+	{
+		return;
+	}
+
+	// Keep one core for the main thread
+	if (num_threads == 0)
+	{
+		uint cores = std::thread::hardware_concurrency();
+		num_threads = (cores > 1) ? cores - 1 : 1;
+		num_threads = (num_threads > STREAMING_MAX_THREADS) ? STREAMING_MAX_THREADS : num_threads;
+	}
+
+	quit = false;
+	for (uint i = 0; i < num_threads; i++)
+	{
+		threads.push_back(std::thread(&ResourceLoader::Work, this));
+	}
+	LOG("Resource streaming: %i threads", num_threads);
+}
+
+void ResourceLoader::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	work_cond.notify_all();
+
+	for (uint i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+	threads.clear();
+
+	// Pending requests are lost
+	for (uint i = 0; i < queue.size(); i++)
+	{
+		Discard(queue[i]);
+	}
+	for (uint i = 0; i < done.size(); i++)
+	{
+		Discard(done[i]);
+	}
+	queue.clear();
+	done.clear();
+}
+
+bool ResourceLoader::Request(Resource* resource)
+{
+	if (threads.size() == 0 || resource == nullptr || resource->GetState() != Resource::State::UNLOADED)
+	{
+		return false;
+	}
+	if (resource->GetType() != Resource::Type::MESH && resource->GetType() != Resource::Type::MATERIAL)
+	{
+		return false;
+	}
+
+	LoadRequest* request = new LoadRequest();
+	request->resource = resource;
+	request->file = std::to_string(resource->GetUUID());
+	resource->SetState(Resource::State::LOADING);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push_back(request);
+	}
+	work_cond.notify_one();
+	return true;
+}
+
+uint ResourceLoader::Update(double budget_ms)
+{
+	PerfTimer timer;
+	uint count = 0;
+
+	// Show the logs of the workers
+	FlushLog();
+
+	while (true)
+	{
+		LoadRequest* request = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (done.size() == 0 || (count > 0 && timer.ReadMs() >= budget_ms))
+			{
+				break;
+			}
+			request = done.front();
+			done.pop_front();
+		}
+
+		Complete(request);
+		count++;
+	}
+	return count;
+}
+
+void ResourceLoader::Cancel(Resource* resource)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	// Not started
+	for (std::deque<LoadRequest*>::iterator it = queue.begin(); it != queue.end();)
+	{
+		if ((*it)->resource == resource)
+		{
+			Discard(*it);
+			it = queue.erase(it);
+		}
+		else
+		{
+			it++;
+		}
+	}
+
+	// A worker has it, wait until it finishes
+	done_cond.wait(lock, [this, resource] { return std::find(working.begin(), working.end(), resource) == working.end(); });
+
+	// Finished but not uploaded
+	for (std::deque<LoadRequest*>::iterator it = done.begin(); it != done.end();)
+	{
+		if ((*it)->resource == resource)
+		{
+			Discard(*it);
+			it = done.erase(it);
+		}
+		else
+		{
+			it++;
+		}
+	}
+}
+
+uint ResourceLoader::GetNumPending() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return queue.size() + working.size() + done.size();
+}
+
+uint ResourceLoader::GetNumThreads() const
+{
+	return threads.size();
+}
+
+void ResourceLoader::Work()
+{
+	Profiler::SetThreadName("Resource Loader");
+	while (true)
+	{
+		LoadRequest* request = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			work_cond.wait(lock, [this] { return quit || queue.size() > 0; });
+			if (quit)
+			{
+				return;
+			}
+			request = queue.front();
+			queue.pop_front();
+			working.push_back(request->resource);
+		}
+
+		request->success = Prepare(request);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			working.erase(std::find(working.begin(), working.end(), request->resource));
+			done.push_back(request);
+		}
+		done_cond.notify_all();
+	}
+}
+
+// Worker thread: read & decode (no GL calls)
+bool ResourceLoader::Prepare(LoadRequest* request)
+{
+	PROFILE_FUNCTION();
+	switch (request->resource->GetType())
+	{
+	case Resource::Type::MESH:
+	{
+		return App->importer->iMesh->PrepareResource(request->file.c_str(), (ResourceMesh*)request->resource);
+	}
+	case Resource::Type::MATERIAL:
+	{
+		request->size = App->fs->LoadFile(request->file.c_str(), &request->buffer, IMPORT_DIRECTORY_LIBRARY_MATERIALS);
+		return request->buffer != nullptr && request->size > 0;
+	}
+	}
+	return false;
+}
+
+// Main thread: upload
+void ResourceLoader::Complete(LoadRequest* request)
+{
+	PROFILE_FUNCTION();
+	Resource* resource = request->resource;
+	if (request->success)
+	{
+		if (resource->GetType() == Resource::Type::MESH)
+		{
+			((ResourceMesh*)resource)->LoadToMemory();
+			if (resource->GetState() == Resource::State::LOADED)
+			{
+				App->scene->MeshLoaded((ResourceMesh*)resource);
+			}
+		}
+		else if (resource->GetType() == Resource::Type::MATERIAL)
+		{
+			App->importer->iMaterial->LoadResource(request->file.c_str(), (ResourceMaterial*)resource, request->buffer, request->size);
+		}
+	}
+
+	if (resource->GetState() == Resource::State::LOADING)
+	{
+		LOG("Resources: %s, can't be loaded", resource->name);
+		Release(resource);
+	}
+
+	RELEASE_ARRAY(request->buffer);
+	RELEASE(request);
+}
+
+void ResourceLoader::Discard(LoadRequest* request)
+{
+	if (request->resource->GetState() == Resource::State::LOADING)
+	{
+		Release(request->resource);
+	}
+
+	RELEASE_ARRAY(request->buffer);
+	RELEASE(request);
+}
+
+// Release the data staged by the worker (materials only stage the request buffer)
+void ResourceLoader::Release(Resource* resource)
+{
+	if (resource->GetType() == Resource::Type::MESH)
+	{
+		resource->DeleteToMemory();
+	}
+	resource->SetState(Resource::State::UNLOADED);
+}
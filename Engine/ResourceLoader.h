@@ -0,0 +1,70 @@
+#ifndef _RESOURCE_LOADER_
+#define _RESOURCE_LOADER_
+
+#include "Globals.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class Resource;
+
+#define STREAMING_MAX_THREADS 4
+#define STREAMING_BUDGET_MS 2.0 // Time of each frame to finish the uploads
+
+struct LoadRequest
+{
+	Resource* resource = nullptr;
+	std::string file;
+	char* buffer = nullptr;		/* Content of the file (materials) */
+	uint size = 0;
+	bool success = false;
+};
+
+// Asynchronous resource loader ------------------------------
+// Worker threads read & decode the files into CPU staging buffers (resource state LOADING),
+// the main thread finishes the GPU uploads with a time budget per frame.
+// Only meshes and materials are streamed. Workers don't touch GL or DevIL: materials
+// are only read by the workers, the image is decoded when it's uploaded.
+class ResourceLoader
+{
+public:
+	ResourceLoader();
+	~ResourceLoader();
+
+	void Start(uint num_threads = 0); // 0 = depends on the CPU
+	void Stop();
+
+	bool Request(Resource* resource);
+
+	// Main thread: upload the finished requests until the budget is spent (at least one)
+	uint Update(double budget_ms);
+
+	// Remove the resource from the loader (waits if a worker has it), it returns to UNLOADED
+	void Cancel(Resource* resource);
+
+	uint GetNumPending() const;
+	uint GetNumThreads() const;
+
+private:
+	void Work();
+	bool Prepare(LoadRequest* request);
+	void Complete(LoadRequest* request);
+	void Discard(LoadRequest* request);
+	void Release(Resource* resource);
+
+private:
+	std::vector<std::thread> threads;
+	mutable std::mutex mutex;
+	std::condition_variable work_cond;
+	std::condition_variable done_cond;
+
+	std::deque<LoadRequest*> queue;		/* Waiting a worker */
+	std::deque<LoadRequest*> done;		/* Waiting the upload */
+	std::vector<Resource*> working;
+	bool quit = false;
+};
+
+#endif
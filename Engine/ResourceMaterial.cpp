@@ -1,5 +1,6 @@
 #include "ResourceMaterial.h"
 #include "Application.h"
+#include "Profiler.h"
 
 
 ResourceMaterial::ResourceMaterial(uint uuid) : Resource(uuid, Resource::Type::MATERIAL, Resource::State::UNLOADED)
@@ -24,18 +25,22 @@ void ResourceMaterial::Init(Texture textureloaded)
 {
 	texture.id = textureloaded.id;
 	texture.name = textureloaded.name;
+	texture.size = textureloaded.size;
 }
 
 void ResourceMaterial::DeleteToMemory()
 {
 	state = Resource::State::UNLOADED;
 	glDeleteTextures(1, &texture.id);
+	SetMemory(0, 0);
 	LOG("UnLoaded Resource Material");
 }
 
 bool ResourceMaterial::LoadToMemory()
 {
+	PROFILE_FUNCTION();
 	state = Resource::State::LOADED;
+	SetMemory(0, texture.size);
 	LOG("Loaded Resource Material");
 	return true;
 }
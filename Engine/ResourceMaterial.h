@@ -11,7 +11,7 @@ struct Texture
 	std::string nameExt;
 	//std::string path;
 	std::string name;
-
+	uint size = 0;	/* Bytes in the GPU */
 };
 
 class ResourceMaterial : public Resource
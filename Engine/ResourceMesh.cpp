@@ -1,6 +1,8 @@
 #include "ResourceMesh.h"
 #include "Application.h"
 #include "Globals.h"
+#include "MeshQuantization.h"
+#include "Profiler.h"
 
 ResourceMesh::ResourceMesh(uint uid) : Resource(uid, Resource::Type::MESH, Resource::State::UNLOADED)
 {
@@ -10,47 +12,118 @@ ResourceMesh::ResourceMesh(uint uid) : Resource(uid, Resource::Type::MESH, Resou
 
 ResourceMesh::~ResourceMesh()
 {
-	vertices.clear();
-	indices.clear();
-	vertices_normals.clear();
+	geometry.Clear();
 }
 
-void ResourceMesh::Init(const float3* vert, const uint* ind, const float3* vert_normals, const float2* texCoord)
+// The arrays are views of the mesh file (mapped while loading), they are read again by LoadToMemory
+void ResourceMesh::Init(const float3* vert, const void* ind, bool ind_16, const float3* vert_normals, const float2* texCoord)
 {
-	// SET VERTEX DATA -------------------------------
-	for (uint i = 0; i < num_vertices; i++)
+	quantized = false;
+	vertex_size = sizeof(Vertex);
+	view_vertices = (const char*)vert;
+	view_normals = hasNormals ? (const char*)vert_normals : nullptr;
+	view_tex_coords = (const char*)texCoord;
+
+	// Positions (exact) & indices are kept for picking & bounding box
+	geometry.Set(vert, num_vertices, ind, ind_16, num_indices);
+	indices_16 = geometry.IsIndices16();
+}
+
+void ResourceMesh::InitQuantized(const float3& offset, float scale, const short* vert, const void* ind, bool ind_16, const signed char* oct_normals, const unsigned short* texCoord)
+{
+	quantized = true;
+	quant_offset = offset;
+	quant_scale = scale;
+	vertex_size = sizeof(VertexQuantized);
+	view_vertices = (const char*)vert;
+	view_normals = hasNormals ? (const char*)oct_normals : nullptr;
+	view_tex_coords = (const char*)texCoord;
+
+	// Positions & indices are kept for picking & bounding box (as in the file)
+	geometry.SetQuantized(offset, scale, vert, num_vertices, ind, ind_16, num_indices);
+	indices_16 = geometry.IsIndices16();
+}
+
+// Interleave the views in the GPU vertex format
+void ResourceMesh::WriteVertices(char* data) const
+{
+	if (quantized)
 	{
-		Vertex ver;
-		// Vertex Positions ------------------
-		ver.pos = vert[i];
+		const short* vert = (const short*)view_vertices;
+		const signed char* oct_normals = (const signed char*)view_normals;
+		const unsigned short* texCoord = (const unsigned short*)view_tex_coords;
 
-		// Vertex Normals --------------------
-		if (hasNormals)
-		{
-			ver.norm = vert_normals[i];
-		}
-		else
+		for (uint i = 0; i < num_vertices; i++)
 		{
-			ver.norm.Set(0, 0, 0);
-		}
+			VertexQuantized ver;
+			// Vertex Positions (decoded by the modelview when drawing) --
+			ver.pos[0] = vert[i * 3];
+			ver.pos[1] = vert[i * 3 + 1];
+			ver.pos[2] = vert[i * 3 + 2];
+			ver.pos[3] = 0;
 
-		// Vertex Tex Coords ------------------
-		ver.texCoords = texCoord[i];
+			// Vertex Normals (fixed pipeline can't decode octahedral normals) --
+			if (oct_normals != nullptr)
+			{
+				float3 normal = OctDecode(&oct_normals[i * 2]);
+				ver.norm[0] = FloatToSnorm8(normal.x);
+				ver.norm[1] = FloatToSnorm8(normal.y);
+				ver.norm[2] = FloatToSnorm8(normal.z);
+			}
+			else
+			{
+				ver.norm[0] = ver.norm[1] = ver.norm[2] = 0;
+			}
+			ver.norm[3] = 0;
 
-		vertices.push_back(ver);
-	}
+			// Vertex Tex Coords (half floats) ---
+			if (texCoord != nullptr)
+			{
+				ver.texCoords[0] = texCoord[i * 2];
+				ver.texCoords[1] = texCoord[i * 2 + 1];
+			}
+			else
+			{
+				ver.texCoords[0] = ver.texCoords[1] = 0;
+			}
 
-	// SET INDEX DATA -----------------------------------------
-	for (uint i = 0; i < num_indices; i++)
-	{
-		indices.push_back(ind[i]);
+			memcpy(data + i * sizeof(VertexQuantized), &ver, sizeof(VertexQuantized));
+		}
 	}
-
-	//NORMALS ARRAY ---------
-	for (int i = 0; i < num_vertices; i++)
+	else
 	{
-		vertices_normals.push_back(float3(vertices[i].pos.x, vertices[i].pos.y, vertices[i].pos.z));
-		vertices_normals.push_back(float3(vertices[i].pos.x + vertices[i].norm.x, vertices[i].pos.y + vertices[i].norm.y, vertices[i].pos.z + vertices[i].norm.z));
+		const float3* vert = (const float3*)view_vertices;
+		const float3* vert_normals = (const float3*)view_normals;
+		const float2* texCoord = (const float2*)view_tex_coords;
+
+		for (uint i = 0; i < num_vertices; i++)
+		{
+			Vertex ver;
+			// Vertex Positions ------------------
+			ver.pos = vert[i];
+
+			// Vertex Normals --------------------
+			if (vert_normals != nullptr)
+			{
+				ver.norm = vert_normals[i];
+			}
+			else
+			{
+				ver.norm.Set(0, 0, 0);
+			}
+
+			// Vertex Tex Coords ------------------
+			if (texCoord != nullptr)
+			{
+				ver.texCoords = texCoord[i];
+			}
+			else
+			{
+				ver.texCoords.Set(0, 0);
+			}
+
+			memcpy(data + i * sizeof(Vertex), &ver, sizeof(Vertex));
+		}
 	}
 }
 
@@ -79,55 +152,200 @@ void ResourceMesh::DeleteToMemory()
 	if (vertices_id != NULL)		glDeleteBuffers(1, &vertices_id);
 	if (indices_id != NULL)			glDeleteBuffers(1, &indices_id);
 	if (vertices_norm_id != NULL)	glDeleteBuffers(1, &vertices_norm_id);
+	if (VAO != NULL)				glDeleteVertexArrays(1, &VAO);
 
 	num_vertices = 0;
 	num_indices = 0;
 	hasNormals = false;
 
-	vertices.clear();
-	indices.clear();
-	vertices_normals.clear();
+	vertices_id = 0;
+	indices_id = 0;
+	vertices_norm_id = 0;
+	VAO = 0;
+	quantized = false;
+	indices_16 = false;
+
+	geometry.Clear();
+	view_vertices = view_normals = view_tex_coords = nullptr;
+	std::vector<char>().swap(staging_vertices);
+	bvh.Clear();
+	UpdateMemory();
 	LOG("UnLoaded Resource Mesh");
 }
 
 bool ResourceMesh::LoadToMemory()
 {
+	PROFILE_FUNCTION();
 	LOG("Resources: %s, Loaded in Memory!", this->name);
-	//glGenVertexArrays(1, &VAO);
 	glGenBuffers(1, &vertices_id);
 	glGenBuffers(1, &indices_id);
-	glGenBuffers(1, &vertices_norm_id);
-
-	//glBindVertexArray(VAO);
 
+	// Vertices are written straight in the buffer (interleaved from the views of the file)
+	uint vertices_size = num_vertices * vertex_size;
 	glBindBuffer(GL_ARRAY_BUFFER, vertices_id);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+	if (staging_vertices.size() > 0)
+	{
+		glBufferData(GL_ARRAY_BUFFER, staging_vertices.size(), staging_vertices.data(), GL_STATIC_DRAW);
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, vertices_size, NULL, GL_STATIC_DRAW);
+	}
+	if (staging_vertices.size() == 0 && vertices_size > 0 && view_vertices != nullptr)
+	{
+		char* data = (char*)glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
+		if (data != nullptr)
+		{
+			WriteVertices(data);
+			if (glUnmapBuffer(GL_ARRAY_BUFFER) == GL_FALSE)
+			{
+				LOG("Vertex buffer of %s lost while uploading", name);
+			}
+		}
+		else
+		{
+			std::vector<char> staging(vertices_size);
+			WriteVertices(staging.data());
+			glBufferSubData(GL_ARRAY_BUFFER, 0, vertices_size, staging.data());
+		}
+	}
 
+	// Indices in RAM already have the GPU format
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint), &indices[0], GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, num_indices * (indices_16 ? sizeof(unsigned short) : sizeof(uint)), geometry.GetIndices(), GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	CreateVAO();
 
-	if (hasNormals)
+	// The file is unmapped after the upload, only positions & indices stay in RAM
+	view_vertices = view_normals = view_tex_coords = nullptr;
+	std::vector<char>().swap(staging_vertices);
+
+	// Build the triangles hierarchy once, picking only tests the triangles near the ray
+	if (bvh.IsBuilt() == false)
 	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vertices_norm_id);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, vertices_normals.size() * sizeof(float3), &vertices_normals[0], GL_STATIC_DRAW);
+		bvh.Build(geometry);
 	}
 
-	//// Vertex Positions -------------
-	//glEnableVertexAttribArray(0);
-	//glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(_Vertex), (void*)0);
+	state = Resource::State::LOADED;
+	UpdateMemory();
+	return true;
+}
+
+void ResourceMesh::StageUpload()
+{
+	staging_vertices.resize(num_vertices * vertex_size);
+	if (view_vertices != nullptr)
+	{
+		WriteVertices(staging_vertices.data());
+	}
 
-	//// Vertex Normals ----------------
-	//glEnableVertexAttribArray(1);
-	//glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(_Vertex), (void*)offsetof(_Vertex, norm));
+	view_vertices = view_normals = view_tex_coords = nullptr;
+}
 
-	//glBindVertexArray(0);
+Resource::State ResourceMesh::IsLoadedToMemory()
+{
+	return state;
+}
+
+// Attributes of the vertex buffer for the shaders, the fixed function path
+// still uses the client arrays with the default VAO
+void ResourceMesh::CreateVAO()
+{
+	if (GLEW_VERSION_3_0 == GL_FALSE || vertices_id == 0)
+	{
+		return;
+	}
+
+	glGenVertexArrays(1, &VAO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, vertices_id);
+
+	glEnableVertexAttribArray(MESH_ATTRIB_POSITION);
+	glEnableVertexAttribArray(MESH_ATTRIB_NORMAL);
+	glEnableVertexAttribArray(MESH_ATTRIB_TEX_COORD);
+	if (quantized)
+	{
+		// Positions are decoded in the vertex shader (quant_offset + pos * quant_scale)
+		glVertexAttribPointer(MESH_ATTRIB_POSITION, 3, GL_SHORT, GL_FALSE, sizeof(VertexQuantized), (void*)offsetof(VertexQuantized, pos));
+		glVertexAttribPointer(MESH_ATTRIB_NORMAL, 3, GL_BYTE, GL_TRUE, sizeof(VertexQuantized), (void*)offsetof(VertexQuantized, norm));
+		glVertexAttribPointer(MESH_ATTRIB_TEX_COORD, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(VertexQuantized), (void*)offsetof(VertexQuantized, texCoords));
+	}
+	else
+	{
+		glVertexAttribPointer(MESH_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, pos));
+		glVertexAttribPointer(MESH_ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, norm));
+		glVertexAttribPointer(MESH_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+	}
+
+	// The VAO keeps the index buffer
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
+	glBindVertexArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
 
-	state = Resource::State::LOADED;
+bool ResourceMesh::CreateNormalsBuffer()
+{
+	if (vertices_norm_id != 0)
+	{
+		return true;
+	}
+	if (hasNormals == false || vertices_id == 0 || vertex_size == 0)
+	{
+		return false;
+	}
+
+	// Normals aren't kept in RAM, read them back from the vertex buffer
+	std::vector<char> data(num_vertices * vertex_size);
+	glBindBuffer(GL_ARRAY_BUFFER, vertices_id);
+	glGetBufferSubData(GL_ARRAY_BUFFER, 0, data.size(), data.data());
+
+	std::vector<float3> lines;
+	lines.reserve(num_vertices * 2);
+	for (uint i = 0; i < num_vertices; i++)
+	{
+		float3 normal;
+		if (quantized)
+		{
+			const VertexQuantized* ver = (const VertexQuantized*)&data[i * vertex_size];
+			normal.Set(ver->norm[0] / 127.0f, ver->norm[1] / 127.0f, ver->norm[2] / 127.0f);
+		}
+		else
+		{
+			normal = ((const Vertex*)&data[i * vertex_size])->norm;
+		}
+		float3 vertex = geometry.GetVertex(i);
+		lines.push_back(vertex);
+		lines.push_back(vertex + normal);
+	}
+
+	glGenBuffers(1, &vertices_norm_id);
+	glBindBuffer(GL_ARRAY_BUFFER, vertices_norm_id);
+	glBufferData(GL_ARRAY_BUFFER, lines.size() * sizeof(float3), lines.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	UpdateMemory();
 	return true;
 }
 
-Resource::State ResourceMesh::IsLoadedToMemory()
+// Positions & indices are duplicated in RAM (format of the file) for picking and the bounding box
+void ResourceMesh::UpdateMemory()
 {
-	return state;
+	uint64 cpu = geometry.GetMemory() + staging_vertices.capacity() + bvh.GetMemory();
+
+	uint64 gpu = 0;
+	if (vertices_id != 0)
+	{
+		gpu += num_vertices * vertex_size;
+	}
+	if (indices_id != 0)
+	{
+		gpu += num_indices * (indices_16 ? sizeof(unsigned short) : sizeof(uint));
+	}
+	if (vertices_norm_id != 0)
+	{
+		gpu += num_vertices * 2 * sizeof(float3);
+	}
+	SetMemory(cpu, gpu);
 }
@@ -4,6 +4,13 @@
 #include "Resource_.h"
 #include "Math/float3.h"
 #include "Math/float2.h"
+#include "MeshBVH.h"
+#include "MeshGeometry.h"
+
+// Attribute locations of the VAO (see RenderBackendCore shaders)
+#define MESH_ATTRIB_POSITION 0
+#define MESH_ATTRIB_NORMAL 1
+#define MESH_ATTRIB_TEX_COORD 2
 
 struct Vertex
 {
@@ -12,34 +19,72 @@ struct Vertex
 	float2 texCoords;
 };
 
+// Quantized vertex (16 bytes): positions relative to the mesh bounds (pos = quant_offset + pos * quant_scale),
+// snorm8 normals and half float tex coords
+struct VertexQuantized
+{
+	short pos[4];				// w is padding
+	signed char norm[4];		// w is padding
+	unsigned short texCoords[2];
+};
+
 class ResourceMesh : public Resource
 {
 public:
 	ResourceMesh(uint uid);
 	virtual ~ResourceMesh();
 
-	void Init(const float3* vert, const uint* ind, const float3* vert_normals, const float2* texCoord);
+	// Arrays have to stay valid until LoadToMemory (ex: the mapped file)
+	void Init(const float3* vert, const void* ind, bool ind_16, const float3* vert_normals, const float2* texCoord);
+	void InitQuantized(const float3& offset, float scale, const short* vert, const void* ind, bool ind_16, const signed char* oct_normals, const unsigned short* texCoord);
 	void InitRanges(uint num_vert, uint num_ind, uint num_normals);
 	void InitInfo(const char* name);
 
 	void DeleteToMemory();
 	bool LoadToMemory();
+	// Copy the views to staging buffers, then LoadToMemory can be done later (resource streaming)
+	void StageUpload();
 	Resource::State IsLoadedToMemory();
 
+	// Lines of the normals are only needed to debug, they are created the first time
+	bool CreateNormalsBuffer();
+
+	// Reports the arrays kept in RAM and the buffers of the GPU (main thread)
+	void UpdateMemory();
+
+private:
+	void CreateVAO();
+	void WriteVertices(char* data) const;
+
 public:
 	bool hasNormals = false;
 	uint num_vertices = 0;
 	uint num_indices = 0;
-	std::vector<Vertex> vertices;
-	std::vector<uint> indices;
-	std::vector<float3> vertices_normals;
+	MeshGeometry geometry;		/* POSITIONS & INDICES (PICKING & BOUNDING BOX) */
+
+	// Views of the file data to upload, only valid until LoadToMemory
+	const char* view_vertices = nullptr;		/* float3 or short[3] */
+	const char* view_normals = nullptr;			/* float3 or octahedral snorm8[2] */
+	const char* view_tex_coords = nullptr;		/* float2 or half[2] */
+
+	// Staging buffers (GPU format) when the upload is done after the file is released
+	std::vector<char> staging_vertices;
+
+	uint vertex_size = 0;						/* Vertex or VertexQuantized */
+	bool indices_16 = false;
+
+	bool quantized = false;
+	float3 quant_offset = float3::zero;
+	float quant_scale = 1.0f;
 	//std::vector<FaceCenter> face_centers;
 
-	//uint VAO = 0;				/* Vertex Array Object */
+	uint VAO = 0;				/* Vertex Array Object (0 without GL 3.0) */
 	uint vertices_id = 0;		/* VERTICES ID */
 	uint indices_id = 0;		/* INDICES ID */
 	uint vertices_norm_id = 0;	/* NORMALS OF VERTICES ID */
 
+	MeshBVH bvh;				/* TRIANGLES HIERARCHY (MOUSE PICKING) */
+
 };
 
 #endif
\ No newline at end of file
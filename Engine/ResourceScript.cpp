@@ -4,6 +4,7 @@
 #include "ModuleFS.h"
 #include "GameObject.h"
 #include "Script_editor.h"
+#include <fstream>
 
 ResourceScript::ResourceScript(uint uid) : Resource(uid, Resource::Type::SCRIPT, Resource::State::UNLOADED)
 {
@@ -57,7 +58,9 @@ bool ResourceScript::ReImportScript(std::string path_dll_)
 {
 	if (csharp != nullptr)
 	{
-		return csharp->ReImport(path_dll_);
+		bool ret = csharp->ReImport(path_dll_);
+		UpdateMemory();
+		return ret;
 	}
 }
 
@@ -65,6 +68,22 @@ bool ResourceScript::ReImportScript(std::string path_dll_)
 void ResourceScript::SetCSharp(CSharpScript* csharp_)
 {
 	csharp = csharp_;
+	UpdateMemory();
+}
+
+// The assembly loaded by Mono takes about the size of the dll
+void ResourceScript::UpdateMemory()
+{
+	uint64 size = 0;
+	if (csharp != nullptr)
+	{
+		std::ifstream file(path_dll, std::ifstream::binary | std::ifstream::ate);
+		if (file.good())
+		{
+			size = (uint64)file.tellg();
+		}
+	}
+	SetMemory(size, 0);
 }
 
 bool ResourceScript::Start()
@@ -129,12 +148,12 @@ Resource::State ResourceScript::IsCompiled()
 	return state;
 }
 
-void ResourceScript::Save(JSON_Object* object, std::string name) const
+void ResourceScript::Save(JSONWriter& writer) const
 {
 	//Save Values
 	if (csharp != nullptr)
 	{
-		csharp->Save(object, name);
+		csharp->Save(writer);
 	}
 }
 
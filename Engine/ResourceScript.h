@@ -9,6 +9,7 @@
 class CSharpScript;
 class Script_editor;
 class GameObject;
+class JSONWriter;
 
 class ResourceScript : public Resource
 {
@@ -41,10 +42,13 @@ public:
 	Resource::State IsCompiled();
 
 	// LOAD - SAVE METHODS ------------------
-	void Save(JSON_Object* object, std::string name) const;
+	void Save(JSONWriter& writer) const;
 	void Load(const JSON_Object* object, std::string name);
 	void LoadValuesGameObject();
 
+private:
+	void UpdateMemory();
+
 private:
 	std::string path_dll;
 	CSharpScript* csharp = nullptr;
@@ -1,4 +1,5 @@
 #include "Resource_.h"
+#include "MemoryTracker.h"
 
 
 Resource::Resource(uint uid, Resource::Type type, Resource::State state) : uuid(uid), type(type), state(state)
@@ -7,6 +8,7 @@ Resource::Resource(uint uid, Resource::Type type, Resource::State state) : uuid(
 
 Resource::~Resource()
 {
+	SetMemory(0, 0);
 	RELEASE_ARRAY(name);
 }
 
@@ -30,3 +32,30 @@ void Resource::SetState(Resource::State newstate)
 	state = newstate;
 }
 
+void Resource::SetMemory(uint64 cpu, uint64 gpu)
+{
+	MemoryTag tag = MEMORY_MESHES;
+	switch (type)
+	{
+	case Type::MESH:		tag = MEMORY_MESHES; break;
+	case Type::MATERIAL:	tag = MEMORY_TEXTURES; break;
+	case Type::SCRIPT:		tag = MEMORY_SCRIPTS; break;
+	default:				return; /* Folders & unknown resources aren't tracked */
+	}
+
+	MemoryAdd(tag, MEMORY_CPU, (__int64)cpu - (__int64)cpu_memory);
+	MemoryAdd(tag, MEMORY_GPU, (__int64)gpu - (__int64)gpu_memory);
+	cpu_memory = cpu;
+	gpu_memory = gpu;
+}
+
+uint64 Resource::GetCPUMemory() const
+{
+	return cpu_memory;
+}
+
+uint64 Resource::GetGPUMemory() const
+{
+	return gpu_memory;
+}
+
@@ -22,7 +22,8 @@ public:
 		REIMPORTED,
 		WANTDELETE,
 		FAILED,
-		REIMPORTEDSCRIPT
+		REIMPORTEDSCRIPT,
+		LOADING				/* Streaming, see ResourceLoader */
 	};
 
 public:
@@ -34,6 +35,11 @@ public:
 	uint GetUUID() const;
 	void SetState(Resource::State state);
 
+	// Bytes in RAM & video memory, added to the tag of the type (see MemoryTracker)
+	void SetMemory(uint64 cpu, uint64 gpu);
+	uint64 GetCPUMemory() const;
+	uint64 GetGPUMemory() const;
+
 	virtual void DeleteToMemory(){}
 	virtual Resource::State IsLoadedToMemory()
 	{
@@ -44,6 +50,8 @@ protected:
 	Type type = Type::UNKNOWN;
 	State state = State::UNLOADED;
 	uint uuid = 0;
+	uint64 cpu_memory = 0;
+	uint64 gpu_memory = 0;
 
 public:
 	char* name = "Name Resource";
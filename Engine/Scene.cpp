@@ -15,14 +15,18 @@
 #include "CompMaterial.h"
 #include "WindowInspector.h"
 #include "CompCamera.h"
+#include "CompScript.h"
 #include "MathGeoLib.h"
 #include "Quadtree.h"
 #include "JSONSerialization.h"
 #include "SkyBox.h"
+#include "FrustumCulling.h"
+#include "JobSystem.h"
 
 #include "Gl3W/include/glew.h"
 #include "ImGui/imgui.h"
 #include "ImGui/imgui_impl_sdl_gl3.h"
+#include "Profiler.h"
 
 #include <direct.h>
 
@@ -38,6 +42,9 @@ Scene::Scene(bool start_enabled) : Module(start_enabled)
 
 	name = "Scene";
 	haveConfig = true;
+
+	/* Init Octree (before any Game Object is created) */
+	octree.Init(float3::zero, OCTREE_SIZE, OCTREE_MAX_DEPTH);
 }
 
 Scene::~Scene()
@@ -85,11 +92,34 @@ bool Scene::Start()
 	return true;
 }
 
-update_status Scene::PreUpdate(float dt)
+// Components of the active GameObjects, in the order of their pool (isActiveInHierarchy is cached)
+template<typename TYPE>
+static void PreUpdatePool(const ComponentPool<TYPE>* pool, float dt)
 {
-	perf_timer.Start();
+	pool->ForEach([dt](TYPE* component)
+	{
+		if (component->isActive() && component->GetParent()->isActiveInHierarchy())
+		{
+			component->preUpdate(dt);
+		}
+	});
+}
 
-	// PreUpdate GameObjects ------------------------
+template<typename TYPE>
+static void UpdatePool(const ComponentPool<TYPE>* pool, float dt)
+{
+	pool->ForEach([dt](TYPE* component)
+	{
+		if (component->isActive() && component->GetParent()->isActiveInHierarchy())
+		{
+			component->Update(dt);
+		}
+	});
+}
+
+update_status Scene::PreUpdate(float dt)
+{
+	// Delete the GameObjects & Components marked ------------------------
 	for (uint i = 0; i < gameobjects.size(); i++)
 	{
 		if (gameobjects[i]->WanttoDelete() == false)
@@ -102,31 +132,30 @@ update_status Scene::PreUpdate(float dt)
 		}
 	}
 
-	//// PreUpdate GameObjects ------------------------
-	//for (uint i = 0; i < gameobjects_inscene->GetNumChilds(); i++)
-	//{
-	//	if (gameobjects_inscene->WanttoDelete() == false) //Scene
-	//	{
-	//		gameobjects_inscene->preUpdate(dt);
-	//	}
-	//}
+	// PreUpdate Components by type (resources first, the main camera culls after) ------
+	PROFILE_SCOPE("Components PreUpdate");
+	PreUpdatePool(component_pools.meshes, dt);
+	PreUpdatePool(component_pools.materials, dt);
+	PreUpdatePool(component_pools.scripts, dt);
+	PreUpdatePool(component_pools.cameras, dt);
 
-	preUpdate_t = perf_timer.ReadMs();
 	return UPDATE_CONTINUE;
 }
 
 update_status Scene::Update(float dt)
 {
-	perf_timer.Start();
-
-	// Update GameObjects -----------
-	for (uint i = 0; i < gameobjects.size(); i++)
+	// Update Components by type: scripts & gizmos move the transforms, then the cameras follow them.
+	// Meshes & materials don't update.
 	{
-		gameobjects[i]->Update(dt);
+		PROFILE_SCOPE("Components Update");
+		UpdatePool(component_pools.scripts, dt);
+		UpdatePool(component_pools.transforms, dt);
+		UpdatePool(component_pools.cameras, dt);
 	}
-	// -------------------------------------------------
 
-	Update_t = perf_timer.ReadMs();
+	// Recalculate modified transforms and their bounding boxes
+	UpdateTransforms();
+
 	return UPDATE_CONTINUE;
 }
 
@@ -197,6 +226,17 @@ void Scene::EditorQuadtree()
 				LOG("Update Quadtree not possible while GAME MODE is ON");
 			}
 		}
+
+		/* Dynamic objects are kept updated in the Octree */
+		ImGui::Checkbox("##octreedraw", &octree_draw); ImGui::SameLine();
+		ImGui::Text("Draw Octree");
+		ImGui::Text("Octree: %i objects / %i nodes", octree.GetNumObjects(), octree.GetNumNodes());
+
+		/* Compare batch culling kernel with CompCamera::ContainsAABox (output to console) */
+		if (ImGui::Button("CULLING BENCHMARK"))
+		{
+			CullingBenchmark(50000, 10);
+		}
 		ImGui::TreePop();
 	}
 	else
@@ -280,10 +320,11 @@ void Scene::ClearAllVariablesScript()
 
 void Scene::SetScriptVariablesToNull(GameObject * go)
 {
-	for (uint i = 0; i < gameobjects.size(); i++)
+	// All the scripts, also the ones of childs
+	component_pools.scripts->ForEach([go](CompScript* script)
 	{
-		gameobjects[i]->RemoveScriptReference(go);
-	}
+		script->RemoveReferences(go);
+	});
 }
 
 GameObject* Scene::GetGameObjectfromScene(bool& active)
@@ -318,15 +359,32 @@ GameObject* Scene::GetGameObjectfromScene(bool& active)
 
 GameObject* Scene::GetGameObjectbyuid(uint uid)
 {
-	for (int i = 0; i < gameobjects.size(); i++)
+	std::unordered_multimap<uint, GameObject*>::const_iterator it = uuid_map.find(uid);
+	if (it != uuid_map.end())
 	{
-		GameObject* ret = gameobjects[i]->GetGameObjectbyuid(uid);
-		if (ret != nullptr)
+		return it->second;
+	}
+	return nullptr;
+}
+
+void Scene::RegisterUUID(GameObject* gameobject)
+{
+	uuid_map.insert(std::pair<uint, GameObject*>(gameobject->GetUUID(), gameobject));
+}
+
+void Scene::UnregisterUUID(GameObject* gameobject)
+{
+	// Only the entry of this GameObject, others with the same UUID are still found
+	typedef std::unordered_multimap<uint, GameObject*>::iterator UUIDIterator;
+	std::pair<UUIDIterator, UUIDIterator> range = uuid_map.equal_range(gameobject->GetUUID());
+	for (UUIDIterator it = range.first; it != range.second; ++it)
+	{
+		if (it->second == gameobject)
 		{
-			return ret;
+			uuid_map.erase(it);
+			return;
 		}
 	}
-	return nullptr;
 }
 
 void Scene::DrawPlane()
@@ -410,6 +468,49 @@ void Scene::FillStaticObjectsVector(bool fill)
 	}
 }
 
+void Scene::MeshLoaded(const ResourceMesh* mesh)
+{
+	component_pools.meshes->ForEach([mesh](CompMesh* comp_mesh)
+	{
+		comp_mesh->ResourceLoaded(mesh);
+	});
+}
+
+// Propagate all dirty transforms in one pass and resize the bounding boxes of the moved objects
+void Scene::UpdateTransforms()
+{
+	PROFILE_FUNCTION();
+	transform_hierarchy.Propagate(App->jobs);
+
+	// Boxes of the objects moved are independent, but the octree is only modified from the main thread
+	const std::vector<int>& changed = transform_hierarchy.GetChanged();
+	refreshed_boxes.resize(changed.size());
+	App->jobs->ParallelFor("Bounding Boxes", changed.size(), JOBS_DEFAULT_GRAIN, [this, &changed](uint begin, uint end)
+	{
+		for (uint i = begin; i < end; i++)
+		{
+			refreshed_boxes[i] = transform_hierarchy.GetOwner(changed[i])->GetParent()->RefreshBoundingBox();
+		}
+	});
+
+	for (uint i = 0; i < changed.size(); i++)
+	{
+		if (refreshed_boxes[i])
+		{
+			octree.Insert(transform_hierarchy.GetOwner(changed[i])->GetParent());
+		}
+	}
+}
+
+uint64 Scene::GetMemory() const
+{
+	uint64 memory = uuid_map.size() * (sizeof(GameObject) + sizeof(std::pair<uint, GameObject*>) + 2 * sizeof(void*));
+	memory += component_pools.GetMemory();
+	memory += transform_hierarchy.GetMemory();
+	memory += octree.GetMemory();
+	return memory;
+}
+
 GameObject* Scene::CreateGameObject(GameObject* parent)
 {
 	GameObject* obj = new GameObject(parent);
@@ -6,7 +6,11 @@
 #include "ModuleFramebuffers.h"
 #include "CompMesh.h"
 #include "Quadtree.h"
+#include "LooseOctree.h"
+#include "TransformHierarchy.h"
+#include "ComponentPool.h"
 #include <vector>
+#include <unordered_map>
 
 class GameObject;
 class SkyBox;
@@ -40,6 +44,13 @@ public:
 	GameObject* GetGameObjectfromScene(bool& active);
 	GameObject* GetGameObjectbyuid(uint uid);
 
+	// UUID REGISTRY ---------
+	// All GameObjects are added on creation/UUID change and removed on delete.
+	// UUIDs can be repeated (ex: instances of a prefab), then any of them is returned
+	// and the others are still found when it's deleted.
+	void RegisterUUID(GameObject* gameobject);
+	void UnregisterUUID(GameObject* gameobject);
+
 	// DRAWING METHODS ---------
 	void DrawPlane();
 	void DrawCube(float size);
@@ -47,6 +58,15 @@ public:
 	// CULLING HELPER FUNCTION -----------
 	void FillStaticObjectsVector(bool fill);
 
+	// TRANSFORMS ----------
+	void UpdateTransforms();
+
+	// A streamed mesh is ready: the objects that use it get their bounding box
+	void MeshLoaded(const ResourceMesh* mesh);
+
+	// Bytes of the GameObjects (without names), components, transforms & octree
+	uint64 GetMemory() const;
+
 	//OBJECTS CREATION / DELETION ---------------------
 	GameObject* CreateGameObject(GameObject* parent = nullptr);
 	GameObject* CreateCube(GameObject* parent = nullptr);
@@ -66,11 +86,22 @@ public:
 	//Container Vector of Static Objects (to speeding searches with quadtree)
 	std::vector<GameObject*> static_objects;
 
+	// Transforms of all Game Objects (sorted parents first) ---
+	TransformHierarchy transform_hierarchy;
+
+	// Components of all Game Objects (contiguous per type, updated pool by pool) ---
+	ComponentPools component_pools;
+
 	// Quadtree ----------------
 	Quadtree quadtree;
 	bool quadtree_draw = false;
 	// -------------------------
 
+	// Octree (all objects with AABB, used for dynamic ones) --
+	LooseOctree octree;
+	bool octree_draw = false;
+	// -------------------------
+
 	// Skybox --------------------
 	SkyBox* skybox = nullptr;
 	int skybox_index = 0;
@@ -83,6 +114,9 @@ public:
 private:
 	int size_plane = 0;
 	float size_quadtree = 0.0f;
+
+	std::unordered_multimap<uint, GameObject*> uuid_map;
+	std::vector<uchar> refreshed_boxes; // Objects moved with a box (written by the jobs)
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,377 @@
+#include "TransformHierarchy.h"
+#include "CompTransform.h"
+#include "JobSystem.h"
+#include <algorithm>
+
+TransformHierarchy::TransformHierarchy()
+{
+}
+
+TransformHierarchy::~TransformHierarchy()
+{
+	Clear();
+}
+
+int TransformHierarchy::Add(CompTransform* owner, int parent)
+{
+	int index = 0;
+
+	// Reuse a free slot if there is one, otherwise push at the end
+	if (free_slots.size() > 0)
+	{
+		index = free_slots.back();
+		free_slots.pop_back();
+		owners[index] = owner;
+		parents[index] = parent;
+		locals[index] = float4x4::identity;
+		globals[index] = float4x4::identity;
+		dirty[index] = DIRTY_NONE;
+		num_childs[index] = 0;
+	}
+	else
+	{
+		index = owners.size();
+		owners.push_back(owner);
+		parents.push_back(parent);
+		locals.push_back(float4x4::identity);
+		globals.push_back(float4x4::identity);
+		dirty.push_back(DIRTY_NONE);
+		num_childs.push_back(0);
+	}
+
+	if (parent != TRANSFORM_NONE)
+	{
+		num_childs[parent]++;
+	}
+
+	// Parents must be stored before their childs
+	if (parent > index)
+	{
+		sorted = false;
+	}
+
+	num_transforms++;
+	SetDirty(index, DIRTY_LOCAL);
+	return index;
+}
+
+void TransformHierarchy::Remove(int index)
+{
+	if (index < 0 || index >= (int)owners.size() || owners[index] == nullptr)
+	{
+		return;
+	}
+
+	if (parents[index] != TRANSFORM_NONE)
+	{
+		num_childs[parents[index]]--;
+	}
+
+	// Childs still alive become roots, otherwise they would follow the next owner of this slot
+	// (the scene deletes the childs first, so usually there aren't)
+	if (num_childs[index] > 0)
+	{
+		for (uint i = 0; i < owners.size(); i++)
+		{
+			if (owners[i] != nullptr && parents[i] == index)
+			{
+				parents[i] = TRANSFORM_NONE;
+				SetDirty(i, DIRTY_GLOBAL);
+			}
+		}
+		num_childs[index] = 0;
+		sorted = false;
+	}
+
+	owners[index] = nullptr;
+	parents[index] = TRANSFORM_NONE;
+	dirty[index] = DIRTY_NONE;
+	free_slots.push_back(index);
+	num_transforms--;
+}
+
+void TransformHierarchy::SetParent(int index, int parent)
+{
+	if (index < 0 || index >= (int)owners.size())
+	{
+		return;
+	}
+
+	if (parents[index] != TRANSFORM_NONE)
+	{
+		num_childs[parents[index]]--;
+	}
+	if (parent != TRANSFORM_NONE)
+	{
+		num_childs[parent]++;
+	}
+
+	parents[index] = parent;
+	if (parent > index)
+	{
+		sorted = false;
+	}
+
+	SetDirty(index, DIRTY_GLOBAL);
+}
+
+void TransformHierarchy::SetDirty(int index, uchar flags)
+{
+	if (index < 0 || index >= (int)owners.size())
+	{
+		return;
+	}
+
+	dirty[index] |= flags;
+	num_dirty++;
+}
+
+void TransformHierarchy::Propagate(JobSystem* jobs)
+{
+	changed.clear();
+
+	// Nothing moved since last frame
+	if (num_dirty == 0)
+	{
+		return;
+	}
+
+	if (sorted == false)
+	{
+		Sort();
+	}
+
+	uint size = owners.size();
+	if (jobs == nullptr || jobs->GetNumThreads() == 0 || size <= JOBS_DEFAULT_GRAIN)
+	{
+		PropagateRange(0, size);
+	}
+	else
+	{
+		// Jobs of JOBS_DEFAULT_GRAIN consecutive transforms (whole subtrees after Sort()).
+		// A job waits the jobs holding the parents stored before its range, there is no
+		// barrier per depth level.
+		JobGraph graph;
+		std::vector<Job*> chunks;
+		std::vector<uint> waits;
+		for (uint begin = 0; begin < size; begin += JOBS_DEFAULT_GRAIN)
+		{
+			uint end = (begin + JOBS_DEFAULT_GRAIN < size) ? begin + JOBS_DEFAULT_GRAIN : size;
+			Job* job = graph.Add("Transforms", [this, begin, end]() { PropagateRange(begin, end); });
+
+			waits.clear();
+			for (uint i = begin; i < end; i++)
+			{
+				int parent = parents[i];
+				if (owners[i] == nullptr || parent == TRANSFORM_NONE || parent >= (int)begin)
+				{
+					continue;
+				}
+
+				uint chunk = parent / JOBS_DEFAULT_GRAIN;
+				if (std::find(waits.begin(), waits.end(), chunk) == waits.end())
+				{
+					waits.push_back(chunk);
+					graph.Depends(job, chunks[chunk]);
+				}
+			}
+			chunks.push_back(job);
+		}
+		jobs->Run(graph);
+	}
+
+	// Reset flags only of the transforms updated
+	for (uint i = 0; i < size; i++)
+	{
+		if (owners[i] != nullptr && dirty[i] != DIRTY_NONE)
+		{
+			changed.push_back(i);
+			dirty[i] = DIRTY_NONE;
+		}
+	}
+	num_dirty = 0;
+}
+
+// Flags are reset after all the ranges, so the childs can check if their parent has been recomputed
+void TransformHierarchy::PropagateRange(uint begin, uint end)
+{
+	for (uint i = begin; i < end; i++)
+	{
+		if (owners[i] == nullptr)
+		{
+			continue;
+		}
+
+		// Parent is always processed before, so its flag tells us if it has been recomputed
+		int parent = parents[i];
+		if (parent != TRANSFORM_NONE && dirty[parent] != DIRTY_NONE)
+		{
+			dirty[i] |= DIRTY_GLOBAL;
+		}
+
+		if (dirty[i] != DIRTY_NONE)
+		{
+			if (dirty[i] & DIRTY_LOCAL)
+			{
+				owners[i]->SetLocalTransform();
+			}
+
+			if (parent != TRANSFORM_NONE)
+			{
+				globals[i] = globals[parent] * locals[i];
+			}
+			else
+			{
+				globals[i] = locals[i];
+			}
+		}
+	}
+}
+
+void TransformHierarchy::Clear()
+{
+	owners.clear();
+	parents.clear();
+	locals.clear();
+	globals.clear();
+	dirty.clear();
+	num_childs.clear();
+	free_slots.clear();
+	changed.clear();
+	num_transforms = 0;
+	num_dirty = 0;
+	sorted = true;
+}
+
+const float4x4& TransformHierarchy::GetLocal(int index) const
+{
+	return locals[index];
+}
+
+const float4x4& TransformHierarchy::GetGlobal(int index) const
+{
+	return globals[index];
+}
+
+void TransformHierarchy::SetLocal(int index, const float4x4& local)
+{
+	locals[index] = local;
+}
+
+int TransformHierarchy::GetParent(int index) const
+{
+	return parents[index];
+}
+
+uint TransformHierarchy::GetNumTransforms() const
+{
+	return num_transforms;
+}
+
+uint TransformHierarchy::GetMemory() const
+{
+	return owners.capacity() * sizeof(CompTransform*) + parents.capacity() * sizeof(int) +
+		(locals.capacity() + globals.capacity()) * sizeof(float4x4) + dirty.capacity() +
+		(num_childs.capacity() + free_slots.capacity() + changed.capacity()) * sizeof(int);
+}
+
+const std::vector<int>& TransformHierarchy::GetChanged() const
+{
+	return changed;
+}
+
+CompTransform* TransformHierarchy::GetOwner(int index) const
+{
+	return owners[index];
+}
+
+// Reorder all arrays depth first (each parent followed by its whole subtree) and remove
+// the free slots. Only needed after reparenting or reusing a slot in front of its parent.
+void TransformHierarchy::Sort()
+{
+	uint size = owners.size();
+
+	// Childs of each transform (consecutive in 'childs', from first_child[i] to first_child[i + 1])
+	std::vector<uint> first_child(size + 1, 0);
+	for (uint i = 0; i < size; i++)
+	{
+		if (owners[i] != nullptr && parents[i] != TRANSFORM_NONE)
+		{
+			first_child[parents[i] + 1]++;
+		}
+	}
+	for (uint i = 1; i <= size; i++)
+	{
+		first_child[i] += first_child[i - 1];
+	}
+
+	std::vector<int> childs(first_child[size]);
+	std::vector<uint> fill(first_child.begin(), first_child.end() - 1);
+	for (uint i = 0; i < size; i++)
+	{
+		if (owners[i] != nullptr && parents[i] != TRANSFORM_NONE)
+		{
+			childs[fill[parents[i]]++] = i;
+		}
+	}
+
+	// Iterative pre-order walk from each root, deep hierarchies would overflow the call stack
+	std::vector<int> remap(size, TRANSFORM_NONE);
+	std::vector<int> stack;
+	int next = 0;
+	for (uint root = 0; root < size; root++)
+	{
+		if (owners[root] == nullptr || parents[root] != TRANSFORM_NONE)
+		{
+			continue;
+		}
+
+		stack.push_back(root);
+		while (stack.size() > 0)
+		{
+			int current = stack.back();
+			stack.pop_back();
+			remap[current] = next++;
+
+			// Pushed in reverse, the childs keep their order
+			for (uint c = first_child[current + 1]; c > first_child[current]; c--)
+			{
+				stack.push_back(childs[c - 1]);
+			}
+		}
+	}
+
+	uint new_size = num_transforms;
+	std::vector<CompTransform*> new_owners(new_size, nullptr);
+	std::vector<int> new_parents(new_size, TRANSFORM_NONE);
+	std::vector<float4x4> new_locals(new_size);
+	std::vector<float4x4> new_globals(new_size);
+	std::vector<uchar> new_dirty(new_size, DIRTY_NONE);
+	std::vector<int> new_num_childs(new_size, 0);
+
+	for (uint i = 0; i < size; i++)
+	{
+		int index = remap[i];
+		if (index == TRANSFORM_NONE)
+		{
+			continue;
+		}
+
+		new_owners[index] = owners[i];
+		new_parents[index] = (parents[i] != TRANSFORM_NONE) ? remap[parents[i]] : TRANSFORM_NONE;
+		new_locals[index] = locals[i];
+		new_globals[index] = globals[i];
+		new_dirty[index] = dirty[i];
+		new_num_childs[index] = num_childs[i];
+		owners[i]->SetHierarchyIndex(index);
+	}
+
+	owners.swap(new_owners);
+	parents.swap(new_parents);
+	locals.swap(new_locals);
+	globals.swap(new_globals);
+	dirty.swap(new_dirty);
+	num_childs.swap(new_num_childs);
+	free_slots.clear();
+	sorted = true;
+}
@@ -0,0 +1,70 @@
+#ifndef _TRANSFORM_HIERARCHY_
+#define _TRANSFORM_HIERARCHY_
+
+#include "Globals.h"
+#include "MathGeoLib.h"
+#include <vector>
+
+class CompTransform;
+class JobSystem;
+
+#define TRANSFORM_NONE -1
+
+enum TransformDirty
+{
+	DIRTY_NONE = 0,
+	DIRTY_LOCAL = 1 << 0,	// Position/Rotation/Scale changed -> rebuild local matrix
+	DIRTY_GLOBAL = 1 << 1	// Only the parent changed -> rebuild global matrix
+};
+
+// Flat (SoA) storage of all the transforms of the scene.
+// Arrays are kept sorted so every parent is stored before its childs,
+// this way modified transforms are recomputed in one linear pass without recursion.
+// Sort() stores each subtree contiguously, so the jobs of Propagate() (consecutive
+// subtrees) only wait the few jobs holding their ancestors.
+class TransformHierarchy
+{
+public:
+	TransformHierarchy();
+	~TransformHierarchy();
+
+	int Add(CompTransform* owner, int parent);
+	void Remove(int index);
+	void SetParent(int index, int parent);
+	void SetDirty(int index, uchar flags = DIRTY_LOCAL);
+
+	// Recompute all dirty transforms (and their childs), in parallel if there is a job system
+	void Propagate(JobSystem* jobs = nullptr);
+	void Clear();
+
+	const float4x4& GetLocal(int index) const;
+	const float4x4& GetGlobal(int index) const;
+	void SetLocal(int index, const float4x4& local);
+	int GetParent(int index) const;
+	uint GetNumTransforms() const;
+	uint GetMemory() const;
+
+	// Transforms recomputed by the last Propagate() call
+	const std::vector<int>& GetChanged() const;
+	CompTransform* GetOwner(int index) const;
+
+private:
+	void Sort();
+	void PropagateRange(uint begin, uint end);
+
+private:
+	std::vector<CompTransform*> owners;
+	std::vector<int> parents;
+	std::vector<float4x4> locals;
+	std::vector<float4x4> globals;
+	std::vector<uchar> dirty;
+	std::vector<int> num_childs;	/* Only to know if a removed transform leaves orphans */
+
+	std::vector<int> free_slots;
+	std::vector<int> changed;
+	uint num_transforms = 0;
+	uint num_dirty = 0;
+	bool sorted = true;
+};
+
+#endif
@@ -2,6 +2,8 @@
 #include "Application.h"
 #include "ModuleGUI.h"
 #include "SDL\include\SDL.h"
+#include "CpuFeatures.h"
+#include "MathBenchmark.h"
 
 Hardware::Hardware() : WindowManager()
 {
@@ -42,6 +44,17 @@ update_status Hardware::Update(float dt)
 		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%d", SDL_GetCPUCount());
 		ImGui::Text("System RAM: "); ImGui::SameLine();
 		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%d Mb (Cache: %d Kb)", SDL_GetSystemRAM(), SDL_GetCPUCacheLineSize());
+		const CpuFeatures& cpu = GetCpuFeatures();
+		ImGui::Text("Caps: "); ImGui::SameLine();
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%s%s%s%s%s%s%s", cpu.sse ? "SSE " : "", cpu.sse2 ? "SSE2 " : "", cpu.sse3 ? "SSE3 " : "",
+			cpu.sse41 ? "SSE41 " : "", cpu.sse42 ? "SSE42 " : "", cpu.avx ? "AVX " : "", cpu.avx2 ? "AVX2" : "");
+		ImGui::Text("Math SIMD build: "); ImGui::SameLine();
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%s", GetBuildSIMDLevel());
+		/* Compare MathGeoLib with scalar references (output to console) */
+		if (ImGui::Button("MATH BENCHMARK"))
+		{
+			MathBenchmark(20);
+		}
 		ImGui::Separator();
 		ImGui::Text("Vendor: "); ImGui::SameLine();
 		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%s", glGetString(GL_VENDOR));
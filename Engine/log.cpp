@@ -4,19 +4,37 @@
 #include "Globals.h"
 #include "Application.h"
 #include "ModuleConsole.h"
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <string>
+
+// Only the main thread writes in the console, logs of other threads (ex: resource streaming) wait in a queue
+static std::thread::id main_thread = std::this_thread::get_id();
+static std::mutex log_mutex;
+static std::vector<std::string> log_queue;
 
 void log(const char file[], int line, const char* format, ...)
 {
-	static char tmp_string[4096];
-	static char tmp_string2[4096];
-	static va_list  ap;
+	char tmp_string[4096];
+	char tmp_string2[4096];
+	va_list  ap;
 
 	// Construct the string from variable arguments
 	va_start(ap, format);
 	vsprintf_s(tmp_string, 4096, format, ap);
 	va_end(ap);
 	sprintf_s(tmp_string2, 4096, "\n%s(%d) : %s", file, line, tmp_string);
-	
+
+	if (std::this_thread::get_id() != main_thread)
+	{
+		std::lock_guard<std::mutex> lock(log_mutex);
+		log_queue.push_back(tmp_string);
+		OutputDebugString(tmp_string2);
+		return;
+	}
+
+	FlushLog();
 	if (App != nullptr && App->console != nullptr)
 	{
 		App->console->AddLog(tmp_string);
@@ -25,4 +43,22 @@ void log(const char file[], int line, const char* format, ...)
 	OutputDebugString(tmp_string2);
 }
 
+void FlushLog()
+{
+	if (std::this_thread::get_id() != main_thread)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(log_mutex);
+	for (uint i = 0; i < log_queue.size(); i++)
+	{
+		if (App != nullptr && App->console != nullptr)
+		{
+			App->console->AddLog(log_queue[i].c_str());
+		}
+	}
+	log_queue.clear();
+}
+
 #endif
\ No newline at end of file
@@ -43,6 +43,7 @@ THE SOFTWARE.
 
 #define STARTING_CAPACITY 16
 #define MAX_NESTING       2048
+#define OBJECT_INDEX_THRESHOLD 16 /* objects with less names are searched linearly */
 #define FLOAT_FORMAT      "%1.17g"
 
 #define SIZEOF_TOKEN(a)       (sizeof(a) - 1)
@@ -80,6 +81,8 @@ struct json_object_t {
 	JSON_Value **values;
 	size_t       count;
 	size_t       capacity;
+	size_t      *index;          /* open addressing table (item + 1, 0 = empty), NULL under OBJECT_INDEX_THRESHOLD */
+	size_t       index_capacity;
 };
 
 struct json_array_t {
@@ -106,8 +109,15 @@ static JSON_Object * json_object_init(JSON_Value *wrapping_value);
 static JSON_Status   json_object_add(JSON_Object *object, const char *name, JSON_Value *value);
 static JSON_Status   json_object_resize(JSON_Object *object, size_t new_capacity);
 static JSON_Value  * json_object_nget_value(const JSON_Object *object, const char *name, size_t n);
+static JSON_Value  * json_object_hget_value(const JSON_Object *object, const char *name, size_t n, unsigned long hash);
 static void          json_object_free(JSON_Object *object);
 
+/* JSON Object index */
+static unsigned long hash_name(const char *name, size_t n);
+static JSON_Status   json_object_index_build(JSON_Object *object);
+static void          json_object_index_insert(JSON_Object *object, size_t item, unsigned long hash);
+static void          json_object_index_release(JSON_Object *object);
+
 /* JSON Array */
 static JSON_Array * json_array_init(JSON_Value *wrapping_value);
 static JSON_Status  json_array_add(JSON_Array *array, JSON_Value *value);
@@ -353,6 +363,8 @@ static JSON_Object * json_object_init(JSON_Value *wrapping_value) {
 	new_obj->values = (JSON_Value**)NULL;
 	new_obj->capacity = 0;
 	new_obj->count = 0;
+	new_obj->index = (size_t*)NULL;
+	new_obj->index_capacity = 0;
 	return new_obj;
 }
 
@@ -378,6 +390,16 @@ static JSON_Status json_object_add(JSON_Object *object, const char *name, JSON_V
 	value->parent = json_object_get_wrapping_value(object);
 	object->values[index] = value;
 	object->count++;
+	/* The index is only written here (and remove/clear), lookups can be concurrent */
+	if (object->index != NULL && object->count * 2 > object->index_capacity) {
+		json_object_index_release(object); /* rebuilt bigger */
+	}
+	if (object->index != NULL) {
+		json_object_index_insert(object, index, hash_name(name, strlen(name)));
+	}
+	else if (object->count >= OBJECT_INDEX_THRESHOLD) {
+		json_object_index_build(object); /* without memory lookups are linear */
+	}
 	return JSONSuccess;
 }
 
@@ -413,6 +435,9 @@ static JSON_Status json_object_resize(JSON_Object *object, size_t new_capacity)
 
 static JSON_Value * json_object_nget_value(const JSON_Object *object, const char *name, size_t n) {
 	size_t i, name_length;
+	if (json_object_get_count(object) >= OBJECT_INDEX_THRESHOLD) {
+		return json_object_hget_value(object, name, n, hash_name(name, n));
+	}
 	for (i = 0; i < json_object_get_count(object); i++) {
 		name_length = strlen(object->names[i]);
 		if (name_length != n) {
@@ -425,17 +450,88 @@ static JSON_Value * json_object_nget_value(const JSON_Object *object, const char
 	return NULL;
 }
 
+/* Lookup with the hash index (built when the object grows, lookups don't write) */
+static JSON_Value * json_object_hget_value(const JSON_Object *object, const char *name, size_t n, unsigned long hash) {
+	size_t slot, mask, item;
+	if (object == NULL || object->count == 0) {
+		return NULL;
+	}
+	if (object->index == NULL) {
+		for (item = 0; item < object->count; item++) { /* no memory for the index, linear search */
+			if (strncmp(object->names[item], name, n) == 0 && object->names[item][n] == '\0') {
+				return object->values[item];
+			}
+		}
+		return NULL;
+	}
+	mask = object->index_capacity - 1;
+	for (slot = hash & mask; object->index[slot] != 0; slot = (slot + 1) & mask) {
+		item = object->index[slot] - 1;
+		if (strncmp(object->names[item], name, n) == 0 && object->names[item][n] == '\0') {
+			return object->values[item];
+		}
+	}
+	return NULL;
+}
+
 static void json_object_free(JSON_Object *object) {
 	size_t i;
 	for (i = 0; i < object->count; i++) {
 		parson_free(object->names[i]);
 		json_value_free(object->values[i]);
 	}
+	json_object_index_release(object);
 	parson_free(object->names);
 	parson_free(object->values);
 	parson_free(object);
 }
 
+/* JSON Object index */
+/* FNV-1a */
+static unsigned long hash_name(const char *name, size_t n) {
+	unsigned long hash = 2166136261UL;
+	size_t i;
+	for (i = 0; i < n; i++) {
+		hash ^= (unsigned char)name[i];
+		hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+	}
+	return hash;
+}
+
+/* Load factor is kept under 0.5 */
+static JSON_Status json_object_index_build(JSON_Object *object) {
+	size_t i, new_capacity = STARTING_CAPACITY;
+	while (new_capacity < object->count * 4) {
+		new_capacity *= 2;
+	}
+	object->index = (size_t*)parson_malloc(new_capacity * sizeof(size_t));
+	if (object->index == NULL) {
+		object->index_capacity = 0;
+		return JSONFailure;
+	}
+	memset(object->index, 0, new_capacity * sizeof(size_t));
+	object->index_capacity = new_capacity;
+	for (i = 0; i < object->count; i++) {
+		json_object_index_insert(object, i, hash_name(object->names[i], strlen(object->names[i])));
+	}
+	return JSONSuccess;
+}
+
+static void json_object_index_insert(JSON_Object *object, size_t item, unsigned long hash) {
+	size_t mask = object->index_capacity - 1;
+	size_t slot = hash & mask;
+	while (object->index[slot] != 0) {
+		slot = (slot + 1) & mask;
+	}
+	object->index[slot] = item + 1;
+}
+
+static void json_object_index_release(JSON_Object *object) {
+	parson_free(object->index);
+	object->index = (size_t*)NULL;
+	object->index_capacity = 0;
+}
+
 /* JSON Array */
 static JSON_Array * json_array_init(JSON_Value *wrapping_value) {
 	JSON_Array *new_array = (JSON_Array*)parson_malloc(sizeof(JSON_Array));
@@ -1162,6 +1258,67 @@ int json_object_dotget_boolean_with_std(const JSON_Object *object, std::string n
 	return json_value_get_boolean(json_object_dotget_value(object, name.c_str()));
 }
 
+JSON_Object * json_object_dotget_node(const JSON_Object *object, const char *path) {
+	const char *dot_position = NULL;
+	if (path == NULL) {
+		return NULL;
+	}
+	while (object != NULL && *path != '\0') {
+		dot_position = strchr(path, '.');
+		if (dot_position == NULL) {
+			return json_value_get_object(json_object_nget_value(object, path, strlen(path)));
+		}
+		object = json_value_get_object(json_object_nget_value(object, path, dot_position - path));
+		path = dot_position + 1;
+	}
+	return (JSON_Object*)object;
+}
+
+JSON_Object * json_object_dotget_node_with_std(const JSON_Object *object, const std::string& path) {
+	return json_object_dotget_node(object, path.c_str());
+}
+
+JSON_Key json_key(const char *name) {
+	JSON_Key key;
+	key.name = name;
+	key.length = strlen(name);
+	key.hash = hash_name(name, key.length);
+	return key;
+}
+
+JSON_Value * json_object_get_value_by_key(const JSON_Object *object, const JSON_Key *key) {
+	size_t i;
+	if (json_object_get_count(object) >= OBJECT_INDEX_THRESHOLD) {
+		return json_object_hget_value(object, key->name, key->length, key->hash);
+	}
+	for (i = 0; i < json_object_get_count(object); i++) {
+		if (strncmp(object->names[i], key->name, key->length) == 0 && object->names[i][key->length] == '\0') {
+			return object->values[i];
+		}
+	}
+	return NULL;
+}
+
+const char * json_object_get_string_by_key(const JSON_Object *object, const JSON_Key *key) {
+	return json_value_get_string(json_object_get_value_by_key(object, key));
+}
+
+double json_object_get_number_by_key(const JSON_Object *object, const JSON_Key *key) {
+	return json_value_get_number(json_object_get_value_by_key(object, key));
+}
+
+JSON_Object * json_object_get_object_by_key(const JSON_Object *object, const JSON_Key *key) {
+	return json_value_get_object(json_object_get_value_by_key(object, key));
+}
+
+JSON_Array * json_object_get_array_by_key(const JSON_Object *object, const JSON_Key *key) {
+	return json_value_get_array(json_object_get_value_by_key(object, key));
+}
+
+int json_object_get_boolean_by_key(const JSON_Object *object, const JSON_Key *key) {
+	return json_value_get_boolean(json_object_get_value_by_key(object, key));
+}
+
 
 
 size_t json_object_get_count(const JSON_Object *object) {
@@ -1884,6 +2041,10 @@ JSON_Status json_object_remove(JSON_Object *object, const char *name) {
 				object->values[i] = object->values[last_item_index];
 			}
 			object->count -= 1;
+			json_object_index_release(object);
+			if (object->count >= OBJECT_INDEX_THRESHOLD) {
+				json_object_index_build(object); /* items moved */
+			}
 			return JSONSuccess;
 		}
 	}
@@ -1918,6 +2079,7 @@ JSON_Status json_object_clear(JSON_Object *object) {
 		json_value_free(object->values[i]);
 	}
 	object->count = 0;
+	json_object_index_release(object);
 	return JSONSuccess;
 }
 
@@ -56,6 +56,13 @@ extern "C"
 	};
 	typedef int JSON_Status;
 
+	/* Key with its length and hash already calculated, name must stay valid (use literals) */
+	typedef struct json_key_t {
+		const char    *name;
+		size_t         length;
+		unsigned long  hash;
+	} JSON_Key;
+
 	typedef void * (*JSON_Malloc_Function)(size_t);
 	typedef void(*JSON_Free_Function)(void *);
 
@@ -136,6 +143,20 @@ extern "C"
 	double        json_object_dotget_number_with_std(const JSON_Object *object, std::string name); /* returns 0 on fail */
 	int           json_object_dotget_boolean_with_std(const JSON_Object *object, std::string name); /* returns -1 on fail */
 
+	/* Resolve a path of nested objects once (a trailing dot is ignored, ex: "GameObject3.Components.")
+	and then read the fields of the node with keys. Objects with many names use a hash index,
+	it's updated when the object changes so reading threads don't write to the document. */
+	JSON_Object * json_object_dotget_node(const JSON_Object *object, const char *path);
+	JSON_Object * json_object_dotget_node_with_std(const JSON_Object *object, const std::string& path);
+
+	JSON_Key      json_key(const char *name);
+	JSON_Value  * json_object_get_value_by_key(const JSON_Object *object, const JSON_Key *key);
+	const char  * json_object_get_string_by_key(const JSON_Object *object, const JSON_Key *key);
+	JSON_Object * json_object_get_object_by_key(const JSON_Object *object, const JSON_Key *key);
+	JSON_Array  * json_object_get_array_by_key(const JSON_Object *object, const JSON_Key *key);
+	double        json_object_get_number_by_key(const JSON_Object *object, const JSON_Key *key); /* returns 0 on fail */
+	int           json_object_get_boolean_by_key(const JSON_Object *object, const JSON_Key *key); /* returns -1 on fail */
+
 
 																						   /* Functions to get available names */
 	size_t        json_object_get_count(const JSON_Object *object);